@@ -328,6 +328,67 @@ class BilinearHinterp : public HLatLonInterp {
       */
       void vinterpVector( int n, const real* lons, const real* lats, const real* zs, real *xvals, real *yvals, const GridLatLonField3D& xgrid, const GridLatLonField3D& ygrid, const Vinterp& vin, int flags=0 ) const; 
 
+      /// interpolates a 3D field to an array of points, reusing cached stencils
+      /*! This function interpolates to an array of points horizontally and vertically,
+          as does the array version of vinterp() above, but it takes the grid cells 
+          and the bilinear weights from an HLatLonStencil object, which it
+          first brings up to date for the given points.
+       
+       \param  n the number of coordinates to interpolate to
+       \param  lons an array of longitudes to interpolate to
+       \param  lats an array of latitudes to interpolate to
+       \param  zs an array of vertical levels to interpolate to
+       \param  results an array of n values which will hold the interpolated results
+       \param  grid a 3D grid of data to be interpolated
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils
+       \param  flags flag values affecting the interpolation
+      */
+      void vinterp( const int n, const real* lons, const real* lats, const real* zs, real* results, const GridLatLonField3D& grid, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const; 
+
+      /// interpolates a vector field to an array of points, reusing cached stencils
+      /*! This function interpolates a vector field to an array of points horizontally and vertically,
+          as does the array version of vinterpVector() above, but it takes the grid cells 
+          and the bilinear weights from an HLatLonStencil object, which it
+          first brings up to date for the given points.
+       
+       \param  n the number of points
+       \param  lons the array of the longitudes to interpolate to
+       \param  lats the array of latitudes to interpolate to
+       \param  zs the array of vertical level to interpolate to
+       \param  xvals the interpolated x vector components
+       \param  yvals the interpolated y vector components
+       \param  xgrid a 3D grid of vector x component data to be interpolated
+       \param  ygrid a 3D grid of vector y component data to be interpolated
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils
+       \param  flags flag values affecting the interpolation
+      */
+      void vinterpVector( int n, const real* lons, const real* lats, const real* zs, real *xvals, real *yvals, const GridLatLonField3D& xgrid, const GridLatLonField3D& ygrid, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const; 
+
+      /// interpolates a 3D field at two times to an array of points, from interleaved data
+      /*! This function interpolates two time snapshots of a quantity to an array of points
+          at once, using cached stencils. The data values are taken from an array 
+          in which the values of the two snapshots are interleaved, so that
+          each corner of each grid cell is looked up once for both times.
+       
+       \param  n the number of coordinates to interpolate to
+       \param  lons an array of longitudes to interpolate to
+       \param  lats an array of latitudes to interpolate to
+       \param  zs an array of vertical levels to interpolate to
+       \param  results1 an array of n values which will hold the interpolated results for the first snapshot
+       \param  results2 an array of n values which will hold the interpolated results for the second snapshot
+       \param  grid a 3D grid that supplies the geometry and fill value of both snapshots
+       \param  pairs an array of 2*grid.dataSize() values, holding the value of the first
+                      snapshot at the gridpoint with direct index i in pairs[2*i], and the value of the second
+                      snapshot in pairs[2*i+1]
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils
+       \param  flags flag values affecting the interpolation
+       \return true
+      */
+      bool vinterpPair( const int n, const real* lons, const real* lats, const real* zs, real* results1, real* results2, const GridLatLonField3D& grid, const real* pairs, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const; 
+
 /*! \name Standard Hinterp methods
  These methods implement the standard methods required by the Hinterp class. 
 */
@@ -712,6 +773,16 @@ class BilinearHinterp : public HLatLonInterp {
            return result;
       }
 
+      /// private convenience function, given precomputed weights
+      inline real minicalc( real fx, real fy
+                          , real d11, real d21, real d12, real d22 ) const
+      {
+           return ( d22 - d12 - d21 + d11 )*fx*fy
+               + ( d21 - d11 ) * fy
+               + ( d12 - d11 ) * fx
+               + d11;
+      }
+
       
    
 };
@@ -19,6 +19,15 @@ Using and object of this class, a parcel may be initialized in, say, pressure al
 converted to potential temperature for tracing in quasi-isentropic mode and subsequent conversion 
 and output back to pressure altitudes.
 
+When the filter is applied to a collection of Parcels, the Parcels that share
+a meteorological data source, a time, and a NonVert status are converted together,
+using the array form of MetData::getData(). In that case, a Parcel whose 
+vertical coordinate cannot be converted (because of bad or missing meteorological data)
+does not cause an exception to be thrown. Instead, its vertical coordinate
+is left unchanged, its HitBad status and NoTrace flag are set, and it is counted in badCount().
+Applied to a Flock or a Swarm, the filter works on each processor's own Parcels, 
+with no need to route the Parcels through a single processor.
+
 */
 
 class ChangeVertical : public ParcelFilter {
@@ -124,6 +133,19 @@ class ChangeVertical : public ParcelFilter {
       */
       void apply( Parcel * const p, const int n ); 
 
+      /// apply the ChangeVertical filter to an array of Parcels, with per-Parcel error flags
+      /*! Apply the filter to an array of parcels
+      
+      \param p the array of Parcel objects to which the filter is to be applied
+    
+      \param n the number of Parcel objects in the array
+      
+      \param errs if not NULL, a pointer to an array of n ints. On return, each element is 0 
+                  if the corresponding Parcel was converted, or 1 if it could not be.
+
+      */
+      void apply( Parcel * const p, const int n, int *errs ); 
+
       /// apply the ChangeVertical filter to  a vector of parcels
       /*! This method applies the ChangeVertical filter to a vector of Parcels.
       
@@ -156,6 +178,26 @@ class ChangeVertical : public ParcelFilter {
       */
       void apply( Flock& p ); 
 
+      /// apply the ChangeVertical filter to  a Swarm of parcels
+      /*! This method applies the ChangeVertical filter to a Swarm of Parcels.
+      
+          \param p the Swarm of Parcel objects to to which the ChangeVertical filter is to be applied
+           
+      */
+      void apply( Swarm& p ); 
+      
+      /// returns the number of Parcels that could not be converted
+      /*! This method returns the number of Parcels (on this processor) whose vertical coordinates could not
+          be converted because of bad or missing meteorological data, 
+          the last time the filter was applied to a collection of Parcels.
+          
+          \return the number of Parcels that could not be converted
+      */
+      inline int badCount() const
+      {
+          return nbad;
+      }
+
 
     private:
     
@@ -169,6 +211,18 @@ class ChangeVertical : public ParcelFilter {
        MetData *metsrc;
        // if true, then we had to create our own met data source
        bool myMet;
+       // the number of parcels that could not be converted
+       int nbad;
+       
+       // works out how to convert a parcel's vertical coordinate:
+       // using src1 to get quantity q1, and then (if src2 is not NULL)
+       // using src2 to get quantity q2 from that. If src1 is NULL, then 
+       // no conversion is needed.
+       void plan( const Parcel& p, MetData* psrc, std::string &fromQ, std::string &toQ
+                , MetData** src1, std::string &q1, MetData** src2, std::string &q2 );
+       
+       // converts a set of parcels in batches
+       void convert( const int n, Parcel** const p, int *errs );
 
 };
 }
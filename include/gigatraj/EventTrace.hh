@@ -0,0 +1,238 @@
+#ifndef GIGATRAJ_EVENTTRACE_H
+#define GIGATRAJ_EVENTTRACE_H
+
+#include <string>
+#include <vector>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/ProcessGrp.hh"
+#include "gigatraj/Instrument.hh"
+
+namespace gigatraj {
+
+///@name Interprocess Communications Tags
+//@{
+/// Interprocess Communications Tags: "event trace timeline contents"
+static const int PGR_TAG_TRACE = 3120;
+//@}
+
+/*!
+\ingroup misc
+   \brief records a timeline of met data traffic between processors
+   
+ The EventTrace class records timed events on each processor of a 
+ processor group, such as the met data requests 
+ that met client processors send to met server processors, the service of those 
+ requests, and the transfer of grid point values. 
+ Each event carries the processor on the other end of the transaction,
+ the met quantity and snapshot time involved, and the number of bytes moved.
+ When the recording is finished, the events from all processors are gathered
+ to the root processor, which writes them to a single file in the Chrome 
+ trace event (JSON) format. That file may be loaded into a timeline viewer 
+ such as Perfetto (ui.perfetto.dev) or chrome://tracing, in which each processor
+ has its own track. This makes it easy to see convoying of requests, 
+ head-of-line blocking at a met server, and idle time.
+ 
+ The library records events through the GT_EVENT_BEGIN(), GT_EVENT_END(),
+ GT_EVENT_MARK(), and GT_EVENT_BYTES() macros. Like those of the Instrument class,
+ these macros expand to nothing unless gigatraj was configured with
+ the --enable-instrument option. Even then, nothing is recorded until start() is called.
+ 
+ Time stamps on each processor are measured from the moment that processor 
+ left the synchronization in start(), so that the timelines of processors 
+ on different nodes line up to within the precision of that synchronization.
+
+ The events and the byte count are kept in process-wide variables. When gigatraj
+ has been configured with the --enable-threads option, updates to them are serialized,
+ so that the threads of a Swarm (see Swarm::setThreads()) may record events.
+ Otherwise, events must be recorded by only one thread at a time.
+ The start() and finish() methods must not be called while other threads are recording events.
+
+*/
+class EventTrace {
+
+   public:
+   
+      /// the beginning of an event
+      /*! An object of the Span class holds the starting time of an event,
+          along with the count of bytes moved by this processor at that time.
+      */
+      class Span {
+      
+         public:
+         
+            /// constructor, which marks the beginning of an event
+            Span();
+            
+            /// the time at which the event began
+            double begin;
+            /// the number of bytes moved by this processor before the event began
+            long bytes0;
+      
+      };
+   
+      /// starts recording events
+      /*! This method starts recording events. It must be called by 
+          every processor in the group.
+      
+          \param pgrp the processor group whose events are to be recorded. If this is NULLPTR,
+                      only the events on this processor are recorded.
+          \param filename the name of the file to which the timeline is to be written by finish()
+          \param maxevents the maximum number of events to be recorded by each processor.
+                      Events past this limit are counted but not kept.
+      */
+      static void start( ProcessGrp* pgrp, const std::string& filename, int maxevents=1000000 );
+      
+      /// stops recording events and writes the timeline
+      /*! This method stops recording events, gathers the events to the root processor,
+          and writes them to the file given to start(). It must be called by every processor
+          in the group. If start() has not been called, it does nothing.
+      */
+      static void finish();
+   
+      /// returns whether events are being recorded
+      /*! \return true if events are being recorded, false otherwise
+      */
+      static inline bool active() 
+      {
+         return on;
+      };
+      
+      /// records an event that spans a period of time
+      /*! This method records a timed event, which runs from the beginning held in
+          a Span object until now.
+      
+          \param name the name of the event. This must be a string that will remain 
+                      valid until finish() is called (e.g., a string literal).
+          \param span the beginning of the event
+          \param peer the processor on the other end of the transaction (-1 if none)
+          \param quantity the met quantity involved (empty if none)
+          \param time the met data snapshot time involved (empty if none)
+          \param bytes the number of bytes moved in the event. If negative,
+                       the number of bytes counted by addBytes() since the beginning of the event is used.
+      */
+      static void event( const char* name, const Span& span, int peer=-1
+                       , const std::string& quantity="", const std::string& time="", long bytes=-1 );
+      
+      /// records an instantaneous event
+      /*! This method records an event that takes no time, such as sending a request.
+      
+          \param name the name of the event. This must be a string that will remain 
+                      valid until finish() is called (e.g., a string literal).
+          \param peer the processor on the other end of the transaction (-1 if none)
+          \param quantity the met quantity involved (empty if none)
+          \param time the met data snapshot time involved (empty if none)
+          \param bytes the number of bytes moved in the event (negative if not applicable)
+      */
+      static void instant( const char* name, int peer=-1
+                         , const std::string& quantity="", const std::string& time="", long bytes=-1 );
+      
+      /// counts bytes moved by this processor
+      /*! \param n the number of bytes sent or received
+      */
+      static void addBytes( long n );
+      
+      /// returns a name for a met data request command
+      /*! \param cmd a PGR_CMD_* command code
+          \return the name of the command (e.g., "PGR_CMD_M3D")
+      */
+      static const char* cmdName( int cmd );
+
+   private:
+
+      /// a single recorded event
+      struct Event {
+         /// the event name
+         const char* name;
+         /// "X" for an event with a duration, "i" for an instant
+         char phase;
+         /// starting time, in seconds since start()
+         double ts;
+         /// duration, in seconds
+         double dur;
+         /// the processor on the other end
+         int peer;
+         /// the met quantity
+         std::string quantity;
+         /// the met snapshot time
+         std::string time;
+         /// bytes moved
+         long bytes;
+      };
+   
+      /// whether we are recording events
+      static bool on;
+      /// the processor group
+      static ProcessGrp* grp;
+      /// the output file name
+      static std::string fname;
+      /// the time at which recording began
+      static double t0;
+      /// the events recorded on this processor
+      static std::vector<Event> events;
+      /// the maximum number of events to keep
+      static int maxev;
+      /// the number of events not kept
+      static long dropped;
+      /// the number of bytes moved by this processor
+      static long nbytes;
+      
+      /// returns the number of bytes moved by this processor so far
+      static long bytesSoFar();
+      
+      /// adds an event to the list
+      static void add( const char* name, char phase, double begin, double end, int peer
+                     , const std::string& quantity, const std::string& time, long bytes );
+      
+      /// formats this processor's events as JSON 
+      static std::string format( int rank );
+
+};
+
+}
+
+
+#ifdef USE_INSTRUMENT
+
+/// marks the beginning of an event, held in variable "var"
+#define GT_EVENT_BEGIN(var) \
+   gigatraj::EventTrace::Span var
+/// records an event that began at the Span held in "var"
+#define GT_EVENT_END(var,name,peer,quantity,time,bytes) \
+   do { \
+      if ( gigatraj::EventTrace::active() ) { \
+         gigatraj::EventTrace::event( (name), var, (peer), (quantity), (time), (bytes) ); \
+      } \
+   } while (0)
+/// records an instantaneous event
+#define GT_EVENT_MARK(name,peer,quantity,time,bytes) \
+   do { \
+      if ( gigatraj::EventTrace::active() ) { \
+         gigatraj::EventTrace::instant( (name), (peer), (quantity), (time), (bytes) ); \
+      } \
+   } while (0)
+/// counts bytes moved by this processor
+#define GT_EVENT_BYTES(n) \
+   gigatraj::EventTrace::addBytes( (n) )
+
+#else
+
+#define GT_EVENT_BEGIN(var)
+#define GT_EVENT_END(var,name,peer,quantity,time,bytes)
+#define GT_EVENT_MARK(name,peer,quantity,time,bytes)
+#define GT_EVENT_BYTES(n)
+
+#endif
+
+#endif
+
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
@@ -12,6 +12,7 @@
 #define GIGATRAJ_FLOCK_H
 
 #include <vector>
+#include <map>
 
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/Parcel.hh"
@@ -22,6 +23,18 @@
 
 namespace gigatraj {
 
+///@name Interprocess Communications Tags
+//@{
+/// Interprocess Communications Tags: "Flock tracer load counts"
+static const int PGR_TAG_FKLOAD = 3200;
+/// Interprocess Communications Tags: "Flock parcel migration plan"
+static const int PGR_TAG_FKPLAN = 3205;
+/// Interprocess Communications Tags: "Flock migrating parcel contents"
+static const int PGR_TAG_FKMOVE = 3210;
+/// Interprocess Communications Tags: "Flock parcel ownership changes"
+static const int PGR_TAG_FKOWNR = 3215;
+//@}
+
 /*!  \ingroup parcels
 
 \brief parallelizable collection of Parcels.  
@@ -69,6 +82,13 @@ to get their wind values.  Again, this should work transparently
 with no additional programming effort required.  The Flock simply 
 takes care of it.
 
+Internally, each processor holds its share of the Flock not as
+individual Parcel objects but as contiguous arrays of Parcel
+contents (longitudes, latitudes, vertical coordinates, times, and so on),
+as the Swarm class does. This lets the advance() method hand the
+position arrays directly to the Integrator, block by block, with no
+copying in and out of Parcel objects at each time step.
+
 Thus, the Flock class enables a programmer to 
 write a custom massively-parallel trajectory model 
 in a straighforward way, without having to worry (much)
@@ -115,9 +135,12 @@ class Flock {
          \param r    the ratio of meteorological-data processors to parcel-tracing processors.
                      (For example, if r=3 then there will be one met processor for
                      every 3 parcel-tracing processors) 
+         \param s    the number of meteorological-data processors in each processor (sub)group.
+                     If s > 1, then met data requests are sharded among the s met processors
+                     by quantity and snapshot time.
                     
      */
-     Flock( ProcessGrp* pgrp, int n=0, int r=0);
+     Flock( ProcessGrp* pgrp, int n=0, int r=0, int s=1);
      
      /// Parcel-initializing constructor
      /*! This Flock constructor assigns N parcels by copying a user-supplied Parcel object. 
@@ -140,9 +163,12 @@ class Flock {
          \param r  the ratio of meteorological-data processors ot tracing processors.
                   (For example, if r=3 then there will be one met processor for
                   every 3 parcel-tracing processors) 
+         \param s  the number of meteorological-data processors in each processor (sub)group.
+                  If s > 1, then met data requests are sharded among the s met processors
+                  by quantity and snapshot time.
                     
      */
-     Flock( const Parcel &p, ProcessGrp* pgrp, int n=0, int r=0);
+     Flock( const Parcel &p, ProcessGrp* pgrp, int n=0, int r=0, int s=1);
      
 
      /// The destructor
@@ -188,6 +214,20 @@ class Flock {
      {
          return pgroup->type();
      }
+     /// returns the number of Parcels handled by this processor
+     inline int local_size() const 
+     {
+         return my_num_parcels;
+     }
+
+     /// returns the global index of a local parcel
+     /*! This method returns the Flock-wide index of one of the current processor's parcels.
+     
+         \param k the local parcel number, running from 0 to (local_size()-1)
+     
+         \return the global index of the parcel
+     */
+     int global_index( int k ) const;
 
 
      class iterator;
@@ -196,6 +236,17 @@ class Flock {
      \brief iterator for the Flock class.
 
      The iterator for this Parcel container class.
+     Since a Flock does not hold actual Parcel objects but only arrays of 
+     their contents, de-referencing the iterator yields a Parcel that is internal
+     to the iterator. It is loaded from the Flock's arrays when the iterator
+     is positioned on an element, and its contents are stored back
+     into those arrays when the iterator is incremented.
+     
+     This means that the Flock's contents must not be accessed with an iterator and 
+     directly accessed (using the set() method, get() method, parcel() method, or [] operator)
+     within the same loop.  And if a loop is exited before the iterator 
+     reaches end(), then the iterator's stop() method should be called
+     so that the last Parcel is stored back into the Flock.
 
      In a serial-processing environment this class functions
      as a conventional iterator, cycling through every Parcel in the
@@ -244,7 +295,7 @@ class Flock {
                
                \return the current Parcel on this processor
            */    
-           Parcel& operator*() const;
+           Parcel& operator*();
 
            /// operator -> override
            /*! This method overrides the -> operator, permitting de-referencing the iterator
@@ -252,7 +303,7 @@ class Flock {
                
                \return the current Parcel on this processor
            */    
-           Parcel* operator->() const;
+           Parcel* operator->();
            
            /// operator == override 
            /*! This method overrides the == operator, allowing for
@@ -297,6 +348,13 @@ class Flock {
                
            */    
            int index() const;
+           
+           /// cleans up after a premature exit
+           /*! This method should be called if an iterator loop is exited in some
+               way other than incrementing the iterator to end(). It copies
+               the iterator's copy of the current Parcel back into the Flock.
+           */
+           void stop();    
      
         protected:
            friend class Flock;
@@ -316,6 +374,15 @@ class Flock {
            int my_parcel;
            // which Flock is this an iterator for?
            Flock* my_flock;
+           // the Parcel that holds the contents of the current parcel of the Flock
+           Parcel pcl;
+           // whether pcl has been loaded from the Flock
+           bool loaded;
+           
+           // loads pcl from the Flock's arrays
+           void load();
+           // stores pcl back into the Flock's arrays
+           void store();
      
      };
 
@@ -484,7 +551,8 @@ class Flock {
                      Regardless of mode setting, all met-reading processors
                      will return a NULL pointer from this method.
 
-          \return a pointer to the desired Parcel. or NULL (see mode, above)
+          \return a pointer to a new copy of the desired Parcel, or NULL (see mode, above).
+                  The caller is responsible for deleting the copy.
                   
      */
      Parcel* parcel( const int n, const int mode=0 ) const;
@@ -505,11 +573,11 @@ class Flock {
                      Regardless of mode setting, all met-reading processors
                      will throw a badparcelindex error from this method.
 
-          \return a reference to the desired Parcel. Note that this reference points to 
-                  a member of the Flock and thus should never be deleted!.
+          \return a copy of the desired Parcel. Note that changing this Parcel
+                    does NOT affect the original that is still in the Flock.
                            
      */
-     Parcel& get( const int n, const int mode=0 ) const;
+     Parcel get( const int n, const int mode=0 ) const;
      
      /// operator [] override
      /*! This method overrides the [] operator, providing a convenient notation
@@ -520,10 +588,10 @@ class Flock {
           \param n the index of the parcel to be replaced.  (This is relative
                   to the entire flock, not just one processor's subset.)
 
-          \return a reference to the desired Parcel. Note that this reference points to 
-                  a member of the Flock and thus should never be deleted!.
+          \return a copy of the desired Parcel. Note that changing this Parcel
+                    does NOT affect the original that is still in the Flock.
      */
-     Parcel& operator[]( int n );
+     Parcel operator[]( int n );
      
 
      /// adds a single parcel to the flock
@@ -542,14 +610,84 @@ class Flock {
      
      /// advance the parcels by one time step
      /*! This methods advances the parcels in the Flock in time.
+         The parcels are handed to the Integrator in blocks of at most
+         blocksize parcels, working directly on the Flock's internal arrays.
+         Parcels that are flagged NoTrace or have hit a bad value or boundary
+         are left as they are, as are SyncTrace parcels whose time has not yet come.
+         The met data source's MetData::setStepSync() setting determines
+         whether the processors wait for each other at the end of the step.
+         Before the step, the region spanned by the parcels is passed
+         to the met data source's MetData::haloRegion() method.
       
          \param dt the delta-time over which the parcel is to advance
          
+         If load-balancing has been turned on with setRebalance(), then
+         every few time steps, after the parcels have been advanced, the tracing 
+         processors report their numbers of active parcels to the root processor,
+         and the active parcels are redistributed among the tracing processors 
+         (see setRebalance()).
+      
          \return always returns zero.
          
      */
      int advance( double dt );
      
+     /// turns on load-balancing of active parcels among the tracing processors
+     /*! This works just as it does for the Swarm class (see Swarm::setRebalance()):
+         every so often, the advance() method migrates active parcels from the more heavily-loaded
+         tracing processors to the more lightly-loaded ones. Migrated parcels
+         keep their index within the Flock, so that the get(), set(), parcel(), and
+         iterator index() methods continue to refer to the same parcels as before.
+         
+         This is a collective operation: all processors in the Flock's
+         processor group must call it with the same value.
+         
+         \param every if > 0, then the load statistics are gathered and the parcels 
+                      are re-balanced every this-many calls to advance().
+                      If < 0, then load statistics are gathered every -every
+                      calls to advance(), but no parcels are migrated. 
+                      If 0 (the default), then neither is done.
+     */
+     void setRebalance( int every );
+     
+     /// returns how often the parcels are re-balanced
+     /*! This method returns the load-balancing setting.
+     
+         \return the number of advance() calls between re-balancings 
+                  (see setRebalance())
+     */
+     int getRebalance() const;
+     
+     /// returns the load imbalance from the most recent re-balancing step
+     /*! This method returns the largest per-processor number of active parcels,
+         divided by the mean number over all tracing processors, as of
+         the last time advance() gathered the load statistics.
+         A perfectly balanced load yields 1.0. 
+         
+         The statistic is valid only on the root processor, and only if
+         load statistics are being gathered (see setRebalance()).
+         
+         \return the load imbalance ratio, or 0.0 if it is not available.
+     */
+     real loadImbalance() const;
+     
+     /// returns the number of active parcels on each processor from the most recent re-balancing step
+     /*! The values are valid only on the root processor, and only if
+         load statistics are being gathered (see setRebalance()).
+         Met processors always have zero.
+
+         \return a vector of active parcel counts, indexed by processor ID.
+     */
+     const std::vector<int>& loads() const;
+     
+     /// returns the number of parcel migrations so far
+     /*! This method returns the total number of parcels that have
+         been moved from one processor to another by load-balancing.
+         
+         \return the number of migrated parcels
+     */
+     int migrations() const;
+     
      
      /// synchronizes the Flock's processors
      /*! This method synchronizes the Flock's processors.
@@ -634,6 +772,45 @@ class Flock {
      */
      std::vector<int> pclends;
    
+     /// The (pgroup) IDs of the parcel-tracing processors
+     /*! This holds the IDs of the parcel-tracing processors, 
+         in ascending order.
+     */
+     std::vector<int> tracers;
+     
+     /// The owner of each parcel, once parcels have been migrated
+     /*! Once load-balancing has moved parcels between processors,
+         the pclstarts and pclends ranges no longer describe
+         which processor holds which parcel. This vector then holds
+         the (pgroup) ID of the processor that handles each parcel,
+         indexed by the parcel's global index.  It is empty until the first
+         migration.
+     */
+     std::vector<int> pclowners;
+     
+     /// The number of parcels held by each processor, once parcels have been migrated
+     std::vector<int> pclcounts;
+     
+     /// Maps a global parcel index to this processor's local parcel number
+     /*! This is used only once parcels have been migrated.
+     */
+     std::map<int,int> pcllocal;
+     
+     /// how often to re-balance the parcel load among processors
+     int rebal_every;
+     
+     /// number of calls to advance() since load-balancing was turned on
+     int rebal_count;
+     
+     /// the total number of parcels migrated
+     int rebal_moved;
+     
+     /// the number of active parcels on each processor, as of the last re-balancing step
+     std::vector<int> pclloads;
+     
+     /// the load imbalance ratio as of the last re-balancing step
+     real load_imbalance;
+
 
      /// the starting parcel index for this process
      /*!
@@ -648,17 +825,81 @@ class Flock {
      */
      int my_num_parcels;
 
-     /// the list of this processor'e parcels 
+     /// a sample parcel
+     /*! This is a copy of the Parcel used to initialize the Flock. 
+         Even met-processors, which have no parcels of their own, 
+         hold one, so that they have access to the met data source.
+     */
+     Parcel* sample_p;
+     
+     /// The size of the arrays that hold the Parcel information
+     unsigned int info_size;
+     
+     /// How much to increment the parcel info arrays when they need to grow
+     unsigned int info_inc;
+
+     //! Longitudes
      /*!
-        This vector hold the Parcels that are being traced on this processor.
-        
-        In a multi-processor environment handlig huge number of parcels, 
-        we do not need or want to keep a copy of each Parcel on each processor.
-        So this vector holds only those Parcles that have been assigned to the
-        local processor. 
+      The longitudes of the parcels on this processor. 
         
+      In a multi-processor environment handlig huge number of parcels, 
+      we do not need or want to keep a copy of each Parcel on each processor.
+      So this array and the ones that follow hold only the contents of those 
+      Parcels that have been assigned to the local processor. 
+     */
+     real *lons;
+
+     //! Latitudes
+     /*!
+      The parcel latitudes
+     */
+     real *lats;
+
+     //! Vertical positions
+     /*!
+     The parcel vertical positions
+     */
+     real *zs;
+
+     //! Times
+     /*!      
+     The  parcel times, in internal model units.
      */
-     std::vector<Parcel*>  parcels;
+     double *ts;
+     
+     //! Tags
+     /*!
+     The parcel tags
+     */
+     double *tgs;
+     
+     //! Flags
+     /*!      
+     The parcel flags 
+     */
+     ParcelFlag *flagsets;
+
+     //! Status
+     /*!      
+     The parcel status
+     */
+     ParcelStatus *statuses;
+     
+     //! Trace flags
+     /*!
+     Scratch space for the per-parcel flags passed to the Integrator
+     by the advance() method. It is sized along with the other arrays, 
+     so that no allocation is needed at each time step.
+     */
+     int *traceflags;
+     
+     //! Global index number
+     /*!
+     The global (Flock-wide) index of each parcel, indexed in the same way as
+     lons, lats, etc.  This is used only once parcels have been migrated among
+     processors by load-balancing.
+     */
+     int *gids;
      
      /// the process that handles the met data
      /*! 
@@ -690,11 +931,58 @@ class Flock {
      */    
      int belongs(const int n) const;
      
+     /// returns the storage location of a parcel
+     /*! This method returns the location in the internal parcel information arrays
+         (lons, lats, etc.) of a parcel that is handled by the current processor.
+         
+         \param n the global index of the parcel
+         
+         \return the location of the parcel in the arrays, or -1 if the parcel is not 
+                 handled by this processor.
+     */
+     int local_index( int n ) const;
+
+     /// gathers load statistics and re-balances the parcels
+     /*! This method is called by the tracing processors from advance().
+         It gathers the numbers of active parcels from all the tracing
+         processors, and optionally migrates parcels among them to 
+         even out the load.
+         
+         \param tyme the current model time
+         \param move if true, then parcels will be migrated as needed; otherwise,
+                      only the load statistics are gathered.
+     */
+     void balance( double tyme, bool move );
+     
+     /// migrates parcels among processors
+     /*! This method carries out a re-balancing plan, sending parcels from one
+         processor to another and updating everyone's notion of which processor
+         handles each parcel.
+         
+         \param nmoves the number of moves in the plan
+         \param moves an array of 3*nmoves ints: for each move, the sending
+                      processor, the receiving processor, and the number of parcels
+                      to be moved.
+         \param tyme the current model time
+     */
+     void migrate( int nmoves, const int* moves, double tyme );
+     
+     /// tests whether a parcel is to be traced
+     /*! This method tests whether a parcel will be traced by the
+         next call to advance().
+         
+         \param idx the location of the parcel in the internal arrays
+         \param tyme the current model time
+         
+         \return true if the parcel is active, false otherwise.
+     */
+     bool active( int idx, double tyme ) const;
+     
      /// universal constructor routine
      /*!
         This is an internal method used by all the constructors to initialized the Flock.
      */
-     void setup( const Parcel &p, ProcessGrp* pgrp, int n, int r);
+     void setup( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s=1);
 
      /// makes an id string for a processor group
      /*! This method makes a string that can be used as a tag 
@@ -707,6 +995,18 @@ class Flock {
      */    
      std::string make_proc_id ( const std::string& tag, int i ) const;
 
+     /// grow the number of parcels this Flock can hold by N
+     /*!
+         This method checks to see if the internal Parcel information arrays
+         can hold another N parcels. If they can, no action is taken.
+         If not, then new, larger arrays are created that replace
+         the current arrays.
+         
+         \param n the number of Parcels to be added to this Flock.
+
+     */
+     void grow( int n=1 );
+
      /// (stub) copy constructor
      /*! Note: Copy construction is not permitted.  The Flock has a potentially
          large collection of processors and Parcels, and there is no good
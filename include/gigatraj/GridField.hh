@@ -661,14 +661,16 @@ class GridField {
       }
              
       /// vector containing the gridded data values (in row-major order)
-      std::vector<real> data;
+      std::vector<gridreal> data;
       
       /// flag to use arrays instead of vectors
       bool use_array;
       /// number of data 
       int nd;
       /// data array
-      real* dater;
+      /*! The values are stored as type gridreal, which may be less precise than type real.
+      */
+      gridreal* dater;
 
       /// used by child classes for operator= overriding methods
       void assign( const GridField& src);
@@ -682,6 +684,21 @@ class GridField {
       /// checks vertical levels
       void checkLevs( const std::vector<real> levs ) const; 
       
+      /// (parallel processing) fetches gridpoint values from the met processor
+      /*! This method sends a list of data array indices to the met processor,
+          and receives the corresponding data values.
+          
+          Parcels that are clustered together (as in a release from a point source)
+          ask for many of the same gridpoints. So the indices are de-duplicated
+          first, each distinct gridpoint is requested only once, and the values
+          are then scattered back to all the places that asked for them.
+          
+          \param n the number of gridpoints 
+          \param indices an array of n data array indices
+          \param vals an array of n values to be filled in
+      */
+      void remote_gridpoints( int n, const int* indices, real* vals ) const;
+      
       
 };
 }
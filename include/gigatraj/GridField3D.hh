@@ -111,7 +111,7 @@ class GridField3D : public GridField {
            \param k the index of the z-coordinate gridpoint
            \return a reference to the [i,j,k]th element of the data grid
       */     
-      virtual real& valueref( int i, int j, int k ) = 0;
+      virtual gridreal& valueref( int i, int j, int k ) = 0;
 
       /// returns an array of data values
       /*! This method fills an array of data values.
@@ -154,7 +154,7 @@ class GridField3D : public GridField {
           \param k the z-coordinate index
           \return a reference to the [i,j,k]th data value
       */    
-      real& operator()( int i, int j, int k );
+      gridreal& operator()( int i, int j, int k );
       
       /// returns the name of the vertical coordinate
       /*! This method returns the name of the vertical coordinate (that is, the name
@@ -226,7 +226,7 @@ class GridField3D : public GridField {
           /param zvals the array of vertical levels to be "absorbed"
             
      */    
-      void absorbLevels( int n, real* zvals );
+      void absorbLevels( int n, gridreal* zvals );
 
      /// returns a copy of the vertical dimension
      /*! This method returns a copy of the vertical dimension
@@ -435,6 +435,34 @@ class GridField3D : public GridField {
       */      
       virtual void svr_send_meta(int id) const = 0;
 
+      /// (parallel processing) sets the region whose data a met client is to hold locally
+      /*! A met data client normally asks its met processor for
+          each gridpoint value needed for an interpolation. If a region is set here,
+          the client instead asks for the whole sub-block of gridpoints that covers the
+          region (plus one gridpoint on each side, for the interpolation stencil) once,
+          the first time it needs gridpoints from this grid, and then serves subsequent
+          gridpoints() calls from that local copy. Gridpoints that lie outside
+          the sub-block are still fetched individually from the met processor.
+          If a new region is not contained in the sub-block already held,
+          then the new sub-block is fetched at the next gridpoints() call.
+
+          This class does not know how its horizontal coordinates
+          are laid out, so this method ignores the region; subclasses
+          override it.
+
+          \param lon0 the westernmost longitude of the region
+          \param lon1 the easternmost longitude of the region. If this is 360 or more
+                      degrees east of lon0, all longitudes are included.
+          \param lat0 the southernmost latitude of the region
+          \param lat1 the northernmost latitude of the region
+          \param z0 the lowest vertical coordinate value of the region
+          \param z1 the highest vertical coordinate value of the region
+      */
+      virtual void setHalo( real lon0, real lon1, real lat0, real lat1, real z0, real z1 );
+
+      /// (parallel processing) drops any region and locally-held sub-block set up by setHalo()
+      void clearHalo();
+
       /// the type of object this is
       static const string iam;
 
@@ -551,7 +579,7 @@ class GridField3D : public GridField {
            iterator( GridField3D* grid, int n=0, int beg=0, int fin=0 );
            
            /// override operator *, returns the reference to current data element
-           real& operator*() const;
+           gridreal& operator*() const;
            
            /// override operator == ; tests two iterators for equallity
            bool operator==(const iterator& x) const;
@@ -1062,7 +1090,31 @@ class GridField3D : public GridField {
 
       /// vector of vertical coordinates
       GridFieldDim zs;
-     
+
+      /// (parallel processing) the sub-block wanted by setHalo(): the starting index and number of points in each dimension
+      int halo_want[6];
+
+      /// (parallel processing) the sub-block held locally, as for halo_want
+      mutable int halo_have[6];
+
+      /// (parallel processing) the values of the locally-held sub-block, first index varying fastest
+      mutable std::vector<real> halo_vals;
+
+      /// (parallel processing) fetches gridpoint values, using the locally-held sub-block where possible
+      /*! This method is used by the gridpoints() methods of subclasses on met clients.
+          If a region has been set with setHalo(), it fetches the sub-block if need be,
+          takes the values it holds from that sub-block,
+          and asks the met processor for the rest.
+
+          \param n the number of gridpoints
+          \param is n-element array of first-indices into the data array
+          \param js n-element array of second-indices into the data array
+          \param ks n-element array of third-indices into the data array
+          \param indices n-element array of simple indices into the data array
+          \param vals an array of n values to be filled in
+      */
+      void halo_gridpoints( int n, const int* is, const int* js, const int* ks, const int* indices, real* vals ) const;
+
 };
 }
 
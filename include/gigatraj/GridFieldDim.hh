@@ -326,7 +326,7 @@ class GridFieldDim : public GridField {
           /param the array of values to be "absorbed"
             
      */    
-      void absorb( int n, real* vals );
+      void absorb( int n, gridreal* vals );
 
      /// returns a new array with the dimensional values 
      /*! Thuis method duplicates the data array of this dimension
@@ -334,7 +334,7 @@ class GridFieldDim : public GridField {
          /param n the number of values returned in the array.
          /return a pointer to the new array. It is the responsibility of the calling rohtine to delete[] it.
      */
-     real* extract( int* n=NULLPTR) const;    
+     gridreal* extract( int* n=NULLPTR) const;    
  
 
      class iterator;
@@ -525,7 +525,7 @@ class GridFieldDim : public GridField {
       bool checkdim( const realvec& inx ) const;
       
       /// checks dimensional values to ensure they are monotonic
-      bool checkdim( int n, const real* inx ) const;
+      bool checkdim( int n, const gridreal* inx ) const;
       
       //void init_md5();
       
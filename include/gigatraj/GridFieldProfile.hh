@@ -163,7 +163,7 @@ class GridFieldProfile : public GridField {
            \param i the index of the coordinate gridpoint
            \return a reference to the [i,j]th element of the data grid
       */     
-      real& valueref( int i );
+      gridreal& valueref( int i );
       
       /// operator overlay allowing for a = obj(i) syntax      
       /*! This operator overlay for () allows 
@@ -185,7 +185,7 @@ class GridFieldProfile : public GridField {
           \param i the coordinate index
           \return a reference to the ith data value
       */    
-      real& operator()( int i );
+      gridreal& operator()( int i );
 
 
       /// returns the vector of vertical levels
@@ -423,7 +423,7 @@ class GridFieldProfile : public GridField {
           /param dvals if non-null, the array of dimensional values to be "absorbed"
             
      */    
-      void absorb( int n, real* vals , real* dvals=NULLPTR);
+      void absorb( int n, gridreal* vals , gridreal* dvals=NULLPTR);
 
 
       /// takes the provided array of dimensional values as its own
@@ -436,7 +436,7 @@ class GridFieldProfile : public GridField {
           /param dvals the array of values to be "absorbed"
             
      */    
-      void absorbZs( int n, real* dvals );
+      void absorbZs( int n, gridreal* dvals );
 
 
 
@@ -473,7 +473,7 @@ class GridFieldProfile : public GridField {
            iterator( GridFieldProfile* grid, int n=0 );
            
            /// override operator *, returns a reference to the current data element
-           real& operator*() const;
+           gridreal& operator*() const;
            
            /// override operator == ; tests two iterators for equallity
            bool operator==(const iterator& x) const;
@@ -124,7 +124,7 @@ class GridFieldSfc : public GridField {
            \param j the index of the y-coordinate gridpoint
            \return a reference to the [i,j]th element of the data grid
       */     
-      virtual real& valueref( int i, int j ) = 0;
+      virtual gridreal& valueref( int i, int j ) = 0;
       
       /// operator overlay allowing for a = obj(i,j) syntax      
       /*! This operator overlay for () allows 
@@ -150,7 +150,7 @@ class GridFieldSfc : public GridField {
           \param j the y-coordinate index
           \return a reference to the [i,j]th data value
       */    
-      real& operator()( int i, int j );
+      gridreal& operator()( int i, int j );
       
       /// returns the name of the surface
       /*! This method returns the name of the surface represwented by this object; e.g., "tropopause").
@@ -374,7 +374,7 @@ class GridFieldSfc : public GridField {
            iterator( GridFieldSfc* grid, int n=0 );
            
            /// override operator *, returns a reference to the current data element
-           real& operator*() const;
+           gridreal& operator*() const;
            
            /// override operator == ; tests two iterators for equallity
            bool operator==(const iterator& x) const;
@@ -114,7 +114,7 @@ class GridLatLonField3D : public GridField3D {
            \param k the index of the z-coordinate gridpoint
            \return a reference to the [i,j,k]th element of the data grid
       */     
-      real& valueref( int i, int j, int k );
+      gridreal& valueref( int i, int j, int k );
       
       /// returns a single data value
       /*! This method returns a single data value, indexed directly into the data array.
@@ -506,7 +506,7 @@ class GridLatLonField3D : public GridField3D {
           /param zvals if non-null, the array of vertical level values to be "absorbed"
             
      */    
-      void absorb( int nlons, int nlats, int nzs, real* vals , real* lonvals=NULLPTR, real* latvals=NULLPTR, real* zvals=NULLPTR);
+      void absorb( int nlons, int nlats, int nzs, gridreal* vals , gridreal* lonvals=NULLPTR, gridreal* latvals=NULLPTR, gridreal* zvals=NULLPTR);
 
       /// takes the provided array of longitude values as its own
       /*! This method takes an array of longitude values and
@@ -518,7 +518,7 @@ class GridLatLonField3D : public GridField3D {
           /param lonvals the array of longitudes to be "absorbed"
             
      */    
-      void absorbLons( int n, real* lonvals );
+      void absorbLons( int n, gridreal* lonvals );
 
       /// takes the provided array of latitude values as its own
       /*! This method takes an array of latitude values and
@@ -530,7 +530,7 @@ class GridLatLonField3D : public GridField3D {
           /param latvals the array of latitudes to be "absorbed"
             
      */    
-      void absorbLats( int n, real* latvals );
+      void absorbLats( int n, gridreal* latvals );
 
       /// (parallel processing) sets the process group and met processor 
       /*! This method sets the process group and met processor for parallel processing.
@@ -542,6 +542,20 @@ class GridLatLonField3D : public GridField3D {
       */
       void setPgroup( ProcessGrp* pg, int met);
 
+      /// (parallel processing) sets the region whose data a met client is to hold locally
+      /*! This method converts a longitude-latitude-vertical region into the
+          sub-block of gridpoints that covers it. See GridField3D::setHalo().
+
+          \param lon0 the westernmost longitude of the region
+          \param lon1 the easternmost longitude of the region. If this is 360 or more
+                      degrees east of lon0, all longitudes are included.
+          \param lat0 the southernmost latitude of the region
+          \param lat1 the northernmost latitude of the region
+          \param z0 the lowest vertical coordinate value of the region
+          \param z1 the highest vertical coordinate value of the region
+      */
+      void setHalo( real lon0, real lon1, real lat0, real lat1, real z0, real z1 );
+
 
 
 
@@ -115,7 +115,7 @@ class GridLatLonFieldSfc : public GridFieldSfc {
            \param j the index of the y-coordinate gridpoint
            \return a reference to the [i,j]th element of the data grid
       */    
-      real& valueref( int i, int j );
+      gridreal& valueref( int i, int j );
       
       
       /// returns a single data value
@@ -491,7 +491,7 @@ class GridLatLonFieldSfc : public GridFieldSfc {
           /param latvals if non-null, the array of latitude values to be "absorbed"
             
      */    
-      void absorb( int nlons, int nlats, real* vals , real* lonvals=NULLPTR, real* latvals=NULLPTR);
+      void absorb( int nlons, int nlats, gridreal* vals , gridreal* lonvals=NULLPTR, gridreal* latvals=NULLPTR);
 
       /// takes the provided array of longitude values as its own
       /*! This method takes an array of longitude values and
@@ -503,7 +503,7 @@ class GridLatLonFieldSfc : public GridFieldSfc {
           /param lonvals the array of longitudes to be "absorbed"
             
      */    
-      void absorbLons( int n, real* lonvals );
+      void absorbLons( int n, gridreal* lonvals );
 
       /// takes the provided array of latitude values as its own
       /*! This method takes an array of latitude values and
@@ -515,7 +515,7 @@ class GridLatLonFieldSfc : public GridFieldSfc {
           /param latvals the array of latitudes to be "absorbed"
             
      */    
-      void absorbLats( int n, real* latvals );
+      void absorbLats( int n, gridreal* latvals );
 
      /// returns a copy of the latitude dimension
      /*! This method returns a copy of the latitude dimension
@@ -7,6 +7,7 @@
 #include "gigatraj/Hinterp.hh"
 #include "gigatraj/GridLatLonField3D.hh"
 #include "gigatraj/GridLatLonFieldSfc.hh"
+#include "gigatraj/HLatLonStencil.hh"
 
 namespace gigatraj {
 
@@ -367,6 +368,87 @@ class HLatLonInterp : public Hinterp {
       */
       virtual void vinterpVector( int n, const real* lons, const real* lats, const real* zs, real *xvals, real *yvals, const GridLatLonField3D& xgrid, const GridLatLonField3D& ygrid, const Vinterp& vin, int flags=0 ) const = 0; 
 
+      /// interpolates a 3D field to an array of points, reusing cached stencils
+      /*! This function is like the array version of vinterp() above, except that it
+          takes an HLatLonStencil object which holds the grid cells and weights
+          from earlier calls. Interpolators that can make use of the stencils
+          bring them up to date and reuse them; the default implementation simply ignores them.
+          
+          The same stencil object may be passed for several grids, such as the 
+          two time snapshots that bracket a desired time, or the several components 
+          of the wind, as long as the grids have the same geometry.
+
+       \param  n the number of coordinates to interpolate to
+       \param  lons an array of longitudes to interpolate to
+       \param  lats an array of latitudes to interpolate to
+       \param  zs an array of vertical levels to interpolate to
+       \param  results an array of n values which will hold the interpolated results
+       \param  grid a 3D grid of data to be interpolated
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils, which may be updated by this call
+       \param  flags flag values affecting the interpolation
+      */
+      virtual void vinterp( const int n, const real* lons, const real* lats, const real* zs, real* results, const GridLatLonField3D& grid, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const
+      {
+          vinterp( n, lons, lats, zs, results, grid, vin, flags );
+      }; 
+
+      /// interpolates a vector field to an array of points, reusing cached stencils
+      /*! This function is like the array version of vinterpVector() above, except that it
+          takes an HLatLonStencil object which holds the grid cells and weights
+          from earlier calls. Interpolators that can make use of the stencils
+          bring them up to date and reuse them; the default implementation simply ignores them.
+
+       \param  n the number of points
+       \param  lons the array of the longitudes to interpolate to
+       \param  lats the array of latitudes to interpolate to
+       \param  zs the array of vertical level to interpolate to
+       \param  xvals the interpolated x vector components
+       \param  yvals the interpolated y vector components
+       \param  xgrid a 3D grid of vector x component data to be interpolated
+       \param  ygrid a 3D grid of vector y component data to be interpolated
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils, which may be updated by this call
+       \param  flags flag values affecting the interpolation
+      */
+      virtual void vinterpVector( int n, const real* lons, const real* lats, const real* zs, real *xvals, real *yvals, const GridLatLonField3D& xgrid, const GridLatLonField3D& ygrid, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const
+      {
+          vinterpVector( n, lons, lats, zs, xvals, yvals, xgrid, ygrid, vin, flags );
+      }; 
+
+      /// interpolates a 3D field at two times to an array of points, from interleaved data
+      /*! This function interpolates to an array of points horizontally and vertically,
+          as does the stencil version of vinterp() above, but for two time snapshots
+          of a quantity at once. Instead of being taken from the grid objects,
+          the data values are taken from a single array in which the values of 
+          the two snapshots are interleaved, so that the values of both snapshots
+          at each gridpoint lie next to each other in memory. This lets each corner 
+          of a grid cell be looked up once for both times.
+          
+          Interpolators that cannot work this way return false without doing anything,
+          and the caller must then interpolate each snapshot separately.
+          The default implementation does this.
+
+       \param  n the number of coordinates to interpolate to
+       \param  lons an array of longitudes to interpolate to
+       \param  lats an array of latitudes to interpolate to
+       \param  zs an array of vertical levels to interpolate to
+       \param  results1 an array of n values which will hold the interpolated results for the first snapshot
+       \param  results2 an array of n values which will hold the interpolated results for the second snapshot
+       \param  grid a 3D grid that supplies the geometry and fill value of both snapshots
+       \param  pairs an array of 2*grid.dataSize() values, holding the value of the first
+                      snapshot at the gridpoint with direct index i in pairs[2*i], and the value of the second
+                      snapshot in pairs[2*i+1]
+       \param  vin a Vinterp object for doing the interpolation to the vertical levels.
+       \param  stencil the cached stencils, which may be updated by this call
+       \param  flags flag values affecting the interpolation
+       \return true if the interpolation was done, false otherwise
+      */
+      virtual bool vinterpPair( const int n, const real* lons, const real* lats, const real* zs, real* results1, real* results2, const GridLatLonField3D& grid, const real* pairs, const Vinterp& vin, HLatLonStencil& stencil, int flags=0 ) const
+      {
+          return false;
+      }; 
+
    
    protected:
 
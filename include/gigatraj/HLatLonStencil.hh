@@ -0,0 +1,252 @@
+#ifndef GIGATRAJ_HLATLONSTENCIL_H
+#define GIGATRAJ_HLATLONSTENCIL_H
+
+#include <vector>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/GridLatLonField3D.hh"
+
+namespace gigatraj {
+
+/*!
+\brief holds the horizontal interpolation stencils for a set of points
+
+\ingroup hinterpolators
+
+An HLatLonStencil object remembers, for each of a set of points,
+the longitude-latitude grid cell that surrounds the point,
+the direct data-array indices of the cell's corners at every vertical level,
+and the fractional position of the point within the cell.
+
+Finding the cell that surrounds a point means searching the grid's
+longitude and latitude dimensions, and assembling the corner indices
+means walking the whole vertical profile. When the same points are interpolated 
+again from another grid with the same geometry (a second time snapshot, or a 
+different wind component), or when a point has moved only a little and is still
+inside the same cell (as happens between the stages of a Runge-Kutta step), that 
+work need not be repeated. An HLatLonInterp object that is handed an HLatLonStencil
+calls update() to bring the stencil up to date for the current points, 
+and then uses the cached indices and weights.
+
+The i-th point is assumed to be the same parcel from one call to the next,
+but nothing depends on it: a point that has left its cached cell (or that 
+belongs to a different parcel altogether) is simply looked up afresh.
+
+*/
+class HLatLonStencil {
+
+   public:
+   
+      /// Default constructor
+      /*!
+         This is the default contructor for the HLatLonStencil class.
+      */
+      HLatLonStencil();
+      
+      /// Default destructor
+      /*!
+         This is the default destructor for the HLatLonStencil class.
+      */
+      ~HLatLonStencil();
+      
+      /// forgets all cached stencils
+      /*! This method marks every cached stencil as stale, so that
+          the next update() call looks up every point afresh.
+      */
+      void clear();
+      
+      /// brings the stencils up to date for a set of points
+      /*! This method ensures that the cached stencils correspond to the given points
+          on the given grid. A point whose coordinates are unchanged is left alone.
+          A point that is still within its cached grid cell keeps its corner indices 
+          but has its weights recomputed. Any other point is looked up on the grid.
+          If the grid geometry differs from the geometry for which the stencils were made,
+          all points are looked up afresh.
+          
+          \param n the number of points
+          \param lons the longitudes of the points
+          \param lats the latitudes of the points
+          \param grid the grid whose geometry is to be used
+      */
+      void update( int n, const real* lons, const real* lats, const GridLatLonField3D& grid );
+      
+      /// returns the number of points
+      /*! This method returns the number of points for which stencils are held.
+      
+          \return the number of points
+      */
+      inline int size() const 
+      {
+          return np;
+      };
+      
+      /// returns the number of vertical levels
+      /*! This method returns the number of vertical levels
+          covered by each stencil.
+          
+          \return the number of vertical levels
+      */
+      inline int levels() const
+      {
+          return nzs;
+      };
+      
+      /// returns the direct corner indices
+      /*! This method returns the direct data-array indices of the grid cell corners.
+          There are four corners per vertical level per point, so that 
+          the index of corner c on level k of point i is at (i*levels() + k)*4 + c.
+          The corners are in the order (i1,j1), (i1,j2), (i2,j1), (i2,j2).
+          
+          \return a pointer to the array of indices
+      */
+      inline const int* indices() const
+      {
+          return &(idxs[0]);
+      };
+      
+      /// returns the corner longitude indices
+      /*! This method returns the longitude indices of the grid cell corners,
+          laid out in the same way as indices().
+          
+          \return a pointer to the array of longitude indices
+      */
+      inline const int* is() const
+      {
+          return &(iis[0]);
+      };
+
+      /// returns the corner latitude indices
+      /*! This method returns the latitude indices of the grid cell corners,
+          laid out in the same way as indices().
+          
+          \return a pointer to the array of latitude indices
+      */
+      inline const int* js() const
+      {
+          return &(jjs[0]);
+      };
+
+      /// returns the corner vertical indices
+      /*! This method returns the vertical indices of the grid cell corners,
+          laid out in the same way as indices().
+          
+          \return a pointer to the array of vertical indices
+      */
+      inline const int* ks() const
+      {
+          return &(kks[0]);
+      };
+      
+      /// returns the longitudinal weight of a point
+      /*! This method returns the fractional distance of a point
+          from the western edge of its grid cell to the eastern edge.
+          
+          \param i the index of the point
+          \return the longitudinal weight
+      */
+      inline real xweight( int i ) const
+      {
+          return fxs[i];
+      };
+
+      /// returns the latitudinal weight of a point
+      /*! This method returns the fractional distance of a point
+          from the southern edge of its grid cell to the northern edge.
+          
+          \param i the index of the point
+          \return the latitudinal weight
+      */
+      inline real yweight( int i ) const
+      {
+          return fys[i];
+      };
+      
+      /// returns the number of stencils reused
+      /*! This method returns the number of times, since the last resetStats() call,
+          that update() was able to reuse a cached grid cell.
+          
+          \return the number of reused stencils
+      */
+      inline long hits() const
+      {
+          return nhits;
+      };
+
+      /// returns the number of stencils looked up
+      /*! This method returns the number of times, since the last resetStats() call,
+          that update() had to look up a point's grid cell.
+          
+          \return the number of looked-up stencils
+      */
+      inline long misses() const
+      {
+          return nmisses;
+      };
+      
+      /// resets the statistics
+      /*! This method sets the hit and miss counts to zero.
+      */
+      void resetStats();   
+
+   private:
+   
+      /// the number of points
+      int np;
+      /// the geometry of the grid for which the stencils were made
+      int nlons, nlats, nzs;
+      /// the first and last longitudes and latitudes of that grid
+      real glon0, glon1, glat0, glat1;
+      
+      /// the coordinates for which each stencil was last computed
+      std::vector<real> plons, plats;
+      /// whether each stencil is usable
+      std::vector<char> ok;
+      /// the longitude and latitude indices of each cell
+      std::vector<int> i1s, i2s, j1s, j2s;
+      /// the longitude and latitude of the corners of each cell
+      std::vector<real> lon1s, lon2s, lat1s, lat2s;
+      /// the weights of each point within its cell
+      std::vector<real> fxs, fys;
+      /// the corner indices at each level
+      std::vector<int> idxs, iis, jjs, kks;
+      
+      /// the statistics
+      long nhits, nmisses;
+      
+      /// computes the weights of a point within its cell
+      /*! This method computes the fractional position of a point
+          within its cached grid cell, in the same way as BilinearHinterp does.
+          
+          \param i the index of the point
+          \param lon the (wrapped) longitude of the point
+          \param lat the latitude of the point
+          \param fx a reference to the longitudinal weight
+          \param fy a reference to the latitudinal weight
+      */
+      void weights( int i, real lon, real lat, real& fx, real& fy ) const;
+      
+      /// fills in the corner indices for one point
+      /*! This method fills in the corner indices of one point at every vertical level.
+      
+          \param i the index of the point
+          \param grid the grid whose indices are to be used
+      */
+      void corners( int i, const GridLatLonField3D& grid );
+      
+};
+
+}
+
+#endif
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
@@ -0,0 +1,251 @@
+#ifndef GIGATRAJ_INSTRUMENT_H
+#define GIGATRAJ_INSTRUMENT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/ProcessGrp.hh"
+
+namespace gigatraj {
+
+///@name Interprocess Communications Tags
+//@{
+/// Interprocess Communications Tags: "Instrumentation statistics count"
+static const int PGR_TAG_INSTNUM = 3100;
+/// Interprocess Communications Tags: "Instrumentation statistic name"
+static const int PGR_TAG_INSTNAME = 3105;
+/// Interprocess Communications Tags: "Instrumentation statistic values"
+static const int PGR_TAG_INSTVALS = 3110;
+//@}
+
+/*!
+\ingroup misc
+   \brief lightweight timers and counters for performance measurement
+   
+ The Instrument class collects timings and counts from the hot paths of 
+ the gigatraj library: Swarm and Flock advances, met data 
+ fetches and cache lookups, met server requests, remote grid point 
+ requests, interpolation calls, and output filters.
+ 
+ Each statistic is identified by a name, and it accumulates the number of
+ events, and the sum, minimum, and maximum of the values recorded for
+ those events. For a timer, the values are elapsed (wall-clock) times in seconds;
+ for a counter, the values are whatever quantity is being counted 
+ (grid points, queue depth, etc.).
+ 
+ The library code records statistics through the GT_TIMER(), GT_TIMER_STOP(), and
+ GT_COUNT() macros. Unless gigatraj was configured with
+ the --enable-instrument option, these macros expand to nothing, so that
+ the instrumentation costs nothing at all in a production build.
+ 
+ At the end of a run, or periodically during it, the report() method gathers 
+ the statistics from all processors in a group and prints a summary on the 
+ root processor.
+
+ When gigatraj has been configured with the --enable-threads option,
+ each thread records its statistics in its own table, so that the threads 
+ of a Swarm (see Swarm::setThreads()) do not contend for a lock on every event.
+ The tables of threads that have finished are folded into a process-wide table,
+ and report() sums the tables of all threads. Note that a timer's values are then
+ summed over all threads. The reset() and report() methods
+ must not be called while other threads are recording statistics.
+ 
+*/
+class Instrument {
+
+   public:
+   
+      /// the kinds of statistics
+      typedef enum {
+         /// elapsed times, in seconds
+         Timing = 0,
+         /// counted quantities
+         Count = 1
+      } Kind;
+   
+      /// a scoped timer
+      /*! An object of the Timer class records the elapsed time from its
+          creation until it goes out of scope (or until its stop() method
+          is called, whichever comes first).
+      */
+      class Timer {
+      
+         public:
+         
+            /// constructor
+            /*! This constructor starts the timer.
+            
+                \param which the slot number of the statistic, as returned by Instrument::slot()
+            */
+            Timer( int which );
+            
+            /// destructor
+            /*! The destructor stops the timer, if it is still running, and records the elapsed time.
+            */
+            ~Timer();
+            
+            /// stops the timer and records the elapsed time
+            void stop();
+            
+         private:
+         
+            /// the slot number of the statistic
+            int stat;
+            /// the starting time
+            double start;
+            /// whether the timer is running
+            bool running;
+      
+      };
+   
+      /// returns the slot number of a statistic, creating it if necessary
+      /*! This method returns the slot number of a named statistic. 
+          The library code normally calls this only once for
+          each place where statistics are recorded, and holds on to the
+          result.
+      
+          \param name the name of the statistic
+          \param kind the kind of statistic: Instrument::Timing or Instrument::Count
+          \return the slot number
+      */
+      static int slot( const std::string& name, Kind kind=Timing );
+      
+      /// records an event for a statistic
+      /*! This method records one event for a statistic.
+      
+          \param which the slot number of the statistic
+          \param value the value for this event
+      */
+      static void record( int which, double value );
+   
+      /// returns a wall-clock time, in seconds
+      /*! This method returns the current time in seconds, measured from
+          some arbitrary starting point, at a resolution of microseconds or better.
+      
+          \return the time in seconds
+      */
+      static double clock();
+   
+      /// resets all statistics
+      /*! This method resets the statistics on this processor.
+          The names and slot numbers are kept.
+      */
+      static void reset();
+      
+      /// returns whether instrumentation is compiled in
+      /*! This method returns true if gigatraj was configured with the
+          --enable-instrument option, false otherwise.
+          
+          \return true if instrumentation is enabled
+      */
+      static bool enabled();
+
+      /// prints a summary of the statistics, gathered across a processor group
+      /*! This method gathers the statistics from each processor
+          in a processor group to the root processor, which prints 
+          a summary table. For each statistic, the table gives the number of 
+          processors that recorded it, the total number of events and the total value across
+          all processors, the mean value per event, the minimum and maximum values of any single event, 
+          and the ratio of the largest per-processor total to the mean per-processor total. 
+          (The last is a measure of load imbalance.)
+          
+          This method must be called by every processor in the group, since
+          it involves interprocessor communications. If instrumentation is
+          not enabled, it does nothing.
+          
+          \param pgrp the processor group. If this is NULLPTR, then only the statistics on this
+                      processor are reported.
+          \param os the output stream to which the summary is written (on the root processor only)
+          \param title a title line for the summary
+          \param clear if true, the statistics are reset after they have been reported
+      */
+      static void report( ProcessGrp* pgrp, std::ostream& os, const std::string& title="", bool clear=false );
+      
+   private:
+
+      /// a single statistic
+      struct Stat {
+         /// the name of the statistic
+         std::string name;
+         /// the kind of statistic
+         Kind kind;
+         /// the number of events
+         double n;
+         /// the sum of the values
+         double sum;
+         /// the minimum value
+         double min;
+         /// the maximum value
+         double max;
+      };
+
+      /// returns the table of statistics for this process
+      static std::vector<Stat>& stats();
+      
+      /// returns the table of statistics for the calling thread
+      static std::vector<Stat>& local();
+      
+      /// returns the per-thread tables that are in use
+      static std::vector< std::vector<Stat>* >& tables();
+      
+      /// sets up the key that finds each thread's table
+      static void makeKey();
+      
+      /// folds the table of a thread that is exiting into the process-wide table
+      static void retire( void* table );
+      
+      /// returns the statistics summed over all threads
+      static std::vector<Stat> combined();
+      
+      /// resets a single statistic
+      static void clearStat( Stat& st );
+      
+      /// adds the events of one statistic to another
+      static void merge( Stat& into, const Stat& from );
+      
+      /// formats and prints the summary table
+      static void printTable( std::ostream& os, const std::string& title, const std::vector<Stat>& totals
+                            , const std::vector<int>& nprocs, const std::vector<double>& maxproc, int nall );
+
+};
+
+}
+
+
+#ifdef USE_INSTRUMENT
+
+/// starts a scoped timer named by a string literal, held in variable "var"
+#define GT_TIMER(var,name) \
+   static const int var##_slot = gigatraj::Instrument::slot( name, gigatraj::Instrument::Timing ); \
+   gigatraj::Instrument::Timer var( var##_slot )
+/// stops the scoped timer held in variable "var" early
+#define GT_TIMER_STOP(var) var.stop()
+/// records a value for a counter named by a string literal
+#define GT_COUNT(name,value) \
+   do { \
+      static const int gt_count_slot = gigatraj::Instrument::slot( name, gigatraj::Instrument::Count ); \
+      gigatraj::Instrument::record( gt_count_slot, (value) ); \
+   } while (0)
+
+#else
+
+#define GT_TIMER(var,name)
+#define GT_TIMER_STOP(var)
+#define GT_COUNT(name,value)
+
+#endif
+
+#endif
+
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
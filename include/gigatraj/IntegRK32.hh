@@ -0,0 +1,200 @@
+
+#ifndef GIGATRAJ_INTEGRK32_H
+#define GIGATRAJ_INTEGRK32_H
+
+#include <vector>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Integrator.hh"
+
+namespace gigatraj {
+
+/*!
+
+\ingroup integrators
+
+\brief implements adaptive-timestep Runge-Kutta integration of parcel trajectories, with per-parcel step control
+
+The IntegRK32 class integrates trajectories with the Bogacki-Shampine
+embedded Runge-Kutta pair. Each step yields both a third-order and a 
+second-order estimate of the new parcel position; their difference
+is used as an estimate of the error in the position.
+
+Each call to go() still advances all parcels over the full time step
+that is given to it, so that a Swarm or Flock keeps its usual output cadence.
+Internally, however, each parcel is moved in as many substeps as it needs to keep
+its estimated horizontal position error per substep within a tolerance.
+Substeps are the time step divided by a power of two, so parcels that
+are at the same point in time and use the same substep length are
+advanced together, and the met data source is always called with
+arrays of positions. A substep is halved when its error estimate is too large,
+and it is doubled (where the dyadic grid allows) when the error estimate is
+small enough that the doubled step should be acceptable.
+Because the Bogacki-Shampine pair has the "first-same-as-last" property,
+the winds obtained at the end of an accepted substep are re-used at the 
+start of the next one, so an accepted substep costs three wind evaluations.
+
+As in IntegRK4Cart, parcel positions are carried through the substeps as
+Earth-centred unit vectors, so that no polar special cases are needed.
+
+The mean number of substeps per parcel per time step is accumulated, 
+and can be obtained with meanSubsteps() for tuning the tolerance and the
+model time step.
+
+*/
+
+
+class IntegRK32 : public Integrator {
+
+  private:
+
+    // the horizontal error tolerance per substep, in km
+    real tol;
+    
+    // the maximum number of times a time step may be halved
+    int maxlev;
+    
+    // the number of accepted substeps since the stats were last reset
+    double nsub;
+    
+    // the number of rejected substeps since the stats were last reset
+    double nrej;
+    
+    // the number of parcel time steps since the stats were last reset
+    double nparcelsteps;
+    
+    // scratch space for the array version of go(), grown as needed and kept between calls
+    struct Scratch {
+       // the number of parcels for which scratch space has been allocated
+       int nwork;
+       std::vector<real> work;
+       std::vector<int> iwork;
+       std::vector<long> lwork;
+    };
+    
+    // the scratch space of thread 0 (or of the only thread)
+    Scratch scratch;
+    
+    // the scratch space of the other threads of a pool (see setThreads())
+    std::vector<Scratch*> tscratch;
+    
+    // returns the calling thread's scratch space
+    Scratch* threadScratch();
+    
+  public:
+    
+    /// the type of object this is
+    static const string id;
+ 
+    /// The basic constructor
+    /*! 
+          This is the basic constructor for a new IntegRK32 object.
+          
+          \param tolerance the maximum acceptable estimated horizontal position error per substep, in km
+          \param maxlevel the maximum number of times that a time step may be halved
+    */
+    IntegRK32( real tolerance=0.1, int maxlevel=8 );
+    
+    /// The destructor
+    ~IntegRK32();
+  
+    /// performs the integration over a time step
+    /*! 
+        This function performs the integration over a single time step
+    
+      \param lon the parcel longitude
+      \param lat the parcel latitude
+      \param z the parcel vertical coordinate
+      \param t the time, in internal model time
+      \param metsrc the source of the meteorological data (winds)
+      \param nav the planetary navigation object
+      \param dt the time step, in internal model time
+       
+    */
+    void go( real &lon, real &lat, real &z, double &t, MetData *metsrc, PlanetNav *nav, double dt );
+
+    /// performs the integration over a time step, for an array of positions
+    /*! 
+        This function performs the integration over a single time step, for an array of positions.
+    
+      \param n the number of positions (length of lons, lats, and zs)
+      \param lons a pointer to the array of parcel longitudes
+      \param lats a pointer to the array of parcel latitudes
+      \param zs a pointer to the array of parcel vertical coordinates
+      \param flags a pointer to an array of flags indicating conditions (e.g., missing data) that prevent tracing
+      \param t the time, in internal model time units
+      \param metsrc the source of the meteorological data (winds)
+      \param nav the planetary navigation object
+      \param dt the time step, in internal model time units
+       
+    */
+    void go( int n, real *lons, real *lats, real *zs, int *flags, double &t, MetData *metsrc, PlanetNav *nav, double dt );
+
+    /// (multithreading) declares how many threads are about to share this integrator
+    /*! This method overrides Integrator::setThreads(). Each thread 
+        gets its own scratch space.
+        
+        \param n the number of threads
+    */
+    void setThreads( int n );
+
+    /// sets the error tolerance
+    /*!
+        \param tolerance the maximum acceptable estimated horizontal position error per substep, in km
+    */
+    void tolerance( real tolerance );
+    
+    /// returns the error tolerance
+    /*!
+        \return the maximum acceptable estimated horizontal position error per substep, in km
+    */
+    real tolerance() const;
+    
+    /// sets the maximum substep level
+    /*!
+        \param maxlevel the maximum number of times a time step may be halved. 
+                        Substeps at this level are accepted regardless of their error estimates.
+                        The value is limited to the range 0 to 30.
+    */
+    void maxLevel( int maxlevel );
+    
+    /// returns the maximum substep level
+    /*!
+        \return the maximum number of times a time step may be halved
+    */
+    int maxLevel() const;
+    
+    /// returns the mean number of substeps per parcel
+    /*!
+        \return the mean number of accepted substeps that each parcel has taken
+                per time step, since the statistics were last reset. If no parcels have been
+                traced, this is zero.
+    */
+    double meanSubsteps() const;
+
+    /// returns the mean number of rejected substeps per parcel
+    /*!
+        \return the mean number of substeps per parcel per time step that were rejected
+                and retried with a shorter substep, since the statistics were last reset
+    */
+    double meanRejects() const;
+
+    /// resets the substep statistics
+    void resetStats();
+
+};
+}
+
+#endif
+
+
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
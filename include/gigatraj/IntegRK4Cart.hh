@@ -0,0 +1,140 @@
+
+#ifndef GIGATRAJ_INTEGRK4CART_H
+#define GIGATRAJ_INTEGRK4CART_H
+
+#include <vector>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Integrator.hh"
+
+namespace gigatraj {
+
+/*!
+
+\ingroup integrators
+
+\brief implements fourth-order Runge-Kutta integration of parcel trajectories on Earth-centred unit vectors
+
+The IntegRK4Cart class provides a method for integrating trajectories
+using the fourth-order Runge-Kutta method, but unlike IntegRK4 and IntegRK4a
+it does not step in longitude and latitude. Instead, each parcel's
+horizontal position is carried through the stages of the step as
+an Earth-centred unit vector P = (cos(lat)cos(lon), cos(lat)sin(lon), sin(lat)).
+The wind components u and v are rotated into the local tangent plane
+as V = u E + v N, where the east and north unit vectors E and N
+are formed algebraically from the components of P. The RK4 stages
+then integrate dP/dt = V/R directly, and each intermediate point is
+re-projected onto the sphere by normalizing it.
+
+Positions are converted back to longitude and latitude only where
+the meteorological data source needs them for interpolation, and once
+at the end of the step. No spherical trigonometry is done to
+move parcels or to relocate winds, so there is no need for the
+polar special cases (and the conformal adjustment setting has no effect);
+a parcel simply passes over a pole.
+
+The planetary radius is taken from the navigation object if it is
+a PlanetSphereNav; otherwise, the mean Earth radius is used.
+
+*/
+
+
+class IntegRK4Cart : public Integrator {
+
+  public:
+    
+    /// the type of object this is
+    static const string id;
+ 
+    /// The basic constructor
+    /*! 
+          This is the basic constructor for a new IntegRK4Cart object.
+    */
+    IntegRK4Cart();
+    
+    /// The destructor
+    ~IntegRK4Cart();
+  
+    /// performs the integration over a time step
+    /*! 
+        This function performs the integration over a single time step
+    
+      \param lon the parcel longitude
+      \param lat the parcel latitude
+      \param z the parcel vertical coordinate
+      \param t the time, in internal model time
+      \param metsrc the source of the meteorological data (winds)
+      \param nav the planetary navigation object
+      \param dt the time step, in internal model time
+       
+    */
+    void go( real &lon, real &lat, real &z, double &t, MetData *metsrc, PlanetNav *nav, double dt );
+
+    /// performs the integration over a time step, for an array of positions
+    /*! 
+        This function performs the integration over a single time step, for an array of positions.
+    
+      \param n the number of positions (length of lons, lats, and zs)
+      \param lons a pointer to the array of parcel longitudes
+      \param lats a pointer to the array of parcel latitudes
+      \param zs a pointer to the array of parcel vertical coordinates
+      \param flags a pointer to an array of flags indicating conditions (e.g., missing data) that prevent tracing
+      \param t the time, in internal model time units
+      \param metsrc the source of the meteorological data (winds)
+      \param nav the planetary navigation object
+      \param dt the time step, in internal model time units
+       
+    */
+    void go( int n, real *lons, real *lats, real *zs, int *flags, double &t, MetData *metsrc, PlanetNav *nav, double dt );
+
+    /// (multithreading) declares how many threads are about to share this integrator
+    /*! This method overrides Integrator::setThreads(). Each thread 
+        gets its own scratch space.
+        
+        \param n the number of threads
+    */
+    void setThreads( int n );
+
+
+  private:
+  
+    /// scratch space for the array version of go()
+    /*! The intermediate positions and winds are kept here between
+        calls, so that they need not be allocated anew on every time step.
+        The space grows as needed to hold the largest number of parcels
+        that go() has been given.
+    */
+    struct Scratch {
+       /// the number of parcels for which scratch space has been allocated
+       int nwork;
+       /// the intermediate positions and winds
+       std::vector<real> work;
+       /// the indices of the parcels being traced
+       std::vector<int> iwork;
+    };
+    
+    /// the scratch space of thread 0 (or of the only thread)
+    Scratch scratch;
+    
+    /// the scratch space of the other threads of a pool (see setThreads())
+    std::vector<Scratch*> tscratch;
+    
+    /// returns the calling thread's scratch space
+    Scratch* threadScratch();
+
+};
+}
+
+#endif
+
+
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
@@ -105,6 +105,114 @@ class Integrator {
     /// 0 = no adjustment near poles on the sphere
     int confml;
 
+    /// returns the planetary radius to be used with a navigation object
+    /*! This function returns the radius of the planet represented by
+        a navigation object, if that object is a PlanetSphereNav, or the
+        mean radius of the Earth otherwise.
+    
+        \param nav the planetary navigation object
+        \return the radius, in km
+    */
+    static real planetRadius( PlanetNav *nav );
+
+    /// rotates horizontal wind components into a Cartesian velocity
+    /*! This function forms the local east and north unit vectors at a point on the
+        unit sphere, and from them a velocity vector in Earth-centred Cartesian coordinates.
+        Only simple vector algebra is used. At a pole, the meridian
+        of longitude zero is used to define east and north, as is done
+        by cartLonLat().
+        
+        \param x the first component of the unit position vector
+        \param y the second component of the unit position vector
+        \param z the third component of the unit position vector
+        \param u the zonal wind component
+        \param v the meridional wind component
+        \param scale a factor by which the velocity is to be multiplied
+        \param vx (output) the first component of the velocity
+        \param vy (output) the second component of the velocity
+        \param vz (output) the third component of the velocity
+    */
+    static inline void cartVelocity( real x, real y, real z, real u, real v, real scale
+                                   , real &vx, real &vy, real &vz )
+    {
+        real cphi, clam, slam;
+        
+        cphi = SQRT( x*x + y*y );
+        if ( cphi > 0.0 ) {
+           clam = x/cphi;
+           slam = y/cphi;
+        } else {
+           clam = 1.0;
+           slam = 0.0;
+        }
+        
+        // east is (-slam, clam, 0), and north is (-z clam, -z slam, cphi)
+        vx = ( - u*slam - v*z*clam )*scale;
+        vy = (   u*clam - v*z*slam )*scale;
+        vz = (   v*cphi            )*scale;
+    }
+
+    /// moves a point along a velocity vector and projects it back onto the unit sphere
+    /*! This function forms the unit vector in the direction of (x,y,z) + h (vx,vy,vz).
+    
+        \param x the first component of the unit position vector
+        \param y the second component of the unit position vector
+        \param z the third component of the unit position vector
+        \param vx the first component of the velocity
+        \param vy the second component of the velocity
+        \param vz the third component of the velocity
+        \param h the time interval over which the point moves
+        \param qx (output) the first component of the new unit position vector
+        \param qy (output) the second component of the new unit position vector
+        \param qz (output) the third component of the new unit position vector
+    */
+    static inline void cartAdvance( real x, real y, real z, real vx, real vy, real vz, real h
+                                  , real &qx, real &qy, real &qz )
+    {
+        real mag;
+        
+        qx = x + h*vx;
+        qy = y + h*vy;
+        qz = z + h*vz;
+        mag = SQRT( qx*qx + qy*qy + qz*qz );
+        qx = qx/mag;
+        qy = qy/mag;
+        qz = qz/mag;
+    }
+
+    /// converts a unit position vector to longitude and latitude
+    /*! 
+        \param x the first component of the unit position vector
+        \param y the second component of the unit position vector
+        \param z the third component of the unit position vector
+        \param nav the planetary navigation object, used to wrap the longitude
+        \param lon (output) the longitude
+        \param lat (output) the latitude
+    */
+    static inline void cartLonLat( real x, real y, real z, PlanetNav *nav, real &lon, real &lat )
+    {
+        lat = ATAN2( z, SQRT( x*x + y*y ) )/RCONV;
+        lon = nav->wrap( ATAN2( y, x )/RCONV );
+    }
+
+    /// converts longitude and latitude to a unit position vector
+    /*!
+        \param lon the longitude
+        \param lat the latitude
+        \param x (output) the first component of the unit position vector
+        \param y (output) the second component of the unit position vector
+        \param z (output) the third component of the unit position vector
+    */
+    static inline void cartFromLonLat( real lon, real lat, real &x, real &y, real &z )
+    {
+        real clat;
+        
+        clat = COS( lat*RCONV );
+        x = clat*COS( lon*RCONV );
+        y = clat*SIN( lon*RCONV );
+        z = SIN( lat*RCONV );
+    }
+
   public:
     
     /// virtual destructor
@@ -145,6 +253,16 @@ class Integrator {
     */
     virtual void go( int n, real *lons, real *lats, real *zs, int *flags, double &t, MetData *metsrc, PlanetNav *nav, double dt ) = 0;
 
+    /// (multithreading) declares how many threads are about to share this integrator
+    /*! This method is called before a pool of threads (see Swarm::setThreads())
+        starts calling the array version of go(), and again with n=1 after they are done.
+        Integrators that keep workspace between calls override it, so that each
+        thread (see MetData::thread()) gets its own. The default does nothing.
+        
+        \param n the number of threads
+    */
+    virtual void setThreads( int n ) {};
+
     /// determines how vectors are interpolated near the poles of the sphere
     /*!
         This function sets how horizontal wind vectors are interpolated
@@ -372,6 +372,17 @@ class MPIGrp : public ProcessGrp {
       */
       void receive_string( int id, std::string *vals, int tag=0, int *src=NULL) const;
 
+      /// returns the number of processors with a message waiting to be received
+      /*! This function returns the number of other processors in this group
+          that have sent this processor a message with a given tag that has not 
+          yet been received. Since it probes each processor in turn, it is
+          meant for diagnostic use only.
+          
+           \param tag the label of the messages to check for
+           \return the number of processors with messages waiting
+      */
+      int pending( int tag=0 ) const;
+
 
 
       /// returns the rank of the current process within this group
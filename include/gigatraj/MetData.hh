@@ -2,9 +2,15 @@
 #define GIGATRAJ_METDATA_H
 
 #include <time.h>
+#include <vector>
 
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/ProcessGrp.hh"
+#include "gigatraj/PlanetNav.hh"
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
 
 namespace gigatraj {
 
@@ -146,7 +152,7 @@ class MetData {
       /// the destructor
       /*! This is the destructor.
       */
-      virtual ~MetData() {};
+      virtual ~MetData();
 
 
       /// the copy constructor
@@ -550,8 +556,23 @@ class MetData {
       
           \return true if recognized, false otherwise
       */
-      virtual bool legalQuantity( const std::string quantity ) { return true; };    
-      
+      virtual bool legalQuantity( const std::string quantity ) { return true; };
+
+      /// check whether a location lies within the data source's domain
+      /*! This method checks whether a location lies within the spatial region
+          for which this data source provides data. Most data sources cover the
+          entire globe and all of their vertical levels, but some may be configured
+          to read only a limited region. Parcels that leave the domain are
+          flagged as having hit a boundary.
+
+          \param lon the longitude of the location
+          \param lat the latitude of the location
+          \param z the vertical coordinate of the location
+
+          \return true if the location is within the domain, false otherwise
+      */
+      virtual bool inDomain( real lon, real lat, real z ) const { return true; };
+
       /// obtain the units of a quantity provided by the data source
       /*! This method provides the units of a quantity that the meteorological data soirce
           provides. The meaning of the returned string is determined solely
@@ -646,6 +667,51 @@ class MetData {
       */
       void setPgroup( ProcessGrp *pg, int met = -1 );
     
+      /// (parallel processing) sets the met server processors among which met requests are sharded
+      /*! When a process group holds more than one dedicated met processor, requests for
+          gridded met data are distributed among them, with each combination of quantity and 
+          snapshot time belonging to exactly one of the met server processors (a "shard").
+          This method sets the list of these processors. It must be called after setPgroup(),
+          by every processor in the group (clients and servers alike), with the same list.
+          
+          If this processor is one of the shards, it becomes the met server for its own share
+          of the requests. Otherwise, the first processor in the list is used as the 
+          default met processor for requests that are not sharded.
+          
+          \param shards a vector of processor IDs within the current process group.
+                  An empty vector (or a vector with only one element) turns sharding off.
+      
+      */
+      void setMetShards( const std::vector<int>& shards );
+    
+      /// (parallel processing) returns the number of met server processors in this process group
+      /*! This method returns the number of dedicated met processors among which 
+          met data requests are distributed.
+          
+          \return the number of met processor shards; this is 0 if no dedicated met processor is being used
+      */
+      int metShards() const;
+    
+      /// (parallel processing) returns the met server processor responsible for a quantity and time
+      /*! This method returns the processor ID of the met processor (shard) that 
+          serves the data for a given quantity and snapshot time. All processors in the
+          group will map a given quantity and time to the same shard.
+          
+          \param quantity the name of the met quantity
+          \param time the model time of the data snapshot
+          
+          \return the processor ID of the met processor to which requests should be sent
+      */
+      int metShard( const std::string& quantity, double time );
+    
+      /// (parallel processing) returns the number of met client processors in the process group
+      /*! This method returns the number of processors in this process group 
+          that are met clients (i.e., not dedicated met processors).
+          
+          \return the number of met client processors
+      */
+      int metClients() const;
+
 
       /// (parallel processing) indicates whether this processor and MetData object is a client for met data.
       /*! This methods returns whether this processor is a client for met data--that is, whether is
@@ -659,6 +725,18 @@ class MetData {
           return ( my_pgroup != NULLPTR && my_metproc >= 0 && my_pgroup->id() != my_metproc );
       }
       
+      /// (parallel processing) indicates whether this processor is one of several met servers sharing the met data requests
+      /*! This methods returns whether met data requests are being sharded across
+          more than one dedicated met processor.
+      
+          \return true if met requests are distributed across multiple met processors
+
+      */
+      inline bool isMetSharded() const
+      {
+          return ( my_pgroup != NULLPTR && my_metshards.size() > 1 );
+      }
+      
       /// (parallel processing) indicates whether this processor and MetData object is a server for met data.
       /*! This methods returns whether this processor is a server for met data, providing data to
           tracer processor clients.
@@ -701,6 +779,8 @@ class MetData {
       /*! In a parallelprocessing environment, this method reads a status code sent by a dedicated
           met data server processor that
           reflects the current status of a recent request that this client has made to that server.
+          If the request was split among several met server shards, the status is
+          collected from each of them, and any failure is reported.
           
           /return an integer containing a status code, one of the PGR_STATUS_* codes.
       */ 
@@ -742,6 +822,256 @@ class MetData {
       */
       void signalMetDone();
      
+      /// (parallel processing) sets how often met servers and clients synchronize while tracing
+      /*! Ordinarily, at the end of every tracing time step each client processor
+          signals its met server processor(s) that it is done, and every processor 
+          in the process group then waits at a barrier. The slowest processor thus
+          sets the pace of every time step.
+          
+          This method loosens that. If every is greater than 1, then the full
+          synchronization is carried out only at every Nth time step; in between,
+          each client merely notifies its met server(s) that it has finished the step
+          and goes on to the next one, and the met servers keep serving
+          requests from whichever clients are still working. If every is 0 or less,
+          then the time steps themselves never synchronize the processors; this is
+          left to the places where synchronization is needed anyway, such as 
+          output, checkpointing, and iterator loops over the parcels.
+          Clients that run ahead are still bound by the met data: a client that
+          needs a new met snapshot must wait for its met server to provide it.
+          
+          This must be set to the same value on every processor in the group.
+          
+          \param every the number of time steps between full synchronizations.
+                 The default is 1 (synchronize at every time step).
+      */
+      void setStepSync( int every );
+     
+      /// (parallel processing) returns how often met servers and clients synchronize while tracing
+      /*! This method returns the number of time steps between full synchronizations
+          of the met servers and their clients. See setStepSync().
+          
+          \return the number of time steps between synchronizations
+      */
+      int stepSync() const;
+      
+      /// (parallel processing) serves met data for one tracing time step
+      /*! This method is called by a met data server processor once for each tracing 
+          time step (see the Swarm::advance() and Flock::advance() methods). 
+          If the processors are synchronized at every step (see setStepSync()),
+          this is the same as serveMet(). Otherwise, the met server returns
+          from this method once every client has reported finishing this time step,
+          without waiting on a barrier, and it records the skew among its clients
+          (see stepSkew()).
+          
+          If this is not a met data server processor, this method returns immediately.
+      */
+      void serveMetStep();
+      
+      /// (parallel processing) signals the met data server that a tracing time step is done 
+      /*! This method is called by a met data client processor at the end of each 
+          tracing time step (see the Swarm::advance() and Flock::advance() methods).
+          If the processors are synchronized at every step (see setStepSync()),
+          this is the same as signalMetDone(). Otherwise, the client notifies its met server(s)
+          that it has finished the time step and returns immediately, except
+          on those time steps at which a full synchronization is called for.
+      */
+      void signalMetStep();
+      
+      /// (parallel processing) returns the skew among met clients at the last time step 
+      /*! On a met server processor, this method returns the difference, in time steps, 
+          between the farthest-ahead and farthest-behind of its clients when the 
+          last time step was completed by all of them. This is always 0 when the processors
+          are synchronized at every time step.
+          
+          \return the client skew, in time steps
+      */
+      int stepSkew() const;
+      
+      /// (parallel processing) returns the largest skew among met clients so far
+      /*! On a met server processor, this method returns the largest client skew 
+          (see stepSkew()) seen so far.
+          
+          \return the maximum client skew, in time steps
+      */
+      int maxStepSkew() const;
+
+      /// (parallel processing) turns on or off the serving of met data in sub-blocks
+      /*! Normally, a met data client asks its met server for each individual gridpoint
+          value that it needs for an interpolation. If this mode is turned on, then
+          a client asks instead for the sub-block of each gridded field
+          that covers the region spanned by its parcels (see haloRegion()), 
+          once per met data snapshot, and interpolates from its local copy. 
+          This trades a single larger transfer for many small round trips.
+          
+          The region is padded on all sides by the greatest distance a parcel 
+          could move in one time step. Parcels that stray outside the region anyway
+          are still served, point by point, as before.
+          
+          \param mode true to turn sub-block serving on, false to turn it off
+          \param speed the greatest horizontal wind speed expected, in m/s.
+                       This sets how far the region is padded horizontally.
+          \param dz how far the region is padded vertically, in units of the 
+                    vertical coordinate. If negative (the default), the region
+                    includes all vertical levels. Since the usual horizontal interpolators 
+                    (see Hinterp::vinterp()) interpolate whole profiles before interpolating
+                    vertically, restricting the levels pays only with other interpolation schemes.
+      */
+      void setHalo( bool mode, real speed=150.0, real dz=-1.0 );
+      
+      /// (parallel processing) returns whether met data are served in sub-blocks
+      /*! This method returns whether met data are served in sub-blocks. See setHalo().
+      
+          \return true if met data are served in sub-blocks, false otherwise
+      */
+      bool halo() const;
+      
+      /// (parallel processing) sets the region spanned by a set of parcels for the next time step
+      /*! This method is called before each tracing time step 
+          (see the Swarm::advance() and Flock::advance() methods), with the positions
+          of the parcels that are about to be traced. If sub-block serving has been
+          turned on with setHalo(), then on a met data client the longitude-latitude-vertical box that
+          encloses those parcels, padded by one time step's maximum displacement,
+          is used to choose the sub-blocks of the gridded fields that the client fetches.
+          If the vertical level window has been turned on with setLevelWindow(), then
+          on a met source that reads its own data the vertical range of the parcels
+          is used to choose the vertical levels to be read.
+          Otherwise, this method does nothing.
+          
+          \param n the number of parcels
+          \param lons an n-element array of parcel longitudes
+          \param lats an n-element array of parcel latitudes
+          \param zs an n-element array of parcel vertical coordinates
+          \param dt the time step, in days
+          \param nav the planetary navigation object, which sets how many kilometers
+                     a degree of latitude spans
+      */
+      void haloRegion( int n, const real* lons, const real* lats, const real* zs, double dt, PlanetNav* nav );
+
+      /// turns on or off the automatic vertical level window
+      /*! If this mode is turned on, then before each tracing time step the range of 
+          vertical coordinates spanned by the parcels (see haloRegion()) is passed
+          to the met data source, which may then read only the vertical levels
+          that span that range, plus a margin of a few levels.
+          The window is widened whenever the parcels approach its edges; it is never narrowed.
+          
+          Data sources that cannot restrict the vertical levels they read ignore this setting.
+          A met data client does not read its own data, so on a client 
+          this has no effect.
+          
+          \param mode true to turn the level window on, false to turn it off
+          \param pad the number of vertical levels of margin to be kept on either side of the parcels
+      */
+      void setLevelWindow( bool mode, int pad=2 );
+      
+      /// returns whether the automatic vertical level window is turned on
+      /*! This method returns whether the automatic vertical level window is turned on.
+          See setLevelWindow().
+      
+          \return true if the level window is on, false otherwise
+      */
+      bool levelWindow() const;
+
+      /// (multithreading) a scoped lock on a met data source
+      /*! An object of the Lock class holds a met data source's lock (see lockMet())
+          from its creation until it goes out of scope, so that the lock is
+          released even if an exception is thrown.
+      */
+      class Lock {
+         public:
+            /// constructor
+            /*! This constructor locks the met data source.
+            
+                \param met the met data source to be locked
+            */
+            Lock( MetData* met );
+            
+            /// destructor
+            /*! The destructor unlocks the met data source, if it is still locked.
+            */
+            ~Lock();
+            
+            /// gives up the lock temporarily
+            /*! This method unlocks the met data source, so that other threads may use it
+                while this one is busy with something that does not touch the met data source's
+                own state, such as interpolating from a grid that is being held in memory.
+                If the calling thread has locked the source more than once (i.e., 
+                it is inside a nested call), then the lock is kept, since the outer
+                call may be relying on it.
+            */
+            void release();
+            
+            /// takes back a lock given up by release()
+            void reacquire();
+            
+         private:
+            /// the met data source
+            MetData* src;
+            /// whether the lock is held
+            bool held;
+      };
+      
+      /// (multithreading) locks the met data source for use by the calling thread
+      /*! When gigatraj has been configured with the --enable-threads option, 
+          several threads may share a single met data source (see Swarm::setThreads()).
+          This method locks the met data source so that 
+          only the calling thread may use it until unlockMet() is called. A thread may lock
+          a met data source more than once (as when one met data method calls
+          another); it must then unlock it the same number of times.
+          
+          Without threads, this method does nothing.
+      */
+      void lockMet();
+      
+      /// (multithreading) unlocks the met data source
+      /*! This method undoes a call to lockMet().
+      */
+      void unlockMet();
+      
+      /// (multithreading) returns whether the met data source locks itself
+      /*! This method returns whether the met data source does its own locking (see lockMet()),
+          so that several threads may call its get_uvw(), getData(), and getVectorData()
+          methods at the same time. If not, then the caller must lock the met data
+          source around each such call.
+          
+          \return true if the met data source does its own locking, false otherwise
+      */
+      virtual bool threadSafe() const;
+      
+      /// (multithreading) declares how many threads are about to use the met data source
+      /*! This method is called before and after a parallel section in which 
+          several threads share this met data source. With more than one thread,
+          a met data source that does its own locking (see threadSafe()) may
+          give up its lock during the time-consuming parts of its work, such as 
+          spatial interpolation, provided that it keeps everything those parts use in memory
+          until the method is called again with a single thread.
+          
+          \param n the number of threads. This must be 1 outside of a parallel section.
+      */
+      virtual void setThreads( int n );
+      
+      /// (multithreading) returns the number of threads using the met data source
+      /*! This method returns the number of threads set by setThreads().
+      
+          \return the number of threads
+      */
+      int threads() const;
+      
+      /// (multithreading) declares which thread of a pool the calling thread is
+      /*! This method is called by each thread of a pool (see Swarm::setThreads())
+          before it uses any met data source, so that a met data source can
+          keep workspace for each thread. The thread that set up the pool is thread 0.
+          
+          \param i the number of the calling thread, from 0 to one less than the number of threads
+      */
+      static void setThread( int i );
+      
+      /// (multithreading) returns which thread of a pool the calling thread is
+      /*! This method returns the number given to the calling thread by setThread().
+      
+          \return the thread number, or 0 if the calling thread was never given one
+      */
+      static int thread();
+     
    
       /// (parallel processing) prepare for data acquisition
       /*! This method is used as an easy way to set up for
@@ -868,6 +1198,122 @@ class MetData {
       /// processor ID of a dedicated met data processor in this process group
       int my_metproc;
 
+      /// processor IDs of the dedicated met processors among which met requests are sharded
+      std::vector<int> my_metshards;
+      
+      /// processor IDs of the met servers from which a request status is pending
+      std::vector<int> my_svrpend;
+      
+      /// the number of time steps between full synchronizations of met servers and clients
+      int my_stepsync;
+      
+      /// the number of time steps completed (by a client) or served (by a server)
+      int my_steps;
+      
+      /// on a met server, the number of time steps each client has reported completing (-1 for non-clients)
+      std::vector<int> my_clientsteps;
+      
+      /// on a met server, the number of "done" signals received during a time step, to be counted by the next serveMet()
+      int my_donecarry;
+      
+      /// whether serveMet() is serving a single unsynchronized time step
+      bool my_stepserve;
+      
+      /// client skew at the last time step
+      int my_skew;
+      
+      /// maximum client skew so far
+      int my_maxskew;
+      
+      /// whether met data are to be served in sub-blocks
+      bool my_halo;
+      
+      /// the greatest horizontal wind speed expected (m/s), for padding the sub-block region
+      real my_halospeed;
+      
+      /// vertical padding of the sub-block region
+      real my_halodz;
+      
+      /// whether a sub-block region has been set
+      bool my_haloset;
+      
+      /// the sub-block region: longitude, latitude, and vertical coordinate ranges
+      real my_halobox[6];
+      
+      /// whether the automatic vertical level window is on
+      bool my_levwin;
+      
+      /// the number of vertical levels of margin in the level window
+      int my_levwinpad;
+      
+      /// sets the vertical range of the parcels about to be traced
+      /*! This method is called by haloRegion() before each tracing time step, 
+          if the automatic vertical level window has been turned on with setLevelWindow().
+          A data source that can restrict the vertical levels it reads
+          overrides this to choose its levels. By default, this does nothing.
+          
+          \param zlo the smallest vertical coordinate value of the parcels
+          \param zhi the largest vertical coordinate value of the parcels
+      */
+      virtual void levelRange( real zlo, real zhi ) {};
+      
+      /// the number of threads using this met data source
+      int my_threads;
+      
+      /// the number of times the thread holding the lock has locked it
+      int my_lockdepth;
+      
+#ifdef USE_THREADS
+      /// the (recursive) lock that serializes threads' use of this met data source
+      pthread_mutex_t my_lock;
+#endif
+      
+      /// begins a serveMet() listening loop
+      /*! This method is called by a met server's serveMet() method 
+          before it starts listening for requests. 
+          
+          \return the number of "done" signals that have already been received
+      */
+      int serveBegin();
+      
+      /// decides whether a serveMet() listening loop should continue
+      /*! This method is called by a met server's serveMet() method 
+          to decide whether to keep listening for requests.
+          
+          \param done_count the number of "done" signals received so far
+          \param done_goal the number of "done" signals needed to end the loop
+          
+          \return true if the server should keep listening, false otherwise
+      */
+      bool serving( int done_count, int done_goal ) const;
+      
+      /// records that a client has finished a time step
+      /*! This method is called by a met server's serveMet() method 
+          when it receives a PGR_CMD_STEP notice from a client.
+          
+          \param src the processor ID of the client
+      */
+      void clientStep( int src );
+      
+      /// ends a serveMet() listening loop
+      /*! This method is called by a met server's serveMet() method 
+          after it stops listening for requests. Unless only a single
+          unsynchronized time step was being served, it waits for
+          the rest of the process group at a barrier.
+          
+          \param done_count the number of "done" signals received
+      */
+      void serveEnd( int done_count );
+      
+      /// records that a request has been sent to a met server, so that its status can be received
+      /*! This method is called by a met client after it sends a data request to a 
+          met server, so that receive_svr_status() will know where to 
+          look for the status of the request.
+          
+          \param proc the processor ID of the met server to which a request was sent
+      */
+      void expect_svr_status( int proc );
+
 
       /// short label for this data source
       static std::string shortdesc;
@@ -14,6 +14,9 @@
 #include "gigatraj/MetData.hh"
 #include "gigatraj/FilePath.hh"
 #include "gigatraj/FileLock.hh"
+#ifdef USE_SHMCACHE
+#include "gigatraj/ShmCache.hh"
+#endif
 #include "gigatraj/PAltOTF.hh"
 #include "gigatraj/PAltDotOTF.hh"
 
@@ -497,6 +500,16 @@ class MetGridData : public MetData {
       */
       void remove( GridFieldSfc* field );
 
+      /// (multithreading) declares how many threads are about to use the met data source
+      /*! This method overrides MetData::setThreads(). While more than one thread
+          is using the met data source, a data field that is pushed out of a cache
+          is not deleted right away, since another thread may still be interpolating
+          from it. Such fields are deleted when this method is called again with a single thread.
+          
+          \param n the number of threads. This must be 1 outside of a parallel section.
+      */
+      void setThreads( int n );
+
       /// get a 3D data field valid at a certain time, using basic access
       /*! This method reads meteorological data from some source and returns
           it in a GridField3D object. 
@@ -633,6 +646,73 @@ class MetGridData : public MetData {
       */
       void report() const;
 
+      /// set a memory budget for the in-memory met data caches
+      /*! This method sets a limit on the total size of the gridded data held
+          in all of this object's in-memory caches together. 
+          
+          Normally, each physical quantity has its own cache that holds a fixed
+          number of time snapshots (see set_snaps()), regardless of how large
+          those snapshots are. When a budget is set, the per-quantity snapshot counts
+          no longer apply. Instead, whenever a new grid is cached and the total exceeds the budget, 
+          the least-recently-used grids of any quantity are dropped until the total
+          fits. Grids that have been handed out and not yet given back through remove()
+          are never dropped this way, so the total may exceed the budget
+          if the grids in use alone do not fit.
+      
+          \param bytes the maximum number of bytes of gridded data to be held in memory. A value of 0
+                       (the default) removes the budget and restores the per-quantity snapshot counts.
+      */
+      void setCacheBudget( size_t bytes );
+      
+      /// returns the memory budget for the in-memory met data caches
+      /*! This method returns the memory budget for the in-memory met data caches.
+      
+          \return the budget, in bytes. 0 means that no budget is set.
+      */
+      size_t cacheBudget() const;
+      
+      /// returns the amount of memory used by the in-memory met data caches
+      /*! This method returns the number of bytes of gridded data currently being
+          held in all of the in-memory met data caches.
+          
+          \return the number of bytes held
+      */
+      size_t cacheBytes() const;
+      
+      /// returns in-memory cache statistics
+      /*! This method returns statistics on the use of the in-memory met data caches
+          since this object was created.
+          
+          \param hits (output) the number of requests that were satisfied from memory
+          \param misses (output) the number of requests that had to be read from disk or from the data source
+          \param evictions (output) the number of grids that were dropped from the caches to make room for others
+      */
+      void cacheStats( long& hits, long& misses, long& evictions ) const;
+
+      /// use a shared met cache server
+      /*! This method connects this object to a local met cache server (see gt_met_cached), through which
+          gridded fields are shared with other processes on the same host.
+          Before reading or deriving a field for itself, this object first looks for it
+          in the shared cache; after reading or deriving a field for itself, 
+          this object hands a copy to the shared cache.
+          The processes that share a server should use the same met source settings, 
+          as with a shared disk cache (see setCacheDir()).
+          
+          This does nothing unless gigatraj was built with the --enable-shmcache option.
+      
+          \param sockname the name of the server's socket. If this is the empty string, 
+                          then the shared cache is not used.
+      */
+      void setSharedCache( const std::string& sockname );
+      
+      /// returns the socket of the shared met cache server
+      /*! This method returns the name of the socket of the shared met cache server
+          being used.
+          
+          \return the socket name, or the empty string if no shared cache is used.
+      */
+      std::string sharedCache() const;
+
 
       /// (parallel processing) prepare for data acquisition
       /*! This method is used as an easy way to set up for
@@ -873,6 +953,46 @@ class MetGridData : public MetData {
       */
       virtual GridFieldSfc* readCacheSfc( const std::string quantity, const std::string time ) = 0;
 
+      /// write a GridField3D object to the shared met cache
+      /*! This method hands a copy of a GridField3D object to the 
+          shared met cache server, if one is being used (see setSharedCache()).
+
+          \param item the GridField3D data object which is to be shared
+      */
+      virtual void writeShared( const GridField3D* item ) const = 0;
+      
+      /// write a GridFieldSfc object to the shared met cache
+      /*! This method hands a copy of a GridFieldSfc object to the 
+          shared met cache server, if one is being used (see setSharedCache()).
+
+          \param item the GridFieldSfc data object which is to be shared
+      */
+      virtual void writeShared( const GridFieldSfc* item ) const = 0;
+
+      ///  read a GridField3D object from the shared met cache
+      /*!  This method reads a GridField3D object from the shared met cache, if one is being used
+           (see setSharedCache()).
+
+           \param quantity the name of the quantity desired
+           \param time the valid-at datestamp string for which data is desired
+
+           \return a pointer to a GridField3D object that holds the data, or NULL
+                   if the data are not in the shared cache
+      */
+      virtual GridField3D* readShared3D( const std::string quantity, const std::string time ) = 0;
+      
+      ///  read a GridFieldSfc object from the shared met cache
+      /*!  This method reads a GridFieldSfc object from the shared met cache, if one is being used
+           (see setSharedCache()).
+
+           \param quantity the name of the quantity desired, possibly with "@" and a surface name appended
+           \param time the valid-at datestamp string for which data is desired
+
+           \return a pointer to a GridFieldSfc object that holds the data, or NULL
+                   if the data are not in the shared cache
+      */
+      virtual GridFieldSfc* readSharedSfc( const std::string quantity, const std::string time ) = 0;
+
       /// (parallel processing) gets a 3D field valid at a certain time, as a client of a met data sertver
       /*! This method contacts a meteorological data server to obtain a new gridded data object,
           instead of reading the data itself. 
@@ -1032,8 +1152,52 @@ class MetGridData : public MetData {
                         No copy is made of the object pointed to; if that object
                         is deleted or otherwise changed by the calling routine, 
                         then the object in the cache is also affected. 
+                 \return the number of fields that were dropped to make room for this one
              */
-             void add( GridField3D* field );
+             int add( GridField3D* field );
+             
+             /// drops a GridField3D object from the cache
+             /*! This method drops a GridField3D object from the cache. 
+                 Unless fields are being held (see hold()), the object is deleted.
+                 
+                 \param field a pointer to the cached GridField3D object to be dropped. If 
+                        the object is not in this cache, nothing is done.
+             */
+             void drop( GridField3D* field );
+             
+             /// returns the number of fields in the cache
+             /*! This method returns the number of fields currently in the cache.
+             
+                 \return the number of cached fields
+             */
+             int count() const;
+             
+             /// returns a cached field
+             /*! This method returns one of the fields in the cache, 
+                 in order of priority, without changing that order.
+                 
+                 \param i the index of the field, from 0 (highest priority) to count()-1 (lowest)
+                 \return a pointer to the cached field
+             */
+             GridField3D* entry( int i ) const;
+             
+             /// returns the size of the cached data
+             /*! This method returns the number of bytes of gridded data held in the cache.
+             
+                 \return the number of bytes
+             */
+             size_t bytes() const;
+             
+             /// holds on to fields that are dropped from the cache
+             /*! This method turns on or off the holding of dropped fields. 
+                 While holding is on, fields that are dropped from the cache to make room for 
+                 new ones are set aside instead of being deleted, and has() still
+                 recognizes them. When holding is turned off, the set-aside fields are deleted.
+                 This is used while several threads share the cache (see MetGridData::setThreads()).
+                 
+                 \param mode true to turn holding on, false to turn it off
+             */
+             void hold( bool mode );
              
              /// print a cache report
              /*! This method prints a report to stderr that describes
@@ -1050,6 +1214,10 @@ class MetGridData : public MetData {
              std::deque<GridField3D*> data;
              /// the maximum capacity of this cache, in GridField objects
              int max;
+             /// whether dropped fields are being held instead of deleted
+             bool holding;
+             /// dropped fields that are being held
+             std::vector<GridField3D*> held;
       
          private:
             /// the default constructor
@@ -1155,8 +1323,52 @@ class MetGridData : public MetData {
                         is deleted or otherwise changed by the calling routine, 
                         then the object in the cache is also affected. Delete the object
                         only by calling the MetGridData remove() method.
+                 \return the number of fields that were dropped to make room for this one
              */
-             void add( GridFieldSfc* field );
+             int add( GridFieldSfc* field );
+             
+             /// drops a GridFieldSfc object from the cache
+             /*! This method drops a GridFieldSfc object from the cache. 
+                 Unless fields are being held (see hold()), the object is deleted.
+                 
+                 \param field a pointer to the cached GridFieldSfc object to be dropped. If 
+                        the object is not in this cache, nothing is done.
+             */
+             void drop( GridFieldSfc* field );
+             
+             /// returns the number of fields in the cache
+             /*! This method returns the number of fields currently in the cache.
+             
+                 \return the number of cached fields
+             */
+             int count() const;
+             
+             /// returns a cached field
+             /*! This method returns one of the fields in the cache, 
+                 in order of priority, without changing that order.
+                 
+                 \param i the index of the field, from 0 (highest priority) to count()-1 (lowest)
+                 \return a pointer to the cached field
+             */
+             GridFieldSfc* entry( int i ) const;
+             
+             /// returns the size of the cached data
+             /*! This method returns the number of bytes of gridded data held in the cache.
+             
+                 \return the number of bytes
+             */
+             size_t bytes() const;
+             
+             /// holds on to fields that are dropped from the cache
+             /*! This method turns on or off the holding of dropped fields. 
+                 While holding is on, fields that are dropped from the cache to make room for 
+                 new ones are set aside instead of being deleted, and has() still
+                 recognizes them. When holding is turned off, the set-aside fields are deleted.
+                 This is used while several threads share the cache (see MetGridData::setThreads()).
+                 
+                 \param mode true to turn holding on, false to turn it off
+             */
+             void hold( bool mode );
              
              /// print a cache report
              /*! This method prints a report to stderr that describes
@@ -1173,6 +1385,10 @@ class MetGridData : public MetData {
              std::deque<GridFieldSfc*> data;
              /// the maximum number of GridField objects this cache object can hold
              int max;
+             /// whether dropped fields are being held instead of deleted
+             bool holding;
+             /// dropped fields that are being held
+             std::vector<GridFieldSfc*> held;
       
          private:
             /// the default constructor cannot be used for anything
@@ -1286,15 +1502,80 @@ class MetGridData : public MetData {
           }
       };
       
+      /// returns the number of snapshots each new per-quantity cache should hold
+      /*! This method returns the number of snapshots that a newly-created
+          per-quantity cache should be allowed to hold. This is maxsnaps, unless
+          a memory budget has been set, in which case the count is effectively unlimited.
+          
+          \return the number of snapshots
+      */
+      int cacheSnaps() const;
+      
+      /// notes that a cached grid has been handed out to a caller
+      /*! This method records that a caller is using a cached grid, which will not be
+          dropped from memory to satisfy the memory budget (see setCacheBudget()) 
+          until the caller gives it back through remove(). A grid may be handed out 
+          to several callers at once.
+          
+          \param field a pointer to the cached grid
+      */
+      void holdCache( const void* field );
+      
+      /// notes that a caller is done with a cached grid
+      /*! This method undoes one holdCache() call for a grid.
+          Grids that were never held are ignored.
+      
+          \param field a pointer to the grid
+      */
+      void releaseCache( const void* field );
+      
+      /// notes that a cached grid has just been used
+      /*! This method records a grid as the most-recently-used of all the cached grids.
+      
+          \param field a pointer to the cached grid
+      */
+      void touchCache( const void* field );
+      
+      /// enforces the memory budget
+      /*! This method drops least-recently-used grids that are not being held by callers
+          from all of the in-memory caches
+          until the cached data fit within the memory budget.
+          
+          \param keep a pointer to a grid that has just been added, and which must not be dropped
+      */
+      void trimCache( const void* keep );
+
+      /// the memory budget for all in-memory caches, in bytes (0=none)
+      size_t cache_budget;
+      /// counter used to order cached grids by use
+      long cache_tick;
+      /// the last use of each cached grid, while a memory budget is set
+      std::map<const void*, long> cache_used;
+      /// the number of callers holding each cached grid
+      std::map<const void*, int> cache_held;
+      /// the number of in-memory cache hits
+      long cache_hits;
+      /// the number of in-memory cache misses
+      long cache_misses;
+      /// the number of grids dropped from the in-memory caches
+      long cache_evictions;
+      
       /// drop all (memory-)cached data
       /*! This method drops all data held in memory cache.
+          Subclasses that keep other data derived from the cached grids
+          should extend it to drop those as well.
       */
-      void flush_cache();
+      virtual void flush_cache();
 
       /// cache directory path
       FilePath* diskcachedir;
       /// flag: are we caching?
       bool diskcaching;
+
+#ifdef USE_SHMCACHE
+      /// the shared met cache client (NULL if none is used)
+      ShmCache* shmcache;
+#endif
       
 
 };
@@ -3,9 +3,11 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/MetGridData.hh"
+#include "gigatraj/HLatLonStencil.hh"
 
 namespace gigatraj {
 
@@ -25,6 +27,25 @@ own methods new_directGrid3D() and new_directGridSfc() for reading met data, as
 as certain other methods for dealing with naming conventions for
 meteorological fields and data cache files.
 
+When interpolating to arrays of points, this class keeps an HLatLonStencil
+object that remembers the grid cell and interpolation weights of each point,
+so that they can be shared among the two time snapshots that bracket
+a desired time and among the wind components, and reused from one 
+call to the next while a parcel remains in the same grid cell
+(as between the stages of a Runge-Kutta step).
+This can be turned off by setting the integer option "StencilCache" to 0.
+
+Interpolating to arrays of points in a 3D field at a time between two snapshots
+ordinarily means interpolating each snapshot in turn. If the integer option
+"TimePairCache" is set to 1, then for each quantity this class 
+also keeps the data of the two snapshots that bracket the current time interval in a single
+buffer, with the values of the two snapshots at each gridpoint side by side. Each corner 
+of each grid cell is then looked up once for both times, with the two values
+sharing a cache line. The buffer is rebuilt when the time moves into a new interval,
+so this pays off when many time steps are taken within each met data interval.
+It costs an extra copy of both snapshots of each quantity in memory, and it 
+applies only to processors that hold their own met data (i.e., not to met clients
+that obtain their data from a met server).
 
 */
 
@@ -409,6 +430,24 @@ class MetGridLatLonData : public MetGridData {
       */
       void getVectorData( int n, string lonquantity, string latquantity, real* lonvals, real *latvals, double time, real* lons, real* lats, real* zs, int flags=0);
 
+      /// (multithreading) returns whether the met data source locks itself
+      /*! This method overrides MetData::threadSafe(). The getData() and getVectorData()
+          methods lock the met data source for themselves, and the array versions
+          give up the lock while they interpolate, so that several threads
+          may interpolate at once.
+          
+          \return true
+      */
+      bool threadSafe() const;
+
+      /// (multithreading) declares how many threads are about to use the met data source
+      /*! This method overrides MetGridData::setThreads(). Each thread keeps
+          its own cached interpolation stencils.
+          
+          \param n the number of threads. This must be 1 outside of a parallel section.
+      */
+      void setThreads( int n );
+
       /// get the default tne delta between field snapshots
       /*! This method returns the default time spacing. Because this may depend on the field
           and on the time for which the fueld is desired, those are required parameters.
@@ -559,6 +598,44 @@ class MetGridLatLonData : public MetGridData {
       */
       GridFieldSfc* readCacheSfc( const std::string quantity, const std::string time );
 
+      /// write a GridField3D object to the shared met cache
+      /*! This method hands a copy of a GridField3D object to the 
+          shared met cache server, if one is being used (see setSharedCache()).
+
+          \param item the GridField3D data object which is to be shared
+      */
+      void writeShared( const GridField3D* item ) const;
+      
+      /// write a GridFieldSfc object to the shared met cache
+      /*! This method hands a copy of a GridFieldSfc object to the 
+          shared met cache server, if one is being used (see setSharedCache()).
+
+          \param item the GridFieldSfc data object which is to be shared
+      */
+      void writeShared( const GridFieldSfc* item ) const;
+
+      ///  read a GridField3D object from the shared met cache
+      /*!  This method reads a GridField3D object from the shared met cache, if one is being used.
+
+           \param quantity the name of the quantity desired
+           \param time the valid-at datestamp string for which data is desired
+
+           \return a pointer to a GridField3D object that holds the data, or NULL
+                   if the data are not in the shared cache
+      */
+      GridField3D* readShared3D( const std::string quantity, const std::string time );
+      
+      ///  read a GridFieldSfc object from the shared met cache
+      /*!  This method reads a GridFieldSfc object from the shared met cache, if one is being used.
+
+           \param quantity the name of the quantity desired, possibly with "@" and a surface name appended
+           \param time the valid-at datestamp string for which data is desired
+
+           \return a pointer to a GridFieldSfc object that holds the data, or NULL
+                   if the data are not in the shared cache
+      */
+      GridFieldSfc* readSharedSfc( const std::string quantity, const std::string time );
+
       /// set up for data access
       /*! Given a quantity and time, this method sets up any internal parameters that 
           may be used repeatedly during the course of data access.
@@ -636,9 +713,85 @@ class MetGridLatLonData : public MetGridData {
       */
       GridFieldSfc* new_clientGridSfc( const std::string& quantity, const std::string& time );
           
+      /// drop all (memory-)cached data
+      /*! This method drops all data held in memory cache, 
+          including any interleaved snapshot pairs (see the "TimePairCache" option).
+      */
+      void flush_cache();
 
 
    private:
+   
+      /// whether to use the cached interpolation stencils
+      bool use_stencil;
+      
+      /// the cached interpolation stencils for arrays of points
+      HLatLonStencil stencil;
+      
+      /// the cached interpolation stencils of the other threads of a pool (see setThreads())
+      std::vector<HLatLonStencil*> tstencils;
+      
+      /// returns the calling thread's cached interpolation stencils
+      HLatLonStencil* threadStencil();
+      
+      /// whether to keep interleaved pairs of time snapshots
+      bool use_timepairs;
+      
+      /// two time snapshots of a 3D quantity, with their values interleaved
+      struct TimePair {
+         /// the valid-at time of the first snapshot
+         std::string time1;
+         /// the valid-at time of the second snapshot
+         std::string time2;
+         /// the model time of the second snapshot
+         double t2;
+         /// the fill value of the second snapshot
+         real bad2;
+         /// the scale factor for converting the second snapshot to MKS units
+         real mksScale2;
+         /// the offset for converting the second snapshot to MKS units
+         real mksOffset2;
+         /// the values, with those of the first snapshot at even indices and the second at odd indices
+         std::vector<real> vals;
+         /// the vertical coordinate of the grids from which the pair was built
+         std::string vquant;
+         /// the longitudes of the grids from which the pair was built
+         std::vector<real> lons;
+         /// the latitudes of the grids from which the pair was built
+         std::vector<real> lats;
+         /// the vertical levels of the grids from which the pair was built
+         std::vector<real> zs;
+      };
+      
+      /// the interleaved snapshot pairs, indexed by quantity name
+      std::map<std::string, TimePair> timepairs;
+      
+      /// interpolates a 3D quantity at both bracketing times, using interleaved snapshot pairs
+      /*! This method interpolates a 3D quantity to an array of points at the two 
+          times that bracket a desired time, building or reusing an interleaved
+          pair of snapshots. Invalid values are replaced by the fill value of the first snapshot,
+          and valid values are converted to MKS units if desired, just as the array version of getData()
+          does for each snapshot.
+          
+          \param quantity the name of the quantity desired
+          \param ct1 the valid-at time of the first snapshot
+          \param ct2 the valid-at time of the second snapshot
+          \param n the number of points
+          \param lons the longitudes of the points
+          \param lats the latitudes of the points
+          \param zs the vertical coordinates of the points
+          \param vals1 (output) the interpolated values at the first time
+          \param vals2 (output) the interpolated values at the second time
+          \param t1 (output) the model time of the first snapshot
+          \param t2 (output) the model time of the second snapshot
+          \param badval (output) the fill value
+          \param flags METDATA_* flags to control the interpolation
+          \return true if the values were interpolated, false if the interleaved pairs could not be used,
+                  in which case the caller must interpolate each snapshot itself
+      */
+      bool pairVinterp( const std::string& quantity, const std::string& ct1, const std::string& ct2
+                      , int n, real* lons, real* lats, real* zs, real* vals1, real* vals2
+                      , double& t1, double& t2, real& badval, int flags );
        
 
 };
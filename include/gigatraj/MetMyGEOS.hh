@@ -255,6 +255,20 @@ class MetMyGEOS : public MetGridLatLonData {
                       Names that are not recognized by a specific subclass are
                       silently ignored.
                       
+                      Allowed names are:
+                      * RegionLonMin - the western edge of a region to which data reads are restricted
+                      * RegionLonMax - the eastern edge of the region (both edges must be set)
+                      * RegionLatMin - the southern edge of the region
+                      * RegionLatMax - the northern edge of the region
+                      * RegionZMin - the smallest value of the native vertical coordinate in the region
+                      * RegionZMax - the largest value of the native vertical coordinate in the region
+                      
+                      Only the gridpoints covering the region (plus one gridpoint of padding
+                      all around) are read and held in memory. Parcels that leave the region
+                      are flagged as having hit a boundary. The longitude edges may straddle the 
+                      dateline (e.g., 160 to -160), but if the region straddles the
+                      edge of the data grid, then all longitudes are read.
+                      
           \param value the value to be applied to the named configuration option
       
       */
@@ -336,6 +350,10 @@ class MetMyGEOS : public MetGridLatLonData {
                       Names that are not recognized by a specific subclass 
                       will return 0.
                       
+                      Allowed names are:
+                      * RegionLonMin, RegionLonMax, RegionLatMin, RegionLatMax,
+                        RegionZMin, RegionZMax - the edges of the region to which data reads are restricted
+                      
           \param value (output) the value to be obtained from the named configuration option
       
           \return true if the option was valid; false if the value returned is meaningless
@@ -413,6 +431,23 @@ class MetMyGEOS : public MetGridLatLonData {
       */
       bool legalQuantity( const std::string quantity );     
 
+      /// check whether a location lies within the region being read
+      /*! This method checks whether a location lies within the region
+          set by the RegionLonMin, RegionLonMax, RegionLatMin, RegionLatMax,
+          RegionZMin, and RegionZMax options. If no region has been set,
+          all locations are within the domain.
+          
+          The vertical coordinate is tested only if the vertical coordinate
+          being used is the native vertical coordinate of the data.
+
+          \param lon the longitude of the location
+          \param lat the latitude of the location
+          \param z the vertical coordinate of the location
+
+          \return true if the location is within the region, false otherwise
+      */
+      bool inDomain( real lon, real lat, real z ) const;
+
 
       /// returns the units of a desired quantity
       /*! This method returns the units of a quantity, if known.
@@ -759,6 +794,14 @@ class MetMyGEOS : public MetGridLatLonData {
            int thin;
            /// offset for thinning longitudes
            int thin_offset;
+           /// index of the first longitude to be read
+           int lonFirst;
+           /// number of longitudes to be read (every thin'th longitude, starting at lonFirst)
+           int lonCount;
+           /// index of the first latitude to be read
+           int latFirst;
+           /// number of latitudes to be read (every thin'th latitude, starting at latFirst)
+           int latCount;
            /*! bitwise indicators for which items have been specified (as opposed to computed)
                  0x01 = startlon
                  0x02 = endlon
@@ -812,6 +855,19 @@ class MetMyGEOS : public MetGridLatLonData {
            */    
            bool test( const HGridSpec& cmp ) const;
 
+           /// sets the longitudes and latitudes to be read
+           /*! This method sets lonFirst, lonCount, latFirst, and latCount, 
+               given the thinning factors and a lon/lat region. 
+               The selected gridpoints cover the region, plus one 
+               gridpoint of padding on every side.
+               
+               \param given bitwise indicators for which region edges are set:
+                     0x01 = western edge, 0x02 = eastern edge, 0x04 = southern edge, 0x08 = northern edge.
+                     The longitude edges are used only if both are set.
+               \param bnds an array of region edges: western longitude, eastern longitude, southern latitude, northern latitude
+           */
+           void region( int given, const real* bnds );
+
        };
        
        /// holds vertical grid specifications
@@ -843,6 +899,10 @@ class MetMyGEOS : public MetGridLatLonData {
            std::vector<real> levs;
            /// number of vertical levels
            int nLevs;
+           /// index of the first vertical level to be read
+           int levFirst;
+           /// number of vertical levels to be read
+           int levCount;
            
            /// constructor
            VGridSpec();
@@ -880,6 +940,18 @@ class MetMyGEOS : public MetGridLatLonData {
            */    
            bool test( const VGridSpec& cmp ) const;
            
+           /// sets the vertical levels to be read
+           /*! This method sets levFirst and levCount, given a range
+               of vertical coordinate values. The selected levels cover the range, 
+               plus one level of padding above and below.
+               
+               \param given bitwise indicators for which range ends are set:
+                     0x01 = minimum, 0x02 = maximum
+               \param zmin the minimum vertical coordinate value
+               \param zmax the maximum vertical coordinate value
+           */
+           void region( int given, real zmin, real zmax );
+           
        };
        
        
@@ -1192,6 +1264,26 @@ class MetMyGEOS : public MetGridLatLonData {
       VGridSpec vgrid;
       /// the specs of the time grid of the data source to be read
       TGridSpec tgrid;
+      
+      /// the edges of the region to be read: lon min, lon max, lat min, lat max, z min, z max
+      real region_bnds[6];
+      /*! bitwise indicators for which region edges have been set
+             0x01 = lon min
+             0x02 = lon max
+             0x04 = lat min
+             0x08 = lat max
+             0x10 = z min
+             0x20 = z max
+      */       
+      int region_given;
+      /// whether the vertical range of the region is in use
+      bool region_vert;
+      /// whether the automatic vertical level window has been set (see MetData::setLevelWindow())
+      bool levwin_set;
+      /// the range of vertical coordinates spanned by the parcels so far
+      real levwin_zs[2];
+      /// the vertical level window: the parcels' range, plus a margin of levels
+      real levwin_bnds[2];
       /// the trgrid spec for an open URL
       TGridSpec url_tgrid;
 
@@ -1750,6 +1842,33 @@ class MetMyGEOS : public MetGridLatLonData {
            This affects tbase and tspace of cur_tgrid.
        */    
        void update_tgrid();
+
+       /// returns a cache file name flag for the region being read
+       /*! This method returns a string that identifies the region to which data reads
+           are restricted, for use in cache file names.
+
+           \param vert true if the vertical range is to be included (for 3D fields), false otherwise
+           \return the flag string, or an empty string if no region has been set
+       */
+       std::string region_tag( bool vert ) const;
+       
+       /// sets the vertical levels to be read
+       /*! This method sets the range of vertical levels to be read in vgrid,
+           combining the vertical range of the region (if any) and the
+           automatic vertical level window (if any).
+       */
+       void update_vregion();
+       
+       /// sets the vertical range of the parcels about to be traced
+       /*! This method widens the automatic vertical level window, if needed,
+           so that it covers the parcels with a margin of vertical levels to spare.
+           If this changes the levels to be read, then the data
+           held in memory are dropped, to be re-read with the new levels.
+           
+           \param zlo the smallest vertical coordinate value of the parcels
+           \param zhi the largest vertical coordinate value of the parcels
+       */
+       void levelRange( real zlo, real zhi );
        
        /// reads the standard set of dimension from an open remote file
        /*! This method reads the time, lon, lat, and (if present) lev dimensions
@@ -1852,7 +1971,7 @@ class MetMyGEOS : public MetGridLatLonData {
                      The index order is the same as for starts[] and counts[].
                      Typically all elements are 1.        
        */
-       void Source_read_data_floats( real** vals, int var_id, int ndims, size_t *starts, size_t *counts, ptrdiff_t *strides );
+       void Source_read_data_floats( gridreal** vals, int var_id, int ndims, size_t *starts, size_t *counts, ptrdiff_t *strides );
 
 
        /// read just the desired 3D variable from the data source 
@@ -1941,7 +2060,7 @@ class MetMyGEOS : public MetGridLatLonData {
            \param nlats a pointer to the number of latitudfes returned
            \param lats a pointer to an array of latitudes returned       
        */
-       void query_hgrid( const HGridSpec& qhgrid, int* nlons, real** lons, int* nlats, real** lats ) const;
+       void query_hgrid( const HGridSpec& qhgrid, int* nlons, gridreal** lons, int* nlats, gridreal** lats ) const;
 
        /// queries a vertical grid for its level values 
        /*! 
@@ -1966,7 +2085,7 @@ class MetMyGEOS : public MetGridLatLonData {
            \param q a reference to a string that will hold the vertical coordinate quantity
            \param u a reference to a string that will hold the units of the vertical coordinate quantity
        */
-       void query_vgrid( const VGridSpec& qvgrid, int* nlevs, real** levels, std::string& q, std::string& u  ) const;
+       void query_vgrid( const VGridSpec& qvgrid, int* nlevs, gridreal** levels, std::string& q, std::string& u  ) const;
 
 
 };
@@ -449,7 +449,10 @@ class NetcdfIn : public ParcelInitializer {
 
 
       /// Initialize a Flock of parcels
-      /*! This method initializes a Flock of Parcels
+      /*! This method initializes a Flock of Parcels.
+          Every processor in the Flock must have opened the file, since each
+          tracing processor reads the block of parcels that it handles itself,
+          without communicating with the other processors.
       
           \param p the Flock of Parcel objects to be initialized
            
@@ -457,7 +460,10 @@ class NetcdfIn : public ParcelInitializer {
       void apply( Flock& p ); 
 
       /// Initialize a Swarm of parcels
-      /*! This method initializes a Swarm of Parcels
+      /*! This method initializes a Swarm of Parcels.
+          Every processor in the Swarm must have opened the file, since each
+          tracing processor reads the block of parcels that it handles itself,
+          without communicating with the other processors.
       
           \param p the Swarm of Parcel objects to be initialized
            
@@ -598,9 +604,11 @@ class NetcdfIn : public ParcelInitializer {
           \param var_type the netcdf type of the variable
           \param n the number of reals to be read
           \param destination a pointer to aa eal or array of reals to hold the data read in
+          \param start the index of the first parcel to be read. If negative (the default),
+                 reading starts at the current parcel.
 
       */
-      void rd_real( int var_id, int var_type, size_t n, real* destination ); 
+      void rd_real( int var_id, int var_type, size_t n, real* destination, int start=-1 ); 
       
 
       /// reads integer numbers from a netcdf variable
@@ -611,9 +619,23 @@ class NetcdfIn : public ParcelInitializer {
           \param var_type the netcdf type of the variable
           \param n the number of integers to be read
           \param destination a pointer to aa eal or array of integers to hold the data read in
+          \param start the index of the first parcel to be read. If negative (the default),
+                 reading starts at the current parcel.
 
       */
-      void rd_int( int var_id, int var_type, size_t n, int* destination ); 
+      void rd_int( int var_id, int var_type, size_t n, int* destination, int start=-1 ); 
+
+      /// reads a contiguous block of parcels
+      /*! This method reads the positions, tags, status, and flags
+          of a contiguous range of parcels in the file, 
+          making one netcdf read call per variable rather than one per parcel.
+          It does not change the current parcel.
+          
+          \param start the index of the first parcel to be read
+          \param n the number of parcels to be read
+          \param dest an array of n Parcels to be initialized
+      */
+      void rd_block( int start, int n, Parcel* dest );
 
      /// convert netcdf time to model time
      /*! This method converts netcdf time to model time
@@ -26,6 +26,14 @@ of longitude lines at the pole.
 Aside from the horizontal position, all other characteristics
 of the Parcels are copied from an input parcel. This includes the vertical coordinate position.
 
+The position of each parcel is determined by the random seed and by the 
+parcel's index within the collection, and not by the order in which parcels
+are generated. Thus, for a given seed, a Flock or Swarm is initialized identically
+no matter how many processors it is spread across, and each processor
+generates only its own parcels. If no seed has been set with seed(), 
+a new one is chosen each time a collection is created (and shared among the processors
+of a process group).
+
 */
 
 class PGenRnd : public ParcelGenerator {
@@ -153,6 +161,9 @@ class PGenRnd : public ParcelGenerator {
      
        RandomSrc rnd; 
        
+       /// flag: the seed was set by the user
+       bool fixed_seed;
+       
        /// westernmost longoitude
        float lon0;
        /// easternmost longitude
@@ -179,6 +190,25 @@ class PGenRnd : public ParcelGenerator {
       void init( Seq<Parcel>* seq
                          );
 
+      /// chooses a new seed, unless the user has set one
+      /*! This method chooses a new random seed for the creation of 
+          a new collection of parcels, unless a seed was set explicitly by seed().
+          
+          \param pgrp a pointer to the process group among whose
+                      members the seed is to be shared. If NULLPTR, the seed
+                      is not shared.
+      */
+      void rekey( ProcessGrp* pgrp=NULLPTR );
+
+      /// sets the position of a parcel
+      /*! This method sets the random position of a parcel, given its index
+          within its collection.
+          
+          \param idx the index of the parcel
+          \param p the parcel whose position is to be set
+      */
+      void place( unsigned long idx, Parcel& p ) const;
+
 
 };
 }
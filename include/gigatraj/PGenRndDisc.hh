@@ -28,6 +28,11 @@ of longitude lines at the pole.
 Aside from the horizontal and vertical positions, all other characteristics
 of the Parcels are copied from an input parcel. 
 
+As with PGenRnd, the position of each parcel is determined by the random seed
+and by the parcel's index within the collection, so that, for a given seed,
+a Flock or Swarm is initialized identically regardless of the number of
+processors, with each processor generating only its own parcels.
+
 */
 
 class PGenRndDisc : public ParcelGenerator {
@@ -179,6 +184,9 @@ class PGenRndDisc : public ParcelGenerator {
    private:
      
        RandomSrc rnd; 
+       
+       /// flag: the seed was set by the user
+       bool fixed_seed;
 
    private:
    
@@ -203,6 +211,26 @@ class PGenRndDisc : public ParcelGenerator {
       void init( Seq<Parcel>* seq
                          );
 
+      /// chooses a new seed, unless the user has set one
+      /*! This method chooses a new random seed for the creation of 
+          a new collection of parcels, unless a seed was set explicitly by seed().
+          
+          \param pgrp a pointer to the process group among whose
+                      members the seed is to be shared. If NULLPTR, the seed
+                      is not shared.
+      */
+      void rekey( ProcessGrp* pgrp=NULLPTR );
+
+      /// sets the position of a parcel
+      /*! This method sets the random position of a parcel, given its index
+          within its collection.
+          
+          \param idx the index of the parcel
+          \param p the parcel whose position is to be set
+      */
+      void place( unsigned long idx, Parcel& p ) const;
+
+
 };
 }
 
@@ -31,6 +31,11 @@ one-dimensional arrays or containers. They are stored in row-major
 (i.e., Fortran) order: along-line first, then vertical
 coordinates.
 
+As with PGenRnd, the position of each parcel is determined by the random seed
+and by the parcel's index within the collection, so that, for a given seed,
+a Flock or Swarm is initialized identically regardless of the number of
+processors, with each processor generating only its own parcels.
+
 */
 
 class PGenRndLine : public ParcelGenerator {
@@ -39,6 +44,37 @@ class PGenRndLine : public ParcelGenerator {
       
        // source of random numbers
        RandomSrc rnd; 
+       
+       /// flag: the seed was set by the user
+       bool fixed_seed;
+
+      /// chooses a new seed, unless the user has set one
+      /*! This method chooses a new random seed for the creation of 
+          a new collection of parcels, unless a seed was set explicitly by seed().
+          
+          \param pgrp a pointer to the process group among whose
+                      members the seed is to be shared. If NULLPTR, the seed
+                      is not shared.
+      */
+      void rekey( ProcessGrp* pgrp=NULLPTR );
+
+      /// sets the position of a parcel
+      /*! This method sets the random position of a parcel, given its index
+          within its collection.
+          
+          \param idx the index of the parcel
+          \param p the parcel whose position is to be set
+          \param e the navigation object to be used
+          \param beglon the beginning longitude value
+          \param beglat the beginning latitude value
+          \param totaldist the length of the line
+          \param bear the bearing of the line at its beginning
+          \param begz the beginning vertical coordinate value
+          \param endz the ending vertical coordinate value
+      */
+      void place( unsigned long idx, Parcel& p, PlanetNav* e
+                , real beglon, real beglat, real totaldist, real bear
+                , real begz, real endz ) const;
 
       /*! initialize the gridpoints in a sequence container
       
@@ -200,6 +236,14 @@ class PGenRndLine : public ParcelGenerator {
                            , ProcessGrp* pgrp=NULLPTR, int r=0
                            );
 
+      /// Seed the random number generator
+      /*! This method seeds the random number generator for parcel location generation.
+      
+         \param saw a pointer to a seed for the random number generator.
+                    If NULL, then an internal seed generator is used.
+      */
+      void seed( unsigned const int *saw=NULL);
+
 
 };
 }
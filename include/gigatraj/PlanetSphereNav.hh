@@ -64,6 +64,43 @@ class PlanetSphereNav: public PlanetNav {
       */
       real polar_limit();
       
+      /// selects the batch (vectorizable) versions of the multi-point navigation methods
+      /*! By default, the multi-point versions of deltaxy(), vRelocate(), distance(),
+          and bearing() loop over the points one at a time, branching on each
+          point's special cases. Setting a nonzero mode here routes those calls
+          (for approximation levels <= 0) through batch kernels instead. These work on blocks 
+          of points, with a branch-free main loop that the compiler can
+          vectorize: non-finite inputs are masked out rather than branched around,
+          the sine and cosine of each angle are computed together, and 
+          the rare pole-crossing cases are finished afterwards by the scalar code.
+          
+          The compiler vectorizes these loops only at higher optimization levels
+          and when it need not preserve errno or floating-point exception flags
+          for the math functions (e.g., with g++, "-O3 -fno-math-errno -fno-trapping-math",
+          which do not change the results). Mode 2 benefits the most, since the
+          math library calls of mode 1 cannot be vectorized.
+          
+          The batch kernels always evaluate the exact spherical-trigonometry formulas,
+          so for approximation level 0 they are more accurate (and not slower)
+          than the scalar approximations they replace.
+          
+          \param mode 0 for the scalar code (the default), 1 for the batch kernels
+                 using the system math library (results agree with the exact scalar
+                 code to within roundoff), or 2 for the batch kernels using inline polynomial
+                 approximations for the trig functions. The polynomial sine and cosine have absolute
+                 errors below 1e-15 for arguments up to 10 radians, and the polynomial arctangent
+                 has a relative error below 1e-15, so
+                 positions agree with the exact code to better than 1e-10 degrees (in double precision).
+      */
+      void vectorized( int mode );
+      
+      /// returns the batch mode for the multi-point navigation methods
+      /*! This method returns the mode set by vectorized(int).
+      
+          \return 0 for the scalar code, 1 for the library batch kernels, 2 for the polynomial batch kernels
+      */
+      int vectorized() const;
+      
       /// applies longitudinal and latitudinal distance displacements to a location
       /*! This function adds a longitudinal distance and a latitudinal distance to a longitude, latitude
           position.
@@ -129,6 +166,18 @@ class PlanetSphereNav: public PlanetNav {
       */
       void distance( int n, const real *lon1, const real *lat1, const real *lon2, const real *lat2, real *d);   
        
+      /// calculates great-circle bearings between two sets of locations.
+      /*! This function calculates the great-circle bearings between two sets of locations.
+      
+         \param n the number of locations 
+         \param lon1 a pointer to the longitudes of the first set of points
+         \param lat1 a pointer to the latitudes of the first set of points
+         \param lon2 a pointer to the longitudes of the second set of points
+         \param lat2 a pointer to the longitudes of the second set of points
+         \param b a pointer to the output bearings, in degrees clockwise from north
+      */
+      void bearing( int n, const real *lon1, const real *lat1, const real *lon2, const real *lat2, real *b);   
+       
       /// calculates a position a given distance and bearing from a given position
       /*! This function calculates the longitude and latitude of a position
           a given distance and bearing from a starting position.
@@ -234,6 +283,9 @@ class PlanetSphereNav: public PlanetNav {
       /// the latitude poleward of which conformal corrections should be applied
       real polar_lat;
 
+      /// the batch mode (see vectorized(int))
+      int vecmode;
+
       /// applies longitudinal and latitudinal distance displacements to multiple locations, exactly
       /*! This function adds an array of longitudinal distances and a latitudinal distances to a 
           set of longitude and latitude
@@ -281,6 +333,20 @@ class PlanetSphereNav: public PlanetNav {
           \param factor an optional multiplicatove factor to be applied to deltax and deltay
       */
       void deltaxy_crude( int n, real *longitudes, real *latitudes, const real *deltax, const real *deltay, real factor=1.0 );
+
+      /// applies longitudinal and latitudinal distance displacements to multiple locations, in batches
+      /*! This function does the same calculation as deltaxy_exact(), but in blocks
+          of points, using a branch-free kernel that the compiler can vectorize. Points that
+          start at or cross a pole are passed to deltaxy_exact() afterwards.
+          
+          \param n the number of positions to change
+          \param longitudes a pointer to an array of the longitudes (input and output)
+          \param latitudes a pointer to an array of latitudes (input and output)
+          \param deltax a pointer to an array of the change in longitudinal position, in km
+          \param deltay a pointer to an array of the change in meridional position, in km
+          \param factor an optional multiplicatove factor to be applied to deltax and deltay
+      */
+      void deltaxy_batch( int n, real *longitudes, real *latitudes, const real *deltax, const real *deltay, real factor=1.0 );
 };
 }
 
@@ -58,6 +58,8 @@ const int PG_KEEPROOT = 0x0002;
 //@{
 /// Interprocess Communications Commands: The recieving processor is advised that the sending processor is done and will issue no further requests.
 static const int PGR_CMD_DONE = 0;
+/// Interprocess Communications Commands: The recieving processor is advised that the sending processor has finished a time step.
+static const int PGR_CMD_STEP = 1;
 //@}
 
 /*! @name Interprocess Communications Status
@@ -480,6 +482,19 @@ class ProcessGrp {
       */
       virtual void receive_string( int id, string *vals, int tag=0, int *src=NULL) const = 0;
 
+      /// returns the number of processors with a message waiting to be received
+      /*! This function returns the number of other processors in this group
+          that have sent this processor a message with a given tag that has not 
+          yet been received. It does not receive the messages.
+          This is meant for diagnostic use, such as measuring
+          the backlog of requests at a met data server processor.
+          The default implementation returns 0.
+          
+           \param tag the label of the messages to check for
+           \return the number of processors with messages waiting
+      */
+      virtual int pending( int tag=0 ) const;
+
 
    protected:
 
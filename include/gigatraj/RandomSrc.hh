@@ -2,6 +2,8 @@
 #define RANDOMSRC_H
 
 
+#include <stdint.h>
+
 #include "gigatraj/gigatraj.hh"
 
 namespace gigatraj {
@@ -12,6 +14,17 @@ namespace gigatraj {
    
  An object of the RandomSrc class generates random numbers.
  
+ The numbers come from a counter-based generator (Philox-4x32-10), 
+ in which the n-th block of four 32-bit random integers is a pure function of
+ the seed and of n. Each RandomSrc object keeps its own seed and counter,
+ so separate objects do not disturb each other. 
+ 
+ Besides drawing numbers in sequence with uniform(), a caller may ask 
+ for the numbers belonging to a particular item (for example, the parcel 
+ with a particular index) with uniform4(). Since these depend only on the
+ seed and the item index, items can be generated in any order, 
+ on any processor, and the results are the same.
+ 
 */
 
 class RandomSrc {
@@ -43,6 +56,24 @@ class RandomSrc {
        */    
        real uniform( real min=0.0, real max=1.0 );
        
+       /// returns the uniformly distributed random numbers that belong to a given item
+       /*! This method returns four uniformly distributed random numbers
+           between 0 and 1 that are determined solely by the current seed
+           and by an item index. It does not affect the sequence
+           of numbers returned by uniform() and raw().
+           
+           \param index the index of the item (such as a parcel index)
+           \param vals a pointer to an array of four values, which will hold the random numbers
+       */
+       void uniform4( unsigned long index, real* vals ) const;
+       
+       /// returns the current seed
+       /*! This method returns the seed with which the generator was last seeded.
+       
+           \return the seed
+       */
+       unsigned int getSeed() const;
+       
 
        /*! returns a raw integer random number directly
            from the random number generator
@@ -63,6 +94,29 @@ class RandomSrc {
        
        /// the name of a device from which random numbers may be read. The default is /dev/random.
        std::string rdev;
+       
+       /// the seed
+       uint32_t key;
+       /// the counter for sequential draws
+       uint64_t ctr;
+       /// the unused random integers from the latest sequential block
+       uint32_t buf[4];
+       /// the number of random integers remaining in buf
+       int nbuf;
+       
+       /// returns the next random integer in sequence
+       uint32_t next();
+       
+       /// the Philox-4x32-10 block function
+       /*! This function turns a 128-bit counter and a 64-bit key into
+           128 bits of random output.
+           
+           \param ctr the four 32-bit words of the counter
+           \param k0 the first word of the key
+           \param k1 the second word of the key
+           \param out the four 32-bit words of random output
+       */
+       static void philox( const uint32_t* ctr, uint32_t k0, uint32_t k1, uint32_t* out );
 
 };
 }
@@ -0,0 +1,234 @@
+#ifndef GIGATRAJ_SHMCACHE_H
+#define GIGATRAJ_SHMCACHE_H
+
+#include <string>
+#include <map>
+#include <streambuf>
+
+#include "gigatraj/gigatraj.hh"
+
+namespace gigatraj {
+
+/*!
+\ingroup MetMisc
+\brief ShmCache shares met data grids among independent processes on the same host
+
+When many independent model runs are made on the same machine (for example,
+for the members of an ensemble), each one would ordinarily read and derive the same
+meteorological data snapshots for itself. The disk cache (see MetGridData::setCacheDir())
+lets those runs share data, but only through the file system.
+
+A ShmCache object is either the server or a client of a small local cache service.
+The server (see the gt_met_cached tool) listens on a Unix-domain socket and owns
+a collection of POSIX shared memory segments, each of which holds one serialized
+gridded field. Clients ask the server over the socket whether a field is
+available; if it is, they attach to its segment read-only and deserialize
+the field from it directly. A client that has had to read or derive a field
+for itself hands a copy to the server so that other clients can use it.
+No network connections are involved.
+
+Each field is identified by a key string, which the client constructs from
+the met data source, the quantity, the vertical coordinate, and the data time,
+in the same way that it names disk cache files. Processes that share
+a server must therefore use the same met data configuration, just as
+with a shared disk cache.
+
+A client whose server is not running simply finds nothing in the cache;
+it never fails because of the cache.
+
+*/
+class ShmCache {
+
+   public:
+   
+      /// Error: the socket could not be set up
+      class badSocket {};
+      
+      /// Error: a shared memory segment could not be set up
+      class badShm {};
+      
+      /// a read-only stream buffer over an attached item
+      /*! This class lets an item obtained from attach() be read 
+          through a std::istream, without copying it first.
+      */
+      class Buffer : public std::streambuf {
+         public:
+            /// the constructor
+            /*! This is the constructor for the Buffer class.
+            
+                \param data the pointer returned by attach()
+                \param size the size returned by attach()
+            */
+            Buffer( const char* data, size_t size ) {
+               char* p = const_cast<char*>(data);
+               setg( p, p, p + size );
+            };
+      };
+      
+      /// the constructor
+      /*! This is the constructor for the ShmCache class.
+      
+          \param sockname the name of the Unix-domain socket through which the server is reached
+      */
+      ShmCache( const std::string& sockname );
+
+      /// destructor
+      /*! This is the destructor for the ShmCache class. If this object is serving
+          data, all of its shared memory segments are removed.
+      */
+      ~ShmCache();
+      
+      /// returns the name of the server socket
+      /*! This method returns the name of the socket through which the server is reached.
+      
+          \return the socket name
+      */
+      std::string socketName() const;
+      
+      /// (client) attaches to a cached item
+      /*! This method asks the server for a cached item and, if it is
+          available, maps the item's shared memory segment read-only
+          into this process.
+          
+          \param key the key string that identifies the desired item
+          \param size (output) the number of bytes in the item
+          
+          \return a pointer to the item's data, or NULL if the item is not available.
+                  The caller should pass the pointer to detach() when done with it.
+      */
+      const char* attach( const std::string& key, size_t& size );
+      
+      /// (client) detaches from a cached item
+      /*! This method unmaps an item's shared memory segment that was 
+          mapped by attach().
+          
+          \param data the pointer returned by attach()
+          \param size the size returned by attach()
+      */
+      void detach( const char* data, size_t size );
+
+      /// (client) offers an item to the cache
+      /*! This method places a copy of an item into a new shared memory segment and
+          hands that segment over to the server.
+          
+          \param key the key string that identifies the item
+          \param data the item's data
+          
+          \return true if the server took the item, false if the server already had it
+                  or could not be reached
+      */
+      bool put( const std::string& key, const std::string& data );
+      
+      /// (client) obtains the server's statistics
+      /*! This method asks the server about the state of the cache.
+      
+          \param items (output) the number of items being held
+          \param bytes (output) the number of bytes being held
+          \param hits (output) the number of requests that found their item
+          \param misses (output) the number of requests that did not
+          
+          \return true if the server responded, false otherwise
+      */
+      bool stats( long& items, size_t& bytes, long& hits, long& misses );
+      
+      /// (client) tells the server to shut down
+      /*! This method tells the server to remove all of its shared memory 
+          segments and exit. Clients that are still attached to a segment 
+          can keep using it until they detach from it.
+          
+          \return true if the server responded, false otherwise
+      */
+      bool shutdown();
+      
+      /// (server) serves cached items to clients
+      /*! This method creates the server socket and then answers client requests until
+          a client calls shutdown() or the process receives SIGINT or SIGTERM.
+          Only one server may use a given socket.
+          
+          \param budget the maximum number of bytes to hold. If a new item 
+                 pushes the total over the budget, the least-recently-used items are dropped.
+                 0 means no limit.
+      */
+      void serve( size_t budget=0 );
+      
+      /// turns on debugging messages
+      int dbug;
+      
+   private:
+   
+      /// a cached item, as tracked by the server
+      struct Item {
+         /// the name of the shared memory segment
+         std::string shmname;
+         /// the size of the item, in bytes
+         size_t size;
+         /// when the item was last asked for
+         long used;
+      };
+   
+      /// the name of the server socket
+      std::string sock;
+      
+      /// (server) the cached items, by key
+      std::map<std::string, Item> items;
+      /// (server) the total size of the cached items
+      size_t total;
+      /// (server) counter used to order items by use
+      long tick;
+      /// (server) the number of requests that found their item
+      long nhits;
+      /// (server) the number of requests that did not
+      long nmisses;
+      
+      /// (client) sends a request to the server and reads its reply
+      /*! This method connects to the server, sends a one-line request, and reads a one-line reply.
+      
+          \param request the request
+          \param reply (output) the reply
+          
+          \return true if the exchange succeeded, false otherwise
+      */
+      bool ask( const std::string& request, std::string& reply );
+      
+      /// (server) answers a single request
+      /*! This method answers one request from a client.
+      
+          \param request the request
+          \param budget the maximum number of bytes to hold (0=no limit)
+          
+          \return the reply
+      */
+      std::string answer( const std::string& request, size_t budget );
+
+      /// (server) drops items until the budget is met
+      /*! This method removes least-recently-used items until the 
+          total size of the cached items fits within a budget.
+          
+          \param budget the maximum number of bytes to hold (0=no limit)
+      */
+      void trim( size_t budget );
+      
+      /// (server) drops all items
+      /*! This method removes all items and their shared memory segments.
+      */
+      void clear();
+
+};
+
+}
+
+#endif
+
+
+
+
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
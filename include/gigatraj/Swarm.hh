@@ -12,6 +12,7 @@
 #define GIGATRAJ_SWARM_H
 
 #include <vector>
+#include <map>
 
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/Parcel.hh"
@@ -22,6 +23,30 @@
 
 namespace gigatraj {
 
+///@name Interprocess Communications Tags
+//@{
+/// Interprocess Communications Tags: "Swarm tracer load counts"
+static const int PGR_TAG_SWLOAD = 3000;
+/// Interprocess Communications Tags: "Swarm parcel migration plan"
+static const int PGR_TAG_SWPLAN = 3005;
+/// Interprocess Communications Tags: "Swarm migrating parcel contents"
+static const int PGR_TAG_SWMOVE = 3010;
+/// Interprocess Communications Tags: "Swarm parcel ownership changes"
+static const int PGR_TAG_SWOWNR = 3015;
+/// Interprocess Communications Tags: "Swarm parcels leaving a spatial domain"
+static const int PGR_TAG_SWDOMN = 3020;
+//@}
+
+///@name Swarm spatial domain decompositions
+//@{
+/// Swarm domains: parcels are owned by index range (or by load-balancing)
+static const int SWARM_DOMAIN_NONE = 0;
+/// Swarm domains: each tracing processor owns an equal-area latitude band, the first and last being polar caps
+static const int SWARM_DOMAIN_BANDS = 1;
+/// Swarm domains: each tracing processor owns a longitude-latitude tile
+static const int SWARM_DOMAIN_TILES = 2;
+//@}
+
 /*!  \ingroup parcels
 
 \brief parallelizable collection of parcel information.  
@@ -108,9 +133,12 @@ class Swarm {
          \param r    the ratio of meteorological-data processors to parcel-tracing processors.
                      (For example, if r=3 then there will be one met processor for
                      every 3 parcel-tracing processors) 
+         \param s    the number of meteorological-data processors in each processor (sub)group.
+                     If s > 1, then met data requests are sharded among the s met processors
+                     by quantity and snapshot time.
                     
      */
-     Swarm( ProcessGrp* pgrp, int n=0, int r=0);
+     Swarm( ProcessGrp* pgrp, int n=0, int r=0, int s=1);
      
      /// Parcel-initializing constructor
      /*! This Swarm constructor assigns N parcels by copying a user-supplied Parcel object. 
@@ -133,9 +161,12 @@ class Swarm {
          \param r  the ratio of meteorological-data processors ot tracing processors.
                   (For example, if r=3 then there will be one met processor for
                   every 3 parcel-tracing processors) 
+         \param s  the number of meteorological-data processors in each processor (sub)group.
+                  If s > 1, then met data requests are sharded among the s met processors
+                  by quantity and snapshot time.
                     
      */
-     Swarm( const Parcel &p, ProcessGrp* pgrp, int n=0, int r=0);
+     Swarm( const Parcel &p, ProcessGrp* pgrp, int n=0, int r=0, int s=1);
      
 
      /// The destructor
@@ -181,6 +212,20 @@ class Swarm {
      {
          return pgroup->type();
      }
+     /// returns the number of Parcels handled by this processor
+     inline int local_size() const 
+     {
+         return my_num_parcels;
+     }
+
+     /// returns the global index of a local parcel
+     /*! This method returns the Swarm-wide index of one of the current processor's parcels.
+     
+         \param k the local parcel number, running from 0 to (local_size()-1)
+     
+         \return the global index of the parcel
+     */
+     int global_index( int k ) const;
 
      class iterator;
      friend class iterator;
@@ -567,11 +612,212 @@ class Swarm {
       
          \param dt the delta-time over which the parcel is to advance
          
+         If load-balancing has been turned on with setRebalance(), then
+         every few time steps, after the parcels have been advanced, the tracing 
+         processors report their numbers of active parcels to the root processor,
+         and the active parcels are redistributed among the tracing processors 
+         (see setRebalance()).
+
+         If spatial domain decomposition has been turned on with setDomains(),
+         then every few time steps the active parcels are moved to the
+         tracing processors whose domains contain them (see setDomains()).
+
+         Whether the processors wait for each other at the end of
+         each time step is governed by the met data source's 
+         MetData::setStepSync() setting.
+         Before the step, the region spanned by the parcels is passed
+         to the met data source's MetData::haloRegion() method.
+         
+         If a pool of threads has been requested with setThreads(), then
+         the processor's parcels are traced in blocks by the threads 
+         of the pool.
+      
          \return always returns zero.
          
      */
      int advance( double dt );
      
+     /// turns on load-balancing of active parcels among the tracing processors
+     /*! Parcels are initially assigned to the tracing processors in contiguous
+         blocks of equal size. As the trajectories are traced, some parcels 
+         stop being traced (they hit a boundary or are flagged NoTrace), and
+         parcels flagged SyncTrace may not have started yet. The tracing load
+         can thus become quite uneven among the processors.
+         
+         This method sets whether and how often the advance() method should 
+         re-balance that load by migrating active parcels from the more heavily-loaded
+         tracing processors to the more lightly-loaded ones. Migrated parcels
+         keep their index within the Swarm, so that the get(), set(), parcel(), and
+         iterator index() methods continue to refer to the same parcels as before.
+         
+         This is a collective operation: all processors in the Swarm's
+         processor group must call it with the same value.
+         
+         \param every if > 0, then the load statistics are gathered and the parcels 
+                      are re-balanced every this-many calls to advance().
+                      If < 0, then load statistics are gathered every -every
+                      calls to advance(), but no parcels are migrated. 
+                      If 0 (the default), then neither is done.
+     */
+     void setRebalance( int every );
+     
+     /// returns how often the parcels are re-balanced
+     /*! This method returns the load-balancing setting.
+     
+         \return the number of advance() calls between re-balancings 
+                  (see setRebalance())
+     */
+     int getRebalance() const;
+     
+     /// returns the load imbalance from the most recent re-balancing step
+     /*! This method returns a statistic that measures how unevenly the 
+         active parcels were distributed among the tracing processors the last time
+         advance() gathered the load statistics: the largest per-processor number of active parcels,
+         divided by the mean number over all tracing processors. 
+         A perfectly balanced load yields 1.0. 
+         
+         The statistic is valid only on the root processor, and only if
+         load statistics are being gathered (see setRebalance()).
+         
+         \return the load imbalance ratio, or 0.0 if it is not available.
+     */
+     real loadImbalance() const;
+     
+     /// returns the number of active parcels on each processor from the most recent re-balancing step
+     /*! This method returns the numbers of active parcels that were being
+         handled by each processor in the Swarm's processor group the last time
+         advance() gathered the load statistics.  Met processors always have zero.
+         
+         The values are valid only on the root processor, and only if
+         load statistics are being gathered (see setRebalance()).
+
+         \return a vector of active parcel counts, indexed by processor ID.
+     */
+     const std::vector<int>& loads() const;
+     
+     /// turns on periodic spatial sorting of the parcels
+     /*! As parcels are advected, parcels that are stored next to each other
+         in the Swarm can end up far apart on the globe. Interpolating the 
+         meteorological fields to the parcels then visits the met grids in an essentially 
+         random order, which makes poor use of the processor's memory cache
+         (and produces randomly-ordered gridpoint requests for a remote met processor).
+         
+         This method sets how often the advance() method should re-order
+         the parcels' internal storage along a space-filling (Morton, or "Z-order") curve
+         in longitude, latitude, and vertical coordinate, so that parcels which are
+         close in space are also close in memory.  Only the internal storage is 
+         re-ordered: a permutation is kept so that the iterator, get(), set(), and 
+         parcel() methods still see the parcels in their original order.
+         
+         \param every if > 0, then the parcels are re-ordered every this-many
+                      calls to advance(). If <= 0 (the default), then the parcels
+                      are never re-ordered.
+     */
+     void setReorder( int every );
+     
+     /// returns how often the parcels are spatially sorted
+     /*! This method returns the spatial sorting setting.
+     
+         \return the number of advance() calls between re-orderings 
+                  (see setReorder())
+     */
+     int getReorder() const;
+
+     /// turns on spatial domain decomposition of the parcels
+     /*! Normally, each tracing processor handles a fixed range of parcel indices
+         (or, with setRebalance(), whichever parcels load-balancing gives it).
+         Since those parcels may be anywhere on the globe, every tracing processor
+         needs every part of every meteorological field.
+         
+         This method instead gives each tracing processor a region of the globe,
+         and the advance() method periodically migrates each active parcel to 
+         the processor whose region the parcel is in. A processor then needs
+         met data only for its own region plus a halo around it 
+         (see MetData::setHalo()). 
+         As with load-balancing, migrated parcels keep their index within the Swarm,
+         so the get(), set(), parcel(), and iterator index() methods, and hence 
+         the order of any output, are unaffected. A processor never gives up its
+         last parcel, however, so that it keeps taking part in the iteration loops.
+         
+         Parcels are migrated by location, not by load, so load-balancing 
+         migrations are not done while domain decomposition is on,
+         although load statistics are still gathered if setRebalance() asks for them.
+         
+         This is a collective operation: all processors in the Swarm's
+         processor group must call it with the same values.
+         
+         \param mode the kind of decomposition: SWARM_DOMAIN_BANDS for latitude bands 
+                     of equal area (so that the southernmost and northernmost are polar caps),
+                     SWARM_DOMAIN_TILES for longitude-latitude tiles (rows of equal area,
+                     each divided into columns of equal longitude width), or
+                     SWARM_DOMAIN_NONE (the default) for no spatial decomposition.
+         \param every the parcels are migrated to their domains every this-many
+                      calls to advance()
+     */
+     void setDomains( int mode, int every=1 );
+     
+     /// returns the kind of spatial domain decomposition in use
+     /*! This method returns the spatial domain decomposition setting.
+     
+         \return the kind of domain decomposition (see setDomains())
+     */
+     int getDomains() const;
+     
+     /// returns the processor whose spatial domain contains a location
+     /*! This method returns the ID of the tracing processor whose 
+         domain (see setDomains()) contains a given location. 
+         
+         \param lon the longitude
+         \param lat the latitude
+         \return the processor ID, or -1 if no spatial domain decomposition is in use
+     */
+     int domain( real lon, real lat ) const;
+
+     /// sets the number of threads with which each processor traces its parcels
+     /*! Normally, each tracing processor traces its parcels in a single thread, 
+         so that using all the cores of a multi-core node means running as many 
+         processors (in the sense of the ProcessGrp class) on the node. Each of those 
+         keeps its own copy of the meteorological data, and all of their traffic 
+         goes through the processor group.
+         
+         This method lets each tracing processor split its parcels instead among a pool
+         of threads that share its single met data source, its in-memory met data caches, 
+         and its integrator. One processor can then be run on each node (or socket),
+         and the processor group carries only the traffic between nodes.
+         
+         In the advance() method, each thread starts with an equal share of the blocks
+         of parcels to be traced. A thread that has finished its share takes over
+         half of the remaining blocks of the thread that has the most left to do
+         (i.e., "work stealing"), so that threads whose parcels need more met data reads or 
+         more integration substeps do not hold up the others.
+         
+         Threads are used only if gigatraj was configured with the --enable-threads option, 
+         and only if the met data source can be shared among threads (see MetData::threadSafe()) 
+         and has its own data (i.e., it is not a client of a dedicated met processor).
+         Otherwise, the parcels are traced by a single thread as usual.
+         
+         \param n the number of threads. Values less than 1 are taken to be 1.
+         \param blk the number of parcels in each block. If <= 0 (the default), then 
+                    the parcels are split into four blocks for each thread.
+     */
+     void setThreads( int n, int blk=0 );
+     
+     /// returns the number of threads with which each processor traces its parcels
+     /*! This method returns the number of threads set by setThreads().
+     
+         \return the number of threads
+     */
+     int getThreads() const;
+
+     /// returns the number of parcel migrations so far
+     /*! This method returns the total number of parcels that have
+         been moved from one processor to another by load-balancing 
+         or spatial domain decomposition.
+         
+         \return the number of migrated parcels
+     */
+     int migrations() const;
+     
      
      /// synchronizes the Swarm's processors
      /*! This method synchronizes the Swarm's processors.
@@ -660,6 +906,69 @@ class Swarm {
      */
      std::vector<int> pclends;
    
+     /// The processors that trace parcels
+     /*! This holds the (pgroup) IDs of all the parcel-tracing processors,
+         in ascending order.
+     */
+     std::vector<int> tracers;
+     
+     /// The owner of each parcel, once parcels have been migrated
+     /*! Once load-balancing has moved parcels between processors,
+         the pclstarts and pclends ranges no longer describe
+         which processor holds which parcel. This vector then holds
+         the (pgroup) ID of the processor that handles each parcel,
+         indexed by the parcel's global index.  It is empty until the first
+         migration.
+     */
+     std::vector<int> pclowners;
+     
+     /// The number of parcels held by each processor, once parcels have been migrated
+     std::vector<int> pclcounts;
+     
+     /// Maps a global parcel index to this processor's local parcel number
+     /*! This is used only once parcels have been migrated.
+     */
+     std::map<int,int> pcllocal;
+     
+     /// how often to re-balance the parcel load among processors
+     int rebal_every;
+     
+     /// number of calls to advance() since load-balancing was turned on
+     int rebal_count;
+     
+     /// the total number of parcels migrated
+     int rebal_moved;
+     
+     /// how often to sort the parcels spatially
+     int reorder_every;
+     
+     /// number of calls to advance() since spatial sorting was turned on
+     int reorder_count;
+     
+     /// the kind of spatial domain decomposition
+     int domain_mode;
+     
+     /// how often to migrate parcels to their spatial domains
+     int domain_every;
+     
+     /// number of calls to advance() since spatial domain decomposition was turned on
+     int domain_count;
+     
+     /// the number of rows of longitude-latitude tiles
+     int domain_rows;
+     
+     /// the number of threads with which to trace this processor's parcels
+     int nthreads;
+     
+     /// the number of parcels in each block traced by a thread (0 for automatic)
+     int threadblk;
+     
+     /// the number of active parcels on each processor, as of the last re-balancing step
+     std::vector<int> pclloads;
+     
+     /// the load imbalance ratio as of the last re-balancing step
+     real load_imbalance;
+     
 
      /// the starting parcel index for this process
      /*!
@@ -756,6 +1065,14 @@ class Swarm {
      run from zero to ( my_num_parcels - 1 ), not (num_parcels_total - 1 ).
      */
      int *ids;
+     
+     //! Global index number
+     /*!
+     The global (Swarm-wide) index of each parcel, indexed in the same way as
+     lons, lats, etc.  This is used only once parcels have been migrated among
+     processors by load-balancing.
+     */
+     int *gids;
 
      //! Navigation
      /*!   The planetary navigation object to be used for all parcels
@@ -783,11 +1100,120 @@ class Swarm {
      */    
      int belongs(const int n) const;
      
+     /// returns the storage location of a parcel
+     /*! This method returns the location in the internal parcel information arrays
+         (lons, lats, etc.) of a parcel that is handled by the current processor.
+         
+         \param n the global index of the parcel
+         
+         \return the location of the parcel in the arrays, or -1 if the parcel is not 
+                 handled by this processor.
+     */
+     int local_index( int n ) const;
+
+     /// gathers load statistics and re-balances the parcels
+     /*! This method is called by the tracing processors from advance().
+         It gathers the numbers of active parcels from all the tracing
+         processors, and optionally migrates parcels among them to 
+         even out the load.
+         
+         \param tyme the current model time
+         \param move if true, then parcels will be migrated as needed; otherwise,
+                      only the load statistics are gathered.
+     */
+     void balance( double tyme, bool move );
+     
+     /// migrates parcels among processors
+     /*! This method carries out a re-balancing plan, sending parcels from one
+         processor to another and updating everyone's notion of which processor
+         handles each parcel.
+         
+         \param nmoves the number of moves in the plan
+         \param moves an array of 3*nmoves ints: for each move, the sending
+                      processor, the receiving processor, and the number of parcels
+                      to be moved.
+         \param tyme the current model time
+         \param dests if not NULLPTR, an array giving the destination processor of each of
+                      this processor's local parcels (by position in the internal arrays),
+                      or -1 for parcels that stay. A sending processor then sends 
+                      the parcels bound for each receiving processor, instead of any
+                      active parcels.
+     */
+     void migrate( int nmoves, const int* moves, double tyme, const int* dests=NULLPTR );
+     
+     /// migrates parcels to the processors whose spatial domains they are in
+     /*! Each tracing processor tells the root processor how many of its
+         active parcels are bound for each of the other processors; the root processor
+         sends everyone the resulting plan, and the parcels are migrated.
+         
+         \param tyme the current model time
+     */
+     void decompose( double tyme );
+
+     /// traces a block of parcels
+     /*! This method advances a contiguous block of this processor's parcels
+         by one time step.
+         
+         \param i the location of the first parcel of the block in the internal arrays
+         \param nn the number of parcels in the block
+         \param traceflags an array of at least nn ints, used for workspace
+         \param tyme the model time at the start of the step
+         \param dt the time step
+     */
+     void traceBlock( int i, int nn, int* traceflags, double tyme, double dt );
+     
+     /// the work done by each thread of the pool
+     /*! This method is run by each thread of the pool set up by advance()
+         when setThreads() has been used. It traces its share of the 
+         blocks of parcels, and then steals from the other threads' shares.
+         
+         \param arg a pointer to the thread's work description
+         \return NULLPTR
+     */
+     static void* threadWork( void* arg );
+     
+     /// sorts parcels along a space-filling curve
+     /*! This method re-orders the first n locations of the internal parcel
+         information arrays so that the parcels are in Morton order
+         of their positions, adjusting the ids array so that 
+         the local parcel numbers still refer to the same parcels.
+         
+         \param n the number of array locations to be sorted
+     */
+     void reorder( int n );
+     
+     /// computes a parcel's position along a space-filling curve
+     /*! This method computes a Morton (or "Z-order") key by interleaving
+         the bits of the binned longitude, latitude, and vertical coordinate
+         of a parcel.
+         
+         \param lon the longitude of the parcel
+         \param lat the latitude of the parcel
+         \param z the vertical coordinate of the parcel
+         \param zmin the lowest vertical coordinate of all the parcels being sorted
+         \param zscale the factor that converts (z - zmin) to a number between 0 and 1
+         
+         \return the sort key
+     */
+     unsigned int sfckey( real lon, real lat, real z, real zmin, real zscale ) const;
+     
+     /// is a parcel actively being traced?
+     /*! This method determines whether a parcel is currently being traced
+         (as opposed to having hit a boundary, or having been flagged NoTrace,
+         or waiting for its time to start being traced).
+         
+         \param idx the location of the parcel in the internal parcel information arrays
+         \param tyme the current model time
+         
+         \return true if the parcel is active, false otherwise.
+     */
+     bool active( int idx, double tyme ) const;
+     
      /// universal constructor routine
      /*!
         This is an internal method used by all the constructors to initialize the Swarm.
      */
-     void setup( const Parcel &p, ProcessGrp* pgrp, int n, int r);
+     void setup( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s=1);
 
      /// makes an id string for a processor group
      /*! This method makes a string that can be used as a tag 
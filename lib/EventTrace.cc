@@ -0,0 +1,299 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "gigatraj/EventTrace.hh"
+#include "gigatraj/MetGridData.hh"
+#include "gigatraj/GridField.hh"
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+using namespace gigatraj;
+
+#ifdef USE_THREADS
+// serializes updates to the events and the byte count from multiple threads
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+bool EventTrace::on = false;
+ProcessGrp* EventTrace::grp = NULLPTR;
+std::string EventTrace::fname = "";
+double EventTrace::t0 = 0.0;
+std::vector<EventTrace::Event> EventTrace::events;
+int EventTrace::maxev = 0;
+long EventTrace::dropped = 0;
+long EventTrace::nbytes = 0;
+
+
+EventTrace::Span::Span()
+{
+    begin = 0.0;
+    bytes0 = 0;
+    if ( EventTrace::active() ) {
+       begin = Instrument::clock();
+       bytes0 = EventTrace::bytesSoFar();
+    }
+}
+
+
+void EventTrace::start( ProcessGrp* pgrp, const std::string& filename, int maxevents )
+{
+    grp = pgrp;
+    fname = filename;
+    maxev = maxevents;
+    dropped = 0;
+    nbytes = 0;
+    events.clear();
+    
+    // line up the starting times of all the processors
+    if ( grp != NULLPTR ) {
+       grp->sync();
+    }
+    t0 = Instrument::clock();
+    
+    on = true;
+}
+
+void EventTrace::add( const char* name, char phase, double begin, double end, int peer
+                    , const std::string& quantity, const std::string& time, long bytes )
+{
+    Event ev;
+    
+    ev.name = name;
+    ev.phase = phase;
+    ev.ts = begin - t0;
+    ev.dur = end - begin;
+    ev.peer = peer;
+    ev.quantity = quantity;
+    ev.time = time;
+    ev.bytes = bytes;
+    
+#ifdef USE_THREADS
+    pthread_mutex_lock( &trace_lock );
+#endif
+
+    if ( static_cast<int>(events.size()) >= maxev ) {
+       dropped++;
+    } else {
+       events.push_back( ev );
+    }
+
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &trace_lock );
+#endif
+}
+
+void EventTrace::addBytes( long n )
+{
+#ifdef USE_THREADS
+    pthread_mutex_lock( &trace_lock );
+#endif
+
+    nbytes += n;
+
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &trace_lock );
+#endif
+}
+
+long EventTrace::bytesSoFar()
+{
+    long result;
+    
+#ifdef USE_THREADS
+    pthread_mutex_lock( &trace_lock );
+#endif
+
+    result = nbytes;
+
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &trace_lock );
+#endif
+
+    return result;
+}
+
+void EventTrace::event( const char* name, const Span& span, int peer
+                      , const std::string& quantity, const std::string& time, long bytes )
+{
+    if ( on ) {
+       if ( bytes < 0 ) {
+          bytes = bytesSoFar() - span.bytes0;
+       }
+       add( name, 'X', span.begin, Instrument::clock(), peer, quantity, time, bytes );
+    }
+}
+
+void EventTrace::instant( const char* name, int peer
+                        , const std::string& quantity, const std::string& time, long bytes )
+{
+    double now;
+    
+    if ( on ) {
+       now = Instrument::clock();
+       add( name, 'i', now, now, peer, quantity, time, bytes );
+    }
+}
+
+const char* EventTrace::cmdName( int cmd )
+{
+    switch (cmd) {
+    case PGR_CMD_DONE:
+       return "PGR_CMD_DONE";
+    case PGR_CMD_STEP:
+       return "PGR_CMD_STEP";
+    case PGR_CMD_M2M:
+       return "PGR_CMD_M2M";
+    case PGR_CMD_M2D:
+       return "PGR_CMD_M2D";
+    case PGR_CMD_M3M:
+       return "PGR_CMD_M3M";
+    case PGR_CMD_M3D:
+       return "PGR_CMD_M3D";
+    case PGR_CMD_M3DV:
+       return "PGR_CMD_M3DV";
+    case PGR_CMD_M2DV:
+       return "PGR_CMD_M2DV";
+    case PGR_CMD_GDONE:
+       return "PGR_CMD_GDONE";
+    case PGR_CMD_GMETA:
+       return "PGR_CMD_GMETA";
+    case PGR_CMD_GDATA:
+       return "PGR_CMD_GDATA";
+    }
+    
+    return "PGR_CMD_unknown";
+}
+
+// escapes a string for use in JSON
+static std::string jsonString( const std::string& str )
+{
+    std::string result;
+    size_t i;
+    
+    result = "\"";
+    for ( i=0; i<str.size(); i++ ) {
+        if ( str[i] == '"' || str[i] == '\\' ) {
+           result.push_back( '\\' );
+        }
+        result.push_back( str[i] );
+    }
+    result.push_back( '"' );
+    
+    return result;
+}
+
+std::string EventTrace::format( int rank )
+{
+    std::ostringstream os;
+    size_t i;
+    
+    os << std::fixed << std::setprecision(3);
+    
+    // name this processor's track
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank 
+       << ",\"args\":{\"name\":\"rank " << rank;
+    if ( dropped > 0 ) {
+       os << " (" << dropped << " events not recorded)";
+    }
+    os << "\"}},\n";
+    os << "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":" << rank 
+       << ",\"args\":{\"sort_index\":" << rank << "}}";
+    
+    for ( i=0; i<events.size(); i++ ) {
+        const Event& ev = events[i];
+        
+        os << ",\n{\"name\":\"" << ev.name << "\",\"cat\":\"met\",\"ph\":\"" << ev.phase << "\"";
+        if ( ev.phase == 'i' ) {
+           os << ",\"s\":\"t\"";
+        }
+        os << ",\"pid\":" << rank << ",\"tid\":0"
+           << ",\"ts\":" << ev.ts*1.0e6;
+        if ( ev.phase == 'X' ) {
+           os << ",\"dur\":" << ev.dur*1.0e6;
+        }
+        os << ",\"args\":{\"rank\":" << rank;
+        if ( ev.peer >= 0 ) {
+           os << ",\"peer\":" << ev.peer;
+        }
+        if ( ev.quantity != "" ) {
+           os << ",\"quantity\":" << jsonString( ev.quantity );
+        }
+        if ( ev.time != "" ) {
+           os << ",\"time\":" << jsonString( ev.time );
+        }
+        if ( ev.bytes >= 0 ) {
+           os << ",\"bytes\":" << ev.bytes;
+        }
+        os << "}}";
+    }
+    
+    return os.str();
+}
+
+void EventTrace::finish()
+{
+    std::ofstream out;
+    std::string contents;
+    int nall;
+    int root;
+    int id;
+    
+    if ( fname == "" ) {
+       return;
+    }
+    
+    on = false;
+    
+    nall = 1;
+    root = 0;
+    if ( grp != NULLPTR ) {
+       nall = grp->size();
+       root = grp->root_id();
+    }
+    
+    if ( grp == NULLPTR || grp->id() == root ) {
+    
+       out.open( fname.c_str() );
+       out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+       for ( id=0; id<nall; id++ ) {
+           if ( id == root ) {
+              contents = format( id );
+           } else {
+              grp->receive_string( id, &contents, PGR_TAG_TRACE );
+           }
+           if ( id > 0 ) {
+              out << ",\n";
+           }
+           out << contents;
+       }
+       out << "\n]}\n";
+       out.close();
+    
+    } else {
+       
+       grp->send_string( root, format( grp->id() ), PGR_TAG_TRACE );
+    
+    }
+    
+    events.clear();
+    fname = "";
+    grp = NULLPTR;
+
+}
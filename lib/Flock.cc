@@ -19,9 +19,11 @@
 
 #include <stdlib.h>
 #include <iostream>
+#include <algorithm>
 
 #include "gigatraj/Flock.hh"
 #include "gigatraj/SerialGrp.hh"
+#include "gigatraj/Instrument.hh"
 
 using namespace gigatraj;
 
@@ -31,7 +33,6 @@ Flock::Flock( int n )
 {
 
    Parcel p;
-   int i;
    ProcessGrp* pg;
    
    if ( n >= 0 ) {
@@ -39,7 +40,7 @@ Flock::Flock( int n )
       // we will do serial processing
       pg = new SerialGrp();
    
-      this->setup(p,pg,n,0);
+      this->setup(p,pg,n,0,1);
 
    } else {
       throw (badparcelcount());
@@ -50,9 +51,8 @@ Flock::Flock( int n )
 
 
      
-Flock::Flock( ProcessGrp *pgrp, int n, int r)
+Flock::Flock( ProcessGrp *pgrp, int n, int r, int s)
 {
-   int i;
    Parcel p;
    ProcessGrp* pg;
    
@@ -67,7 +67,7 @@ Flock::Flock( ProcessGrp *pgrp, int n, int r)
          pg = new SerialGrp();
       }   
 
-      this->setup(p,pg,n,r);
+      this->setup(p,pg,n,r,s);
 
    } else {
       throw (badparcelcount());
@@ -79,7 +79,6 @@ Flock::Flock( ProcessGrp *pgrp, int n, int r)
 
 Flock::Flock( const Parcel &p, int n)
 {
-   int i;
    ProcessGrp* pg;
    
    if ( n >= 0 ) {
@@ -87,7 +86,7 @@ Flock::Flock( const Parcel &p, int n)
       // No processor group was given, so we will do serial processing
       pg = new SerialGrp();
    
-      this->setup(p,pg,n,0);
+      this->setup(p,pg,n,0,1);
 
    } else {
       throw (badparcelcount());
@@ -95,7 +94,7 @@ Flock::Flock( const Parcel &p, int n)
 
 };
 
-Flock::Flock( const Parcel &p, ProcessGrp* pgrp, int n, int r)
+Flock::Flock( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s)
 {
     ProcessGrp* pg;
    
@@ -108,7 +107,7 @@ Flock::Flock( const Parcel &p, ProcessGrp* pgrp, int n, int r)
        pg = new SerialGrp();
     }   
 
-    this->setup(p,pg,n,r);
+    this->setup(p,pg,n,r,s);
 }
 
 std::string Flock::make_proc_id ( const std::string& tag, int i ) const
@@ -146,7 +145,7 @@ std::string Flock::make_proc_id ( const std::string& tag, int i ) const
 }
 
 // this is an in11ternal function used by constructors to set up and initialize the Flock 
-void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
+void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s)
 {
    // the number of processors in this group
    int numprocs;
@@ -208,13 +207,38 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
    int my_root;
    // subprocessor id
    std::string subproctag;
+   // subgroup ranks of the met-handlers, if met requests are sharded
+   std::vector<int> shards;
 
 
    // grab the met data source from the Parcel
    metsrc = p.getMet();
 
+   lons = NULLPTR;
+   lats = NULLPTR;
+   zs = NULLPTR;
+   ts = NULLPTR;
+   tgs = NULLPTR;
+   flagsets = NULLPTR;
+   statuses = NULLPTR;
+   traceflags = NULLPTR;
+   gids = NULLPTR;
+   info_size = 0;
+   info_inc = 100;
+   my_num_parcels = 0;
+   my_parcel_start = -1;
+
+   // every processor, met-handler or not, keeps a sample parcel
+   // so that it has access to the met data source
+   sample_p = p.copy();
+
    blocksize = 0;
    
+   rebal_every = 0;
+   rebal_count = 0;
+   rebal_moved = 0;
+   load_imbalance = 0.0;
+   
    pgroup = pgrp;
       
    // how many processors do we have to work with?
@@ -261,29 +285,42 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
    //- std::cerr << "New Flock: r = " << r << std::endl;
    if ( r > 0 && numprocs > 1 ) {
    
+      // we need at least one met processor per (sub)group,
+      // and at least one tracing processor
+      if ( s < 1 ) {
+         s = 1;
+      }
+      if ( s > (numprocs - 1) ) {
+         s = numprocs - 1;
+      }
+   
       // Cap the number of tracing processors (approx. r) 
-      // at the number of total procrssors, minus one 
-      // for a met processor.
-      if ( r > (numprocs - 1) ) {
-         r = numprocs - 1;
+      // at the number of total procrssors, minus the 
+      // met processors.
+      if ( r > (numprocs - s) ) {
+         r = numprocs - s;
       }
    
       // At the Flock level, the pgroup is set to be a coordinator
       pgrp->setType( -1, ProcessGrp::PGrpRole_Coordinator);
 
+      // for EACH set of s met-handler processes, 
+      // we will set up one (sub)group of parcel-tracing processors
+      num_groups = numprocs / (r+s);
+      if ( num_groups < 1 ) {
+         num_groups = 1;
+      }
+
       // figure out how many processors to devote to met-handling
-      num_metprocs = numprocs / (r+1);
+      num_metprocs = num_groups * s;
 
       // how many processors are to be devoted to tracing parcels?
       num_traceprocs = numprocs - num_metprocs;
-   
-      // for EACH met-handler process, 
-      // we will set up one (sub)group of parcel-tracing processors
-      num_groups = num_metprocs ;
        
    } else {
       // every procesor will do its own met handling
       // so there will be just the one (sub)group of parcel-tracing processors
+      s = 0;
       num_metprocs = 0;
       num_traceprocs = numprocs;
       num_groups = 1;
@@ -298,9 +335,9 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
       normal_group_size = num_traceprocs / num_groups;
       // will there be any processors left over?
       extra_procs = num_traceprocs - normal_group_size * num_groups;
-      // add one for the met processors, since each (sub)group
-      // consists of one met-handler and one-or-more parcel-tracers
-      normal_group_size++;
+      // add the met processors, since each (sub)group
+      // consists of s met-handlers and one-or-more parcel-tracers
+      normal_group_size = normal_group_size + s;
       // what is the max size (number of procs) of one of our process-tracing (sub)groups?
       max_group_size = normal_group_size;
       if ( extra_procs > 0 ) {
@@ -455,16 +492,17 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           if ( num_metprocs > 0 ) {
              // the first (sub)group: the rank-1 processor is the met-handler,
              // so that the rank-0 processor (which is also the rank-o processor
-             // of the main group "pgroup") can remain a parcel-tracer
-             if ( my_proc_sub == 1 ) {
+             // of the main group "pgroup") can remain a parcel-tracer.
+             // (If the met requests are sharded, then ranks 1 through s are
+             // all met-handlers.)
+             if ( my_proc_sub >= 1 && my_proc_sub <= s ) {
                 new_proc_grp->setType( my_proc_sub, ProcessGrp::PGrpRole_MetReader);
                 my_num_parcels = 0;
                 my_parcel_start = -1;
                 is_met = 1;
                 // even though as a met-processor our official my_num_parcels is 0,
-                // we sneak one parcel in so that we have access to its met
+                // we still have the sample parcel so that we have access to its met
                 // data source, in case we need it.
-                parcels.push_back(p.copy());
              } else {
                 new_proc_grp->setType( my_proc_sub, ProcessGrp::PGrpRole_Tracer);
                 is_met = 0;
@@ -502,9 +540,10 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           // if we are not using met handlers, or
           // if the jth processors in this (sub)group is not a met-handler...
           if ( (num_metprocs == 0)
-            || (j!=1)  ) {
+            || (j < 1 || j > s)  ) {
             
             // ...then it must be a parcel-tracer
+            tracers.push_back( grp_proc_list[j] );
             
             // are there parcels left to be allocated?
             if ( parcels_left > 0 ) {
@@ -519,16 +558,23 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
                // are these *my* parcels?
                if ( pgroup->id() == grp_proc_list[j] ) {
                
+                  // allocate space for them
+                  grow( this_num_parcels );
+               
                   my_num_parcels = this_num_parcels;
                   my_parcel_start = this_parcel_start;
                
-                  // allocate space for them
-                  parcels.reserve(my_num_parcels);
-               
-                  // push the parcels in, for non-met-processing processors
+                  // fill in the parcels, for non-met-processing processors
                   // (the met processing case is handled above)
                   for (int ip=0; ip < my_num_parcels; ip++ ) {
-                      parcels.push_back( p.copy() );
+                      lons[ip] = p.lon;
+                      lats[ip] = p.lat;
+                      zs[ip]   = p.z;
+                      ts[ip]   = p.t;
+                      tgs[ip]  = p.tg;
+                      flagsets[ip] = p.flagset;
+                      statuses[ip] = p.statuses;
+                      gids[ip] = this_parcel_start + ip;
                   }
                }
                
@@ -569,6 +615,15 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           }
           
           metsrc->setPgroup( subgroups[i] , my_met );
+          
+          if ( s > 1 ) {
+             // spread the met requests across several met-handlers
+             shards.clear();
+             for ( int is=1; is <= s; is++ ) {
+                 shards.push_back( is );
+             }
+             metsrc->setMetShards( shards );
+          }
 
        }
          
@@ -586,7 +641,6 @@ void Flock::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
 
 Flock::~Flock()
 {
-   int i;
    std::vector<ProcessGrp*>::iterator pi;
    MetData *metdata;
 
@@ -595,7 +649,7 @@ Flock::~Flock()
    pgroup->sync();
    
    // unset the met process group for this processor
-   metdata = parcels[0]->getMet();
+   metdata = sample_p->getMet();
    metdata->setPgroup( NULLPTR, -1 );
 
    // destroy all sub-groups
@@ -605,15 +659,19 @@ Flock::~Flock()
    }
    
    // destroy all parcels
-   if ( my_num_parcels > 0 ) {
-      // parcel-tracer: destroy all parcels
-      for (i=0; i < my_num_parcels; i++ ) {
-          delete parcels[i];
-      }
-   } else {
-      // and even met-readers have a sample parcel
-      delete parcels[0];
+   if ( lons != NULLPTR ) {
+      delete[] gids;
+      delete[] traceflags;
+      delete[] statuses;
+      delete[] flagsets;
+      delete[] tgs;
+      delete[] ts;
+      delete[] zs;
+      delete[] lats;
+      delete[] lons;
    }
+   // and even met-readers have a sample parcel
+   delete sample_p;
 
    // destroy the process group
    delete pgroup;
@@ -632,6 +690,7 @@ Flock::iterator::iterator()
    // default constructor is a dummy that does nothing
    my_parcel = -1;
    my_flock = NULLPTR;
+   loaded = false;
 };
 
 Flock::iterator::iterator(int init, Flock *flk) 
@@ -642,9 +701,13 @@ Flock::iterator::iterator(int init, Flock *flk)
 void Flock::iterator::set(int init, Flock *flk)
 {
    my_flock = flk; 
+   loaded = false;
    if ( my_flock->my_num_parcels >= 0 ) {
       if ( init <  my_flock->my_num_parcels ) {
          my_parcel = init;
+         if ( init >= 0 ) {
+            load();
+         }
       } else {
          throw(badparcelindex());
       }      
@@ -654,14 +717,40 @@ void Flock::iterator::set(int init, Flock *flk)
 
 }
 
-Parcel& Flock::iterator::operator*() const 
+void Flock::iterator::load()
+{
+    pcl.lon = my_flock->lons[my_parcel];
+    pcl.lat = my_flock->lats[my_parcel];
+    pcl.z   = my_flock->zs[my_parcel];
+    pcl.t   = my_flock->ts[my_parcel];
+    pcl.tg  = my_flock->tgs[my_parcel];
+    pcl.flagset  = my_flock->flagsets[my_parcel];
+    pcl.statuses = my_flock->statuses[my_parcel];
+    loaded = true;
+}
+
+void Flock::iterator::store()
+{
+    if ( loaded && my_parcel >= 0 && my_parcel < my_flock->my_num_parcels ) {
+       my_flock->lons[my_parcel]     = pcl.lon;
+       my_flock->lats[my_parcel]     = pcl.lat;
+       my_flock->zs[my_parcel]       = pcl.z;
+       my_flock->ts[my_parcel]       = pcl.t;
+       my_flock->tgs[my_parcel]      = pcl.tg;
+       my_flock->flagsets[my_parcel] = pcl.flagset;
+       my_flock->statuses[my_parcel] = pcl.statuses;
+    }
+    loaded = false;
+}
+
+Parcel& Flock::iterator::operator*()  
 {
-    return *(my_flock->parcels[my_parcel]);
+    return pcl;
 };
 
-Parcel* Flock::iterator::operator->() const 
+Parcel* Flock::iterator::operator->() 
 {
-    return my_flock->parcels[my_parcel];
+    return &pcl;
 };
 
 bool Flock::iterator::operator==(const iterator& x) const 
@@ -677,8 +766,13 @@ bool Flock::iterator::operator!=(const iterator& x) const
 // postfix
 Flock::iterator& Flock::iterator::operator++(int n) 
 {
+    // before we move on, copy the iterator's Parcel back into the Flock
+    store();
+    
     my_parcel++;
-    if ( my_parcel >= my_flock->my_num_parcels ) {
+    if ( my_parcel < my_flock->my_num_parcels ) {
+       load();
+    } else {
        my_parcel = -1;
        my_flock->fin();
     }
@@ -688,8 +782,13 @@ Flock::iterator& Flock::iterator::operator++(int n)
 // prefix
 Flock::iterator& Flock::iterator::operator++() 
 {
+    // before we move on, copy the iterator's Parcel back into the Flock
+    store();
+    
     ++my_parcel;
-    if ( my_parcel >= my_flock->my_num_parcels ) {
+    if ( my_parcel < my_flock->my_num_parcels ) {
+       load();
+    } else {
        my_parcel = -1;
        my_flock->fin();
     }
@@ -703,7 +802,7 @@ int Flock::iterator::index() const
     if ( my_flock->my_num_parcels > 0 ) {
        if ( my_parcel >= 0 && my_parcel < my_flock->my_num_parcels ) {
        
-          result = my_flock->my_parcel_start + my_parcel;
+          result = my_flock->global_index( my_parcel );
 
        }
     }
@@ -711,6 +810,14 @@ int Flock::iterator::index() const
     return result;
 }
 
+void Flock::iterator::stop()
+{
+    store();
+    
+    my_parcel = -1;
+    my_flock->fin();
+}
+
 
 void Flock::debut()
 {
@@ -751,7 +858,7 @@ void Flock::debut()
        if ( is_met ) {
           //- std::cerr << "Flock::debut: [" << pgroup->id() << "/" << pgroup->group_id() 
           //- << "]:    I am Met-reader" << std::endl;        
-          met = parcels[0]->getMet();
+          met = sample_p->getMet();
           met->serveMet();
           //pgroup->sync("Flock::debut sync for met server, past serveMet");
           //pgroup->sync();
@@ -782,7 +889,7 @@ void Flock::fin()
         
         //- std::cerr << "Flock::fin: [" << pgroup->id() << "/" << pgroup->group_id() 
         //-  << "]: signaling " << my_met << std::endl;        
-        met = parcels[0]->getMet();
+        met = sample_p->getMet();
         met->signalMetDone();
         
         
@@ -833,7 +940,7 @@ void Flock::setNav( PlanetNav& newnav )
 {
 
     if ( num_parcels_total > 0 ) {
-       parcels[0]->setNav(newnav);
+       sample_p->setNav(newnav);
     } else {
        throw ( Flock :: badparcelcount() );
     };     
@@ -842,7 +949,7 @@ void Flock::setNav( PlanetNav& newnav )
 PlanetNav* Flock::getNav() 
 {
     if ( num_parcels_total > 0 ) {
-       return parcels[0]->getNav();
+       return sample_p->getNav();
     } else {
        throw ( Flock :: badparcelcount() );
     };     
@@ -852,7 +959,7 @@ PlanetNav* Flock::getNav()
 void Flock::setMet( MetData& newmet ) 
 {
     if ( num_parcels_total > 0 ) {
-       parcels[0]->setMet(newmet);
+       sample_p->setMet(newmet);
     } else {
        throw ( Flock :: badparcelcount() );
     };     
@@ -861,13 +968,90 @@ void Flock::setMet( MetData& newmet )
 MetData* Flock::getMet() 
 {
     if ( num_parcels_total > 0 ) {
-       return parcels[0]->getMet();
+       return sample_p->getMet();
     } else {
        throw ( Flock :: badparcelcount() );
     };     
 };
 
 
+void Flock::grow( int n )
+{
+     int to_spare;
+     unsigned int new_size;
+     real* new_lons;
+     real* new_lats;
+     real* new_zs;
+     double* new_ts;
+     double* new_tgs;
+     ParcelFlag* new_flagsets;
+     ParcelStatus* new_statuses;
+     int* new_traceflags;
+     int* new_gids;
+     
+     if ( n < 0 ) {
+        // we only grow. We never shrink.
+        return;
+     }
+     
+     to_spare = info_size - my_num_parcels;
+     
+     if ( n > to_spare ) {
+        // ok, we need to grow
+        
+        new_size = info_size + (n / info_inc + 1)*info_inc;
+     
+        new_lons = new real[new_size];
+        new_lats = new real[new_size];
+        new_zs   = new real[new_size];
+        new_ts   = new double[new_size];
+        new_tgs  = new double[new_size];
+        new_flagsets = new ParcelFlag[new_size];
+        new_statuses = new ParcelStatus[new_size];   
+        new_traceflags = new int[new_size];
+        new_gids = new int[new_size];
+        
+        if ( lons != NULLPTR ) {
+           
+           for ( int i=0; i < my_num_parcels; i++ ) {
+               new_lons[i] = lons[i];
+               new_lats[i] = lats[i];
+               new_zs[i]   = zs[i];
+               new_ts[i]   = ts[i];
+               new_tgs[i]  = tgs[i];
+               new_flagsets[i] = flagsets[i];
+               new_statuses[i] = statuses[i];
+               new_gids[i] = gids[i];
+           }
+           
+           delete[] gids;
+           delete[] traceflags;
+           delete[] statuses;
+           delete[] flagsets;
+           delete[] tgs;
+           delete[] ts;
+           delete[] zs;
+           delete[] lats;
+           delete[] lons;
+     
+        }
+        
+        lons = new_lons;
+        lats = new_lats;
+        zs = new_zs;
+        ts = new_ts;
+        tgs = new_tgs;
+        flagsets = new_flagsets;
+        statuses = new_statuses;
+        traceflags = new_traceflags;
+        gids = new_gids;
+        
+        info_size = new_size;
+        
+     }
+
+}
+
 // iterators: (must be forward-only!)
 //     on begin:
 //         sync all procs in group
@@ -885,6 +1069,34 @@ int Flock::size()
 
 };
 
+int Flock::global_index( int k ) const
+{
+    if ( pclowners.size() > 0 ) {
+       return gids[k];
+    }
+    
+    return my_parcel_start + k;
+}
+
+int Flock::local_index( int n ) const
+{
+    std::map<int,int>::const_iterator loc;
+    int result = -1;
+    
+    if ( pclowners.size() > 0 ) {
+       loc = pcllocal.find( n );
+       if ( loc != pcllocal.end() ) {
+          result = loc->second;
+       }
+    } else {
+       if ( n >= my_parcel_start && n < (my_parcel_start + my_num_parcels) ) {
+          result = n - my_parcel_start;
+       }
+    }
+    
+    return result;
+}
+
 int Flock::belongs( const int n ) const
 {
     int proc_idx;
@@ -896,6 +1108,11 @@ int Flock::belongs( const int n ) const
     if ( n < 0 || n >= num_parcels_total ) {
        throw (badparcelindex());
     }
+    
+    // have parcels been migrated among processors?
+    if ( pclowners.size() > 0 ) {
+       return pclowners[n];
+    }
        
     // which processor owns this parcel?
     proc_idx = 0;
@@ -916,8 +1133,8 @@ void Flock::set( const int n,  const Parcel& p, const int mode)
 {
    int idx;
    int proc_idx;
-   int my_parcel_end ;
    std::vector<int>::iterator pits, pite;
+   Parcel pcl;
 
    //- std::cerr << "Flock::set: entry for parcel " << n << std::endl;
    
@@ -934,31 +1151,43 @@ void Flock::set( const int n,  const Parcel& p, const int mode)
    // then if we are the root process, just return the parcel
    // but if we are not the root process, send/receive the parcel
 
-   my_parcel_end = my_parcel_start + my_num_parcels - 1;
-   //- std::cerr << "Flock::set: this processors handles parcels " 
-   //- << my_parcel_start << " through " << my_parcel_end << std::endl;
+   //- std::cerr << "Flock::set: this processors handles " 
+   //- << my_num_parcels << " parcels" << std::endl;
    //- std::cerr << "Flock::set: my root processor is " << pgroup->root_id() << std::endl; 
 
+   // index relative to the start of this processor's parcels
+   idx = local_index( n );
+   
    // does the requested parcel belong to this processor?   
-   if ( n >= my_parcel_start && n <= my_parcel_end ) {
+   if ( idx >= 0 ) {
       //- std::cerr << "Flock::set:    Parcel " << n << " is MY parcel! (" 
-      //- << my_parcel_start << "-" << my_parcel_end << ")" << std::endl;     
-      // index relative to the start of this processor's parcels
-      idx = n - my_parcel_start;
+      //- << idx << ")" << std::endl;     
       
       if ( pgroup->id() != 0 && mode == 0) {
          // we are not the root process, so we have
          // this parcel receive itself from the root
          //- std::cerr << "Flock::set:    about to receive" << std::endl;
-         parcels[idx]->receive(pgroup, 0);
+         pcl.receive(pgroup, 0);
          //- std::cerr << "Flock::set:    received" << std::endl;
+         lons[idx]      = pcl.lon;      
+         lats[idx]      = pcl.lat;      
+         zs[idx]        = pcl.z;        
+         ts[idx]        = pcl.t;        
+         tgs[idx]       = pcl.tg;       
+         flagsets[idx]  = pcl.flagset;  
+         statuses[idx]  = pcl.statuses; 
       } else {
-          // we are the root processor, and this is our parcel,
-          // OR mode!=0.  Either way, we want to use our local copy,
-          // so just set it here, after deleting the old parcel first.
-          delete parcels[idx];
+         // we are the root processor, and this is our parcel,
+         // OR mode!=0.  Either way, we want to use our local copy,
+         // so just set it here.
          //- std::cerr << "Flock::set:    about to copy" << std::endl;
-          parcels[idx] = p.copy();
+         lons[idx]      = p.lon;      
+         lats[idx]      = p.lat;      
+         zs[idx]        = p.z;        
+         ts[idx]        = p.t;        
+         tgs[idx]       = p.tg;       
+         flagsets[idx]  = p.flagset;  
+         statuses[idx]  = p.statuses; 
          //- std::cerr << "Flock::set:    copied" << std::endl;
       }
       
@@ -995,6 +1224,7 @@ Parcel* Flock::parcel( int n, int flag ) const
    int my_proc;
    int i;
    int valid_parcel = 0;
+   int idx;
    
    if ( pgroup->type() == ProcessGrp::PGrpRole_MetReader ) {
       return NULLPTR;
@@ -1014,7 +1244,16 @@ Parcel* Flock::parcel( int n, int flag ) const
    if ( my_proc == parcel_proc ) {
    
       // get it
-      p = parcels[ n - my_parcel_start ];
+      p = sample_p->copy();
+      idx = local_index( n );
+      p->lon = lons[idx];
+      p->lat = lats[idx];
+      p->z   = zs[idx];
+      p->t   = ts[idx];
+      p->tg  = tgs[idx];
+      p->flagset = flagsets[idx];
+      p->statuses = statuses[idx];
+      
       valid_parcel = 1;
 
       // If we are the root processor...
@@ -1042,9 +1281,9 @@ Parcel* Flock::parcel( int n, int flag ) const
    } else {
    
       // we do not own the parcel
-      // so create a new one by copying the first parcel
-      // that we own (so that the parcels really are all the same type)
-      p = (parcels[0])->copy();
+      // so create a new one by copying the sample parcel
+      // (so that the parcels really are all the same type)
+      p = sample_p->copy();
 
       
       // are we the root processor?
@@ -1091,19 +1330,22 @@ Parcel* Flock::parcel( int n, int flag ) const
 
 }
 
-Parcel& Flock::get( int n, int flag ) const
+Parcel Flock::get( int n, int flag ) const
 {
    Parcel* p;
+   Parcel pp;
    
    p = this->parcel(n, flag);
    if ( p != NULLPTR ) {
-      return *p;
+      pp = *p;
+      delete p;
+      return pp;
    } else {
       throw (badparcelindex());
    }
 }
 
-Parcel& Flock::operator[]( int n )
+Parcel Flock::operator[]( int n )
 {
    
    return this->get(n);
@@ -1118,38 +1360,77 @@ void Flock::add( const Parcel& p, const int mode )
     int num_p;
     int my_rank;
     Parcel* parcl;
+    int idx;
     std::vector<int>::iterator pits, pite;
    
     
     my_rank = pgroup->id();
 
-    // find the process (sub)group that has the fewest Parcels 
-    for ( proc_idx = 0;  proc_idx < pclstarts.size() ; proc_idx++ ) {        
-         num_p = pclends[proc_idx] - pclstarts[proc_idx] + 1;
-         if ( num_p > lowest_pop ) {
-            lowest_pop = num_p;
-            lowest_proc = proc_idx;
-         }
-    }
+    if ( pclowners.size() > 0 ) {
     
-    // found none? Throw an error.
-    if ( lowest_proc < 0 ) {
-       throw (badparcelindex());
-    }
+       // Parcels have been migrated among the processors, so the
+       // contiguous index ranges no longer apply. Simply give the 
+       // new parcel the next index, and hand it to the tracing processor 
+       // that has the fewest Parcels.
+       for ( size_t i=0; i < tracers.size(); i++ ) {
+           proc_idx = tracers[i];
+           if ( lowest_proc < 0 || pclcounts[proc_idx] < lowest_pop ) {
+              lowest_pop = pclcounts[proc_idx];
+              lowest_proc = proc_idx;
+           }
+       }
+       
+       // found none? Throw an error.
+       if ( lowest_proc < 0 ) {
+          throw (badparcelindex());
+       }
+       
+       pclowners.push_back( lowest_proc );
+       pclcounts[lowest_proc]++;
+       if ( my_rank == lowest_proc ) {
+          grow( 1 );
+          pcllocal[num_parcels_total] = my_num_parcels;
+          my_num_parcels++;
+       }
     
-    // increment the start and end parcel indices
-    // past this processor's
-    for ( int i=lowest_proc; i<pclstarts.size(); i++) {
-        if ( i > 0 && pclstarts[i] >= 0 ) {
-           pclstarts[i]++;
-        }
-        if ( pclends[i] >= 0 ) {
-           pclends[i]++;
-        }
-        if ( my_rank == i ) {
-           my_parcel_start = pclstarts[i];
-           my_num_parcels = pclends[i] - my_parcel_start + 1;
-        }
+    } else {
+
+       // find the parcel-tracing processor that has the fewest Parcels 
+       // (met-handling processors have no parcel range at all)
+       for ( proc_idx = 0;  proc_idx < pclstarts.size() ; proc_idx++ ) {        
+            if ( pclstarts[proc_idx] >= 0 ) {
+               num_p = pclends[proc_idx] - pclstarts[proc_idx] + 1;
+               if ( lowest_proc < 0 || num_p < lowest_pop ) {
+                  lowest_pop = num_p;
+                  lowest_proc = proc_idx;
+               }
+            }
+       }
+    
+       // found none? Throw an error.
+       if ( lowest_proc < 0 ) {
+          throw (badparcelindex());
+       }
+    
+       // grow the info arrays if we have to
+       if ( lowest_proc == my_rank ) {
+          grow( 1 );
+       }
+    
+       // the new parcel goes at the end of the chosen processor's range,
+       // so that range grows by one and every later range shifts up by one
+       for ( int i=lowest_proc; i<pclstarts.size(); i++) {
+           if ( pclstarts[i] >= 0 ) {
+              if ( i > lowest_proc ) {
+                 pclstarts[i]++;
+              }
+              pclends[i]++;
+              if ( my_rank == i ) {
+                 my_parcel_start = pclstarts[i];
+                 my_num_parcels = pclends[i] - my_parcel_start + 1;
+              }
+           }
+       }
     }
     // oh, and increment the total as well
     num_parcels_total++;
@@ -1165,8 +1446,19 @@ void Flock::add( const Parcel& p, const int mode )
           // receive the value from the root processor
           parcl->receive( pgroup, 0 );
        }
-       // add it to our local list
-       parcels.push_back( parcl );
+       
+       // add it to the end of our local list
+       idx = my_num_parcels - 1;
+       lons[idx]     = parcl->lon;
+       lats[idx]     = parcl->lat;
+       zs[idx]       = parcl->z;
+       ts[idx]       = parcl->t;
+       tgs[idx]      = parcl->tg;
+       flagsets[idx] = parcl->flagset;
+       statuses[idx] = parcl->statuses;
+       gids[idx]     = num_parcels_total - 1;
+       
+       delete parcl;
     
     } else {
        // not my parcel. 
@@ -1182,129 +1474,562 @@ void Flock::add( const Parcel& p, const int mode )
 
 int Flock::advance( double dt )
 {
-   /*
-    Flock::iterator pk;
-
-    pk = this->begin();
-    while ( pk != this->end() ) {
-       pk->advance(dt);
-       ++pk;
-    }
-    */
 
     int i;
+    int j;
+    int jj;
     MetData* met;
     double tyme;
+    double btyme;
+    int nn;
+    
+    GT_TIMER( advtimer, "Flock::advance" );
  
-    if ( parcels.size() > 0 ) {
+    if ( sample_p != NULLPTR ) {
        
-       met = parcels[0]->getMet();
+       met = sample_p->getMet();
        
        if ( is_met ) {
           //- std::cerr << "Flock::dadvance: [" << pgroup->id() << "/" << pgroup->group_id() 
           //- << "]:    I am Met-reader" << std::endl;        
-          met->serveMet();
+          met->serveMetStep();
        } else {
 
-          Parcel* p;
-       
           int blk = my_num_parcels;
           if ( blocksize > 0 && blocksize < blk ) {
              blk = blocksize;
           }
        
-          real* const lons = new real[blk];
-          real* const lats = new real[blk];
-          real* const zs = new real[blk];
-          ParcelFlag* const flags = new ParcelFlag[blk];
-          ParcelStatus* const statuses = new ParcelStatus[blk];
-          int* const traceflags = new int[blk];
-
-       
-          p = parcels[0];
-          tyme = p->t;
-          Integrator* integ = p->integrator();
-          PlanetNav* nav = p->getNav();
-
-          /*
-          for ( i=0; i < my_num_parcels; i++ ) {
-
-              p = parcels[i];              
+          GT_COUNT( "Flock::advance parcels", my_num_parcels );
           
-              p->advance( dt );
-              
+          Integrator* integ = sample_p->integrator();
+          PlanetNav* nav = sample_p->getNav();
+
+          // the model time is that of the parcels that are already being traced
+          tyme = 0.0;
+          if ( my_num_parcels > 0 ) {
+             tyme = ts[0];
+             for ( j=0; j < my_num_parcels; j++ ) {
+                 if ( ! ( flagsets[j] & (SyncTrace | NoTrace) )
+                   && ! ( statuses[j] & (HitBad | HitBdy) ) ) {
+                    tyme = ts[j];
+                    break;
+                 }
+             }
           }
-          */
           
+          // tell the met source where our parcels are, in case it serves sub-blocks
+          // or chooses its vertical levels
+          met->haloRegion( my_num_parcels, lons, lats, zs, dt, nav );
+          
+          // traceflags: 0 = trace, 1 = tracing failed, 2 = do not trace
           i=0;
           while ( i < my_num_parcels ) {
           
-              int jmax = i + blk;
+              int jmax = i + blk - 1;
               if ( jmax >= my_num_parcels ) {
                  jmax = my_num_parcels - 1;
               }   
               
-              int nn = jmax - i + 1;
+              nn = jmax - i + 1;
               
-              for ( int j = i; j <= jmax; j++ ) {
-
-                  p = parcels[j];              
-          
-                  lons[j] = p->lon;
-                  lats[j] = p->lat;
-                  zs[j] = p->z;
-                  flags[j] = p->flagset;
-                  statuses[j] = p->statuses;
+              for ( j = i; j <= jmax; j++ ) {
+                  jj = j - i;
                   
-                  traceflags[j] = 0;
+                  traceflags[jj] = 0;
                   
                   if ( ( statuses[j] & (HitBad | HitBdy) )
-                    || ( flags[j] & NoTrace ) 
-                    || ( (flags[j] & SyncTrace) && (p->t >= tyme) )
+                    || ( flagsets[j] & NoTrace ) 
+                    || ( (flagsets[j] & SyncTrace) && (ts[j] >= tyme) )
                   ) {
-                     traceflags[i] = 1;
+                     traceflags[jj] = 2;
                   }
               }
               
-              integ->go( nn, lons, lats, zs, traceflags, tyme, met, nav, dt ); 
-          
-              for ( int j = i; j <= jmax; j++ ) {
-
-                  p = parcels[j];           
+              // each block starts at the same time
+              btyme = tyme;
+              integ->go( nn, &(lons[i]), &(lats[i]), &(zs[i]), traceflags, btyme, met, nav, dt ); 
           
-                  p->lon = lons[j];
-                  p->lat = lats[j];
-                  p->z = zs[j];
-                  p->t = tyme;
+              for ( j = i; j <= jmax; j++ ) {
+                  jj = j - i;
                   
-                  if ( traceflags[j] ) {
-                     statuses[j] = statuses[j] | HitBad;
-                     flags[j] = flags[j] | NoTrace;
+                  if ( traceflags[jj] != 2 ) {
+                     ts[j] = btyme;
                   }
                   
-                  p->flagset = flags[j];
-                  p->statuses = statuses[j];
+                  if ( traceflags[jj] != 2 && ! met->inDomain( lons[j], lats[j], zs[j] ) ) {
+                     // the parcel has left the region covered by the met source
+                     statuses[j] = statuses[j] | HitBdy;
+                     flagsets[j] = flagsets[j] | NoTrace;
+                  } else if ( traceflags[jj] == 1 ) {
+                     statuses[j] = statuses[j] | HitBad;
+                     flagsets[j] = flagsets[j] | NoTrace;
+                  }
               }
               
               i = jmax + 1;
                   
           }
           
-          delete traceflags;
-          delete statuses;
-          delete flags;
-          delete zs;
-          delete lats;
-          delete lons;
-          
+          met->signalMetStep();
           
-          met->signalMetDone();
+          // gather the load statistics (and maybe re-balance) only every so often
+          if ( rebal_every != 0 ) {
+             rebal_count++;
+             if ( (rebal_count % abs(rebal_every)) == 0 ) {
+                balance( tyme + dt, ( rebal_every > 0 ) );
+             }
+          }
        }
     }
     
     return 0;
 }
 
+void Flock::setRebalance( int every )
+{
+    rebal_every = every;
+    rebal_count = 0;
+}
+
+int Flock::getRebalance() const
+{
+    return rebal_every;
+}
+
+real Flock::loadImbalance() const
+{
+    return load_imbalance;
+}
+
+const std::vector<int>& Flock::loads() const
+{
+    return pclloads;
+}
+
+int Flock::migrations() const
+{
+    return rebal_moved;
+}
+
+bool Flock::active( int idx, double tyme ) const
+{
+    if ( (flagsets[idx] & NoTrace) || (statuses[idx] & (HitBad | HitBdy)) ) {
+       return false;
+    }
+    if ( (flagsets[idx] & SyncTrace) && (ts[idx] >= tyme) ) {
+       return false;
+    }
+    
+    return true;
+}
+
+void Flock::balance( double tyme, bool move )
+{
+    int my_rank;
+    int root;
+    // the number of tracing processors
+    int ntracers;
+    // this processor's total and active parcel counts
+    int counts[2];
+    // the total number of active parcels
+    int total;
+    // the most active parcels held by one processor
+    int maxload;
+    // each tracer's total and active parcel counts, and target active count
+    std::vector<int> npcls;
+    std::vector<int> nactive;
+    std::vector<int> target;
+    // how many parcels each tracer can give away or take on
+    std::vector<int> surplus;
+    std::vector<int> deficit;
+    // the migration plan
+    std::vector<int> plan;
+    int nmoves;
+    int extra;
+    int id;
+    int ir;
+    int cnt;
+
+    my_rank = pgroup->id();
+    root = pgroup->root_id();
+    ntracers = tracers.size();
+
+    counts[0] = my_num_parcels;
+    counts[1] = 0;
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        if ( active( k, tyme ) ) {
+           counts[1]++;
+        }
+    }
+
+    nmoves = 0;
+    
+    if ( my_rank == root ) {
+    
+       // collect everyone's load
+       npcls.assign( ntracers, 0 );
+       nactive.assign( ntracers, 0 );
+       pclloads.assign( pgroup->size(), 0 );
+       total = 0;
+       maxload = 0;
+       for ( int it=0; it < ntracers; it++ ) {
+           if ( tracers[it] == my_rank ) {
+              npcls[it] = counts[0];
+              nactive[it] = counts[1];
+           } else {
+              int rcounts[2];
+              pgroup->receive_ints( tracers[it], 2, rcounts, PGR_TAG_FKLOAD );
+              npcls[it] = rcounts[0];
+              nactive[it] = rcounts[1];
+           }
+           pclloads[tracers[it]] = nactive[it];
+           total += nactive[it];
+           if ( nactive[it] > maxload ) {
+              maxload = nactive[it];
+           }
+       }
+       
+       load_imbalance = 1.0;
+       if ( total > 0 ) {
+          load_imbalance = static_cast<real>( maxload ) * ntracers / total;
+       }
+       //- std::cerr << "Flock::balance: load imbalance " << load_imbalance 
+       //-           << " (max " << maxload << ", total " << total << ")" << std::endl;
+       
+       if ( move ) {
+       
+          // each tracer should end up with about total/ntracers active parcels.
+          // The leftover parcels go to the tracers that are already the most heavily
+          // loaded, to minimize the number of parcels to be moved.
+          target.assign( ntracers, total / ntracers );
+          extra = total - ( total / ntracers ) * ntracers;
+          for ( int it=0; it < ntracers && extra > 0; it++ ) {
+              if ( nactive[it] > target[it] ) {
+                 target[it]++;
+                 extra--;
+              }
+          }
+          for ( int it=0; it < ntracers && extra > 0; it++ ) {
+              if ( nactive[it] == target[it] ) {
+                 target[it]++;
+                 extra--;
+              }
+          }
+          
+          surplus.assign( ntracers, 0 );
+          deficit.assign( ntracers, 0 );
+          for ( int it=0; it < ntracers; it++ ) {
+              if ( nactive[it] > target[it] ) {
+                 // every tracer must keep at least one parcel, 
+                 // so that it keeps taking part in the iteration loops
+                 surplus[it] = std::min( nactive[it] - target[it], npcls[it] - 1 );
+              } else {
+                 deficit[it] = target[it] - nactive[it];
+              }
+          }
+          
+          // match up the givers with the takers
+          id = 0;
+          ir = 0;
+          while ( id < ntracers && ir < ntracers ) {
+              if ( surplus[id] <= 0 ) {
+                 id++;
+              } else if ( deficit[ir] <= 0 ) {
+                 ir++;
+              } else {
+                 cnt = std::min( surplus[id], deficit[ir] );
+                 plan.push_back( tracers[id] );
+                 plan.push_back( tracers[ir] );
+                 plan.push_back( cnt );
+                 surplus[id] -= cnt;
+                 deficit[ir] -= cnt;
+              }
+          }
+          nmoves = plan.size() / 3;
+       
+          // tell everyone the plan
+          for ( int it=0; it < ntracers; it++ ) {
+              if ( tracers[it] != my_rank ) {
+                 pgroup->send_ints( tracers[it], 1, &nmoves, PGR_TAG_FKPLAN );
+                 if ( nmoves > 0 ) {
+                    pgroup->send_ints( tracers[it], nmoves*3, &(plan[0]), PGR_TAG_FKPLAN );
+                 }
+              }
+          }
+       }
+       
+    } else {
+    
+       pgroup->send_ints( root, 2, counts, PGR_TAG_FKLOAD );
+       
+       if ( move ) {
+          pgroup->receive_ints( root, 1, &nmoves, PGR_TAG_FKPLAN );
+          if ( nmoves > 0 ) {
+             plan.resize( nmoves*3 );
+             pgroup->receive_ints( root, nmoves*3, &(plan[0]), PGR_TAG_FKPLAN );
+          }
+       }
+    
+    }
+    
+    if ( nmoves > 0 ) {
+       migrate( nmoves, &(plan[0]), tyme );
+    }
+
+}
+
+void Flock::migrate( int nmoves, const int* moves, double tyme )
+{
+    int my_rank;
+    int root;
+    int from;
+    int to;
+    int cnt;
+    int nmoved;
+    int idx;
+    int ntotal;
+    int nrecv;
+    int nkeep;
+    // local parcel numbers of the active parcels, any of which may be given away
+    std::vector<int> givable;
+    // which local parcels have been given away
+    std::vector<bool> gone;
+    // the global indices of all parcels moved, in plan order
+    std::vector<int> moved;
+    // the contents of the parcels received from other processors
+    std::vector<int> rgids;
+    std::vector<real> rlocs;
+    std::vector<double> rtimes;
+    std::vector<int> rinfo;
+    // buffers for sending parcels
+    std::vector<int> sgids;
+    std::vector<real> slocs;
+    std::vector<double> stimes;
+    std::vector<int> sinfo;
+    // the new order of the local parcels: (global index, source)
+    std::vector< std::pair<int,int> > order;
+    
+    my_rank = pgroup->id();
+    root = pgroup->root_id();
+    
+    // Is this the first migration? Then we need to switch from 
+    // contiguous index ranges to explicit ownership tables
+    if ( pclowners.size() == 0 ) {
+       pclowners.assign( num_parcels_total, -1 );
+       pclcounts.assign( pgroup->size(), 0 );
+       for ( int ip=0; ip < static_cast<int>( pclstarts.size() ); ip++ ) {
+           if ( pclstarts[ip] >= 0 ) {
+              for ( int n=pclstarts[ip]; n <= pclends[ip]; n++ ) {
+                  pclowners[n] = ip;
+              }
+              pclcounts[ip] = pclends[ip] - pclstarts[ip] + 1;
+           }
+       }
+       // (add() may have shifted our index range since the Flock was set up)
+       for ( int k=0; k < my_num_parcels; k++ ) {
+           gids[k] = my_parcel_start + k;
+       }
+    }
+    
+    // we give away active parcels, starting from the end
+    for ( int k=my_num_parcels - 1; k >= 0; k-- ) {
+        if ( active( k, tyme ) ) {
+           givable.push_back( k );
+        }
+    }
+    gone.assign( my_num_parcels, false );
+    
+    // move the parcels.
+    // (Note that no processor both sends and receives parcels.)
+    nmoved = 0;
+    nrecv = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        from = moves[m*3];
+        to   = moves[m*3 + 1];
+        cnt  = moves[m*3 + 2];
+        
+        if ( from == my_rank ) {
+        
+           sgids.resize( cnt );
+           slocs.resize( cnt*3 );
+           stimes.resize( cnt*2 );
+           sinfo.resize( cnt*2 );
+           for ( int ic=0; ic < cnt; ic++ ) {
+               idx = givable[nmoved];
+               sgids[ic]        = gids[idx];
+               slocs[ic*3]      = lons[idx];
+               slocs[ic*3 + 1]  = lats[idx];
+               slocs[ic*3 + 2]  = zs[idx];
+               stimes[ic*2]     = ts[idx];
+               stimes[ic*2 + 1] = tgs[idx];
+               sinfo[ic*2]      = flagsets[idx];
+               sinfo[ic*2 + 1]  = statuses[idx];
+               gone[idx] = true;
+               moved.push_back( gids[idx] );
+               nmoved++;
+           }
+           pgroup->send_ints( to, cnt, &(sgids[0]), PGR_TAG_FKMOVE );
+           pgroup->send_reals( to, cnt*3, &(slocs[0]), PGR_TAG_FKMOVE );
+           pgroup->send_doubles( to, cnt*2, &(stimes[0]), PGR_TAG_FKMOVE );
+           pgroup->send_ints( to, cnt*2, &(sinfo[0]), PGR_TAG_FKMOVE );
+        
+        } else if ( to == my_rank ) {
+        
+           idx = nrecv;
+           nrecv += cnt;
+           rgids.resize( nrecv );
+           rlocs.resize( nrecv*3 );
+           rtimes.resize( nrecv*2 );
+           rinfo.resize( nrecv*2 );
+           pgroup->receive_ints( from, cnt, &(rgids[idx]), PGR_TAG_FKMOVE );
+           pgroup->receive_reals( from, cnt*3, &(rlocs[idx*3]), PGR_TAG_FKMOVE );
+           pgroup->receive_doubles( from, cnt*2, &(rtimes[idx*2]), PGR_TAG_FKMOVE );
+           pgroup->receive_ints( from, cnt*2, &(rinfo[idx*2]), PGR_TAG_FKMOVE );
+        
+        }
+    }
+    
+    // Now make sure everyone knows which parcels went where.
+    // The givers tell the root processor, and the root processor tells everyone.
+    ntotal = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        ntotal += moves[m*3 + 2];
+    }
+    if ( my_rank == root ) {
+       std::vector<int> all_moved( ntotal );
+       
+       idx = 0;
+       nmoved = 0;
+       for ( int m=0; m < nmoves; m++ ) {
+           from = moves[m*3];
+           cnt  = moves[m*3 + 2];
+           if ( from == my_rank ) {
+              for ( int ic=0; ic < cnt; ic++ ) {
+                  all_moved[idx + ic] = moved[nmoved + ic];
+              }
+              nmoved += cnt;
+           } else {
+              pgroup->receive_ints( from, cnt, &(all_moved[idx]), PGR_TAG_FKOWNR );
+           }
+           idx += cnt;
+       }
+       for ( size_t it=0; it < tracers.size(); it++ ) {
+           if ( tracers[it] != my_rank ) {
+              pgroup->send_ints( tracers[it], ntotal, &(all_moved[0]), PGR_TAG_FKOWNR );
+           }
+       }
+       moved = all_moved;
+    } else {
+       nmoved = 0;
+       for ( int m=0; m < nmoves; m++ ) {
+           if ( moves[m*3] == my_rank ) {
+              cnt = moves[m*3 + 2];
+              pgroup->send_ints( root, cnt, &(moved[nmoved]), PGR_TAG_FKOWNR );
+              nmoved += cnt;
+           }
+       }
+       moved.resize( ntotal );
+       pgroup->receive_ints( root, ntotal, &(moved[0]), PGR_TAG_FKOWNR );
+    }
+    
+    idx = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        from = moves[m*3];
+        to   = moves[m*3 + 1];
+        cnt  = moves[m*3 + 2];
+        for ( int ic=0; ic < cnt; ic++ ) {
+            pclowners[moved[idx]] = to;
+            idx++;
+        }
+        pclcounts[from] -= cnt;
+        pclcounts[to] += cnt;
+    }
+    rebal_moved += ntotal;
+    
+    // rebuild the local parcel arrays, ordered by global index.
+    // Sources >= 0 are current array locations; sources < 0 are 
+    // (-1 - n), where n indexes the parcels just received.
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        if ( ! gone[k] ) {
+           order.push_back( std::pair<int,int>( gids[k], k ) );
+        }
+    }
+    for ( int k=0; k < nrecv; k++ ) {
+        order.push_back( std::pair<int,int>( rgids[k], -1 - k ) );
+    }
+    std::sort( order.begin(), order.end() );
+    nkeep = order.size();
+    
+    if ( nrecv > 0 || nmoved > 0 ) {
+    
+       real* const tlons = new real[nkeep];
+       real* const tlats = new real[nkeep];
+       real* const tzs = new real[nkeep];
+       double* const tts = new double[nkeep];
+       double* const ttgs = new double[nkeep];
+       ParcelFlag* const tflags = new ParcelFlag[nkeep];
+       ParcelStatus* const tstats = new ParcelStatus[nkeep];
+       
+       for ( int k=0; k < nkeep; k++ ) {
+           idx = order[k].second;
+           if ( idx >= 0 ) {
+              tlons[k]  = lons[idx];
+              tlats[k]  = lats[idx];
+              tzs[k]    = zs[idx];
+              tts[k]    = ts[idx];
+              ttgs[k]   = tgs[idx];
+              tflags[k] = flagsets[idx];
+              tstats[k] = statuses[idx];
+           } else {
+              idx = -1 - idx;
+              tlons[k]  = rlocs[idx*3];
+              tlats[k]  = rlocs[idx*3 + 1];
+              tzs[k]    = rlocs[idx*3 + 2];
+              tts[k]    = rtimes[idx*2];
+              ttgs[k]   = rtimes[idx*2 + 1];
+              tflags[k] = rinfo[idx*2];
+              tstats[k] = rinfo[idx*2 + 1];
+           }
+       }
+       
+       // (nothing needs to be copied over if the arrays have to grow)
+       my_num_parcels = 0;
+       grow( nkeep );
+       
+       pcllocal.clear();
+       for ( int k=0; k < nkeep; k++ ) {
+           lons[k]     = tlons[k];
+           lats[k]     = tlats[k];
+           zs[k]       = tzs[k];
+           ts[k]       = tts[k];
+           tgs[k]      = ttgs[k];
+           flagsets[k] = tflags[k];
+           statuses[k] = tstats[k];
+           gids[k]     = order[k].first;
+           pcllocal[gids[k]] = k;
+       }
+       my_num_parcels = nkeep;
+       
+       delete[] tstats;
+       delete[] tflags;
+       delete[] ttgs;
+       delete[] tts;
+       delete[] tzs;
+       delete[] tlats;
+       delete[] tlons;
+       
+    } else if ( pcllocal.size() == 0 ) {
+    
+       // not involved in the moves, but we still need the index map
+       for ( int k=0; k < my_num_parcels; k++ ) {
+           pcllocal[gids[k]] = k;
+       }
+    
+    }
+
+}
+
 void Flock::sync()
 {
    if ( pgroup != NULLPTR ) {
@@ -1321,8 +2046,8 @@ void Flock::sync(const std::string msg)
 
 void Flock::metDelay() 
 {
-     if ( parcels.size() > 0 ) {
-        ((parcels[0])->getMet())->delay();
+     if ( sample_p != NULLPTR ) {
+        (sample_p->getMet())->delay();
      }
 }
 
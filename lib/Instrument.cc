@@ -0,0 +1,423 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include <sys/time.h>
+#include <iomanip>
+#include <map>
+
+#include "gigatraj/Instrument.hh"
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+using namespace gigatraj;
+
+#ifdef USE_THREADS
+// serializes changes to the process-wide table and to the list of per-thread tables
+static pthread_mutex_t instrument_lock = PTHREAD_MUTEX_INITIALIZER;
+// finds each thread's own table
+static pthread_key_t instrument_key;
+static pthread_once_t instrument_once = PTHREAD_ONCE_INIT;
+#endif
+
+
+Instrument::Timer::Timer( int which ) 
+{
+    stat = which;
+    running = true;
+    start = Instrument::clock();
+}
+
+Instrument::Timer::~Timer()
+{
+    stop();
+}
+
+void Instrument::Timer::stop()
+{
+    if ( running ) {
+       Instrument::record( stat, Instrument::clock() - start );
+       running = false;
+    }
+}
+
+
+std::vector<Instrument::Stat>& Instrument::stats()
+{
+    // (constructed on first use, so that statistics may be recorded
+    // during static initialization elsewhere)
+    static std::vector<Stat> table;
+    
+    return table;
+}
+
+std::vector<Instrument::Stat>& Instrument::local()
+{
+#ifdef USE_THREADS
+    std::vector<Stat>* table;
+    
+    pthread_once( &instrument_once, makeKey );
+    
+    table = static_cast<std::vector<Stat>*>( pthread_getspecific( instrument_key ) );
+    if ( table == NULLPTR ) {
+       table = new std::vector<Stat>;
+       pthread_setspecific( instrument_key, table );
+       pthread_mutex_lock( &instrument_lock );
+       tables().push_back( table );
+       pthread_mutex_unlock( &instrument_lock );
+    }
+    
+    return *table;
+#else
+    return stats();
+#endif
+}
+
+std::vector< std::vector<Instrument::Stat>* >& Instrument::tables()
+{
+    static std::vector< std::vector<Stat>* > all;
+    
+    return all;
+}
+
+void Instrument::makeKey()
+{
+#ifdef USE_THREADS
+    pthread_key_create( &instrument_key, retire );
+#endif
+}
+
+void Instrument::retire( void* table )
+{
+#ifdef USE_THREADS
+    std::vector<Stat>* mine;
+    std::vector< std::vector<Stat>* >& all = tables();
+    size_t i;
+    
+    mine = static_cast<std::vector<Stat>*>( table );
+    
+    pthread_mutex_lock( &instrument_lock );
+    
+    std::vector<Stat>& totals = stats();
+    for ( i=0; i<mine->size(); i++ ) {
+        merge( totals[i], (*mine)[i] );
+    }
+    for ( i=0; i<all.size(); i++ ) {
+        if ( all[i] == mine ) {
+           all.erase( all.begin() + i );
+           break;
+        }
+    }
+    
+    pthread_mutex_unlock( &instrument_lock );
+    
+    delete mine;
+#endif
+}
+
+std::vector<Instrument::Stat> Instrument::combined()
+{
+    std::vector<Stat> result;
+#ifdef USE_THREADS
+    std::vector< std::vector<Stat>* >& all = tables();
+    size_t i;
+    size_t j;
+    
+    pthread_mutex_lock( &instrument_lock );
+    
+    result = stats();
+    for ( j=0; j<all.size(); j++ ) {
+        for ( i=0; i<all[j]->size(); i++ ) {
+            merge( result[i], (*all[j])[i] );
+        }
+    }
+    
+    pthread_mutex_unlock( &instrument_lock );
+#else
+    result = stats();
+#endif
+
+    return result;
+}
+
+void Instrument::clearStat( Stat& st )
+{
+    st.n = 0.0;
+    st.sum = 0.0;
+    st.min = 0.0;
+    st.max = 0.0;
+}
+
+void Instrument::merge( Stat& into, const Stat& from )
+{
+    if ( from.n <= 0.0 ) {
+       return;
+    }
+    if ( into.n <= 0.0 || from.min < into.min ) {
+       into.min = from.min;
+    }
+    if ( into.n <= 0.0 || from.max > into.max ) {
+       into.max = from.max;
+    }
+    into.n += from.n;
+    into.sum += from.sum;
+}
+
+int Instrument::slot( const std::string& name, Kind kind )
+{
+    std::vector<Stat>& table = stats();
+    Stat st;
+    size_t i;
+    int result;
+    
+#ifdef USE_THREADS
+    pthread_mutex_lock( &instrument_lock );
+#endif
+    
+    for ( i=0; i<table.size(); i++ ) {
+        if ( table[i].name == name ) {
+           break;
+        }
+    }
+    
+    if ( i >= table.size() ) {
+       st.name = name;
+       st.kind = kind;
+       clearStat( st );
+       table.push_back( st );
+    }
+    result = i;
+    
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &instrument_lock );
+#endif
+    
+    return result;
+}
+
+void Instrument::record( int which, double value )
+{
+    std::vector<Stat>& table = local();
+    
+#ifdef USE_THREADS
+    if ( which >= static_cast<int>( table.size() ) ) {
+       // the first event of this statistic in this thread:
+       // get the names of any statistics created since the last one
+       pthread_mutex_lock( &instrument_lock );
+       std::vector<Stat>& names = stats();
+       for ( size_t i=table.size(); i<names.size(); i++ ) {
+           table.push_back( names[i] );
+           clearStat( table.back() );
+       }
+       pthread_mutex_unlock( &instrument_lock );
+    }
+#endif
+
+    Stat& st = table[which];
+    
+    if ( st.n == 0.0 || value < st.min ) {
+       st.min = value;
+    }
+    if ( st.n == 0.0 || value > st.max ) {
+       st.max = value;
+    }
+    st.n += 1.0;
+    st.sum += value;
+}
+
+double Instrument::clock()
+{
+    struct timeval tv;
+    
+    gettimeofday( &tv, NULLPTR );
+    
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec)*1.0e-6;
+}
+
+void Instrument::reset()
+{
+    std::vector<Stat>& table = stats();
+    size_t i;
+#ifdef USE_THREADS
+    std::vector< std::vector<Stat>* >& all = tables();
+    size_t j;
+    
+    pthread_mutex_lock( &instrument_lock );
+    for ( j=0; j<all.size(); j++ ) {
+        for ( i=0; i<all[j]->size(); i++ ) {
+            clearStat( (*all[j])[i] );
+        }
+    }
+#endif
+    
+    for ( i=0; i<table.size(); i++ ) {
+        clearStat( table[i] );
+    }
+    
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &instrument_lock );
+#endif
+}
+
+bool Instrument::enabled()
+{
+#ifdef USE_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Instrument::report( ProcessGrp* pgrp, std::ostream& os, const std::string& title, bool clear )
+{
+    // the statistics on this processor, summed over its threads
+    const std::vector<Stat> table = combined();
+    // the statistics summed over all processors
+    std::vector<Stat> totals;
+    // the number of processors that recorded each statistic
+    std::vector<int> nprocs;
+    // the largest per-processor total of each statistic
+    std::vector<double> maxproc;
+    // where each statistic is in totals
+    std::map<std::string, size_t> where;
+    std::map<std::string, size_t>::iterator wi;
+    Stat st;
+    std::string name;
+    double vals[5];
+    int nall;
+    int root;
+    int nstats;
+    int id;
+    int i;
+    size_t k;
+    
+    if ( ! enabled() ) {
+       return;
+    }
+    
+    nall = 1;
+    root = 0;
+    if ( pgrp != NULLPTR ) {
+       nall = pgrp->size();
+       root = pgrp->root_id();
+    }
+    
+    if ( pgrp == NULLPTR || pgrp->id() == root ) {
+    
+       for ( id=0; id<nall; id++ ) {
+       
+           if ( id == root ) {
+              nstats = table.size();
+           } else {
+              pgrp->receive_ints( id, 1, &nstats, PGR_TAG_INSTNUM );
+           }
+           
+           for ( i=0; i<nstats; i++ ) {
+               if ( id == root ) {
+                  st = table[i];
+               } else {
+                  pgrp->receive_string( id, &name, PGR_TAG_INSTNAME );
+                  pgrp->receive_doubles( id, 5, vals, PGR_TAG_INSTVALS );
+                  st.name = name;
+                  st.kind = ( vals[0] == 0.0 ) ? Timing : Count;
+                  st.n = vals[1];
+                  st.sum = vals[2];
+                  st.min = vals[3];
+                  st.max = vals[4];
+               }
+               if ( st.n <= 0.0 ) {
+                  continue;
+               }
+               
+               wi = where.find( st.name );
+               if ( wi == where.end() ) {
+                  where[st.name] = totals.size();
+                  totals.push_back( st );
+                  nprocs.push_back( 1 );
+                  maxproc.push_back( st.sum );
+               } else {
+                  k = (*wi).second;
+                  merge( totals[k], st );
+                  nprocs[k]++;
+                  if ( st.sum > maxproc[k] ) {
+                     maxproc[k] = st.sum;
+                  }
+               }
+           }
+       
+       }
+    
+       printTable( os, title, totals, nprocs, maxproc, nall );
+       
+    } else {
+    
+       nstats = table.size();
+       pgrp->send_ints( root, 1, &nstats, PGR_TAG_INSTNUM );
+       for ( i=0; i<nstats; i++ ) {
+           vals[0] = ( table[i].kind == Timing ) ? 0.0 : 1.0;
+           vals[1] = table[i].n;
+           vals[2] = table[i].sum;
+           vals[3] = table[i].min;
+           vals[4] = table[i].max;
+           pgrp->send_string( root, table[i].name, PGR_TAG_INSTNAME );
+           pgrp->send_doubles( root, 5, vals, PGR_TAG_INSTVALS );
+       }
+    
+    }
+    
+    if ( clear ) {
+       reset();
+    }
+
+}
+
+void Instrument::printTable( std::ostream& os, const std::string& title, const std::vector<Stat>& totals
+                           , const std::vector<int>& nprocs, const std::vector<double>& maxproc, int nall )
+{
+    size_t k;
+    double mean;
+    
+    os << "# Instrumentation summary";
+    if ( title != "" ) {
+       os << ": " << title;
+    }
+    os << " (" << nall << " processors; times in seconds)" << std::endl;
+    os << "# " << std::left << std::setw(50) << "statistic" << std::right
+       << std::setw(6) << "kind"
+       << std::setw(6) << "procs"
+       << std::setw(12) << "events"
+       << std::setw(13) << "total"
+       << std::setw(13) << "mean"
+       << std::setw(13) << "min"
+       << std::setw(13) << "max"
+       << std::setw(10) << "imbal"
+       << std::endl;
+    for ( k=0; k<totals.size(); k++ ) {
+        // the mean total per reporting processor
+        mean = totals[k].sum/nprocs[k];
+        os << "  " << std::left << std::setw(50) << totals[k].name << std::right
+           << std::setw(6) << ( ( totals[k].kind == Timing ) ? "time" : "count" )
+           << std::setw(6) << nprocs[k]
+           << std::setw(12) << static_cast<long>( totals[k].n )
+           << std::setprecision(5)
+           << std::setw(13) << totals[k].sum
+           << std::setw(13) << totals[k].sum/totals[k].n
+           << std::setw(13) << totals[k].min
+           << std::setw(13) << totals[k].max
+           << std::setw(10) << std::setprecision(3) << ( ( mean > 0.0 ) ? maxproc[k]/mean : 1.0 )
+           << std::endl;
+    }
+    os << std::setprecision(6);
+
+}
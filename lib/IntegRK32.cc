@@ -0,0 +1,477 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include "gigatraj/IntegRK32.hh"
+
+using namespace gigatraj;
+
+const std::string IntegRK32::id = "IntegRK32";
+
+
+IntegRK32 :: IntegRK32( real tolerance, int maxlevel )
+{
+    // conformal adjustments are not used
+    confml = 0;
+    
+    tol = tolerance;
+    maxLevel( maxlevel );
+    
+    resetStats();
+    
+    scratch.nwork = 0;
+}
+
+IntegRK32 :: ~IntegRK32()
+{
+    for ( size_t i=0; i < tscratch.size(); i++ ) {
+        delete tscratch[i];
+    }
+}
+
+void IntegRK32 :: setThreads( int n )
+{
+    // thread 0 uses our own scratch space
+    while ( static_cast<int>( tscratch.size() ) < n - 1 ) {
+        tscratch.push_back( new Scratch() );
+        tscratch.back()->nwork = 0;
+    }
+}
+
+IntegRK32::Scratch* IntegRK32 :: threadScratch()
+{
+    int i;
+    
+    i = MetData::thread();
+    if ( i <= 0 || i > static_cast<int>( tscratch.size() ) ) {
+       return &scratch;
+    }
+    
+    return tscratch[i-1];
+}
+
+void IntegRK32 :: tolerance( real tolerance )
+{
+    tol = tolerance;
+}
+
+real IntegRK32 :: tolerance() const
+{
+    return tol;
+}
+
+void IntegRK32 :: maxLevel( int maxlevel )
+{
+    maxlev = maxlevel;
+    if ( maxlev < 0 ) {
+       maxlev = 0;
+    }
+    if ( maxlev > 30 ) {
+       maxlev = 30;
+    }
+}
+
+int IntegRK32 :: maxLevel() const
+{
+    return maxlev;
+}
+
+double IntegRK32 :: meanSubsteps() const
+{
+    double result;
+    
+    result = 0.0;
+    if ( nparcelsteps > 0 ) {
+       result = nsub/nparcelsteps;
+    }
+    
+    return result;
+}
+
+double IntegRK32 :: meanRejects() const
+{
+    double result;
+    
+    result = 0.0;
+    if ( nparcelsteps > 0 ) {
+       result = nrej/nparcelsteps;
+    }
+    
+    return result;
+}
+
+void IntegRK32 :: resetStats()
+{
+    nsub = 0.0;
+    nrej = 0.0;
+    nparcelsteps = 0.0;
+}
+
+void IntegRK32 :: go( real &lon, real &lat, real &z, double &t, MetData *metsrc, PlanetNav *nav, double dt0 )
+{
+    int flags;
+
+    
+    flags = 0;
+    
+    go( 1, &lon, &lat, &z, &flags, t, metsrc, nav, dt0 );
+    
+
+}
+
+void IntegRK32 :: go( int n, real *lons, real *lats, real *zs, int *flags, double &t, MetData *metsrc, PlanetNav *nav, double dt0 )
+{
+    // delta time in seconds
+    double dt;
+    // the substep length, in seconds and in internal model time units
+    double h, hd;
+    // the time at the start of a substep
+    double ts;
+    // progress through the time step, in units of the smallest possible substep
+    long full;
+    long pmin;
+    // Cartesian velocity components, in radians/s
+    real vx, vy, vz;
+    // a weighted sum of vertical velocities
+    real ww;
+    real ex, ey, ez, err;
+    real r, rr;
+    std::string dyt;
+    int debug;
+    int i, j;
+    int ii;
+    int lev;
+    int nb;
+    int nleft;
+    int nuse;
+    // accepted and rejected substeps in this call
+    double bsub, brej;
+    Scratch* sc;
+    
+    debug = metsrc->dbug;
+    bsub = 0.0;
+    brej = 0.0;
+
+    // get the planetary radius (in km)
+    r = planetRadius( nav );
+    // converts m/s to radians/s on the unit sphere
+    rr = 1.0/(r*1000.0);
+    
+    // convert days to seconds
+    dt = dt0 * 86400.0;
+    
+    full = 1L << maxlev;
+    
+    // get the scratch space, growing it if this call has more parcels than any before
+    // (each thread of a pool has its own)
+    sc = threadScratch();
+    if ( n > sc->nwork || sc->nwork == 0 ) {
+       sc->nwork = ( n > 0 ) ? n : 1;
+       sc->iwork.resize( 4*sc->nwork );
+       sc->lwork.resize( sc->nwork );
+       sc->work.resize( 28*sc->nwork );
+    }
+    
+    int*  const iused = &(sc->iwork[0]);
+    // the substep level and progress of each parcel
+    int*  const levs = iused + n;
+    long* const prog = &(sc->lwork[0]);
+
+    // the current positions, as unit vectors, lon/lat, and vertical coordinates
+    real* const px = &(sc->work[0]);
+    real* const py = px + n;
+    real* const pz = py + n;
+    real* const plons = pz + n;
+    real* const plats = plons + n;
+    real* const pzs   = plats + n;
+    
+    // the velocities at the current positions, if known
+    int*  const k1ok = levs + n;
+    real* const k1x = pzs + n;
+    real* const k1y = k1x + n;
+    real* const k1z = k1y + n;
+    real* const k1w = k1z + n;
+    
+    // the other stage velocities
+    real* const k2x = k1w + n;
+    real* const k2y = k2x + n;
+    real* const k2z = k2y + n;
+    real* const k2w = k2z + n;
+    real* const k3x = k2w + n;
+    real* const k3y = k3x + n;
+    real* const k3z = k3y + n;
+    real* const k3w = k3z + n;
+    
+    // the third-order end points of the substeps
+    real* const nx = k3w + n;
+    real* const ny = nx + n;
+    real* const nz = ny + n;
+    real* const nzs = nz + n;
+    
+    // the parcels being advanced together, and their stage positions and winds
+    int*  const bidx = k1ok + n;
+    real* const blons = nzs + n;
+    real* const blats = blons + n;
+    real* const bzs = blats + n;
+    real* const bus = bzs + n;
+    real* const bvs = bus + n;
+    real* const bws = bvs + n;
+
+    // mark which parcels we are going to trace, and convert them to unit vectors
+    nuse = 0;
+    ii = -1;
+    for ( i=0; i<n; i++ ) {
+        if ( flags[i] == 0 ) {
+
+           nuse++;
+           ii++;
+
+           iused[ii] = i;
+
+           plons[ii] = lons[i];
+           plats[ii] = lats[i];
+           pzs[ii]   = zs[i];
+           cartFromLonLat( lons[i], lats[i], px[ii], py[ii], pz[ii] );
+           
+           levs[ii] = 0;
+           prog[ii] = 0;
+           k1ok[ii] = 0;
+        }    
+    }
+    
+    nleft = nuse;
+    while ( nleft > 0 ) {
+    
+        // find the earliest point in time that any unfinished parcel has reached
+        pmin = full;
+        for ( i=0; i<nuse; i++ ) {
+            if ( prog[i] < pmin ) {
+               pmin = prog[i];
+            }
+        }
+        ts = t + dt0*( static_cast<double>(pmin)/static_cast<double>(full) );
+        
+        // Advance the parcels at that time in batches by substep length.
+        // Rejected substeps move parcels to the next level, where they will be 
+        // picked up again on this same pass.
+        for ( lev=0; lev<=maxlev; lev++ ) {
+        
+            nb = 0;
+            for ( i=0; i<nuse; i++ ) {
+                if ( prog[i] == pmin && levs[i] == lev ) {
+                   bidx[nb] = i;
+                   nb++;
+                }
+            }
+            if ( nb == 0 ) {
+               continue;
+            }
+            
+            h = dt/static_cast<double>(1L << lev);
+            hd = dt0/static_cast<double>(1L << lev);
+            
+            //// Stage 1: the winds at the starting points, unless we already have them
+            
+            ii = 0;
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                if ( ! k1ok[i] ) {
+                   blons[ii] = plons[i];
+                   blats[ii] = plats[i];
+                   bzs[ii] = pzs[i];
+                   ii++;
+                }
+            }
+            if ( ii > 0 ) {
+               metsrc->get_uvw( ts, ii, blons, blats, bzs, bus, bvs, bws );
+               ii = 0;
+               for ( j=0; j<nb; j++ ) {
+                   i = bidx[j];
+                   if ( ! k1ok[i] ) {
+                      cartVelocity( px[i], py[i], pz[i], bus[ii], bvs[ii], rr, k1x[i], k1y[i], k1z[i] );
+                      k1w[i] = bws[ii];
+                      k1ok[i] = 1;
+                      ii++;
+                   }
+               }
+            }
+            
+            //// Stage 2: the winds half a substep along the stage-1 velocities
+            
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                if ( FINITE(k1x[i]) && FINITE(k1y[i]) && FINITE(k1z[i]) ) {
+                   cartAdvance( px[i], py[i], pz[i], k1x[i], k1y[i], k1z[i], h*0.5, nx[i], ny[i], nz[i] );
+                   cartLonLat( nx[i], ny[i], nz[i], nav, blons[j], blats[j] );
+                } else {
+                   // bad data at this point, so no advancement
+                   nx[i] = px[i];
+                   ny[i] = py[i];
+                   nz[i] = pz[i];
+                   blons[j] = plons[i];
+                   blats[j] = plats[i];
+                }
+                if ( FINITE(k1w[i]) ) {
+                   bzs[j] = pzs[i] + h*0.5*k1w[i]/1000.0;
+                } else {
+                   bzs[j] = pzs[i];
+                }
+            }
+            metsrc->get_uvw( ts + hd*0.5, nb, blons, blats, bzs, bus, bvs, bws );
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                cartVelocity( nx[i], ny[i], nz[i], bus[j], bvs[j], rr, k2x[i], k2y[i], k2z[i] );
+                k2w[i] = bws[j];
+            }
+            
+            //// Stage 3: the winds three-quarters of a substep along the stage-2 velocities
+            
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                if ( FINITE(k2x[i]) && FINITE(k2y[i]) && FINITE(k2z[i]) ) {
+                   cartAdvance( px[i], py[i], pz[i], k2x[i], k2y[i], k2z[i], h*0.75, nx[i], ny[i], nz[i] );
+                   cartLonLat( nx[i], ny[i], nz[i], nav, blons[j], blats[j] );
+                } else {
+                   nx[i] = px[i];
+                   ny[i] = py[i];
+                   nz[i] = pz[i];
+                   blons[j] = plons[i];
+                   blats[j] = plats[i];
+                }
+                if ( FINITE(k2w[i]) ) {
+                   bzs[j] = pzs[i] + h*0.75*k2w[i]/1000.0;
+                } else {
+                   bzs[j] = pzs[i];
+                }
+            }
+            metsrc->get_uvw( ts + hd*0.75, nb, blons, blats, bzs, bus, bvs, bws );
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                cartVelocity( nx[i], ny[i], nz[i], bus[j], bvs[j], rr, k3x[i], k3y[i], k3z[i] );
+                k3w[i] = bws[j];
+            }
+            
+            //// The third-order end point, and the winds there
+            
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                vx = k1x[i]*2.0/9.0 + k2x[i]/3.0 + k3x[i]*4.0/9.0;
+                vy = k1y[i]*2.0/9.0 + k2y[i]/3.0 + k3y[i]*4.0/9.0;
+                vz = k1z[i]*2.0/9.0 + k2z[i]/3.0 + k3z[i]*4.0/9.0;
+                if ( FINITE(vx) && FINITE(vy) && FINITE(vz) ) {
+                   cartAdvance( px[i], py[i], pz[i], vx, vy, vz, h, nx[i], ny[i], nz[i] );
+                   cartLonLat( nx[i], ny[i], nz[i], nav, blons[j], blats[j] );
+                } else {
+                   // bad data, so the parcel stays where it is
+                   nx[i] = px[i];
+                   ny[i] = py[i];
+                   nz[i] = pz[i];
+                   blons[j] = plons[i];
+                   blats[j] = plats[i];
+                }
+                ww = k1w[i]*2.0/9.0 + k2w[i]/3.0 + k3w[i]*4.0/9.0;
+                if ( FINITE(ww) ) {
+                   nzs[i] = pzs[i] + h*ww/1000.0;
+                } else {
+                   nzs[i] = pzs[i];
+                }
+                bzs[j] = nzs[i];
+            }
+            metsrc->get_uvw( ts + hd, nb, blons, blats, bzs, bus, bvs, bws );
+            
+            //// Estimate the errors, and accept or reject each substep
+            
+            for ( j=0; j<nb; j++ ) {
+                i = bidx[j];
+                
+                // the stage-4 winds, which are also the stage-1 winds of the next substep
+                cartVelocity( nx[i], ny[i], nz[i], bus[j], bvs[j], rr, vx, vy, vz );
+                
+                // the difference between the third- and second-order solutions
+                ex = k1x[i]*(-5.0/72.0) + k2x[i]/12.0 + k3x[i]/9.0 - vx/8.0;
+                ey = k1y[i]*(-5.0/72.0) + k2y[i]/12.0 + k3y[i]/9.0 - vy/8.0;
+                ez = k1z[i]*(-5.0/72.0) + k2z[i]/12.0 + k3z[i]/9.0 - vz/8.0;
+                err = ABS(h)*r*SQRT( ex*ex + ey*ey + ez*ez );
+                if ( ! FINITE(err) ) {
+                   // missing data cannot be helped by shorter substeps 
+                   err = 0.0;
+                }
+                
+                if ( err <= tol || lev >= maxlev ) {
+                   // accept the substep
+                   px[i] = nx[i];
+                   py[i] = ny[i];
+                   pz[i] = nz[i];
+                   pzs[i] = nzs[i];
+                   plons[i] = blons[j];
+                   plats[i] = blats[j];
+                   k1x[i] = vx;
+                   k1y[i] = vy;
+                   k1z[i] = vz;
+                   k1w[i] = bws[j];
+                   
+                   prog[i] += ( full >> lev );
+                   bsub = bsub + 1.0;
+                   
+                   if ( prog[i] >= full ) {
+                      nleft--;
+                   } else if ( lev > 0 && err*16.0 <= tol && ( prog[i] % ( full >> (lev-1) ) ) == 0 ) {
+                      // The error estimate scales as the cube of the substep length, 
+                      // so a doubled substep should still be acceptable.
+                      levs[i] = lev - 1;
+                   }
+                } else {
+                   // reject the substep, and try again with half the length.
+                   // (The stage-1 winds remain valid.)
+                   levs[i] = lev + 1;
+                   brej = brej + 1.0;
+                }
+            }
+            
+            if ( debug >= 100 ) {
+               dyt = metsrc->time2Cal( ts, 3 );
+               std::cerr << "     IntegRK32 @ (" << ts << "/" << dyt << "): level " << lev 
+                         << " substep of " << nb << " parcels; " << nleft << " unfinished" << std::endl;
+            }
+        }
+    }
+    
+    // (the met source's lock serializes the statistics when several threads share this integrator)
+    metsrc->lockMet();
+    nsub = nsub + bsub;
+    nrej = nrej + brej;
+    nparcelsteps = nparcelsteps + nuse;
+    metsrc->unlockMet();
+    
+    for ( i=0; i<nuse; i++ ) {
+        // store the results
+        ii = iused[i];        
+        if ( FINITE(plons[i]) && FINITE(plats[i]) && FINITE(pzs[i]) ) {
+           lons[ii] = plons[i];
+           lats[ii] = plats[i];
+           zs[ii]   = pzs[i];
+        } else {
+           // disable tracing this parcel 
+           flags[ii] = 1;
+        }   
+    }
+    if ( debug >= 100 && nuse > 0 ) {
+       std::cerr << "     IntegRK32 result (" << t + dt0 << ", "  << plons[0] << ", " << plats[0] 
+                 << ", " << pzs[0] << "); mean substeps " << meanSubsteps() << std::endl;
+    }
+    
+
+
+    // advance the time
+    t += dt0;
+
+}
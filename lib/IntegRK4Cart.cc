@@ -0,0 +1,262 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include "gigatraj/IntegRK4Cart.hh"
+
+using namespace gigatraj;
+
+const std::string IntegRK4Cart::id = "IntegRK4Cart";
+
+
+IntegRK4Cart :: IntegRK4Cart()
+{
+    // conformal adjustments are not used
+    confml = 0;
+    
+    scratch.nwork = 0;
+}
+
+IntegRK4Cart :: ~IntegRK4Cart()
+{
+    for ( size_t i=0; i < tscratch.size(); i++ ) {
+        delete tscratch[i];
+    }
+}
+
+void IntegRK4Cart :: setThreads( int n )
+{
+    // thread 0 uses our own scratch space
+    while ( static_cast<int>( tscratch.size() ) < n - 1 ) {
+        tscratch.push_back( new Scratch() );
+        tscratch.back()->nwork = 0;
+    }
+}
+
+IntegRK4Cart::Scratch* IntegRK4Cart :: threadScratch()
+{
+    int i;
+    
+    i = MetData::thread();
+    if ( i <= 0 || i > static_cast<int>( tscratch.size() ) ) {
+       return &scratch;
+    }
+    
+    return tscratch[i-1];
+}
+
+void IntegRK4Cart :: go( real &lon, real &lat, real &z, double &t, MetData *metsrc, PlanetNav *nav, double dt0 )
+{
+    int flags;
+
+    
+    flags = 0;
+    
+    go( 1, &lon, &lat, &z, &flags, t, metsrc, nav, dt0 );
+    
+
+}
+
+void IntegRK4Cart :: go( int n, real *lons, real *lats, real *zs, int *flags, double &t, MetData *metsrc, PlanetNav *nav, double dt0 )
+{
+    // delta time in seconds
+    double dt;
+    // time of an intermediate stage
+    double xt;
+    // the RK4 stage weights and the fractions of a time step for the next stage
+    const real wgt[4] = { 1.0/6.0, 2.0/6.0, 2.0/6.0, 1.0/6.0 };
+    const real frac[4] = { 0.5, 0.5, 1.0, 0.0 };
+    const double tfrac[4] = { 0.0, 0.5, 0.5, 1.0 };
+    // Cartesian velocity components, in radians/s
+    real vx, vy, vz;
+    real dz;
+    real r, rr;
+    std::string dyt;
+    int debug;
+    int i;
+    int ii;
+    int stage;
+    int nuse;
+    Scratch* sc;
+    
+    debug = metsrc->dbug;
+
+    // get the planetary radius (in km)
+    r = planetRadius( nav );
+    // converts m/s to radians/s on the unit sphere
+    rr = 1.0/(r*1000.0);
+    
+    // convert days to seconds
+    dt = dt0 * 86400.0;
+    
+    // get the scratch space, growing it if this call has more parcels than any before
+    // (each thread of a pool has its own)
+    sc = threadScratch();
+    if ( n > sc->nwork || sc->nwork == 0 ) {
+       sc->nwork = ( n > 0 ) ? n : 1;
+       sc->iwork.resize( sc->nwork );
+       sc->work.resize( 17*sc->nwork );
+    }
+    
+    int*  const iused = &(sc->iwork[0]);
+
+    real* const pzs   = &(sc->work[0]);
+    // the starting unit vectors
+    real* const px = pzs + n;
+    real* const py = px + n;
+    real* const pz = py + n;
+    // the current stage unit vectors
+    real* const qx = pz + n;
+    real* const qy = qx + n;
+    real* const qz = qy + n;
+    // the weighted sums of the stage velocities
+    real* const ax = qz + n;
+    real* const ay = ax + n;
+    real* const az = ay + n;
+
+    real* const tmplons = az + n;
+    real* const tmplats = tmplons + n;
+    real* const tmpzs = tmplats + n;
+    real* const zhold = tmpzs + n;
+
+    real* const kus = zhold + n;
+    real* const kvs = kus + n;
+    real* const kws = kvs + n;
+
+    // mark which parcels we are going to trace, and convert them to unit vectors
+    nuse = 0;
+    ii = -1;
+    for ( i=0; i<n; i++ ) {
+        if ( flags[i] == 0 ) {
+
+           nuse++;
+           ii++;
+
+           iused[ii] = i;
+
+           tmplons[ii] = lons[i];
+           tmplats[ii] = lats[i];
+           pzs[ii]   = zs[i];
+           tmpzs[ii] = zs[i];
+           
+           cartFromLonLat( lons[i], lats[i], px[ii], py[ii], pz[ii] );
+           
+           qx[ii] = px[ii];
+           qy[ii] = py[ii];
+           qz[ii] = pz[ii];
+           
+           ax[ii] = 0.0;
+           ay[ii] = 0.0;
+           az[ii] = 0.0;
+           zhold[ii] = 0.0;
+        }    
+    }
+    
+    for ( stage=0; stage<4; stage++ ) {
+
+        // get the winds at this stage's points
+        xt = t + dt0*tfrac[stage];
+        metsrc->get_uvw( xt, nuse, tmplons, tmplats, tmpzs, kus, kvs, kws );
+        if ( debug >= 100 ) {
+           dyt = metsrc->time2Cal( xt, 3 );
+           std::cerr << "     IntegRK4Cart @ (" << xt << "/" << dyt << ", " << tmplons[0] << ", " << tmplats[0] 
+                     << ", " << tmpzs[0] << "): u" << (stage+1) << "=" << kus[0] 
+                     << ", v" << (stage+1) << "=" << kvs[0] << std::endl;
+        }
+        
+        for ( i=0; i<nuse; i++ ) {
+        
+            // rotate the winds into the tangent plane at the stage point
+            cartVelocity( qx[i], qy[i], qz[i], kus[i], kvs[i], rr, vx, vy, vz );
+            
+            // accumulate the weighted velocities
+            ax[i] = ax[i] + vx*wgt[stage];
+            ay[i] = ay[i] + vy*wgt[stage];
+            az[i] = az[i] + vz*wgt[stage];
+            zhold[i] = zhold[i] + kws[i]*wgt[stage];
+            
+            if ( stage < 3 ) {
+               // the next stage point is reached from the starting point
+               if ( FINITE(vx) && FINITE(vy) && FINITE(vz) ) {
+                  cartAdvance( px[i], py[i], pz[i], vx, vy, vz, dt*frac[stage], qx[i], qy[i], qz[i] );
+                  cartLonLat( qx[i], qy[i], qz[i], nav, tmplons[i], tmplats[i] );
+               } else {
+                  // bad data at this point, so no advancement
+                  qx[i] = px[i];
+                  qy[i] = py[i];
+                  qz[i] = pz[i];
+                  ii = iused[i];
+                  tmplons[i] = lons[ii];
+                  tmplats[i] = lats[ii];
+               }
+               if ( FINITE(kws[i]) && FINITE(tmpzs[i]) ) {
+                  dz = dt*kws[i]/1000.0;
+                  tmpzs[i] = pzs[i] + dz*frac[stage];
+               } else {
+                  // bad data at this point, so no advancement
+                  tmpzs[i] = pzs[i];
+               }
+            }
+        }
+    }
+    
+    xt = t + dt0;
+    if ( debug >= 100 ) {
+       dyt = metsrc->time2Cal( xt, 3 );
+       std::cerr << "     IntegRK4Cart end (" << xt << "/" << dyt << ", " << px[0] << ", " << py[0] 
+                 << ", " << pz[0] << "): vv=(" << ax[0] << ", " << ay[0] << ", " << az[0] << ")" << std::endl;
+    }
+    
+    for ( i=0; i<nuse; i++ ) {
+        ii = iused[i];
+        
+        // move forward one full time step
+        if ( FINITE(ax[i]) && FINITE(ay[i]) && FINITE(az[i]) ) {
+           cartAdvance( px[i], py[i], pz[i], ax[i], ay[i], az[i], dt, qx[i], qy[i], qz[i] );
+           cartLonLat( qx[i], qy[i], qz[i], nav, tmplons[i], tmplats[i] );
+        } else {
+           // bad data, so the parcel stays where it is
+           tmplons[i] = lons[ii];
+           tmplats[i] = lats[ii];
+        }
+        
+        // advance in the vertical
+        if ( FINITE(zhold[i]) && FINITE(pzs[i]) ) {
+           dz = dt*zhold[i]/1000.0;
+           tmpzs[i] =  pzs[i] + dz;
+        } else {
+           // bad data at this point, so no advancement
+           // the parcel stays where it is
+           tmpzs[i] = pzs[i];
+        }
+    
+        // and store the results
+        if ( FINITE(tmplons[i]) && FINITE(tmplats[i]) && FINITE(tmpzs[i]) ) {
+           lons[ii] = tmplons[i];
+           lats[ii] = tmplats[i];
+           zs[ii]   = tmpzs[i];
+        } else {
+           // disable tracing this parcel 
+           flags[ii] = 1;
+        }   
+    }
+    if ( debug >= 100 && nuse > 0 ) {
+       std::cerr << "     IntegRK4Cart result (" << xt << "/" << dyt << ", "  << tmplons[0] << ", " << tmplats[0] 
+                 << ", " << tmpzs[0] << ")" << std::endl;
+    }
+    
+
+
+    // advance the time
+    t += dt0;
+
+}
@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include "gigatraj/Integrator.hh"
+#include "gigatraj/PlanetSphereNav.hh"
 
 using namespace gigatraj;
 
@@ -31,3 +32,16 @@ int Integrator :: conformal()
     return confml;
 }
 
+real Integrator :: planetRadius( PlanetNav *nav )
+{
+    PlanetSphereNav *snav;
+    real r;
+    
+    r = 6371.0;
+    snav = dynamic_cast<PlanetSphereNav*>(nav);
+    if ( snav != NULLPTR ) {
+       r = snav->radius();
+    }
+    
+    return r;
+}
@@ -874,4 +874,30 @@ void MPIGrp::receive_string( int id, std::string *str, int tag, int *src) const
 
 }
 
+int MPIGrp::pending( int tag ) const
+{
+   int err;
+   int flag;
+   int count;
+   int id;
+   MPI_Status status;
+   
+   count = 0;
+   if ( my_id >= 0 ) {
+      for ( id=0; id < num_procs; id++ ) {
+          if ( id != my_id ) {
+             err = MPI_Iprobe( id, tag, comm, &flag, &status );
+             if ( err != MPI_SUCCESS ) {
+                throw (badparallelism());
+             }
+             if ( flag ) {
+                count++;
+             }
+          }
+      }
+   }
+   
+   return count;
+}
+
 #endif
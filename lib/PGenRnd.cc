@@ -26,6 +26,7 @@ PGenRnd::PGenRnd( float LLlat, float LLlon, float URlat, float URlon )
 {
 
      use_z = 0;
+     fixed_seed = false;
      
      setBox( LLlat, LLlon, URlat, URlon );
      
@@ -61,6 +62,39 @@ void PGenRnd::setZ( float zlow, float zhigh )
 void PGenRnd::seed( const unsigned int *saw ) 
 {
     rnd.seed(saw);
+    fixed_seed = ( saw != NULL );
+}
+
+void PGenRnd::rekey( ProcessGrp* pgrp )
+{
+    unsigned int saw;
+    
+    if ( ! fixed_seed ) {
+       if ( pgrp != NULLPTR ) {
+          // every processor must use the same seed
+          saw = (unsigned int)( pgrp->random() * 4294967295.0 );
+          rnd.seed( &saw );
+       } else {
+          rnd.seed();
+       }
+    }
+}
+
+void PGenRnd::place( unsigned long idx, Parcel& p ) const
+{
+    real u[4];
+    real lon, lat;
+    
+    rnd.uniform4( idx, u );
+    
+    lon = lon0 + u[0]*(lon1 - lon0);
+    lat = ASIN( slat0 + u[1]*(slat1 - slat0) ) /RCONV;
+    p.setPos( lon, lat );
+    
+    if ( use_z ) {
+       p.setZ( z0 + u[2]*(z1 - z0) );
+    }
+
 }
 
 
@@ -68,28 +102,21 @@ template< template<class U, class = std::allocator<U> > class Seq>
 void PGenRnd :: init( Seq<Parcel>* seq
                     )                          
 {
+     unsigned long idx;
           
-     seed();
-     
      if ( seq->size() <= 0 ) {
         throw  (ParcelGenerator :: badparcelcount());
      }
 
-
+     rekey();
 
      try {                                       
          typename Seq<Parcel>::iterator it;     
          it = seq->begin();
+         idx = 0;
          while ( it != seq->end() ) {
-             real lon, lat;
-             lon = rnd.uniform(lon0, lon1);
-             lat = ASIN( rnd.uniform(slat0, slat1) ) /RCONV;
-             it->setPos( lon, lat );
-          
-             if ( use_z ) {
-                it->setZ( rnd.uniform( z0, z1 ) );
-             }
-          
+             place( idx, *it );
+             idx++;
              it++;
          }
     } catch (...) {
@@ -110,22 +137,12 @@ Parcel * PGenRnd :: create_array(Parcel parcel, int n
     };  
 
     try {
-       seed();
+       rekey();
        pa = new Parcel[n];
        // initialize the parcel value
        for (int i=0; i<n; i++ ) {
-          real lon, lat;
-          lon = rnd.uniform(lon0, lon1);
-          lat = ASIN( rnd.uniform(slat0, slat1) ) /RCONV;
-          //lon = (real)(rand() % 32768)/32767.0 * 359.9999;
-          //lat = ASIN( 2.0*(real)(rand() % 32768)/32767.0 - 1.0 ) /RCONV;
           pa[i] = parcel;
-          pa[i].setPos( lon, lat );
-          
-          if ( use_z ) {
-             pa[i].setZ( rnd.uniform( z0, z1 ));
-          }
-          
+          place( i, pa[i] );
        }
     } catch(...) {
        throw ( ParcelGenerator :: badgeneration() );
@@ -223,8 +240,6 @@ Flock* PGenRnd :: create_Flock(const Parcel& p, int n
      // the parcel container
      Flock *flock;
      Flock::iterator ip;         
-     real lon,lat,z;
-     int status = 0;
 
      if ( n <= 0 ) {
         throw (ParcelGenerator :: badparcelcount());
@@ -235,25 +250,19 @@ Flock* PGenRnd :: create_Flock(const Parcel& p, int n
         // now create a Flock os that many parels
         flock = new Flock( p, pgrp, n, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=flock->begin(); ip != flock->end(); ip++ ) {
             try {
                // generate a random position
-               lon = rnd.uniform(lon0, lon1);
-               lat = ASIN( rnd.uniform(slat0, slat1) ) /RCONV;
-               //lon = rnd.uniform(0.0, 359.9999);
-               //lat = ASIN( rnd.uniform(-1.0, 1.0) ) /RCONV;
-               // load the parcel location into the parcel
-              ip->setPos( lon, lat );
-          
-              if ( use_z ) {
-                 ip->setZ( rnd.uniform( z0, z1 ));
-              }
-
+               place( ip.index(), *ip );
             } catch (std::ios::failure) {
                throw (ParcelGenerator :: badgeneration());
             }   
@@ -275,8 +284,6 @@ Swarm* PGenRnd :: create_Swarm(const Parcel& p, int n
      // the parcel container
      Swarm *swarm;
      Swarm::iterator ip;         
-     real lon,lat,z;
-     int status = 0;
 
      if ( n <= 0 ) {
         throw (ParcelGenerator :: badparcelcount());
@@ -287,25 +294,19 @@ Swarm* PGenRnd :: create_Swarm(const Parcel& p, int n
         // now create a Swarm os that many parels
         swarm = new Swarm( p, pgrp, n, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=swarm->begin(); ip != swarm->end(); ip++ ) {
             try {
                // generate a random position
-               lon = rnd.uniform(lon0, lon1);
-               lat = ASIN( rnd.uniform(slat0, slat1) ) /RCONV;
-              //lon = rnd.uniform(0.0, 359.9999);
-              //lat = ASIN( rnd.uniform(-1.0, 1.0) ) /RCONV;
-               // load the parcel location into the parcel
-              ip->setPos( lon, lat );
-
-              if ( use_z ) {
-                 ip->setZ( rnd.uniform( z0, z1 ));
-              }
-
+               place( ip.index(), *ip );
             } catch (std::ios::failure) {
                throw (ParcelGenerator :: badgeneration());
             }   
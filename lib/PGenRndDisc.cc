@@ -28,6 +28,7 @@ PGenRndDisc::PGenRndDisc()
    thk = 1e-10;
       
    rnd.seed();
+   fixed_seed = false;
 }
 
 PGenRndDisc::PGenRndDisc( const real lon, const real lat, const real level, const real r, const real thickness )
@@ -39,6 +40,7 @@ PGenRndDisc::PGenRndDisc( const real lon, const real lat, const real level, cons
    z0 = level;
 
    rnd.seed();
+   fixed_seed = false;
 }
 
 const void PGenRndDisc::center( real &lon, real &lat, real &level )   
@@ -74,36 +76,62 @@ void PGenRndDisc::set_size( const real r, const real thickness )
 void PGenRndDisc::seed( const unsigned int *saw ) 
 {
     rnd.seed(saw);
+    fixed_seed = ( saw != NULL );
+}
+
+void PGenRndDisc::rekey( ProcessGrp* pgrp )
+{
+    unsigned int saw;
+    
+    if ( ! fixed_seed ) {
+       if ( pgrp != NULLPTR ) {
+          // every processor must use the same seed
+          saw = (unsigned int)( pgrp->random() * 4294967295.0 );
+          rnd.seed( &saw );
+       } else {
+          rnd.seed();
+       }
+    }
+}
+
+void PGenRndDisc::place( unsigned long idx, Parcel& p ) const
+{
+    PlanetNav *nav;
+    real u[4];
+    real lon, lat, r, ang;
+    
+    rnd.uniform4( idx, u );
+
+    nav = p.getNav();
+    
+    r = rad * SQRT( u[0] );
+    ang =  360.0*u[1];
+    nav->displace( lon0,lat0, r,ang, lon,lat);
+    
+    p.setPos( lon, lat );
+    p.setZ( z0 + thk/2.0*( 2.0*u[2] - 1.0 ) );
+
 }
 
 template< template<class U, class = std::allocator<U> > class Seq>
 void PGenRndDisc :: init( Seq<Parcel>* seq
                     )                          
 {
-     PlanetNav *nav;
-     real lon, lat, z;
+     unsigned long idx;
      
      if ( seq->size() <= 0 ) {
         throw  (ParcelGenerator :: badparcelcount());
      }
 
+     rekey();
+
      try {                                       
          typename Seq<Parcel>::iterator it;     
          it = seq->begin();
+         idx = 0;
          while ( it != seq->end() ) {
-             real lon, lat, lev, r, ang;
-             
-             nav = it->getNav();
-             
-             r = rad * SQRT( rnd.uniform(0.0,1.0) );
-             ang =  360.0*rnd.uniform(0.0, 360.0);
-             nav->displace( lon0,lat0, r,ang, lon,lat);
-             
-             z = z0 + thk/2.0*rnd.uniform(-1.0,1.0);
-
-             it->setPos( lon, lat );
-             it->setZ( z );
-          
+             place( idx, *it );
+             idx++;
              it++;
          }
     } catch (...) {
@@ -118,31 +146,19 @@ Parcel * PGenRndDisc :: create_array(Parcel parcel, int n
                                 ) 
 {
     Parcel* pa;
-    PlanetNav *nav;
-     
     
     if ( n <= 0 ) {
        throw (ParcelGenerator :: badparcelcount());
     };  
      
-    nav = parcel.getNav();
-    
     try {
 
+       rekey();
        pa = new Parcel[n];
        // initialize the parcel value
        for (int i=0; i<n; i++ ) {
-          real lon, lat, z, r, ang;
-
-          r = rad * SQRT( rnd.uniform(0.0,1.0) );
-          ang =  360.0*rnd.uniform(0.0, 360.0);
-          nav->displace( lon0,lat0, r,ang, lon,lat);
-          
-          z = z0 + thk/2.0*rnd.uniform(-1.0,1.0);             
-
           pa[i] = parcel;
-          pa[i].setPos( lon, lat );
-          pa[i].setZ( z );
+          place( i, pa[i] );
        }
     } catch(...) {
        throw ( ParcelGenerator :: badgeneration() );
@@ -243,9 +259,6 @@ Flock* PGenRndDisc :: create_Flock(const Parcel& p, int n
      // the parcel container
      Flock *flock;
      Flock::iterator ip;         
-     real lon,lat,z, rx, ang;
-     int status = 0;
-     PlanetNav *nav;
      
 
      if ( n <= 0 ) {
@@ -257,27 +270,19 @@ Flock* PGenRndDisc :: create_Flock(const Parcel& p, int n
         // now create a Flock os that many parels
         flock = new Flock( p, pgrp, n, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=flock->begin(); ip != flock->end(); ip++ ) {
             try {
               // generate a random position
-
-              nav = ip->getNav();
-    
-              rx = rad * SQRT( rnd.uniform(0.0,1.0) );
-              ang =  360.0*rnd.uniform(0.0, 360.0);
-              nav->displace( lon0,lat0, rx,ang, lon,lat);
-               
-              z = z0 + thk/2.0*rnd.uniform(-1.0,1.0);
-
-               // load the parcel location into the parcel
-              ip->setPos( lon, lat );
-              ip->setZ( z );
-
+              place( ip.index(), *ip );
             } catch (std::ios::failure) {
                throw (ParcelGenerator :: badgeneration());
             }   
@@ -299,9 +304,6 @@ Swarm* PGenRndDisc :: create_Swarm(const Parcel& p, int n
      // the parcel container
      Swarm *swarm;
      Swarm::iterator ip;         
-     real lon,lat,z, rx, ang;
-     int status = 0;
-     PlanetNav *nav;
      
 
      if ( n <= 0 ) {
@@ -313,27 +315,19 @@ Swarm* PGenRndDisc :: create_Swarm(const Parcel& p, int n
         // now create a Swarm os that many parels
         swarm = new Swarm( p, pgrp, n, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=swarm->begin(); ip != swarm->end(); ip++ ) {
             try {
               // generate a random position
-
-              nav = ip->getNav();
-    
-              rx = rad * SQRT( rnd.uniform(0.0,1.0) );
-              ang =  360.0*rnd.uniform(0.0, 360.0);
-              nav->displace( lon0,lat0, rx,ang, lon,lat);
-               
-              z = z0 + thk/2.0*rnd.uniform(-1.0,1.0);
-
-               // load the parcel location into the parcel
-              ip->setPos( lon, lat );
-              ip->setZ( z );
-
+              place( ip.index(), *ip );
             } catch (std::ios::failure) {
                throw (ParcelGenerator :: badgeneration());
             }   
@@ -26,6 +26,44 @@ using namespace gigatraj;
 PGenRndLine::PGenRndLine()
 {
    rnd.seed();
+   fixed_seed = false;
+}
+
+void PGenRndLine::seed( const unsigned int *saw ) 
+{
+    rnd.seed(saw);
+    fixed_seed = ( saw != NULL );
+}
+
+void PGenRndLine::rekey( ProcessGrp* pgrp )
+{
+    unsigned int saw;
+    
+    if ( ! fixed_seed ) {
+       if ( pgrp != NULLPTR ) {
+          // every processor must use the same seed
+          saw = (unsigned int)( pgrp->random() * 4294967295.0 );
+          rnd.seed( &saw );
+       } else {
+          rnd.seed();
+       }
+    }
+}
+
+void PGenRndLine::place( unsigned long idx, Parcel& p, PlanetNav* e
+                       , real beglon, real beglat, real totaldist, real bear
+                       , real begz, real endz ) const
+{
+    real u[4];
+    real lon, lat;
+    
+    rnd.uniform4( idx, u );
+    
+    e->displace( beglon, beglat, u[0]*totaldist, bear, lon, lat );
+    
+    p.setPos( lon, lat );
+    p.setZ( begz + u[1]*(endz - begz) );
+
 }
 
 
@@ -37,8 +75,7 @@ void PGenRndLine::init( Seq<Parcel>* seq, const Parcel& p
                    )
 {
      PlanetNav *e;
-     real lon, lat;
-     real dist, totaldist, bear;
+     real totaldist, bear;
      
      if ( seq->size() <= 0 ) {
         throw  (ParcelGenerator :: badparcelcount());
@@ -50,18 +87,18 @@ void PGenRndLine::init( Seq<Parcel>* seq, const Parcel& p
      totaldist = e->distance( beglon,beglat, endlon,endlat );
      bear = e->bearing( beglon,beglat, endlon,endlat );
 
+     rekey();
+
      try {                                       
          typename Seq<Parcel>::iterator it;     
+         unsigned long idx;
          it = seq->begin();
+         idx = 0;
          while ( it != seq->end() ) {
          
-         
-             dist = rnd.uniform(0.0, totaldist);
-             e->displace( beglon, beglat, dist, bear, lon, lat );
-          
-             it->setPos( lon, lat );
-             it->setZ( rnd.uniform( begz, endz ) );
+             place( idx, *it, e, beglon, beglat, totaldist, bear, begz, endz );
           
+             idx++;
              it++;
          }
     } catch (...) {
@@ -78,8 +115,7 @@ Parcel * PGenRndLine::create_array(const Parcel& p, int np
                      )
 {
      PlanetNav* e;
-     real lon, lat;
-     real dist, totaldist, bear;
+     real totaldist, bear;
      Parcel* pa;
 
      e = p.getNav();
@@ -91,16 +127,13 @@ Parcel * PGenRndLine::create_array(const Parcel& p, int np
 
      try {
          
+         rekey();
          pa = new Parcel[np];
          
          for ( int i=0; i < np; i++ ) {          
          
-             dist = rnd.uniform(0.0, totaldist);
-             e->displace( beglon, beglat, dist, bear, lon, lat );
-          
              pa[i] = p;
-             pa[i].setPos( lon, lat );
-             pa[i].setZ( rnd.uniform( begz, endz ) );
+             place( i, pa[i], e, beglon, beglat, totaldist, bear, begz, endz );
           
          }
     } catch (...) {
@@ -202,12 +235,9 @@ Flock* PGenRndLine::create_Flock(const Parcel& parcel, int np
      // the parcel container
      Flock *flock;
      Flock::iterator ip;         
-     real lon,lat,z;
-     real totaldist, bear, dist;
+     real totaldist, bear;
      PlanetNav* e;
 
-     int status = 0;
-
      if ( np <= 0 ) {
         throw (ParcelGenerator :: badparcelcount());
      };  
@@ -224,24 +254,19 @@ Flock* PGenRndLine::create_Flock(const Parcel& parcel, int np
         // now create a Flock os that many parels
         flock = new Flock( parcel, pgrp, np, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=flock->begin(); ip != flock->end(); ip++ ) {
             try {
                // generate a random position
-               
-         
-               dist = rnd.uniform(0.0, totaldist);
-               e->displace( beglon, beglat, dist, bear, lon, lat );
-               
-               // load the parcel location into the parcel
-               ip->setPos( lon, lat );
-          
-               ip->setZ( rnd.uniform( begz, endz ));
-
+               place( ip.index(), *ip, e, beglon, beglat, totaldist, bear, begz, endz );
             } catch (...) {
                throw (ParcelGenerator :: badgeneration());
             }   
@@ -268,12 +293,9 @@ Swarm* PGenRndLine::create_Swarm(const Parcel& parcel, int np
      // the parcel container
      Swarm *swarm;
      Swarm::iterator ip;         
-     real lon,lat,z;
-     real totaldist, bear, dist;
+     real totaldist, bear;
      PlanetNav* e;
 
-     int status = 0;
-
      if ( np <= 0 ) {
         throw (ParcelGenerator :: badparcelcount());
      };  
@@ -290,24 +312,19 @@ Swarm* PGenRndLine::create_Swarm(const Parcel& parcel, int np
         // now create a Swarm os that many parels
         swarm = new Swarm( parcel, pgrp, np, r);
 
+        // all the processors must agree on the seed
+        rekey( pgrp );
+
         // sync all the processors before we start loading
         if ( pgrp != NULLPTR ) {
            pgrp->sync();
         }
 
+        // each processor generates just its own parcels, by global index
         for ( ip=swarm->begin(); ip != swarm->end(); ip++ ) {
             try {
                // generate a random position
-               
-         
-               dist = rnd.uniform(0.0, totaldist);
-               e->displace( beglon, beglat, dist, bear, lon, lat );
-               
-               // load the parcel location into the parcel
-               ip->setPos( lon, lat );
-          
-               ip->setZ( rnd.uniform( begz, endz ));
-
+               place( ip.index(), *ip, e, beglon, beglat, totaldist, bear, begz, endz );
             } catch (...) {
                throw (ParcelGenerator :: badgeneration());
             }   
@@ -182,9 +182,18 @@ int Parcel :: advance( double dt )
     try {
        if ( ! queryNoTrace() && ! queryNonVert() ) {
           integ->go( lon, lat, z, t, metsrc, nav, dt );
+          if ( ! metsrc->inDomain( lon, lat, z ) ) {
+             // the parcel has left the region covered by the met source
+             setHitBdy();
+             setNoTrace();
+          }
        }   
     } catch(MetData::badmetdata) {
-       setHitBad();
+       if ( metsrc->inDomain( lon, lat, z ) ) {
+          setHitBad();
+       } else {
+          setHitBdy();
+       }
        setNoTrace();
     } catch(Interpolator::badoutofdomain) {
        setHitBdy();
@@ -26,9 +26,349 @@ using namespace gigatraj;
 #define POLAR_LIMIT 75.0
 #endif
 
+// the number of points handled at a time by the batch kernels
+#define NAVBLOCK 256
+
+// GCC will not vectorize the deltaxy kernel once it has been inlined
+// into deltaxy_batch(), whose fix-up loop can throw
+#ifdef __GNUC__
+#define NAV_NOINLINE __attribute__((noinline))
+#else
+#define NAV_NOINLINE
+#endif
+
+
+/*
+    Helpers for the batch navigation kernels.
+    
+    These are written so that loops calling them contain no branches 
+    that depend on the data, so that the compiler can vectorize them.
+    Conditional selections choose only between values that have already
+    been computed: an arithmetic expression inside a "?:" could trap, and
+    it would keep the compiler from if-converting the loop. The template parameter FAST selects
+    the inline polynomial approximations (FAST=1) instead of the 
+    math library functions (FAST=0).
+*/
+
+// sine and cosine of x, by polynomials.
+// The argument is reduced to [-pi/4, pi/4] by a two-part multiple of pi/2,
+// and then the Taylor series are taken out to x^15 (sine) and x^16 (cosine),
+// where the next terms are below 5e-17. The absolute error is below 1e-15
+// for |x| < 10 and grows slowly (with the reduction error) beyond that.
+// (The reduction is done in double precision even when real is float, 
+// since pi/2 cannot be split accurately enough in single precision.)
+static inline void nav_fast_sincos( real x, real &s, real &c )
+{
+    const double twoopi = 0.636619772367581343075535;
+    const double pio2_1  = 1.57079632673412561417e+00;
+    const double pio2_1t = 6.07710050650619224932e-11;
+    int q;
+    real y, y2, ps, pc, tmp;
+    
+    q = static_cast<int>( x*twoopi + ( ( x >= 0 ) ? 0.5 : -0.5 ) );
+    y = ( static_cast<double>(x) - q*pio2_1 ) - q*pio2_1t;
+    y2 = y*y;
+    
+    ps = y + y*y2*( -1.0/6.0 + y2*( 1.0/120.0 + y2*( -1.0/5040.0 + y2*( 1.0/362880.0 
+           + y2*( -1.0/39916800.0 + y2*( 1.0/6227020800.0 - y2/1307674368000.0 ) ) ) ) ) );
+    pc = 1.0 + y2*( -0.5 + y2*( 1.0/24.0 + y2*( -1.0/720.0 + y2*( 1.0/40320.0 
+           + y2*( -1.0/3628800.0 + y2*( 1.0/479001600.0 + y2*( -1.0/87178291200.0 
+           + y2/20922789888000.0 ) ) ) ) ) ) );
+    
+    // odd quadrants swap sine and cosine
+    tmp = ( q & 1 ) ? pc : ps;
+    pc  = ( q & 1 ) ? ps : pc;
+    ps  = tmp;
+    s = ( q & 2 ) ? -ps : ps;
+    c = ( ( q + 1 ) & 2 ) ? -pc : pc;
+}
+
+// atan2(y,x), by a rational approximation.
+// This uses the rational function of the Cephes math library on |t| <= 0.66,
+// after reducing the ratio of the smaller to the larger of |x| and |y| 
+// into that range. The relative error is below 1e-15. (The only departure from
+// ATAN2 is in the signs of zero results.)
+static inline real nav_fast_atan2( real y, real x )
+{
+    const real pio2 = 1.57079632679489661923;
+    const real pio4 = 0.78539816339744830962;
+    const real morebits = 6.123233995736765886130e-17;
+    const real one = 1.0;
+    real ax, ay, mx, mn, t, u, z, a, alt;
+    bool big;
+    
+    ax = ABS(x);
+    ay = ABS(y);
+    mx = ( ax > ay ) ? ax : ay;
+    mn = ( ax > ay ) ? ay : ax;
+    mx = ( mx > 0 ) ? mx : one;
+    t = mn / mx;
+    
+    big = ( t > 0.66 );
+    alt = ( t - 1.0 )/( t + 1.0 );
+    u = big ? alt : t;
+    z = u*u;
+    a = u + u*z*( -6.485021904942025371773e1 + z*( -1.228866684490136173410e2 
+          + z*( -7.500855792314704667340e1 + z*( -1.615753718733365076637e1
+          + z*( -8.750608600031904122785e-1 ) ) ) ) )
+          / ( 1.945506571482613964425e2 + z*( 4.853903996359136964868e2 
+          + z*( 4.328810604912902668951e2 + z*( 1.650270098316988542046e2 
+          + z*( 2.485846490142306297962e1 + z ) ) ) ) );
+    alt = a + ( pio4 + 0.5*morebits );
+    a = big ? alt : a;
+    
+    alt = ( pio2 - a ) + morebits;
+    a = ( ay > ax ) ? alt : a;
+    alt = PI - a;
+    a = ( x < 0 ) ? alt : a;
+    a = ( y < 0 ) ? -a : a;
+    
+    return a;
+}
+
+template <int FAST>
+static inline void nav_sincos( real x, real &s, real &c )
+{
+    if ( FAST ) {
+       nav_fast_sincos( x, s, c );
+    } else {
+       // (the compiler fuses these into a single sincos call)
+       s = SIN(x);
+       c = COS(x);
+    }
+}
+
+template <int FAST>
+static inline real nav_atan2( real y, real x )
+{
+    return ( FAST ) ? nav_fast_atan2( y, x ) : ATAN2( y, x );
+}
+
+// returns the sine of acos(x) through b, and acos(x) itself
+template <int FAST>
+static inline real nav_acos( real x, real &sinb )
+{
+    real b;
+    
+    if ( FAST ) {
+       sinb = SQRT( ( 1.0 - x )*( 1.0 + x ) );
+       b = nav_fast_atan2( sinb, x );
+    } else {
+       b = ACOS( x );
+       sinb = SIN( b );
+    }
+    return b;
+}
+
+
+/*
+   The deltaxy kernel, on a block of m points.
+   
+   The new positions go into olon and olat, and flag gets
+   0 if the point is to be left alone (non-finite inputs), 1 if the new
+   position is good, 2 if the point needs the scalar code (it starts at or
+   beyond a pole, or the path runs into a pole), or 3 if the new
+   position is bad.
+*/
+template <int FAST>
+NAV_NOINLINE static void nav_deltaxy_block( int m, const real *lons, const real *lats, const real *dxs, const real *dys
+                             , real r, real factor, real wraplon, real *olon, real *olat, int *flag )
+{
+    const real fc = PlanetNav::fullcircle;
+    const real zero = 0.0;
+    const real one = 1.0;
+    // (a bound on the number of full circles to unwrap, to keep the count in an int)
+    const real tmax = 1.0e9;
+    real lon, lat, dx, dy, ds, dsx;
+    real sinBB, cosBB;
+    real a, sinA, cosA;
+    real c, sinC, cosC;
+    real b, sinB, cosB;
+    real sinAA, cosAA, dlon;
+    real newlon, newlat, t;
+    int k, f;
+    bool ok, moving, special, badpos;
+    // local copies of the inputs, which the compiler knows
+    // cannot overlap the outputs
+    real blons[NAVBLOCK];
+    real blats[NAVBLOCK];
+    real bdxs[NAVBLOCK];
+    real bdys[NAVBLOCK];
+    
+    for ( int i=0; i<m; i++ ) {
+        blons[i] = lons[i];
+        blats[i] = lats[i];
+        bdxs[i] = dxs[i];
+        bdys[i] = dys[i];
+    }
+    
+    for ( int i=0; i<m; i++ ) {
+    
+        lon = blons[i];
+        lat = blats[i];
+        dx = bdxs[i];
+        dy = bdys[i];
+        
+        // (x - x is 0 for finite x, and NaN otherwise)
+        ok = ( ( lon - lon ) + ( lat - lat ) + ( dx - dx ) + ( dy - dy ) ) == zero;
+        // masked-out points are computed with harmless values
+        lon = ok ? lon : zero;
+        lat = ok ? lat : zero;
+        dx  = ok ? dx  : zero;
+        dy  = ok ? dy  : zero;
+        
+        // (this mirrors deltaxy_exact; see that method for the geometry)
+        ds = SQRT( dx*dx + dy*dy );
+        moving = ( ds > 0 );
+        dsx = moving ? ds : one;
+        
+        sinBB = dx/dsx;
+        cosBB = dy/dsx;
+        
+        c = (90.0 - lat)*RCONV;
+        nav_sincos<FAST>( c, sinC, cosC );
+        
+        a = ds/r*factor;
+        nav_sincos<FAST>( a, sinA, cosA );
+        
+        cosB = cosC*cosA + sinC*sinA*cosBB;
+        b = nav_acos<FAST>( cosB, sinB );
+        
+        // points starting at a pole, or running into one, are special, 
+        // but only if they are moving
+        sinB = ( ABS(lat) >= 90.0 ) ? zero : sinB;
+        sinB = moving ? sinB : one;
+        special = ( sinB == zero );
+        sinB = special ? one : sinB;
+        
+        sinAA = sinA/sinB*sinBB;
+        cosAA = ( cosA - cosB*cosC )/sinB/sinC;
+        dlon = nav_atan2<FAST>( sinAA, cosAA )/RCONV;
+        
+        newlat = 90.0 - b/RCONV;
+        newlon = lon + dlon;
+        newlat = moving ? newlat : lat;
+        newlon = moving ? newlon : lon;
+        
+        // wrap the longitude
+        t = ( newlon - wraplon )/fc;
+        t = ( t > tmax ) ? tmax : t;
+        t = ( t < -tmax ) ? -tmax : t;
+        k = static_cast<int>( t );
+        k = ( t < k ) ? k - 1 : k;
+        newlon = newlon - k*fc;
+        t = newlon - fc;
+        newlon = ( newlon >= wraplon + fc ) ? t : newlon;
+        t = newlon + fc;
+        newlon = ( newlon < wraplon ) ? t : newlon;
+        
+        badpos = ! ( ( ABS(newlat) + ( newlon - newlon ) ) <= 90.0 );
+        
+        olon[i] = newlon;
+        olat[i] = newlat;
+        f = badpos ? 3 : 1;
+        f = special ? 2 : f;
+        flag[i] = ok ? f : 0;
+    }
+}
+
+// the distance kernel (Vincenty's formula, as in distance())
+template <int FAST>
+static void nav_distance_batch( int n, const real *lon1, const real *lat1, const real *lon2, const real *lat2
+                              , real r, real *d )
+{
+    real clat1, slat1, clat2, slat2, cdlon, sdlon;
+    real a, b;
+    
+    for ( int i=0; i<n; i++ ) {
+        nav_sincos<FAST>( (lon2[i] - lon1[i])*RCONV, sdlon, cdlon );
+        nav_sincos<FAST>( lat1[i]*RCONV, slat1, clat1 );
+        nav_sincos<FAST>( lat2[i]*RCONV, slat2, clat2 );
+        
+        a = SQRT( (clat2*sdlon)*(clat2*sdlon) 
+                + (clat1*slat2-slat1*clat2*cdlon)*(clat1*slat2-slat1*clat2*cdlon)  );
+        b = slat1*slat2 + clat1*clat2*cdlon;
+        
+        d[i] = nav_atan2<FAST>( a, b ) * r;
+    }
+}
+
+// the bearing kernel (as in bearing(), with the special cases selected rather than branched to)
+template <int FAST>
+static void nav_bearing_batch( int n, const real *lon1, const real *lat1, const real *lon2, const real *lat2
+                             , real *bear )
+{
+    const real one = 1.0;
+    const real halfpi = PI/2.0;
+    real slat1, clat1, slat2, clat2, slons, clons;
+    real result;
+    bool atpole, antipode;
+    
+    for ( int i=0; i<n; i++ ) {
+        nav_sincos<FAST>( lat1[i]*RCONV, slat1, clat1 );
+        nav_sincos<FAST>( lat2[i]*RCONV, slat2, clat2 );
+        nav_sincos<FAST>( (lon2[i] - lon1[i])*RCONV, slons, clons );
+        
+        atpole = ! ( ABS(clat2) > 1e-15 );
+        antipode = ! ( ( clons < -1.0 ) | ( lat1[i] != -lat2[i] ) );
+        clat2 = atpole ? one : clat2;
+        
+        result = nav_atan2<FAST>( slons, (clat1*slat2/clat2 - slat1*clons ) );
+        result = antipode ? halfpi : result;
+        result = atpole ? ( ( slat2 > 0 ) ? PI : -PI ) : result;
+        
+        bear[i] = result/RCONV;
+    }
+}
+
+// the vRelocate kernel (for the conformal adjustment)
+template <int FAST>
+static void nav_vrelocate_batch( int n, const real *newlon, const real *newlat, const real *lon0, const real *lat0
+                               , real polar_lat, real *u, real *v )
+{
+    real dlon, cosDlon, sinDlon;
+    real ui, vi, tmp_u, tmp_v;
+    real alat0, alat;
+    bool polar;
+    int npolar;
+    
+    // most of the time, none of the points are near a pole
+    npolar = 0;
+    for ( int i=0; i<n; i++ ) {
+        alat0 = ABS( lat0[i] );
+        alat = ABS( newlat[i] );
+        alat = ( alat0 > alat ) ? alat0 : alat;
+        npolar += ( alat >= polar_lat ) ? 1 : 0;
+    }
+    if ( npolar == 0 ) {
+       return;
+    }
+    
+    for ( int i=0; i<n; i++ ) {
+        alat0 = ABS( lat0[i] );
+        alat = ABS( newlat[i] );
+        alat = ( alat0 > alat ) ? alat0 : alat;
+        polar = ( alat >= polar_lat );
+        
+        dlon = (newlon[i] - lon0[i])*RCONV;
+        dlon = ( lat0[i] < 0.0 ) ? -dlon : dlon;
+        nav_sincos<FAST>( dlon, sinDlon, cosDlon );
+        
+        ui = u[i];
+        vi = v[i];
+        tmp_u = ui*cosDlon - vi*sinDlon;
+        tmp_v = ui*sinDlon + vi*cosDlon;
+        
+        u[i] = polar ? tmp_u : ui;
+        v[i] = polar ? tmp_v : vi;
+    }
+}
+
+
 PlanetSphereNav :: PlanetSphereNav() : PlanetNav()
 {
    polar_lat = POLAR_LIMIT;
+   vecmode = 0;
 }
 
 
@@ -47,6 +387,16 @@ real PlanetSphereNav :: polar_limit()
      return polar_lat;
 }
 
+void PlanetSphereNav :: vectorized( int mode )
+{
+     vecmode = mode;
+}
+
+int PlanetSphereNav :: vectorized() const
+{
+     return vecmode;
+}
+
 void PlanetSphereNav :: deltaxy( real *longitude, real *latitude, real deltax, real deltay, real factor, int approx )
 {
 
@@ -60,7 +410,9 @@ void PlanetSphereNav :: deltaxy( int n, real *longitudes, real *latitudes, const
       approx = quality;
    }
    
-   if ( approx == 0 ) {
+   if ( vecmode > 0 && approx <= 0 ) {
+      deltaxy_batch( n, longitudes, latitudes, deltax, deltay, factor);
+   } else if ( approx == 0 ) {
       deltaxy_approx( n, longitudes, latitudes, deltax, deltay, factor);
    } else if ( approx < 0 ) {
       deltaxy_exact( n, longitudes, latitudes, deltax, deltay, factor);   
@@ -504,6 +856,14 @@ void PlanetSphereNav :: distance( int n, const real *lon1, const real *lat1, con
          http://en.wikipedia.org/wiki/Great-circle_distance
     */
    
+    if ( vecmode == 1 ) {
+       nav_distance_batch<0>( n, lon1, lat1, lon2, lat2, r, d );
+       return;
+    } else if ( vecmode > 1 ) {
+       nav_distance_batch<1>( n, lon1, lat1, lon2, lat2, r, d );
+       return;
+    }
+    
     for ( int i=0; i<n; i++ ) { 
     
         cdlon = COS( (lon2[i] - lon1[i])*RCONV );
@@ -579,6 +939,19 @@ real PlanetSphereNav :: bearing( real lon1, real lat1, real lon2, real lat2)
     return result/RCONV;
 
 }
+
+void PlanetSphereNav :: bearing( int n, const real *lon1, const real *lat1, const real *lon2, const real *lat2, real *b)
+{
+    if ( vecmode == 1 ) {
+       nav_bearing_batch<0>( n, lon1, lat1, lon2, lat2, b );
+    } else if ( vecmode > 1 ) {
+       nav_bearing_batch<1>( n, lon1, lat1, lon2, lat2, b );
+    } else {
+       for ( int i=0; i<n; i++ ) {
+           b[i] = PlanetSphereNav::bearing( lon1[i], lat1[i], lon2[i], lat2[i] );
+       }
+    }
+}
   
 void PlanetSphereNav :: displace( const real clon, const real clat, const real d, const real bearing, real &lon, real &lat )
 {
@@ -721,7 +1094,13 @@ void PlanetSphereNav :: vRelocate( int n, const real *newlon, const real *newlat
      }
      
      if ( confml == 1 ) { 
-        if ( approx == 0 ) {
+        if ( vecmode > 0 && approx <= 0 ) {
+           if ( vecmode == 1 ) {
+              nav_vrelocate_batch<0>( n, newlon, newlat, lon0, lat0, polar_lat, u, v );
+           } else {
+              nav_vrelocate_batch<1>( n, newlon, newlat, lon0, lat0, polar_lat, u, v );
+           }
+        } else if ( approx == 0 ) {
            for ( int i=0; i<n; i++ ) {
               // we apply the transform only if we are within 15 degrees latitude of the pole
               if ( lat0[i] >= polar_lat || lat0[i] <= -polar_lat || newlat[i] >= polar_lat || newlat[i] <= -polar_lat ) {
@@ -794,3 +1173,51 @@ void PlanetSphereNav :: vRelocate( int n, const real *newlon, const real *newlat
      }
 
 }
+
+void PlanetSphereNav :: deltaxy_batch( int n, real *longitudes, real *latitudes, const real *deltax, const real *deltay, real factor) 
+{
+   real olon[NAVBLOCK];
+   real olat[NAVBLOCK];
+   int flag[NAVBLOCK];
+   real wlon;
+   int m;
+   int j;
+   
+   wlon = wrappingLongitude();
+   
+   for ( int i0=0; i0<n; i0 += NAVBLOCK ) {
+   
+       m = n - i0;
+       if ( m > NAVBLOCK ) {
+          m = NAVBLOCK;
+       }
+       
+       if ( vecmode == 1 ) {
+          nav_deltaxy_block<0>( m, longitudes + i0, latitudes + i0, deltax + i0, deltay + i0
+                              , r, factor, wlon, olon, olat, flag );
+       } else {
+          nav_deltaxy_block<1>( m, longitudes + i0, latitudes + i0, deltax + i0, deltay + i0
+                              , r, factor, wlon, olon, olat, flag );
+       }
+       
+       // finish up, in order, so that a bad position 
+       // throws at the same point as it would in deltaxy_exact()
+       for ( int i=0; i<m; i++ ) {
+           j = i0 + i;
+           switch ( flag[i] ) {
+           case 1:
+              longitudes[j] = olon[i];
+              latitudes[j] = olat[i];
+              break;
+           case 2:
+              deltaxy_exact( 1, longitudes + j, latitudes + j, deltax + j, deltay + j, factor );
+              break;
+           case 3:
+              checkpos( olon[i], olat[i] );
+              longitudes[j] = olon[i];
+              latitudes[j] = olat[i];
+              break;
+           }
+       }
+   }
+}
@@ -60,6 +60,11 @@ int ProcessGrp::size() const
     return num_procs;
 };
 
+int ProcessGrp::pending( int tag ) const
+{
+    return 0;
+};
+
 ProcessGrp::ProcessRole ProcessGrp::type() const
 {
    return role;
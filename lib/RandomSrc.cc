@@ -34,7 +34,7 @@ RandomSrc::RandomSrc()
     
     saw = genSeed();
     
-    srand(saw);
+    seed(&saw);
     
 };
 
@@ -42,7 +42,7 @@ RandomSrc::RandomSrc( unsigned int saw )
 {
    rdev = "/dev/random";
     
-   srand(saw);
+   seed(&saw);
 }
 
 RandomSrc::RandomSrc( const std::string dev )
@@ -53,7 +53,7 @@ RandomSrc::RandomSrc( const std::string dev )
     
     saw = genSeed();
     
-    srand(saw);
+    seed(&saw);
 
 }
 
@@ -63,22 +63,99 @@ RandomSrc::~RandomSrc() {
 }
 
 
+void RandomSrc::philox( const uint32_t* ctr, uint32_t k0, uint32_t k1, uint32_t* out )
+{
+    // multipliers and key increments from Salmon et al. (2011), 
+    // "Parallel random numbers: as easy as 1, 2, 3"
+    const uint64_t M0 = 0xD2511F53;
+    const uint64_t M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9;
+    const uint32_t W1 = 0xBB67AE85;
+    uint32_t x0, x1, x2, x3;
+    uint64_t p0, p1;
+    
+    x0 = ctr[0];
+    x1 = ctr[1];
+    x2 = ctr[2];
+    x3 = ctr[3];
+    
+    for ( int round=0; round<10; round++ ) {
+        p0 = M0 * x0;
+        p1 = M1 * x2;
+        x0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+        x2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+        x1 = (uint32_t)p1;
+        x3 = (uint32_t)p0;
+        k0 += W0;
+        k1 += W1;
+    }
+    
+    out[0] = x0;
+    out[1] = x1;
+    out[2] = x2;
+    out[3] = x3;
+
+}
+
+uint32_t RandomSrc::next()
+{
+    uint32_t c[4];
+    
+    if ( nbuf <= 0 ) {
+       // sequential draws use counter words 2 and 3 set to all ones,
+       // so that they never coincide with the per-item blocks of uniform4()
+       c[0] = (uint32_t) ctr;
+       c[1] = (uint32_t)( ctr >> 32 );
+       c[2] = 0xFFFFFFFF;
+       c[3] = 0xFFFFFFFF;
+       philox( c, key, 0, buf );
+       ctr++;
+       nbuf = 4;
+    }
+    nbuf--;
+    
+    return buf[nbuf];
+}
+
 real RandomSrc::uniform( real min, real max ) 
 {
     real result;
     
-    
-    result = (real)(rand() % 32768)/32767.0;
+    result = (real)( next() )/4294967295.0;
     result = result * (max-min) + min;
 
     return result;
 }       
 
+void RandomSrc::uniform4( unsigned long index, real* vals ) const
+{
+    uint32_t c[4];
+    uint32_t out[4];
+    uint64_t idx;
+
+    idx = index;    
+    c[0] = (uint32_t) idx;
+    c[1] = (uint32_t)( idx >> 32 );
+    c[2] = 0;
+    c[3] = 0;
+    philox( c, key, 0, out );
+    
+    for ( int i=0; i<4; i++ ) {
+        vals[i] = (real)( out[i] )/4294967295.0;
+    }
+}
+
 int RandomSrc::raw()
 {
-   return rand();
+   // (non-negative, as from rand())
+   return (int)( next() >> 1 );
 }   
 
+unsigned int RandomSrc::getSeed() const
+{
+    return key;
+}    
+
 unsigned int RandomSrc::genSeed()
 {
     unsigned int saw;
@@ -121,7 +198,9 @@ void RandomSrc::seed( const unsigned int *saw )
         saw2 = *saw;
      }   
 
-     srand(saw2);
+     key = saw2;
+     ctr = 0;
+     nbuf = 0;
 
 }
 
@@ -0,0 +1,508 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include "gigatraj/ShmCache.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <iostream>
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <signal.h>
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+using namespace gigatraj;
+
+
+// the prefix of the names of our shared memory segments
+static const char* shm_prefix = "/gigatraj.";
+
+// counts the shared memory segments made by this process, so that each gets its own name
+static unsigned long shm_count = 0;
+#ifdef USE_THREADS
+static pthread_mutex_t shm_count_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// how long to wait for the other end of a socket to respond, in seconds
+static const int sock_wait = 10;
+
+// set by a signal handler to tell the server to stop
+static volatile sig_atomic_t shm_stop = 0;
+
+static void shm_onsignal( int sig )
+{
+    shm_stop = 1;
+}
+
+// sets up a Unix-domain socket address
+static bool shm_address( const std::string& name, struct sockaddr_un* addr )
+{
+    memset( addr, 0, sizeof(struct sockaddr_un) );
+    addr->sun_family = AF_UNIX;
+    if ( name.size() >= sizeof(addr->sun_path) ) {
+       return false;
+    }
+    strncpy( addr->sun_path, name.c_str(), sizeof(addr->sun_path) - 1 );
+    return true;
+}
+
+// sets the time a socket waits for the other end
+static void shm_timeout( int fd )
+{
+    struct timeval tv;
+    
+    tv.tv_sec = sock_wait;
+    tv.tv_usec = 0;
+    setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+    setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) );
+}
+
+// writes a line of text to a socket
+static bool shm_send( int fd, const std::string& line )
+{
+    std::string msg;
+    size_t done;
+    ssize_t n;
+    int flags = 0;
+    
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    
+    msg = line + "\n";
+    done = 0;
+    while ( done < msg.size() ) {
+       n = send( fd, msg.data() + done, msg.size() - done, flags );
+       if ( n < 0 && errno == EINTR ) {
+          continue;
+       }
+       if ( n <= 0 ) {
+          return false;
+       }
+       done += n;
+    }
+    return true;
+}
+
+// reads a line of text from a socket
+static bool shm_recv( int fd, std::string& line )
+{
+    char c;
+    ssize_t n;
+    
+    line = "";
+    while ( true ) {
+       n = recv( fd, &c, 1, 0 );
+       if ( n < 0 && errno == EINTR ) {
+          continue;
+       }
+       if ( n <= 0 ) {
+          return false;
+       }
+       if ( c == '\n' ) {
+          break;
+       }
+       line.push_back( c );
+    }
+    return true;
+}
+
+
+
+ShmCache::ShmCache( const std::string& sockname )
+{
+    sock = sockname;
+    total = 0;
+    tick = 0;
+    nhits = 0;
+    nmisses = 0;
+    dbug = 0;
+}
+
+ShmCache::~ShmCache()
+{
+    clear();
+}
+
+std::string ShmCache::socketName() const
+{
+    return sock;
+}
+
+bool ShmCache::ask( const std::string& request, std::string& reply )
+{
+    struct sockaddr_un addr;
+    int fd;
+    bool ok;
+    
+    reply = "";
+    
+    if ( ! shm_address( sock, &addr ) ) {
+       return false;
+    }
+    
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 ) {
+       return false;
+    }
+    shm_timeout( fd );
+    
+    ok = ( connect( fd, (struct sockaddr*) &addr, sizeof(addr) ) == 0 );
+    if ( ok ) {
+       ok = shm_send( fd, request ) && shm_recv( fd, reply );
+    } else {
+       if ( dbug > 0 ) {
+          std::cerr << "ShmCache::ask: cannot reach the server at " << sock << std::endl;
+       }
+    }
+    close( fd );
+    
+    return ok;
+}
+
+const char* ShmCache::attach( const std::string& key, size_t& size )
+{
+    std::string reply;
+    std::string word;
+    std::string shmname;
+    struct stat info;
+    void* data;
+    int fd;
+    
+    size = 0;
+    
+    if ( ! ask( "GET " + key, reply ) ) {
+       return NULLPTR;
+    }
+    
+    std::istringstream ss( reply );
+    ss >> word >> shmname >> size;
+    if ( word != "HIT" || size == 0 ) {
+       size = 0;
+       return NULLPTR;
+    }
+    
+    // (the server may drop the segment at any time; if it already has, this fails)
+    fd = shm_open( shmname.c_str(), O_RDONLY, 0 );
+    if ( fd < 0 ) {
+       size = 0;
+       return NULLPTR;
+    }
+    data = MAP_FAILED;
+    if ( fstat( fd, &info ) == 0 && static_cast<size_t>(info.st_size) >= size ) {
+       data = mmap( NULLPTR, size, PROT_READ, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+    if ( data == MAP_FAILED ) {
+       size = 0;
+       return NULLPTR;
+    }
+
+    if ( dbug > 1 ) {
+       std::cerr << "ShmCache::attach: attached to " << key << " in " << shmname << std::endl;
+    }
+    
+    return static_cast<const char*>(data);
+}
+
+void ShmCache::detach( const char* data, size_t size )
+{
+    if ( data != NULLPTR ) {
+       munmap( const_cast<char*>(data), size );
+    }
+}
+
+bool ShmCache::put( const std::string& key, const std::string& data )
+{
+    std::ostringstream name;
+    std::ostringstream request;
+    std::string reply;
+    void* mem;
+    int fd;
+    unsigned long serial;
+    
+    if ( data.size() == 0 || key.find('\n') != std::string::npos ) {
+       return false;
+    }
+    
+#ifdef USE_THREADS
+    pthread_mutex_lock( &shm_count_lock );
+#endif
+    serial = shm_count++;
+#ifdef USE_THREADS
+    pthread_mutex_unlock( &shm_count_lock );
+#endif
+    
+    // a name that no other process (or other put() in this process) will use
+    // (the time guards against a segment left behind by an earlier process with our pid)
+    name << shm_prefix << getpid() << "." << time(NULLPTR) << "." << serial;
+    
+    fd = shm_open( name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+    if ( fd < 0 ) {
+       return false;
+    }
+    mem = MAP_FAILED;
+    if ( ftruncate( fd, data.size() ) == 0 ) {
+       mem = mmap( NULLPTR, data.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+    if ( mem == MAP_FAILED ) {
+       shm_unlink( name.str().c_str() );
+       return false;
+    }
+    memcpy( mem, data.data(), data.size() );
+    munmap( mem, data.size() );
+    
+    // hand the segment over to the server
+    request << "PUT " << name.str() << " " << data.size() << " " << key;
+    if ( ask( request.str(), reply ) && reply == "OK" ) {
+       if ( dbug > 1 ) {
+          std::cerr << "ShmCache::put: gave " << key << " to the server in " << name.str() << std::endl;
+       }
+       return true;
+    }
+    
+    // the server did not take it, so it is still ours
+    shm_unlink( name.str().c_str() );
+    return false;
+}
+
+bool ShmCache::stats( long& nitems, size_t& bytes, long& hits, long& misses )
+{
+    std::string reply;
+    std::string word;
+    
+    nitems = 0;
+    bytes = 0;
+    hits = 0;
+    misses = 0;
+    
+    if ( ! ask( "STAT", reply ) ) {
+       return false;
+    }
+    std::istringstream ss( reply );
+    ss >> word >> nitems >> bytes >> hits >> misses;
+    
+    return ( word == "STAT" );
+}
+
+bool ShmCache::shutdown()
+{
+    std::string reply;
+    
+    return ( ask( "QUIT", reply ) && reply == "OK" );
+}
+
+void ShmCache::serve( size_t budget )
+{
+    struct sockaddr_un addr;
+    struct sigaction act;
+    struct sigaction oldint;
+    struct sigaction oldterm;
+    struct sigaction oldpipe;
+    std::string request;
+    std::string reply;
+    int fd;
+    int client;
+    bool done;
+    
+    if ( ! shm_address( sock, &addr ) ) {
+       throw (badSocket());
+    }
+    
+    // is another server already using this socket?
+    if ( ask( "STAT", reply ) ) {
+       throw (badSocket());
+    }
+    // if not, then any socket file is left over from a server that has gone
+    unlink( sock.c_str() );
+    
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 ) {
+       throw (badSocket());
+    }
+    if ( bind( fd, (struct sockaddr*) &addr, sizeof(addr) ) != 0 
+      || listen( fd, 16 ) != 0 ) {
+       close( fd );
+       throw (badSocket());
+    }
+    
+    // stop cleanly on SIGINT or SIGTERM.
+    // (no SA_RESTART, so that a signal interrupts accept())
+    memset( &act, 0, sizeof(act) );
+    act.sa_handler = shm_onsignal;
+    sigemptyset( &act.sa_mask );
+    act.sa_flags = 0;
+    sigaction( SIGINT, &act, &oldint );
+    sigaction( SIGTERM, &act, &oldterm );
+    // and do not die if a client goes away before it gets its reply
+    act.sa_handler = SIG_IGN;
+    sigaction( SIGPIPE, &act, &oldpipe );
+    shm_stop = 0;
+    
+    if ( dbug > 0 ) {
+       std::cerr << "ShmCache::serve: serving on " << sock << std::endl;
+    }
+    
+    done = false;
+    while ( ! done && ! shm_stop ) {
+       client = accept( fd, NULLPTR, NULLPTR );
+       if ( client < 0 ) {
+          // (interrupted, or a client that gave up)
+          continue;
+       }
+       shm_timeout( client );
+       if ( shm_recv( client, request ) ) {
+          reply = answer( request, budget );
+          shm_send( client, reply );
+          done = ( request == "QUIT" );
+       }
+       close( client );
+    }
+    
+    close( fd );
+    unlink( sock.c_str() );
+    clear();
+    
+    sigaction( SIGINT, &oldint, NULLPTR );
+    sigaction( SIGTERM, &oldterm, NULLPTR );
+    sigaction( SIGPIPE, &oldpipe, NULLPTR );
+
+    if ( dbug > 0 ) {
+       std::cerr << "ShmCache::serve: done serving on " << sock << ": " 
+                 << nhits << " hits, " << nmisses << " misses" << std::endl;
+    }
+    
+}
+
+std::string ShmCache::answer( const std::string& request, size_t budget )
+{
+    std::map<std::string, Item>::iterator it;
+    std::ostringstream reply;
+    std::string cmd;
+    std::string key;
+    Item item;
+    size_t pos;
+    
+    pos = request.find(' ');
+    cmd = request.substr( 0, pos );
+    
+    if ( cmd == "GET" && pos != std::string::npos ) {
+       key = request.substr( pos + 1 );
+       it = items.find( key );
+       if ( it != items.end() ) {
+          tick++;
+          (*it).second.used = tick;
+          nhits++;
+          reply << "HIT " << (*it).second.shmname << " " << (*it).second.size;
+       } else {
+          nmisses++;
+          reply << "MISS";
+       }
+    } else if ( cmd == "PUT" && pos != std::string::npos ) {
+       // PUT shmname size key
+       item.size = 0;
+       std::istringstream ss( request.substr( pos + 1 ) );
+       ss >> item.shmname >> item.size;
+       ss.get();
+       std::getline( ss, key );
+       if ( item.shmname.compare( 0, strlen(shm_prefix), shm_prefix ) != 0 
+         || item.shmname.find( '/', 1 ) != std::string::npos 
+         || item.size == 0 || key == "" ) {
+          reply << "ERR";
+       } else if ( items.find( key ) != items.end() ) {
+          // someone else got there first
+          reply << "HAVE";
+       } else {
+          tick++;
+          item.used = tick;
+          items[key] = item;
+          total += item.size;
+          if ( dbug > 1 ) {
+             std::cerr << "ShmCache::answer: now holding " << key << " in " << item.shmname << std::endl;
+          }
+          trim( budget );
+          reply << "OK";
+       }
+    } else if ( cmd == "STAT" ) {
+       reply << "STAT " << items.size() << " " << total << " " << nhits << " " << nmisses;
+    } else if ( cmd == "QUIT" ) {
+       reply << "OK";
+    } else {
+       reply << "ERR";
+    }
+    
+    return reply.str();
+}
+
+void ShmCache::trim( size_t budget )
+{
+    std::map<std::string, Item>::iterator it;
+    std::map<std::string, Item>::iterator oldest;
+    
+    if ( budget == 0 ) {
+       return;
+    }
+    
+    while ( total > budget && items.size() > 0 ) {
+       oldest = items.begin();
+       for ( it = items.begin(); it != items.end(); it++ ) {
+          if ( (*it).second.used < (*oldest).second.used ) {
+             oldest = it;
+          }
+       }
+       if ( dbug > 1 ) {
+          std::cerr << "ShmCache::trim: dropping " << (*oldest).first << std::endl;
+       }
+       // (clients still attached to the segment keep their mapping)
+       shm_unlink( (*oldest).second.shmname.c_str() );
+       total -= (*oldest).second.size;
+       items.erase( oldest );
+    }
+}
+
+void ShmCache::clear()
+{
+    std::map<std::string, Item>::iterator it;
+    
+    for ( it = items.begin(); it != items.end(); it++ ) {
+       shm_unlink( (*it).second.shmname.c_str() );
+    }
+    items.clear();
+    total = 0;
+}
+
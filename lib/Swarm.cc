@@ -18,13 +18,112 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <math.h>
 #include <iostream>
+#include <algorithm>
 
 #include "gigatraj/Swarm.hh"
 #include "gigatraj/SerialGrp.hh"
+#include "gigatraj/Instrument.hh"
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
 
 using namespace gigatraj;
 
+#ifdef USE_THREADS
+
+// the blocks of parcels that one thread of the pool has yet to trace
+struct SwarmBlocks {
+    // the next block to be traced
+    int next;
+    // one past the last block to be traced
+    int end;
+    pthread_mutex_t lock;
+};
+
+// what each thread of the pool is to do
+struct SwarmWork {
+    Swarm* swarm;
+    // the block ranges of all the threads, and which one is this thread's
+    SwarmBlocks* ranges;
+    int nranges;
+    int me;
+    // the number of parcels to be traced, in blocks of blk parcels
+    int num;
+    int blk;
+    double tyme;
+    double dt;
+};
+
+// takes the next block for a thread to trace, stealing one if need be
+static bool nextBlock( SwarmWork* work, int& b )
+{
+    SwarmBlocks* mine;
+    SwarmBlocks* victim;
+    int most;
+    int left;
+    int take;
+    int end;
+    
+    mine = &(work->ranges[work->me]);
+    
+    pthread_mutex_lock( &(mine->lock) );
+    if ( mine->next < mine->end ) {
+       b = mine->next;
+       mine->next++;
+       pthread_mutex_unlock( &(mine->lock) );
+       return true;
+    }
+    pthread_mutex_unlock( &(mine->lock) );
+    
+    // our own share is done, so take half of the largest remaining share.
+    // (No thread ever holds more than one of the locks at a time.)
+    while ( true ) {
+       victim = NULLPTR;
+       most = 0;
+       for ( int r=0; r < work->nranges; r++ ) {
+           if ( r != work->me ) {
+              pthread_mutex_lock( &(work->ranges[r].lock) );
+              left = work->ranges[r].end - work->ranges[r].next;
+              pthread_mutex_unlock( &(work->ranges[r].lock) );
+              if ( left > most ) {
+                 most = left;
+                 victim = &(work->ranges[r]);
+              }
+           }
+       }
+       if ( victim == NULLPTR ) {
+          // nothing left anywhere
+          return false;
+       }
+       
+       pthread_mutex_lock( &(victim->lock) );
+       left = victim->end - victim->next;
+       if ( left > 0 ) {
+          // take the upper half, which the victim would get to last
+          take = ( left + 1 )/2;
+          end = victim->end;
+          victim->end = end - take;
+          pthread_mutex_unlock( &(victim->lock) );
+          
+          pthread_mutex_lock( &(mine->lock) );
+          mine->next = end - take;
+          mine->end = end;
+          b = mine->next;
+          mine->next++;
+          pthread_mutex_unlock( &(mine->lock) );
+          
+          return true;
+       }
+       // someone else got there first; look again
+       pthread_mutex_unlock( &(victim->lock) );
+    }
+}
+
+#endif
+
 
 
 Swarm::Swarm( int n )
@@ -46,6 +145,7 @@ Swarm::Swarm( int n )
    flagsets = NULLPTR;
    statuses = NULLPTR;
    ids = NULLPTR;
+   gids = NULLPTR;
    
    sample_p = NULLPTR;
    
@@ -57,7 +157,7 @@ Swarm::Swarm( int n )
       // we will do serial processing
       pg = new SerialGrp();
    
-      this->setup(p,pg,n,0);
+      this->setup(p,pg,n,0,1);
 
    } else {
       throw (badparcelcount());
@@ -68,7 +168,7 @@ Swarm::Swarm( int n )
 
 
      
-Swarm::Swarm( ProcessGrp *pgrp, int n, int r)
+Swarm::Swarm( ProcessGrp *pgrp, int n, int r, int s)
 {
    int i;
    Parcel p;
@@ -86,6 +186,7 @@ Swarm::Swarm( ProcessGrp *pgrp, int n, int r)
    flagsets = NULLPTR;
    statuses = NULLPTR;
    ids = NULLPTR;
+   gids = NULLPTR;
    
    sample_p = NULLPTR;
    
@@ -103,7 +204,7 @@ Swarm::Swarm( ProcessGrp *pgrp, int n, int r)
          pg = new SerialGrp();
       }   
 
-      this->setup(p,pg,n,r);
+      this->setup(p,pg,n,r,s);
 
    } else {
       throw (badparcelcount());
@@ -130,6 +231,7 @@ Swarm::Swarm( const Parcel &p, int n)
    flagsets = NULLPTR;
    statuses = NULLPTR;
    ids = NULLPTR;
+   gids = NULLPTR;
    
    sample_p = NULLPTR;
    
@@ -141,7 +243,7 @@ Swarm::Swarm( const Parcel &p, int n)
       // No processor group was given, so we will do serial processing
       pg = new SerialGrp();
    
-      this->setup(p,pg,n,0);
+      this->setup(p,pg,n,0,1);
 
    } else {
       throw (badparcelcount());
@@ -150,7 +252,7 @@ Swarm::Swarm( const Parcel &p, int n)
 
 };
 
-Swarm::Swarm( const Parcel &p, ProcessGrp* pgrp, int n, int r)
+Swarm::Swarm( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s)
 {
     ProcessGrp* pg;
 
@@ -166,6 +268,7 @@ Swarm::Swarm( const Parcel &p, ProcessGrp* pgrp, int n, int r)
     flagsets = NULLPTR;
     statuses = NULLPTR;
    ids = NULLPTR;
+   gids = NULLPTR;
    
    sample_p = NULLPTR;
    
@@ -181,7 +284,7 @@ Swarm::Swarm( const Parcel &p, ProcessGrp* pgrp, int n, int r)
        pg = new SerialGrp();
     }   
 
-    this->setup(p,pg,n,r);
+    this->setup(p,pg,n,r,s);
 }
 
 std::string Swarm::make_proc_id ( const std::string& tag, int i ) const
@@ -219,7 +322,7 @@ std::string Swarm::make_proc_id ( const std::string& tag, int i ) const
 }
 
 // this is an internal function used by constructors to set up and initialize the Swarm 
-void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
+void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r, int s)
 {
    // the number of processors in this group
    int numprocs;
@@ -279,6 +382,8 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
    int my_root;
    // subprocessor id
    std::string subproctag;
+   // subgroup ranks of the met-handlers, if met requests are sharded
+   std::vector<int> shards;
 
 
    /* and get the navigation, met source, and integration objects */
@@ -292,6 +397,19 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
    sample_p = p.copy();
 
    blocksize = 0;
+   nthreads = 1;
+   threadblk = 0;
+   
+   rebal_every = 0;
+   rebal_count = 0;
+   reorder_every = 0;
+   reorder_count = 0;
+   rebal_moved = 0;
+   load_imbalance = 0.0;
+   domain_mode = SWARM_DOMAIN_NONE;
+   domain_every = 1;
+   domain_count = 0;
+   domain_rows = 1;
    
    pgroup = pgrp;
       
@@ -339,29 +457,42 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
    //- std::cerr << "New Swarm: r = " << r << std::endl;
    if ( r > 0 && numprocs > 1 ) {
    
+      // we need at least one met processor per (sub)group,
+      // and at least one tracing processor
+      if ( s < 1 ) {
+         s = 1;
+      }
+      if ( s > (numprocs - 1) ) {
+         s = numprocs - 1;
+      }
+   
       // Cap the number of tracing processors (approx. r) 
-      // at the number of total procrssors, minus one 
-      // for a met processor.
-      if ( r > (numprocs - 1) ) {
-         r = numprocs - 1;
+      // at the number of total procrssors, minus the 
+      // met processors.
+      if ( r > (numprocs - s) ) {
+         r = numprocs - s;
       }
    
       // At the Swarm level, the pgroup is set to be a coordinator
       pgrp->setType( -1, ProcessGrp::PGrpRole_Coordinator);
 
+      // for EACH set of s met-handler processes, 
+      // we will set up one (sub)group of parcel-tracing processors
+      num_groups = numprocs / (r+s);
+      if ( num_groups < 1 ) {
+         num_groups = 1;
+      }
+
       // figure out how many processors to devote to met-handling
-      num_metprocs = numprocs / (r+1);
+      num_metprocs = num_groups * s;
 
       // how many processors are to be devoted to tracing parcels?
       num_traceprocs = numprocs - num_metprocs;
-   
-      // for EACH met-handler process, 
-      // we will set up one (sub)group of parcel-tracing processors
-      num_groups = num_metprocs ;
        
    } else {
       // every procesor will do its own met handling
       // so there will be just the one (sub)group of parcel-tracing processors
+      s = 0;
       num_metprocs = 0;
       num_traceprocs = numprocs;
       num_groups = 1;
@@ -376,9 +507,9 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
       normal_group_size = num_traceprocs / num_groups;
       // will there be any processors left over?
       extra_procs = num_traceprocs - normal_group_size * num_groups;
-      // add one for the met processors, since each (sub)group
-      // consists of one met-handler and one-or-more parcel-tracers
-      normal_group_size++;
+      // add the met processors, since each (sub)group
+      // consists of s met-handlers and one-or-more parcel-tracers
+      normal_group_size = normal_group_size + s;
       // what is the max size (number of procs) of one of our process-tracing (sub)groups?
       max_group_size = normal_group_size;
       if ( extra_procs > 0 ) {
@@ -533,8 +664,10 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           if ( num_metprocs > 0 ) {
              // the first (sub)group: the rank-1 processor is the met-handler,
              // so that the rank-0 processor (which is also the rank-o processor
-             // of the main group "pgroup") can remain a parcel-tracer
-             if ( my_proc_sub == 1 ) {
+             // of the main group "pgroup") can remain a parcel-tracer.
+             // (If the met requests are sharded, then ranks 1 through s are
+             // all met-handlers.)
+             if ( my_proc_sub >= 1 && my_proc_sub <= s ) {
                 new_proc_grp->setType( my_proc_sub, ProcessGrp::PGrpRole_MetReader);
                 my_num_parcels = 0;
                 my_parcel_start = -1;
@@ -581,9 +714,10 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           // if we are not using met handlers, or
           // if the jth processors in this (sub)group is not a met-handler...
           if ( (num_metprocs == 0)
-            || (j!=1)  ) {
+            || (j < 1 || j > s)  ) {
             
             // ...then it must be a parcel-tracer
+            tracers.push_back( grp_proc_list[j] );
             
             // are there parcels left to be allocated?
             if ( parcels_left > 0 ) {
@@ -615,6 +749,7 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
                       flagsets[ip] = p.flagset;
                       statuses[ip] = p.statuses;
                       ids[ip] = ip;
+                      gids[ip] = this_parcel_start + ip;
                   }
                   
                }
@@ -656,6 +791,15 @@ void Swarm::setup( const Parcel &p, ProcessGrp* pgrp, int n, int r)
           }
           
           metsrc->setPgroup( subgroups[i] , my_met );
+          
+          if ( s > 1 ) {
+             // spread the met requests across several met-handlers
+             shards.clear();
+             for ( int is=1; is <= s; is++ ) {
+                 shards.push_back( is );
+             }
+             metsrc->setMetShards( shards );
+          }
 
        }
          
@@ -719,6 +863,9 @@ Swarm::~Swarm()
    if ( ids != NULLPTR ) {
       delete[] ids;
    }
+   if ( gids != NULLPTR ) {
+      delete[] gids;
+   }
    if ( sample_p != NULLPTR ) {
       delete sample_p;
    }
@@ -853,7 +1000,7 @@ int Swarm::iterator::index() const
     if ( my_swarm->my_num_parcels > 0 ) {
        if ( my_parcel >= 0 && my_parcel < my_swarm->my_num_parcels ) {
        
-          result = my_swarm->my_parcel_start + my_swarm->ids[my_parcel];
+          result = my_swarm->global_index( my_parcel );
 
        }
     }
@@ -1063,6 +1210,7 @@ void Swarm::grow( int n )
      ParcelFlag* new_flagsets;
      ParcelStatus* new_statuses;
      int* new_ids;
+     int* new_gids;
      
      if ( n < 0 ) {
         // we only grow. We never shrink.
@@ -1084,6 +1232,7 @@ void Swarm::grow( int n )
         new_flagsets = new ParcelFlag[new_size];
         new_statuses = new ParcelStatus[new_size];   
         new_ids = new int[new_size];
+        new_gids = new int[new_size];
         
         if ( lons != NULLPTR ) {
            
@@ -1096,8 +1245,10 @@ void Swarm::grow( int n )
                new_flagsets[i] = flagsets[i];
                new_statuses[i] = statuses[i];
                new_ids[i]  = ids[i];
+               new_gids[i] = gids[i];
            }
            
+           delete[] gids;
            delete[] ids;
            delete[] statuses;
            delete[] flagsets;
@@ -1117,6 +1268,7 @@ void Swarm::grow( int n )
         flagsets = new_flagsets;
         statuses = new_statuses;
         ids = new_ids;
+        gids = new_gids;
         
         info_size = new_size;
         
@@ -1141,6 +1293,11 @@ int Swarm::belongs( const int n ) const
     if ( n < 0 || n >= num_parcels_total ) {
        throw (badparcelindex());
     }
+    
+    // have parcels been migrated among processors?
+    if ( pclowners.size() > 0 ) {
+       return pclowners[n];
+    }
        
     // which processor owns this parcel?
     proc_idx = 0;
@@ -1157,11 +1314,38 @@ int Swarm::belongs( const int n ) const
     return proc_idx;
 }
 
+int Swarm::global_index( int k ) const
+{
+    if ( pclowners.size() > 0 ) {
+       return gids[ids[k]];
+    }
+    
+    return my_parcel_start + k;
+}
+
+int Swarm::local_index( int n ) const
+{
+    std::map<int,int>::const_iterator loc;
+    int result = -1;
+    
+    if ( pclowners.size() > 0 ) {
+       loc = pcllocal.find( n );
+       if ( loc != pcllocal.end() ) {
+          result = ids[loc->second];
+       }
+    } else {
+       if ( n >= my_parcel_start && n < (my_parcel_start + my_num_parcels) ) {
+          result = ids[n - my_parcel_start];
+       }
+    }
+    
+    return result;
+}
+
 void Swarm::set( const int n,  const Parcel& p, const int mode)
 {
    int idx;
    int proc_idx;
-   int my_parcel_end ;
    std::vector<int>::iterator pits, pite;
    Parcel pcl;
 
@@ -1180,17 +1364,17 @@ void Swarm::set( const int n,  const Parcel& p, const int mode)
    // then if we are the root process, just return the parcel
    // but if we are not the root process, send/receive the parcel
 
-   my_parcel_end = my_parcel_start + my_num_parcels - 1;
-   //- std::cerr << "Swarm::set: this processors handles parcels " 
-   //- << my_parcel_start << " through " << my_parcel_end << std::endl;
+   //- std::cerr << "Swarm::set: this processors handles " 
+   //- << my_num_parcels << " parcels" << std::endl;
    //- std::cerr << "Swarm::set: my root processor is " << pgroup->root_id() << std::endl; 
 
+   // index relative to the start of this processor's parcels
+   idx = local_index( n );
+   
    // does the requested parcel belong to this processor?   
-   if ( n >= my_parcel_start && n <= my_parcel_end ) {
+   if ( idx >= 0 ) {
       //- std::cerr << "Swarm::set:    Parcel " << n << " is MY parcel! (" 
-      //- << my_parcel_start << "-" << my_parcel_end << ")" << std::endl;     
-      // index relative to the start of this processor's parcels
-      idx = ids[n - my_parcel_start];
+      //- << idx << ")" << std::endl;     
       
       if ( pgroup->id() != 0 && mode == 0) {
          // we are not the root process, so we have
@@ -1275,7 +1459,7 @@ Parcel* Swarm::parcel( int n, int flag ) const
       // get it
       
       p = new Parcel;
-      idx = ids[n - my_parcel_start];
+      idx = local_index( n );
       p->lon = lons[idx];
       p->lat = lats[idx];
       p->z   = zs[idx];
@@ -1397,37 +1581,66 @@ void Swarm::add( const Parcel& p, const int mode )
     
     my_rank = pgroup->id();
 
-    // find the process (sub)group that has the fewest Parcels 
-    for ( proc_idx = 0;  proc_idx < pclstarts.size() ; proc_idx++ ) {        
-         num_p = pclends[proc_idx] - pclstarts[proc_idx] + 1;
-         if ( num_p > lowest_pop ) {
-            lowest_pop = num_p;
-            lowest_proc = proc_idx;
-         }
-    }
+    if ( pclowners.size() > 0 ) {
     
-    // found none? Throw an error.
-    if ( lowest_proc < 0 ) {
-       throw (badparcelindex());
-    }
+       // Parcels have been migrated among the processors, so the
+       // contiguous index ranges no longer apply. Simply give the 
+       // new parcel the next index, and hand it to the tracing processor 
+       // that has the fewest Parcels.
+       for ( size_t i=0; i < tracers.size(); i++ ) {
+           proc_idx = tracers[i];
+           if ( lowest_proc < 0 || pclcounts[proc_idx] < lowest_pop ) {
+              lowest_pop = pclcounts[proc_idx];
+              lowest_proc = proc_idx;
+           }
+       }
+       
+       // found none? Throw an error.
+       if ( lowest_proc < 0 ) {
+          throw (badparcelindex());
+       }
+       
+       pclowners.push_back( lowest_proc );
+       pclcounts[lowest_proc]++;
+       if ( my_rank == lowest_proc ) {
+          pcllocal[num_parcels_total] = my_num_parcels;
+          my_num_parcels++;
+       }
     
-    // increment the start and end parcel indices
-    // past this processor's
-    for ( int i=lowest_proc; i<pclstarts.size(); i++) {
-        // increment everybody's scopy of the starting and stopping indices
-        if ( i > 0 && pclstarts[i] >= 0 ) {
-           pclstarts[i]++;
-        }
-        if ( pclends[i] >= 0 ) {
-           pclends[i]++;
-        }
-        // if I am one of the processors whose indices are to be
-        // adjusted, then let's do that now.
-        if ( my_rank == i ) {
-           my_parcel_start = pclstarts[i];
-           // this should be the same as before, except for the lowest_proc processor
-           my_num_parcels = pclends[i] - my_parcel_start + 1;
-        }
+    } else {
+
+       // find the process (sub)group that has the fewest Parcels 
+       for ( proc_idx = 0;  proc_idx < pclstarts.size() ; proc_idx++ ) {        
+            num_p = pclends[proc_idx] - pclstarts[proc_idx] + 1;
+            if ( num_p > lowest_pop ) {
+               lowest_pop = num_p;
+               lowest_proc = proc_idx;
+            }
+       }
+    
+       // found none? Throw an error.
+       if ( lowest_proc < 0 ) {
+          throw (badparcelindex());
+       }
+    
+       // increment the start and end parcel indices
+       // past this processor's
+       for ( int i=lowest_proc; i<pclstarts.size(); i++) {
+           // increment everybody's scopy of the starting and stopping indices
+           if ( i > 0 && pclstarts[i] >= 0 ) {
+              pclstarts[i]++;
+           }
+           if ( pclends[i] >= 0 ) {
+              pclends[i]++;
+           }
+           // if I am one of the processors whose indices are to be
+           // adjusted, then let's do that now.
+           if ( my_rank == i ) {
+              my_parcel_start = pclstarts[i];
+              // this should be the same as before, except for the lowest_proc processor
+              my_num_parcels = pclends[i] - my_parcel_start + 1;
+           }
+       }
     }
     // oh, and increment the total as well
     num_parcels_total++;
@@ -1459,6 +1672,7 @@ void Swarm::add( const Parcel& p, const int mode )
        tgs[idx]      = parcl->tg;
        flagsets[idx] = parcl->flagset;
        statuses[idx] = parcl->statuses;
+       gids[idx]     = num_parcels_total - 1;
 
        delete parcl;
 
@@ -1476,9 +1690,9 @@ void Swarm::add( const Parcel& p, const int mode )
 
 int Swarm::arrange()
 {
-    int i;
-    int last_valid;
-    int nn;
+    int lo;
+    int hi;
+    int* slot_owner;
     real tmplon;
     real tmplat;
     real tmpz;
@@ -1488,57 +1702,70 @@ int Swarm::arrange()
     ParcelStatus tmpstatus;
     double tmptag;
     
-    nn = 0;
+    if ( my_num_parcels <= 0 ) {
+       return 0;
+    }
     
-    for ( last_valid = my_num_parcels - 1; last_valid >= 0; last_valid-- ) {
-        if ( (flagsets[last_valid] == 0) && (statuses[last_valid] == 0) ) {
-           break;
-        }
+    // which local parcel number is stored in each array location?
+    // (we need this to keep the ids array consistent as we move things around)
+    slot_owner = new int[my_num_parcels];
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        slot_owner[ids[k]] = k;
     }
     
-    if ( last_valid >= 0 ) {
-       
-       for ( i=0; i<last_valid; i++ ) {
-           if ( (flagsets[i] != 0) || (statuses[i] != 0) ) {
-              // bad parcel.  Exchange it with the last good parcel
-              tmpid     = ids[i];
-              tmplon    = lons[i];
-              tmplat    = lats[i];
-              tmpz      = zs[i];
-              tmptime   = ts[i];
-              tmptag    = tgs[i];
-              tmpflag   = flagsets[i];
-              tmpstatus = statuses[i];
-
-              ids[i]      = ids[last_valid];
-              lons[i]     = lons[last_valid];
-              lats[i]     = lats[last_valid];
-              zs[i]       = zs[last_valid];
-              ts[i]       = ts[last_valid];
-              tgs[i]      = tgs[last_valid];
-              flagsets[i] = flagsets[last_valid];
-              statuses[i] = statuses[last_valid];
-
-              ids[last_valid]      = tmpid; 
-              lons[last_valid]     = tmplon; 
-              lats[last_valid]     = tmplat;  
-              zs[last_valid]       = tmpz;    
-              ts[last_valid]       = tmptime; 
-              tgs[last_valid]      = tmptag;  
-              flagsets[last_valid] = tmpflag; 
-              statuses[last_valid] = tmpstatus; 
-              
-              last_valid--;
-              
-           } else {
-              nn++;
-           }
+    lo = 0;
+    hi = my_num_parcels - 1;
+    while ( lo <= hi ) {
+        if ( ! ( (flagsets[lo] & NoTrace) || (statuses[lo] & (HitBad | HitBdy)) ) ) {
+           // good parcel. Leave it where it is.
+           lo++;
+        } else if ( (flagsets[hi] & NoTrace) || (statuses[hi] & (HitBad | HitBdy)) ) {
+           // bad parcel, already at the end.
+           hi--;
+        } else {
+           // bad parcel.  Exchange it with the last good parcel
+           tmplon    = lons[lo];
+           tmplat    = lats[lo];
+           tmpz      = zs[lo];
+           tmptime   = ts[lo];
+           tmptag    = tgs[lo];
+           tmpflag   = flagsets[lo];
+           tmpstatus = statuses[lo];
+           tmpid     = gids[lo];
+
+           lons[lo]     = lons[hi];
+           lats[lo]     = lats[hi];
+           zs[lo]       = zs[hi];
+           ts[lo]       = ts[hi];
+           tgs[lo]      = tgs[hi];
+           flagsets[lo] = flagsets[hi];
+           statuses[lo] = statuses[hi];
+           gids[lo]     = gids[hi];
+
+           lons[hi]     = tmplon; 
+           lats[hi]     = tmplat;  
+           zs[hi]       = tmpz;    
+           ts[hi]       = tmptime; 
+           tgs[hi]      = tmptag;  
+           flagsets[hi] = tmpflag; 
+           statuses[hi] = tmpstatus; 
+           gids[hi]     = tmpid;
            
-       }      
-    
+           // the local parcel numbers now point to each other's locations
+           ids[slot_owner[lo]] = hi;
+           ids[slot_owner[hi]] = lo;
+           tmpid = slot_owner[lo];
+           slot_owner[lo] = slot_owner[hi];
+           slot_owner[hi] = tmpid;
+           
+           lo++;
+           hi--;
+        }
     }
     
-    return nn;
+    delete[] slot_owner;
+    
+    return lo;
     
 }
 
@@ -1547,17 +1774,18 @@ int Swarm::advance( double dt )
 
     int i;
     int j;
-    int jj;
     double tyme;
     int nn;
     int num_to_trace;
+    
+    GT_TIMER( advtimer, "Swarm::advance" );
  
     if ( sample_p != NULLPTR ) {
        
        if ( is_met ) {
           //- std::cerr << "Swarm::dadvance: [" << pgroup->id() << "/" << pgroup->group_id() 
           //- << "]:    I am Met-reader" << std::endl;        
-          metsrc->serveMet();
+          metsrc->serveMetStep();
        } else {
 
           int blk = my_num_parcels;
@@ -1565,58 +1793,978 @@ int Swarm::advance( double dt )
              blk = blocksize;
           }
        
-
+          // move the parcels that are not to be traced out of the way
           num_to_trace = arrange();
+          GT_COUNT( "Swarm::advance parcels", num_to_trace );
+          
+          // sort the rest so that the met grids are visited in a cache-friendly order
+          if ( reorder_every > 0 ) {
+             reorder_count++;
+             if ( (reorder_count % reorder_every) == 0 ) {
+                reorder( num_to_trace );
+             }
+          }
        
-          tyme = ts[0];
+          // the model time is that of the parcels that are already being traced
+          tyme = 0.0;
+          if ( my_num_parcels > 0 ) {
+             tyme = ts[0];
+             for ( j=0; j < num_to_trace; j++ ) {
+                 if ( ! (flagsets[j] & SyncTrace) ) {
+                    tyme = ts[j];
+                    break;
+                 }
+             }
+          }
+          
+          // tell the met source where our parcels are, in case it serves sub-blocks
+          // or chooses its vertical levels
+          metsrc->haloRegion( num_to_trace, lons, lats, zs, dt, nav );
+          
+#ifdef USE_THREADS
+          if ( nthreads > 1 && metsrc->threadSafe() && ! metsrc->isMetClient() ) {
+          
+             // trace the parcels in blocks with the thread pool
+             if ( threadblk > 0 ) {
+                blk = threadblk;
+             } else {
+                blk = ( num_to_trace + 4*nthreads - 1 )/( 4*nthreads );
+                if ( blk < 1 ) {
+                   blk = 1;
+                }
+             }
+             int nblocks = ( num_to_trace + blk - 1 )/blk;
+             
+             SwarmBlocks* const ranges = new SwarmBlocks[nthreads];
+             SwarmWork* const works = new SwarmWork[nthreads];
+             pthread_t* const threads = new pthread_t[nthreads];
+             bool* const started = new bool[nthreads];
+             
+             // each thread starts with an equal share of the blocks
+             for ( j=0; j < nthreads; j++ ) {
+                 ranges[j].next = ( j*nblocks )/nthreads;
+                 ranges[j].end = ( (j+1)*nblocks )/nthreads;
+                 pthread_mutex_init( &(ranges[j].lock), NULLPTR );
+                 
+                 works[j].swarm = this;
+                 works[j].ranges = ranges;
+                 works[j].nranges = nthreads;
+                 works[j].me = j;
+                 works[j].num = num_to_trace;
+                 works[j].blk = blk;
+                 works[j].tyme = tyme;
+                 works[j].dt = dt;
+             }
+             
+             metsrc->setThreads( nthreads );
+             integ->setThreads( nthreads );
+             
+             // (if a thread cannot be started, the others will steal its share)
+             for ( j=1; j < nthreads; j++ ) {
+                 started[j] = ( pthread_create( &(threads[j]), NULLPTR, threadWork, &(works[j]) ) == 0 );
+             }
+             threadWork( &(works[0]) );
+             for ( j=1; j < nthreads; j++ ) {
+                 if ( started[j] ) {
+                    pthread_join( threads[j], NULLPTR );
+                 }
+             }
+             
+             integ->setThreads( 1 );
+             metsrc->setThreads( 1 );
+             
+             for ( j=0; j < nthreads; j++ ) {
+                 pthread_mutex_destroy( &(ranges[j].lock) );
+             }
+             delete[] started;
+             delete[] threads;
+             delete[] works;
+             delete[] ranges;
+             
+          } else
+#endif
+          {
+          
+             // 0 = trace, 1 = tracing failed, 2 = do not trace yet
+             int* const traceflags = new int[blk + 1];
+
+             i=0;
+             while ( i < num_to_trace ) {
+                       
+                 nn = blk;
+                 if ( i + nn > num_to_trace ) {
+                    nn = num_to_trace - i;
+                 }   
+                 
+                 traceBlock( i, nn, traceflags, tyme, dt );
+                 
+                 i = i + nn;
+                     
+             }
+             
+             delete[] traceflags;
+          
+          }
+                    
+          metsrc->signalMetStep();
+          
+          if ( domain_mode != SWARM_DOMAIN_NONE ) {
+             domain_count++;
+             if ( (domain_count % domain_every) == 0 ) {
+                decompose( tyme + dt );
+             }
+          }
+          
+          // gather the load statistics (and maybe re-balance) only every so often
+          // (while the parcels are decomposed by domain, they are not re-balanced)
+          if ( rebal_every != 0 ) {
+             rebal_count++;
+             if ( (rebal_count % abs(rebal_every)) == 0 ) {
+                balance( tyme + dt, ( domain_mode == SWARM_DOMAIN_NONE && rebal_every > 0 ) );
+             }
+          }
+       }
+    }
+    
+    return 0;
+}
 
-          int* const traceflags = new int[blk];
+void Swarm::traceBlock( int i, int nn, int* traceflags, double tyme, double dt )
+{
+    int j;
+    int jj;
+    double btyme;
+    
+    for ( jj = 0; jj < nn; jj++ ) {
+        j = i + jj;
+        
+        traceflags[jj] = 0;
+        
+        if ( (flagsets[j] & SyncTrace) && (ts[j] >= tyme) ) {
+           traceflags[jj] = 2;
+        }
+    }
+    
+    // each block starts at the same time
+    btyme = tyme;    
+    integ->go( nn, &(lons[i]), &(lats[i]), &(zs[i]), traceflags, btyme, metsrc, nav, dt ); 
+    
+    for ( jj = 0; jj < nn; jj++ ) {
+        j = i + jj;
+        
+        if ( traceflags[jj] != 2 ) {
+           ts[j] = btyme;
+        }
+        
+        if ( traceflags[jj] != 2 && ! metsrc->inDomain( lons[j], lats[j], zs[j] ) ) {
+           // the parcel has left the region covered by the met source
+           statuses[j] = statuses[j] | HitBdy;
+           flagsets[j] = flagsets[j] | NoTrace;
+        } else if ( traceflags[jj] == 1 ) {
+           statuses[j] = statuses[j] | HitBad;
+           flagsets[j] = flagsets[j] | NoTrace;
+        }
+    }
 
-          i=0;
-          while ( i < num_to_trace ) {
-                    
-              int jmax = i + blk;
-              if ( jmax >= my_num_parcels ) {
-                 jmax = my_num_parcels - 1;
-              }   
-              
-              int nn = jmax - i + 1;
-              
-              for ( j = i; j <= jmax; j++ ) {
-                  jj = j - i;
-                  
-                  traceflags[jj] = 0;
-                  
-                  if ( ( statuses[jj] & (HitBad | HitBdy) )
-                    || ( flagsets[jj] & NoTrace ) 
-                    || ( (flagsets[jj] & SyncTrace) && (ts[jj] >= tyme) )
-                  ) {
-                     traceflags[j] = 1;
-                  }
+}
+
+void* Swarm::threadWork( void* arg )
+{
+#ifdef USE_THREADS
+    SwarmWork* work;
+    int b;
+    int i;
+    int nn;
+    
+    work = static_cast<SwarmWork*>(arg);
+    
+    // so that the met source can tell the threads apart
+    MetData::setThread( work->me );
+    
+    int* const traceflags = new int[work->blk + 1];
+    
+    while ( nextBlock( work, b ) ) {
+       i = b*work->blk;
+       nn = work->blk;
+       if ( i + nn > work->num ) {
+          nn = work->num - i;
+       }
+       work->swarm->traceBlock( i, nn, traceflags, work->tyme, work->dt );
+    }
+    
+    delete[] traceflags;
+#endif
+    
+    return NULLPTR;
+}
+
+void Swarm::setThreads( int n, int blk )
+{
+    nthreads = ( n > 1 ) ? n : 1;
+#ifndef USE_THREADS
+    nthreads = 1;
+#endif
+    threadblk = blk;
+}
+
+int Swarm::getThreads() const
+{
+    return nthreads;
+}
+
+void Swarm::setRebalance( int every )
+{
+    rebal_every = every;
+    rebal_count = 0;
+}
+
+int Swarm::getRebalance() const
+{
+    return rebal_every;
+}
+
+real Swarm::loadImbalance() const
+{
+    return load_imbalance;
+}
+
+const std::vector<int>& Swarm::loads() const
+{
+    return pclloads;
+}
+
+int Swarm::migrations() const
+{
+    return rebal_moved;
+}
+
+void Swarm::setDomains( int mode, int every )
+{
+    int ntracers;
+    
+    domain_mode = mode;
+    domain_every = every;
+    if ( domain_every < 1 ) {
+       domain_every = 1;
+    }
+    domain_count = 0;
+    
+    // Tiles are arranged in rows and columns, with about
+    // twice as many columns as rows (i.e., roughly square tiles)
+    ntracers = tracers.size();
+    domain_rows = 1;
+    for ( int r=1; 2*r*r <= ntracers; r++ ) {
+        if ( (ntracers % r) == 0 ) {
+           domain_rows = r;
+        }
+    }
+}
+
+int Swarm::getDomains() const
+{
+    return domain_mode;
+}
+
+int Swarm::domain( real lon, real lat ) const
+{
+    int ntracers;
+    int row;
+    int col;
+    int ncols;
+    // fraction of the globe's area that lies south of the latitude
+    real frac;
+    
+    ntracers = tracers.size();
+    if ( domain_mode == SWARM_DOMAIN_NONE || ntracers <= 0 ) {
+       return -1;
+    }
+    
+    frac = ( sin( lat*PI/180.0 ) + 1.0 )/2.0;
+    
+    if ( domain_mode == SWARM_DOMAIN_BANDS ) {
+    
+       row = static_cast<int>( frac*ntracers );
+       if ( row >= ntracers ) {
+          row = ntracers - 1;
+       }
+       if ( row < 0 ) {
+          row = 0;
+       }
+       return tracers[row];
+       
+    } else {
+    
+       ncols = ntracers / domain_rows;
+       row = static_cast<int>( frac*domain_rows );
+       if ( row >= domain_rows ) {
+          row = domain_rows - 1;
+       }
+       if ( row < 0 ) {
+          row = 0;
+       }
+       lon = fmod( lon, 360.0 );
+       if ( lon < 0.0 ) {
+          lon = lon + 360.0;
+       }
+       col = static_cast<int>( lon/360.0*ncols );
+       if ( col >= ncols ) {
+          col = ncols - 1;
+       }
+       return tracers[ row*ncols + col ];
+    
+    }
+}
+
+void Swarm::setReorder( int every )
+{
+    reorder_every = every;
+    reorder_count = 0;
+}
+
+int Swarm::getReorder() const
+{
+    return reorder_every;
+}
+
+unsigned int Swarm::sfckey( real lon, real lat, real z, real zmin, real zscale ) const
+{
+    // each coordinate gets 10 bits
+    const real nbins = 1024.0;
+    real x[3];
+    unsigned int b;
+    unsigned int result;
+    
+    // latitude gets the most significant bits, then longitude, then altitude
+    const int shifts[3] = { 1, 2, 0 };
+    
+    lon = lon - 360.0*floor( lon/360.0 );
+    x[0] = lon/360.0 * nbins;
+    x[1] = (lat + 90.0)/180.0 * nbins;
+    x[2] = (z - zmin)*zscale * nbins;
+    
+    result = 0;
+    for ( int i=0; i < 3; i++ ) {
+        b = 0;
+        if ( x[i] >= nbins ) {
+           b = 1023;
+        } else if ( x[i] > 0.0 ) {
+           b = static_cast<unsigned int>( x[i] );
+        }
+        // spread the 10 bits out to every third bit
+        b = ( b | (b << 16) ) & 0x030000FF;
+        b = ( b | (b <<  8) ) & 0x0300F00F;
+        b = ( b | (b <<  4) ) & 0x030C30C3;
+        b = ( b | (b <<  2) ) & 0x09249249;
+        result = result | ( b << shifts[i] );
+    }
+    
+    return result;
+}
+
+void Swarm::reorder( int n )
+{
+    real zmin;
+    real zmax;
+    real zscale;
+    int* slot_owner;
+    // (sort key, current array location) for each parcel
+    std::vector< std::pair<unsigned int,int> > order;
+    int idx;
+    
+    if ( n <= 1 ) {
+       return;
+    }
+    
+    zmin = zs[0];
+    zmax = zs[0];
+    for ( int i=1; i < n; i++ ) {
+        if ( zs[i] < zmin ) {
+           zmin = zs[i];
+        }
+        if ( zs[i] > zmax ) {
+           zmax = zs[i];
+        }
+    }
+    zscale = 0.0;
+    if ( zmax > zmin ) {
+       zscale = 1.0/(zmax - zmin);
+    }
+    
+    order.reserve( n );
+    for ( int i=0; i < n; i++ ) {
+        order.push_back( std::pair<unsigned int,int>( sfckey( lons[i], lats[i], zs[i], zmin, zscale ), i ) );
+    }
+    std::sort( order.begin(), order.end() );
+    
+    // which local parcel number is stored in each array location?
+    slot_owner = new int[my_num_parcels];
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        slot_owner[ids[k]] = k;
+    }
+    
+    real* const tlons = new real[n];
+    real* const tlats = new real[n];
+    real* const tzs = new real[n];
+    double* const tts = new double[n];
+    double* const ttgs = new double[n];
+    ParcelFlag* const tflags = new ParcelFlag[n];
+    ParcelStatus* const tstats = new ParcelStatus[n];
+    int* const tgids = new int[n];
+    
+    for ( int i=0; i < n; i++ ) {
+        idx = order[i].second;
+        tlons[i]  = lons[idx];
+        tlats[i]  = lats[idx];
+        tzs[i]    = zs[idx];
+        tts[i]    = ts[idx];
+        ttgs[i]   = tgs[idx];
+        tflags[i] = flagsets[idx];
+        tstats[i] = statuses[idx];
+        tgids[i]  = gids[idx];
+        // the local parcel that was at idx is now at i
+        ids[slot_owner[idx]] = i;
+    }
+    for ( int i=0; i < n; i++ ) {
+        lons[i]     = tlons[i];
+        lats[i]     = tlats[i];
+        zs[i]       = tzs[i];
+        ts[i]       = tts[i];
+        tgs[i]      = ttgs[i];
+        flagsets[i] = tflags[i];
+        statuses[i] = tstats[i];
+        gids[i]     = tgids[i];
+    }
+    
+    delete[] tgids;
+    delete[] tstats;
+    delete[] tflags;
+    delete[] ttgs;
+    delete[] tts;
+    delete[] tzs;
+    delete[] tlats;
+    delete[] tlons;
+    delete[] slot_owner;
+
+}
+
+bool Swarm::active( int idx, double tyme ) const
+{
+    if ( (flagsets[idx] & NoTrace) || (statuses[idx] & (HitBad | HitBdy)) ) {
+       return false;
+    }
+    if ( (flagsets[idx] & SyncTrace) && (ts[idx] >= tyme) ) {
+       return false;
+    }
+    
+    return true;
+}
+
+void Swarm::balance( double tyme, bool move )
+{
+    int my_rank;
+    int root;
+    // the number of tracing processors
+    int ntracers;
+    // this processor's total and active parcel counts
+    int counts[2];
+    // the total number of active parcels
+    int total;
+    // the most active parcels held by one processor
+    int maxload;
+    // each tracer's total and active parcel counts, and target active count
+    std::vector<int> npcls;
+    std::vector<int> nactive;
+    std::vector<int> target;
+    // how many parcels each tracer can give away or take on
+    std::vector<int> surplus;
+    std::vector<int> deficit;
+    // the migration plan
+    std::vector<int> plan;
+    int nmoves;
+    int extra;
+    int id;
+    int ir;
+    int cnt;
+
+    my_rank = pgroup->id();
+    root = pgroup->root_id();
+    ntracers = tracers.size();
+
+    counts[0] = my_num_parcels;
+    counts[1] = 0;
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        if ( active( ids[k], tyme ) ) {
+           counts[1]++;
+        }
+    }
+
+    nmoves = 0;
+    
+    if ( my_rank == root ) {
+    
+       // collect everyone's load
+       npcls.assign( ntracers, 0 );
+       nactive.assign( ntracers, 0 );
+       pclloads.assign( pgroup->size(), 0 );
+       total = 0;
+       maxload = 0;
+       for ( int it=0; it < ntracers; it++ ) {
+           if ( tracers[it] == my_rank ) {
+              npcls[it] = counts[0];
+              nactive[it] = counts[1];
+           } else {
+              int rcounts[2];
+              pgroup->receive_ints( tracers[it], 2, rcounts, PGR_TAG_SWLOAD );
+              npcls[it] = rcounts[0];
+              nactive[it] = rcounts[1];
+           }
+           pclloads[tracers[it]] = nactive[it];
+           total += nactive[it];
+           if ( nactive[it] > maxload ) {
+              maxload = nactive[it];
+           }
+       }
+       
+       load_imbalance = 1.0;
+       if ( total > 0 ) {
+          load_imbalance = static_cast<real>( maxload ) * ntracers / total;
+       }
+       //- std::cerr << "Swarm::balance: load imbalance " << load_imbalance 
+       //-           << " (max " << maxload << ", total " << total << ")" << std::endl;
+       
+       if ( move ) {
+       
+          // each tracer should end up with about total/ntracers active parcels.
+          // The leftover parcels go to the tracers that are already the most heavily
+          // loaded, to minimize the number of parcels to be moved.
+          target.assign( ntracers, total / ntracers );
+          extra = total - ( total / ntracers ) * ntracers;
+          for ( int it=0; it < ntracers && extra > 0; it++ ) {
+              if ( nactive[it] > target[it] ) {
+                 target[it]++;
+                 extra--;
               }
-                  
-              integ->go( nn, &(lons[i]), &(lats[i]), &(zs[i]), flagsets, tyme, metsrc, nav, dt ); 
-              
-              for ( j = i; j <= jmax; j++ ) {
-                  jj = j - i;
-                  
-                  ts[j] = tyme;
-                  
-                  if ( traceflags[jj] ) {
-                     statuses[j] = statuses[j] | HitBad;
-                     flagsets[j] = flagsets[j] | NoTrace;
-                  }
+          }
+          for ( int it=0; it < ntracers && extra > 0; it++ ) {
+              if ( nactive[it] == target[it] ) {
+                 target[it]++;
+                 extra--;
               }
-              
-              i = jmax + 1;
-                  
           }
-                    
-          metsrc->signalMetDone();
+          
+          surplus.assign( ntracers, 0 );
+          deficit.assign( ntracers, 0 );
+          for ( int it=0; it < ntracers; it++ ) {
+              if ( nactive[it] > target[it] ) {
+                 // every tracer must keep at least one parcel, 
+                 // so that it keeps taking part in the iteration loops
+                 surplus[it] = std::min( nactive[it] - target[it], npcls[it] - 1 );
+              } else {
+                 deficit[it] = target[it] - nactive[it];
+              }
+          }
+          
+          // match up the givers with the takers
+          id = 0;
+          ir = 0;
+          while ( id < ntracers && ir < ntracers ) {
+              if ( surplus[id] <= 0 ) {
+                 id++;
+              } else if ( deficit[ir] <= 0 ) {
+                 ir++;
+              } else {
+                 cnt = std::min( surplus[id], deficit[ir] );
+                 plan.push_back( tracers[id] );
+                 plan.push_back( tracers[ir] );
+                 plan.push_back( cnt );
+                 surplus[id] -= cnt;
+                 deficit[ir] -= cnt;
+              }
+          }
+          nmoves = plan.size() / 3;
+       
+          // tell everyone the plan
+          for ( int it=0; it < ntracers; it++ ) {
+              if ( tracers[it] != my_rank ) {
+                 pgroup->send_ints( tracers[it], 1, &nmoves, PGR_TAG_SWPLAN );
+                 if ( nmoves > 0 ) {
+                    pgroup->send_ints( tracers[it], nmoves*3, &(plan[0]), PGR_TAG_SWPLAN );
+                 }
+              }
+          }
+       }
+       
+    } else {
+    
+       pgroup->send_ints( root, 2, counts, PGR_TAG_SWLOAD );
+       
+       if ( move ) {
+          pgroup->receive_ints( root, 1, &nmoves, PGR_TAG_SWPLAN );
+          if ( nmoves > 0 ) {
+             plan.resize( nmoves*3 );
+             pgroup->receive_ints( root, nmoves*3, &(plan[0]), PGR_TAG_SWPLAN );
+          }
        }
+    
     }
     
-    return 0;
+    if ( nmoves > 0 ) {
+       migrate( nmoves, &(plan[0]), tyme );
+    }
+
+}
+
+void Swarm::decompose( double tyme )
+{
+    int my_rank;
+    int root;
+    int ntracers;
+    // where each local parcel is to go (-1 = stays)
+    std::vector<int> dests;
+    // the number of parcels leaving for each tracer, indexed by processor ID
+    std::vector<int> outgoing;
+    std::vector<int> counts;
+    int nleaving;
+    // the migration plan
+    std::vector<int> plan;
+    int nmoves;
+    int dest;
+    
+    my_rank = pgroup->id();
+    root = pgroup->root_id();
+    ntracers = tracers.size();
+    
+    dests.assign( my_num_parcels + 1, -1 );
+    outgoing.assign( pgroup->size(), 0 );
+    counts.assign( pgroup->size(), 0 );
+    nleaving = 0;
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        if ( active( ids[k], tyme ) ) {
+           dest = domain( lons[ids[k]], lats[ids[k]] );
+           if ( dest >= 0 && dest != my_rank ) {
+              dests[k] = dest;
+              outgoing[dest]++;
+              nleaving++;
+           }
+        }
+    }
+    // every tracer must keep at least one parcel, 
+    // so that it keeps taking part in the iteration loops
+    if ( nleaving > 0 && nleaving == my_num_parcels ) {
+       outgoing[dests[0]]--;
+       dests[0] = -1;
+    }
+    
+    nmoves = 0;
+    
+    if ( my_rank == root ) {
+    
+       for ( int it=0; it < ntracers; it++ ) {
+           if ( tracers[it] == my_rank ) {
+              counts = outgoing;
+           } else {
+              pgroup->receive_ints( tracers[it], pgroup->size(), &(counts[0]), PGR_TAG_SWDOMN );
+           }
+           for ( int ip=0; ip < pgroup->size(); ip++ ) {
+               if ( counts[ip] > 0 ) {
+                  plan.push_back( tracers[it] );
+                  plan.push_back( ip );
+                  plan.push_back( counts[ip] );
+               }
+           }
+       }
+       nmoves = plan.size() / 3;
+       
+       // tell everyone the plan
+       for ( int it=0; it < ntracers; it++ ) {
+           if ( tracers[it] != my_rank ) {
+              pgroup->send_ints( tracers[it], 1, &nmoves, PGR_TAG_SWPLAN );
+              if ( nmoves > 0 ) {
+                 pgroup->send_ints( tracers[it], nmoves*3, &(plan[0]), PGR_TAG_SWPLAN );
+              }
+           }
+       }
+    
+    } else {
+    
+       pgroup->send_ints( root, pgroup->size(), &(outgoing[0]), PGR_TAG_SWDOMN );
+       
+       pgroup->receive_ints( root, 1, &nmoves, PGR_TAG_SWPLAN );
+       if ( nmoves > 0 ) {
+          plan.resize( nmoves*3 );
+          pgroup->receive_ints( root, nmoves*3, &(plan[0]), PGR_TAG_SWPLAN );
+       }
+       
+    }
+    
+    if ( nmoves > 0 ) {
+       migrate( nmoves, &(plan[0]), tyme, &(dests[0]) );
+    }
+
+}
+
+void Swarm::migrate( int nmoves, const int* moves, double tyme, const int* dests )
+{
+    int my_rank;
+    int root;
+    int from;
+    int to;
+    int cnt;
+    int nmoved;
+    int idx;
+    int ntotal;
+    int nrecv;
+    int nkeep;
+    // local parcel numbers of the active parcels, any of which may be given away
+    std::vector<int> givable;
+    // which local parcels have been given away
+    std::vector<bool> gone;
+    // the global indices of all parcels moved, in plan order
+    std::vector<int> moved;
+    // the contents of the parcels received from other processors
+    std::vector<int> rgids;
+    std::vector<real> rlocs;
+    std::vector<double> rtimes;
+    std::vector<int> rinfo;
+    // buffers for sending parcels
+    std::vector<int> sgids;
+    std::vector<real> slocs;
+    std::vector<double> stimes;
+    std::vector<int> sinfo;
+    // the new order of the local parcels: (global index, source)
+    std::vector< std::pair<int,int> > order;
+    
+    my_rank = pgroup->id();
+    root = pgroup->root_id();
+    
+    // Is this the first migration? Then we need to switch from 
+    // contiguous index ranges to explicit ownership tables
+    if ( pclowners.size() == 0 ) {
+       pclowners.assign( num_parcels_total, -1 );
+       pclcounts.assign( pgroup->size(), 0 );
+       for ( int ip=0; ip < static_cast<int>( pclstarts.size() ); ip++ ) {
+           if ( pclstarts[ip] >= 0 ) {
+              for ( int n=pclstarts[ip]; n <= pclends[ip]; n++ ) {
+                  pclowners[n] = ip;
+              }
+              pclcounts[ip] = pclends[ip] - pclstarts[ip] + 1;
+           }
+       }
+       for ( int k=0; k < my_num_parcels; k++ ) {
+           gids[ids[k]] = my_parcel_start + k;
+       }
+    }
+    
+    // we give away active parcels, starting from the end
+    if ( dests == NULLPTR ) {
+       for ( int k=my_num_parcels - 1; k >= 0; k-- ) {
+           if ( active( ids[k], tyme ) ) {
+              givable.push_back( k );
+           }
+       }
+    }
+    gone.assign( my_num_parcels, false );
+    
+    // move the parcels.
+    // (Every processor works through the moves in the same order, 
+    // so the sends and receives always pair up.)
+    nmoved = 0;
+    nrecv = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        from = moves[m*3];
+        to   = moves[m*3 + 1];
+        cnt  = moves[m*3 + 2];
+        
+        if ( from == my_rank ) {
+        
+           sgids.resize( cnt );
+           slocs.resize( cnt*3 );
+           stimes.resize( cnt*2 );
+           sinfo.resize( cnt*2 );
+           if ( dests != NULLPTR ) {
+              // the parcels bound for that processor
+              givable.clear();
+              for ( int k=0; k < my_num_parcels && static_cast<int>( givable.size() ) < cnt; k++ ) {
+                  if ( dests[k] == to ) {
+                     givable.push_back( k );
+                  }
+              }
+           }
+           for ( int ic=0; ic < cnt; ic++ ) {
+               int k = ( dests != NULLPTR ) ? givable[ic] : givable[nmoved];
+               idx = ids[k];
+               sgids[ic]        = gids[idx];
+               slocs[ic*3]      = lons[idx];
+               slocs[ic*3 + 1]  = lats[idx];
+               slocs[ic*3 + 2]  = zs[idx];
+               stimes[ic*2]     = ts[idx];
+               stimes[ic*2 + 1] = tgs[idx];
+               sinfo[ic*2]      = flagsets[idx];
+               sinfo[ic*2 + 1]  = statuses[idx];
+               gone[k] = true;
+               moved.push_back( gids[idx] );
+               nmoved++;
+           }
+           pgroup->send_ints( to, cnt, &(sgids[0]), PGR_TAG_SWMOVE );
+           pgroup->send_reals( to, cnt*3, &(slocs[0]), PGR_TAG_SWMOVE );
+           pgroup->send_doubles( to, cnt*2, &(stimes[0]), PGR_TAG_SWMOVE );
+           pgroup->send_ints( to, cnt*2, &(sinfo[0]), PGR_TAG_SWMOVE );
+        
+        } else if ( to == my_rank ) {
+        
+           idx = nrecv;
+           nrecv += cnt;
+           rgids.resize( nrecv );
+           rlocs.resize( nrecv*3 );
+           rtimes.resize( nrecv*2 );
+           rinfo.resize( nrecv*2 );
+           pgroup->receive_ints( from, cnt, &(rgids[idx]), PGR_TAG_SWMOVE );
+           pgroup->receive_reals( from, cnt*3, &(rlocs[idx*3]), PGR_TAG_SWMOVE );
+           pgroup->receive_doubles( from, cnt*2, &(rtimes[idx*2]), PGR_TAG_SWMOVE );
+           pgroup->receive_ints( from, cnt*2, &(rinfo[idx*2]), PGR_TAG_SWMOVE );
+        
+        }
+    }
+    
+    // Now make sure everyone knows which parcels went where.
+    // The givers tell the root processor, and the root processor tells everyone.
+    ntotal = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        ntotal += moves[m*3 + 2];
+    }
+    if ( my_rank == root ) {
+       std::vector<int> all_moved( ntotal );
+       
+       idx = 0;
+       nmoved = 0;
+       for ( int m=0; m < nmoves; m++ ) {
+           from = moves[m*3];
+           cnt  = moves[m*3 + 2];
+           if ( from == my_rank ) {
+              for ( int ic=0; ic < cnt; ic++ ) {
+                  all_moved[idx + ic] = moved[nmoved + ic];
+              }
+              nmoved += cnt;
+           } else {
+              pgroup->receive_ints( from, cnt, &(all_moved[idx]), PGR_TAG_SWOWNR );
+           }
+           idx += cnt;
+       }
+       for ( size_t it=0; it < tracers.size(); it++ ) {
+           if ( tracers[it] != my_rank ) {
+              pgroup->send_ints( tracers[it], ntotal, &(all_moved[0]), PGR_TAG_SWOWNR );
+           }
+       }
+       moved = all_moved;
+    } else {
+       nmoved = 0;
+       for ( int m=0; m < nmoves; m++ ) {
+           if ( moves[m*3] == my_rank ) {
+              cnt = moves[m*3 + 2];
+              pgroup->send_ints( root, cnt, &(moved[nmoved]), PGR_TAG_SWOWNR );
+              nmoved += cnt;
+           }
+       }
+       moved.resize( ntotal );
+       pgroup->receive_ints( root, ntotal, &(moved[0]), PGR_TAG_SWOWNR );
+    }
+    
+    idx = 0;
+    for ( int m=0; m < nmoves; m++ ) {
+        from = moves[m*3];
+        to   = moves[m*3 + 1];
+        cnt  = moves[m*3 + 2];
+        for ( int ic=0; ic < cnt; ic++ ) {
+            pclowners[moved[idx]] = to;
+            idx++;
+        }
+        pclcounts[from] -= cnt;
+        pclcounts[to] += cnt;
+    }
+    rebal_moved += ntotal;
+    
+    // rebuild the local parcel arrays, ordered by global index.
+    // Sources >= 0 are current array locations; sources < 0 are 
+    // (-1 - n), where n indexes the parcels just received.
+    for ( int k=0; k < my_num_parcels; k++ ) {
+        if ( ! gone[k] ) {
+           order.push_back( std::pair<int,int>( gids[ids[k]], ids[k] ) );
+        }
+    }
+    for ( int ir=0; ir < nrecv; ir++ ) {
+        order.push_back( std::pair<int,int>( rgids[ir], -1 - ir ) );
+    }
+    std::sort( order.begin(), order.end() );
+    nkeep = order.size();
+    
+    if ( nrecv > 0 || nmoved > 0 ) {
+    
+       real* const tlons = new real[nkeep];
+       real* const tlats = new real[nkeep];
+       real* const tzs = new real[nkeep];
+       double* const tts = new double[nkeep];
+       double* const ttgs = new double[nkeep];
+       ParcelFlag* const tflags = new ParcelFlag[nkeep];
+       ParcelStatus* const tstats = new ParcelStatus[nkeep];
+       
+       for ( int k=0; k < nkeep; k++ ) {
+           idx = order[k].second;
+           if ( idx >= 0 ) {
+              tlons[k]  = lons[idx];
+              tlats[k]  = lats[idx];
+              tzs[k]    = zs[idx];
+              tts[k]    = ts[idx];
+              ttgs[k]   = tgs[idx];
+              tflags[k] = flagsets[idx];
+              tstats[k] = statuses[idx];
+           } else {
+              idx = -1 - idx;
+              tlons[k]  = rlocs[idx*3];
+              tlats[k]  = rlocs[idx*3 + 1];
+              tzs[k]    = rlocs[idx*3 + 2];
+              tts[k]    = rtimes[idx*2];
+              ttgs[k]   = rtimes[idx*2 + 1];
+              tflags[k] = rinfo[idx*2];
+              tstats[k] = rinfo[idx*2 + 1];
+           }
+       }
+       
+       // (nothing needs to be copied over if the arrays have to grow)
+       my_num_parcels = 0;
+       grow( nkeep );
+       
+       pcllocal.clear();
+       for ( int k=0; k < nkeep; k++ ) {
+           lons[k]     = tlons[k];
+           lats[k]     = tlats[k];
+           zs[k]       = tzs[k];
+           ts[k]       = tts[k];
+           tgs[k]      = ttgs[k];
+           flagsets[k] = tflags[k];
+           statuses[k] = tstats[k];
+           gids[k]     = order[k].first;
+           ids[k]      = k;
+           pcllocal[gids[k]] = k;
+       }
+       my_num_parcels = nkeep;
+       
+       delete[] tstats;
+       delete[] tflags;
+       delete[] ttgs;
+       delete[] tts;
+       delete[] tzs;
+       delete[] tlats;
+       delete[] tlons;
+       
+    } else if ( pcllocal.size() == 0 ) {
+    
+       // not involved in the moves, but we still need the index map
+       for ( int k=0; k < my_num_parcels; k++ ) {
+           pcllocal[gids[ids[k]]] = k;
+       }
+    
+    }
+
 }
 
 void Swarm::sync()
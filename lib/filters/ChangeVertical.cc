@@ -10,6 +10,7 @@ ChangeVertical :: ChangeVertical( const std::string to, const std::string from,
     toQuantity = to;
     metsrc = met;
     myMet = false;
+    nbad = 0;
 }
 
 ChangeVertical :: ~ChangeVertical()
@@ -59,29 +60,14 @@ void ChangeVertical :: setMet( MetData* met )
 }
 
 
-void ChangeVertical :: apply( Parcel& p )
+void ChangeVertical :: plan( const Parcel& p, MetData* psrc, std::string &fromQ, std::string &toQ
+                            , MetData** src1, std::string &q1, MetData** src2, std::string &q2 )
 {
-     std::string metQ;
-     std::string metUnits;
-     std::string fromQ;
-     std::string toQ;
-     std::string midQ;
-     bool nonVertical;
-     real oldv;
-     real midv;
-     real newv;
-     real longitude, latitude;
-     double time;
-     MetData* psrc;
-     MetData* met;
-     
-     
-     oldv = p.getZ();
-     p.getPos( &longitude, &latitude );
-     time = p.getTime();
      
-     // we are going to be referring to the parcel's met source
-     psrc = p.getMet();
+     *src1 = NULLPTR;
+     *src2 = NULLPTR;
+     q1 = "";
+     q2 = "";
 
      if ( metsrc == NULL ) {
         // no met source specified yet?
@@ -123,7 +109,8 @@ void ChangeVertical :: apply( Parcel& p )
            // is the vertical coordinate of our own met source.
            toQ = metsrc->vertical();
            // Do the conversion using the parcel's met source
-           newv = psrc->getData( toQ, time, longitude, latitude, oldv, METDATA_THROWBAD );
+           *src1 = psrc;
+           q1 = toQ;
         } else {
            // We have a desired value for the "to" coordinate
            if ( toQ != psrc->vertical() ) {
@@ -131,14 +118,17 @@ void ChangeVertical :: apply( Parcel& p )
 
               if ( psrc->legalQuantity(toQ) ) {
                  // yes! go ahead and do the conversion now
-                 newv = psrc->getData( toQ, time, longitude, latitude, oldv, METDATA_THROWBAD );
+                 *src1 = psrc;
+                 q1 = toQ;
               } else { 
                  // ok ,things are a bit more complicated
                  
                  // Can we do an intermediate conversion?
                  if ( psrc->legalQuantity( metsrc->vertical() ) && metsrc->legalQuantity( toQ ) ) {
-                    midv = psrc->getData( metsrc->vertical(), time, longitude, latitude, oldv, METDATA_THROWBAD );
-                    newv = metsrc->getData( toQ, time, longitude, latitude, midv, METDATA_THROWBAD );             
+                    *src1 = psrc;
+                    q1 = metsrc->vertical();
+                    *src2 = metsrc;
+                    q2 = toQ;
                  } else {
                     throw (badvcoordconflict());              
                  }
@@ -148,13 +138,11 @@ void ChangeVertical :: apply( Parcel& p )
               // toQ is the parcel met sources;' vert coord
               // and fromQ is the parcel met source's vert coord
               // which means that toQ == fromQ
-              if ( toQ == fromQ ) {
-                 // which means that no conversion is needed
-                 newv = oldv;
-              } else {
+              if ( toQ != fromQ ) {
                  // really should never get here
                  throw (badvcoordconflict());
               }
+              // otherwise, no conversion is needed
            
            }
         } 
@@ -182,7 +170,8 @@ void ChangeVertical :: apply( Parcel& p )
            // the only thing to choose from is the parcel's met source's vert coord
            toQ = psrc->vertical();
            // Do the conversion using ourmet source
-           newv = metsrc->getData( toQ, time, longitude, latitude, oldv, METDATA_THROWBAD );
+           *src1 = metsrc;
+           q1 = toQ;
            
         } else {
            
@@ -192,13 +181,16 @@ void ChangeVertical :: apply( Parcel& p )
 
               if ( metsrc->legalQuantity(toQ) ) {
                  // yes! go ahead and do the conversion now
-                 newv = metsrc->getData( toQ, time, longitude, latitude, oldv, METDATA_THROWBAD );
+                 *src1 = metsrc;
+                 q1 = toQ;
               } else { 
                  
                  // Can we do an intermediate conversion?
                  if ( metsrc->legalQuantity( psrc->vertical() ) && psrc->legalQuantity( toQ ) ) {
-                    midv = metsrc->getData( psrc->vertical(), time, longitude, latitude, oldv, METDATA_THROWBAD );
-                    newv = psrc->getData( toQ, time, longitude, latitude, midv, METDATA_THROWBAD );             
+                    *src1 = metsrc;
+                    q1 = psrc->vertical();
+                    *src2 = psrc;
+                    q2 = toQ;
                  } else {
                     throw (badvcoordconflict());              
                  }
@@ -208,13 +200,11 @@ void ChangeVertical :: apply( Parcel& p )
               // toQ is our sources;' vert coord
               // and fromQ is our met source's vert coord
               // which means that toQ == fromQ
-              if ( toQ == fromQ ) {
-                 // which means that no conversion is needed
-                 newv = oldv;
-              } else {
+              if ( toQ != fromQ ) {
                  // really should never get here
                  throw (badvcoordconflict());
               }
+              // otherwise, no conversion is needed
            
            }
         
@@ -230,6 +220,37 @@ void ChangeVertical :: apply( Parcel& p )
         toQuantity = toQ;
      }         
 
+}
+
+void ChangeVertical :: apply( Parcel& p )
+{
+     std::string fromQ;
+     std::string toQ;
+     std::string q1, q2;
+     MetData *src1, *src2;
+     real oldv;
+     real newv;
+     real longitude, latitude;
+     double time;
+     MetData* psrc;
+     
+     
+     oldv = p.getZ();
+     p.getPos( &longitude, &latitude );
+     time = p.getTime();
+     
+     // we are going to be referring to the parcel's met source
+     psrc = p.getMet();
+
+     plan( p, psrc, fromQ, toQ, &src1, q1, &src2, q2 );
+     
+     newv = oldv;
+     if ( src1 != NULLPTR ) {
+        newv = src1->getData( q1, time, longitude, latitude, oldv, METDATA_THROWBAD );
+        if ( src2 != NULLPTR ) {
+           newv = src2->getData( q2, time, longitude, latitude, newv, METDATA_THROWBAD );
+        }
+     }
      
      p.setZ(newv);
 
@@ -241,17 +262,152 @@ void ChangeVertical :: apply( Parcel& p )
 
 }
 
+void ChangeVertical :: convert( const int n, Parcel** const p, int *errs )
+{
+     std::string fromQ;
+     std::string toQ;
+     std::string q1, q2;
+     MetData *src1, *src2;
+     MetData *psrc;
+     double time;
+     bool nonvert;
+     int i, j, k;
+     int ng;
+     int nok;
+     
+     nbad = 0;
+
+     if ( n <= 0 ) {
+        return;
+     }
+     
+     // which parcels have been handled
+     char*  const done = new char[n];
+     // the parcels in the current group
+     int*   const grp  = new int[n];
+     real*  const lons = new real[n];
+     real*  const lats = new real[n];
+     real*  const zs   = new real[n];
+     real*  const vals = new real[n];
+     real*  const outs = new real[n];
+     
+     for ( i=0; i<n; i++ ) {
+         done[i] = 0;
+     }
+     
+     // Parcels that share a met source, a time, and a NonVert status
+     // are converted together with one batched getData() call per step.
+     // The groups are handled in the order of their first parcels, so that
+     // the from and to coordinates get settled just as they would
+     // if the parcels were converted one at a time.
+     for ( i=0; i<n; i++ ) {
+     
+         if ( done[i] ) {
+            continue;
+         }
+         
+         psrc = p[i]->getMet();
+         time = p[i]->getTime();
+         nonvert = p[i]->queryNonVert();
+         
+         ng = 0;
+         for ( j=i; j<n; j++ ) {
+             if ( ! done[j] && p[j]->getMet() == psrc && p[j]->getTime() == time 
+                  && p[j]->queryNonVert() == nonvert ) {
+                grp[ng] = j;
+                p[j]->getPos( &(lons[ng]), &(lats[ng]) );
+                zs[ng] = p[j]->getZ();
+                done[j] = 1;
+                ng++;
+             }
+         }
+         
+         plan( *(p[i]), psrc, fromQ, toQ, &src1, q1, &src2, q2 );
+         
+         if ( src1 != NULLPTR ) {
+            src1->getData( q1, time, ng, lons, lats, zs, vals, METDATA_NANBAD );
+            if ( src2 != NULLPTR ) {
+               // only the good intermediate values go on to the second step
+               nok = 0;
+               for ( k=0; k<ng; k++ ) {
+                   if ( FINITE(vals[k]) ) {
+                      lons[nok] = lons[k];
+                      lats[nok] = lats[k];
+                      zs[nok] = vals[k];
+                      nok++;
+                   }
+               }
+               src2->getData( q2, time, nok, lons, lats, zs, outs, METDATA_NANBAD );
+               nok = 0;
+               for ( k=0; k<ng; k++ ) {
+                   if ( FINITE(vals[k]) ) {
+                      vals[k] = outs[nok];
+                      nok++;
+                   }
+               }
+            }
+         } else {
+            // no conversion is needed
+            for ( k=0; k<ng; k++ ) {
+                vals[k] = zs[k];
+            }
+         }
+         
+         for ( k=0; k<ng; k++ ) {
+             j = grp[k];
+             if ( FINITE(vals[k]) ) {
+                p[j]->setZ( vals[k] );
+                if ( toQ != psrc->vertical() ) {
+                   p[j]->setNonVert();
+                } else {
+                   p[j]->clearNonVert();
+                }
+                if ( errs != NULLPTR ) {
+                   errs[j] = 0;
+                }
+             } else {
+                // this parcel cannot be converted, so it cannot be traced
+                p[j]->setHitBad();
+                p[j]->setNoTrace();
+                if ( errs != NULLPTR ) {
+                   errs[j] = 1;
+                }
+                nbad++;
+             }
+         }
+         
+     }
+     
+     delete[] outs;
+     delete[] vals;
+     delete[] zs;
+     delete[] lats;
+     delete[] lons;
+     delete[] grp;
+     delete[] done;
+
+}
   
-  
-void ChangeVertical :: apply( Parcel * const p, const int n )
+void ChangeVertical :: apply( Parcel * const p, const int n, int *errs )
 {
      int i;
      
-     for (i = 0; i<n; i++ ) {
-         
-         apply( p[i] );
+     Parcel** const pp = new Parcel*[n];
      
+     for (i = 0; i<n; i++ ) {
+         pp[i] = &(p[i]);
      }
+     
+     convert( n, pp, errs );
+     
+     delete[] pp;
+
+}
+  
+void ChangeVertical :: apply( Parcel * const p, const int n )
+{
+
+     apply( p, n, NULLPTR );
 
 }
 
@@ -267,9 +423,16 @@ void ChangeVertical :: apply( std::vector<Parcel>& p )
        throw (ParcelFilter::badparcelnum());
     };  
     
+    Parcel** const pp = new Parcel*[n];
+    
+    i = 0;
     for ( ip = p.begin(); ip != p.end(); ip++ ) {
-        apply( *ip );
+        pp[i++] = &(*ip);
     }
+    
+    convert( n, pp, NULLPTR );
+    
+    delete[] pp;
 
 }
 
@@ -277,6 +440,7 @@ void ChangeVertical :: apply( std::list<Parcel>& p )
 {
     std::list<Parcel>::iterator ip;
     int n;
+    int i;
     
     n = p.size();
     
@@ -284,10 +448,16 @@ void ChangeVertical :: apply( std::list<Parcel>& p )
        throw (ParcelFilter::badparcelnum());
     };  
     
+    Parcel** const pp = new Parcel*[n];
+    
+    i = 0;
+    for ( ip=p.begin(); ip != p.end(); ip++ ) {
+        pp[i++] = &(*ip);
+    }   
     
-   for ( ip=p.begin(); ip != p.end(); ip++ ) {
-      apply( *ip );
-   }   
+    convert( n, pp, NULLPTR );
+    
+    delete[] pp;
 
 };
 
@@ -295,6 +465,7 @@ void ChangeVertical :: apply( std::deque<Parcel>& p )
 {
     std::deque<Parcel>::iterator ip;
     int n;
+    int i;
     
     n = p.size();
     
@@ -302,10 +473,16 @@ void ChangeVertical :: apply( std::deque<Parcel>& p )
        throw (ParcelFilter::badparcelnum());
     };  
     
+    Parcel** const pp = new Parcel*[n];
     
-   for ( ip=p.begin(); ip != p.end(); ip++ ) {
-      apply( *ip );
-   }   
+    i = 0;
+    for ( ip=p.begin(); ip != p.end(); ip++ ) {
+        pp[i++] = &(*ip);
+    }   
+    
+    convert( n, pp, NULLPTR );
+    
+    delete[] pp;
 
 };
 
@@ -313,7 +490,7 @@ void ChangeVertical :: apply( Flock& p )
 {
     Flock::iterator iter;
     int n;
-    Parcel px;
+    int i;
     
     n = p.size();
     
@@ -321,11 +498,66 @@ void ChangeVertical :: apply( Flock& p )
        throw (ParcelFilter::badparcelnum());
     };  
   
+    // The iterator runs over only this processor's own Parcels,
+    // so each processor converts its Parcels independently.
+    // A Flock holds only the contents of its Parcels, so
+    // this processor's Parcels are copied out, converted together,
+    // and copied back in. 
+    std::vector<Parcel> local;
+    for ( iter = p.begin(); iter != p.end(); iter++ ) {
+        local.push_back( *iter );
+    }    
+    
+    n = local.size();
+    Parcel** const pp = new Parcel*[n];
+    for ( i=0; i<n; i++ ) {
+        pp[i] = &(local[i]);
+    }
+    
+    convert( n, pp, NULLPTR );
+    
+    i = 0;
+    for ( iter = p.begin(); iter != p.end(); iter++ ) {
+        *iter = local[i++];
+    }    
+    
+    delete[] pp;
+
+};
 
+void ChangeVertical :: apply( Swarm& p )
+{
+    Swarm::iterator iter;
+    int n;
+    int i;
+    
+    n = p.size();
+    
+    if ( n <= 0 ) {
+       throw (ParcelFilter::badparcelnum());
+    };  
+  
+    // A Swarm holds only the contents of its Parcels, so
+    // this processor's Parcels are copied out, converted together,
+    // and copied back in. 
+    std::vector<Parcel> local;
     for ( iter = p.begin(); iter != p.end(); iter++ ) {
-        px = *iter;
-        apply( px );
-        *iter = px;
+        local.push_back( *iter );
     }    
+    
+    n = local.size();
+    Parcel** const pp = new Parcel*[n];
+    for ( i=0; i<n; i++ ) {
+        pp[i] = &(local[i]);
+    }
+    
+    convert( n, pp, NULLPTR );
+    
+    i = 0;
+    for ( iter = p.begin(); iter != p.end(); iter++ ) {
+        *iter = local[i++];
+    }    
+    
+    delete[] pp;
 
 };
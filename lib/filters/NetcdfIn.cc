@@ -1077,7 +1077,7 @@ int NetcdfIn::get_var_id( const std::string &varname, bool required, const std::
 
 }
 
-void NetcdfIn::rd_real( int var_id, int var_type, size_t n, real* destination )
+void NetcdfIn::rd_real( int var_id, int var_type, size_t n, real* destination, int start )
 {
     int err;
     size_t starts[2];
@@ -1089,14 +1089,19 @@ void NetcdfIn::rd_real( int var_id, int var_type, size_t n, real* destination )
     int    *ibuffr;
     long   *lbuffr;
     
+    if ( start < 0 ) {
+       starts[1] = ip;
+    } else {
+       starts[1] = start;
+    }
+    
     // trying to read too many Parcels
-    if ( ( n + ip ) > np ) {
-       std::cerr << " trying to read too many parcels: " << n + ip << " of " << np << std::endl;
+    if ( ( n + starts[1] ) > np ) {
+       std::cerr << " trying to read too many parcels: " << n + starts[1] << " of " << np << std::endl;
        throw(badFileConventions());        
     } 
     
     starts[0]= it;
-    starts[1] = ip;
     counts[0] = 1;
     counts[1] = n;
     strides[0] = 1;
@@ -1181,7 +1186,7 @@ void NetcdfIn::reset()
     ip = 0;
 }
 
-void NetcdfIn::rd_int( int var_id, int var_type, size_t n, int* destination )
+void NetcdfIn::rd_int( int var_id, int var_type, size_t n, int* destination, int start )
 {
     int err;
     size_t starts[2];
@@ -1193,14 +1198,19 @@ void NetcdfIn::rd_int( int var_id, int var_type, size_t n, int* destination )
     int    *ibuffr;
     long   *lbuffr;
     
+    if ( start < 0 ) {
+       starts[1] = ip;
+    } else {
+       starts[1] = start;
+    }
+    
     // trying to read too many Parcels
-    if ( ( n + ip ) > np ) {
-       std::cerr << " trying to read too many parcels: " << n + ip << " of " << np << std::endl;
+    if ( ( n + starts[1] ) > np ) {
+       std::cerr << " trying to read too many parcels: " << n + starts[1] << " of " << np << std::endl;
        throw(badFileConventions());        
     } 
     
     starts[0]= it;
-    starts[1] = ip;
     counts[0] = 1;
     counts[1] = n;
     strides[0] = 1;
@@ -1273,56 +1283,85 @@ void NetcdfIn::rd_int( int var_id, int var_type, size_t n, int* destination )
 
 
 
-void NetcdfIn::apply( Parcel& p )
+void NetcdfIn::rd_block( int start, int n, Parcel* dest )
 {
-    real lon, lat, z, tag;
-    double t;
-    int status,flags;
+    real *lons, *lats, *zs, *tags;
+    int *statuses, *flagsets;
+    int i;
     
+    if ( n <= 0 ) {
+       return;
+    }
     
-    lon = 0.0;
-    rd_real( vid_lon, vtyp_lon, 1, &lon );
-
-    lat = 0.0;
-    rd_real( vid_lat, vtyp_lat, 1, &lat );
-
-    z = 0.0;
-    rd_real( vid_z, vtyp_z, 1, &z );
-    z = z*vfactor;
-
-    p.setTime( t0 );
+    lons = new real[n];
+    lats = new real[n];
+    zs = new real[n];
+    tags = new real[n];
+    statuses = new int[n];
+    flagsets = new int[n];
+    
+    for ( i=0; i<n; i++ ) {
+        lons[i] = 0.0;
+        lats[i] = 0.0;
+        zs[i] = 0.0;
+        tags[i] = badtag;
+        statuses[i] = 0;
+        flagsets[i] = 0;
+    }
     
+    // one read per variable for the whole block
+    rd_real( vid_lon, vtyp_lon, n, lons, start );
+    rd_real( vid_lat, vtyp_lat, n, lats, start );
+    rd_real( vid_z, vtyp_z, n, zs, start );
     if ( vid_tag >= 0 ) {
-       tag = badtag;
-       rd_real( vid_tag, vtyp_tag, 1, &tag );
-    
-       p.tag( tag );
+       rd_real( vid_tag, vtyp_tag, n, tags, start );
     }
-
     if ( vid_status >= 0 ) {
-       status = 0.0;
-       rd_int( vid_status, vtyp_status, 1, &status );
-    
-       p.setStatus( status );
+       rd_int( vid_status, vtyp_status, n, statuses, start );
     }
-    
     if ( vid_flags >= 0 ) {
-       flags = 0.0;
-       rd_int( vid_flags, vtyp_flags, 1, &flags );
-    
-       p.setFlags( flags );
+       rd_int( vid_flags, vtyp_flags, n, flagsets, start );
     }
     
-    // should only need to check longitude, since for dead Parcels
-    // all of lat, lon, z, and tag will be NaN.
-    if ( FINITE(lon) && ( lon != badlon ) ) {
-       p.setPos( lon, lat );
-       p.setZ( z );
-    } else {
-       p.setNoTrace();
-       p.setPos( 0.0, 0.0 );
-       p.setZ( 0.0 );
+    for ( i=0; i<n; i++ ) {
+    
+        dest[i].setTime( t0 );
+    
+        if ( vid_tag >= 0 ) {
+           dest[i].tag( tags[i] );
+        }
+        if ( vid_status >= 0 ) {
+           dest[i].setStatus( statuses[i] );
+        }
+        if ( vid_flags >= 0 ) {
+           dest[i].setFlags( flagsets[i] );
+        }
+
+        // should only need to check longitude, since for dead Parcels
+        // all of lat, lon, z, and tag will be NaN.
+        if ( FINITE(lons[i]) && ( lons[i] != badlon ) ) {
+           dest[i].setPos( lons[i], lats[i] );
+           dest[i].setZ( zs[i]*vfactor );
+        } else {
+           dest[i].setNoTrace();
+           dest[i].setPos( 0.0, 0.0 );
+           dest[i].setZ( 0.0 );
+        }
     }
+    
+    delete[] flagsets;
+    delete[] statuses;
+    delete[] tags;
+    delete[] zs;
+    delete[] lats;
+    delete[] lons;
+    
+}
+
+void NetcdfIn::apply( Parcel& p )
+{
+    
+    rd_block( ip, 1, &p );
         
     ip = ip + 1;
     
@@ -1330,7 +1369,6 @@ void NetcdfIn::apply( Parcel& p )
 
 void NetcdfIn::apply( Parcel * p, const int n ) 
 {
-    int i;
     int nn;
     
     //if ( n < 0 ) {
@@ -1343,15 +1381,14 @@ void NetcdfIn::apply( Parcel * p, const int n )
        nn = np - ip;
     }
     
-    for ( i=0; i<nn; i++ ) {
-       apply( p[i] );
-    }   
+    rd_block( ip, nn, p );
+    
+    ip = ip + nn;
 
 }
 
 void NetcdfIn::apply( std::vector<Parcel>& p ) 
 {
-    std::vector<Parcel>::iterator iip;
     size_t n;
     
     n = p.size();
@@ -1360,9 +1397,11 @@ void NetcdfIn::apply( std::vector<Parcel>& p )
        p.resize(n);
     }
     
-    for ( iip=p.begin(); iip != p.end(); iip++ ) {
-        apply( *iip );
-    }   
+    if ( n > 0 ) {
+       rd_block( ip, n, &(p[0]) );
+    }
+    
+    ip = ip + n;
 
 }
 
@@ -1400,10 +1439,11 @@ void NetcdfIn::apply( std::deque<Parcel>& p )
 
 void NetcdfIn::apply( Flock& p ) 
 {
-    Flock::iterator itp;
     int n;
-    Parcel px;
-    bool i_am_root;
+    int nlocal;
+    int first, last;
+    int idx;
+    Parcel* block;
     
     n = p.size();
     
@@ -1411,35 +1451,46 @@ void NetcdfIn::apply( Flock& p )
        throw (ParcelFilter::badparcelnum());
     };  
     
-    i_am_root = p.is_root();
-
-    for ( int i=0; i<p.size(); i++ ) {
-    
-       p.sync();
+    // Each tracing processor reads its own parcels straight from the file
+    // (met processors have none), so no parcels need to be sent around.
+    nlocal = p.local_size();
+    if ( nlocal > 0 ) {
+    
+       first = p.global_index( 0 );
+       last = first;
+       for ( int k=1; k<nlocal; k++ ) {
+           idx = p.global_index( k );
+           if ( idx < first ) {
+              first = idx;
+           }
+           if ( idx > last ) {
+              last = idx;
+           }
+       }
        
-       if ( i_am_root ) {
-          // get the parcel
-          apply( px );
-       }   
-       // If we are the root processor, the parcel px
-       // is valid, and it is sent to the processor
-       // to which it belongs.
-       // If we are not the root processor, then
-       // then px has no valid value, but the
-       // processor will ignore it and receive its
-       // parcel value from the root processor.
-       p.set( i, px, 0 );
-
-    }   
+       block = new Parcel[last - first + 1];
+       
+       rd_block( ip + first, last - first + 1, block );
+       
+       for ( int k=0; k<nlocal; k++ ) {
+           idx = p.global_index( k );
+           p.set( idx, block[idx - first], 1 );
+       }
+       
+       delete[] block;
+    }
+    
+    ip = ip + n;
 
 }
 
 void NetcdfIn::apply( Swarm& p )
 {
-    Swarm::iterator ip;
     int n;
-    Parcel px;
-    bool i_am_root;
+    int nlocal;
+    int first, last;
+    int idx;
+    Parcel* block;
     
     n = p.size();
     
@@ -1447,25 +1498,35 @@ void NetcdfIn::apply( Swarm& p )
        throw (ParcelFilter::badparcelnum());
     };  
     
-    i_am_root = p.is_root();
-
-    for ( int i=0; i<p.size(); i++ ) {
-
-       p.sync();
+    // Each tracing processor reads its own parcels straight from the file
+    // (met processors have none), so no parcels need to be sent around.
+    nlocal = p.local_size();
+    if ( nlocal > 0 ) {
+    
+       first = p.global_index( 0 );
+       last = first;
+       for ( int k=1; k<nlocal; k++ ) {
+           idx = p.global_index( k );
+           if ( idx < first ) {
+              first = idx;
+           }
+           if ( idx > last ) {
+              last = idx;
+           }
+       }
        
-          if ( i_am_root ) {
-             // get the parcel
-             apply( px );
-          }   
-          // If we are the root processor, the parcel px
-          // is valid, and it is sent to the processor
-          // to which it belongs.
-          // If we are not the root processor, then
-          // then px has no valid value, but the
-          // processor will ignore it and receive its
-          // parcel value from the root processor.
-          p.set( i, px, 0 );
-
-    }   
+       block = new Parcel[last - first + 1];
+       
+       rd_block( ip + first, last - first + 1, block );
+       
+       for ( int k=0; k<nlocal; k++ ) {
+           idx = p.global_index( k );
+           p.set( idx, block[idx - first], 1 );
+       }
+       
+       delete[] block;
+    }
+    
+    ip = ip + n;
 
 }
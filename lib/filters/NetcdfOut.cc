@@ -4,6 +4,7 @@
 #include <string.h>
 #include <sstream>
 #include "gigatraj/NetcdfOut.hh"
+#include "gigatraj/Instrument.hh"
 
 using namespace gigatraj;
 
@@ -2489,6 +2490,8 @@ void NetcdfOut::apply( Flock& p )
    Parcel* px;
    bool gotit;
    
+   GT_TIMER( outtimer, "NetcdfOut::apply Flock" );
+   
    stuff = NULLPTR;
 
    i_am_root = p.is_root();
@@ -2540,6 +2543,7 @@ void NetcdfOut::apply( Flock& p )
           
           notrace = true;
           
+          px = NULLPTR;
           try {
              // Try to get the parcel.
              // If this is the root processor, we get a valid pointer.
@@ -2595,6 +2599,11 @@ void NetcdfOut::apply( Flock& p )
                 tt = tttmp;
              }
           }   
+          
+          // (the owning processor gets a copy, too)
+          if ( px != NULLPTR ) {
+             delete px;
+          }
       }
       
       if ( ! FINITE(tt) ) {
@@ -2662,6 +2671,7 @@ void NetcdfOut::apply( Flock& p )
                 statuses[i] = Inert;
              }
              
+             px = NULLPTR;
              try {
                 // Now try to get the parcel.
                 // If this is the root processor, we get a valid pointer.
@@ -2714,6 +2724,11 @@ void NetcdfOut::apply( Flock& p )
                 }
          
              }
+             
+             // (the owning processor gets a copy, too)
+             if ( px != NULLPTR ) {
+                delete px;
+             }
          }
          if ( nstuff > 0 ) {
             // for each extra met field we want to outpout...
@@ -2791,6 +2806,8 @@ void NetcdfOut::apply( Swarm& p )
    Parcel* px;
    bool gotit;
 
+   GT_TIMER( outtimer, "NetcdfOut::apply Swarm" );
+   
    stuff = NULLPTR;
       
    i_am_root = p.is_root();
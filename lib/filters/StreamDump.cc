@@ -259,6 +259,9 @@ void StreamDump :: apply( Flock& p )
           sn = static_cast<std::streamsize>( bn*sizeof(char) );
           os->write( reinterpret_cast<char *>(&bn), static_cast<std::streamsize>(sizeof(int)) );
        }
+       if ( px != NULLPTR ) {
+          delete px;
+       }
     }
     
     for ( int i=0; i<n; i++ ) {
@@ -286,6 +289,11 @@ void StreamDump :: apply( Flock& p )
                     os->write( output, sn );
                  }
               }   
+              
+              // (the owning processor gets a copy, too)
+              if ( px != NULLPTR ) {
+                 delete px;
+              }
            } catch (Flock::badparcelindex()) {
              // no problem. ignore this.  
            }; 
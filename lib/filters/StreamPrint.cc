@@ -2,6 +2,7 @@
 #include "config.h"
 
 #include "gigatraj/StreamPrint.hh"
+#include "gigatraj/Instrument.hh"
 #include <iostream>
 #include <sstream>
 
@@ -874,6 +875,8 @@ void StreamPrint :: apply( Flock& p )
     Parcel *px;
     bool i_am_root;
     
+    GT_TIMER( outtimer, "StreamPrint::apply Flock" );
+    
     n = p.size();
     
     if ( n <= 0 ) {
@@ -894,6 +897,7 @@ void StreamPrint :: apply( Flock& p )
         // the ith parcel.
         //p.sync("StreamPrint::apply");
 
+        px = NULLPTR;
         try {
            // get the parcel.
            // If this is the root processor, we get a valid pointer.
@@ -926,6 +930,11 @@ void StreamPrint :: apply( Flock& p )
            }
 
         }
+        
+        // (the owning processor gets a copy, too)
+        if ( px != NULLPTR ) {
+           delete px;
+        }
 
    }   
 
@@ -943,6 +952,8 @@ void StreamPrint :: apply( Swarm& p )
     Parcel *px;
     bool i_am_root;
     
+    GT_TIMER( outtimer, "StreamPrint::apply Swarm" );
+    
     n = p.size();
     
     if ( n <= 0 ) {
@@ -1759,6 +1759,128 @@ void BilinearHinterp::vinterpVector( int n, const real* lons, const real* lats,
 
 }
 
+void BilinearHinterp::vinterpVector( int n, const real* lons, const real* lats, const real* zs, real* xvals, real* yvals, const GridLatLonField3D& xgrid, const GridLatLonField3D& ygrid, const Vinterp& vin, HLatLonStencil& stencil, int flags ) const 
+{
+     // the bad-or-missing-data fill value
+     real xbad, ybad;
+     // data values at the four grid points that surround each desired lat and lon
+     real *xvalsprf, *yvalsprf;
+     // longitude indices of the four grid points that surround each desired lat and lon
+     const int *is;
+     // loop index for the grid vertical level
+     int k;
+     // number of vertical levels
+     int nzs;
+     // vectors to hold horizontally-interpolated data,
+     // which will subsequently be vertically interpolated
+     std::vector<real> xprofile, yprofile;
+     // index offset used in assembling indices from different grid levels
+     int idx;
+     // temp values for conformal adjustment
+     real xtmp, ytmp;
+     // other temp values
+     real x_val, y_val;
+     // lat, lon
+     real lat, lon;
+     // the weights of a point within its grid cell
+     real fx, fy;
+     // 
+     real cdlon, sdlon;
+     //
+     real tmplon;
+
+     if ( n <= 0 ) {
+        return;
+     }
+
+     if ( ! xgrid.compatible( ygrid ) )  {
+        throw (badincompatible());
+     }
+
+     // find the grid cells and weights, reusing whatever we can
+     // (the two grids are compatible, so one stencil serves both)
+     stencil.update( n, lons, lats, xgrid );
+     nzs = stencil.levels();
+     is = stencil.is();
+     
+     // the bad-or-missing-data fill value
+     xbad = xgrid.fillval();
+     ybad = ygrid.fillval();
+     
+     // create arrays to hold the grid point values
+     xvalsprf = new real[4*nzs*n];
+     yvalsprf = new real[4*nzs*n];
+
+     // Get the values at the corners of the grid cells.
+     // The 0x02 flag ensures that each gridpoints() call results in a svr_done() call.
+     // (gridpoints() does not modify the indices; it just does not say so.)
+     xgrid.ask_for_data();
+     xgrid.gridpoints( 4*nzs*n, const_cast<int*>(stencil.indices()), xvalsprf, do_local(flags) | 0x02 );
+     ygrid.ask_for_data();
+     ygrid.gridpoints( 4*nzs*n, const_cast<int*>(stencil.indices()), yvalsprf, do_local(flags) | 0x02 );
+
+     for ( int i=0; i<n; i++ ) {
+
+        lon = xgrid.wrap( lons[i] );
+        lat = lats[i];
+        fx = stencil.xweight(i);
+        fy = stencil.yweight(i);
+
+        if ( confml == 1 ) {
+           if ( lat >= NEARPOLE || lat <= -NEARPOLE ) { 
+              for ( k=0; k<nzs; k++ ) {
+                  idx = (i*nzs + k)*4;
+                  for ( int ii=0; ii<4; ii++ ) {
+                      tmplon = xgrid.longitude(is[idx+ii]);
+                      cdlon = COS( (tmplon - lon)*RCONV  );
+                      sdlon = SIN( (tmplon - lon)*RCONV  );
+                      xtmp =  xvalsprf[idx + ii]*cdlon + yvalsprf[idx + ii]*sdlon; 
+                      ytmp = -xvalsprf[idx + ii]*sdlon + yvalsprf[idx + ii]*cdlon;
+                      xvalsprf[idx + ii] = xtmp;
+                      yvalsprf[idx + ii] = ytmp;
+                  }
+              }
+           }
+        }
+        
+        xprofile.clear();
+        yprofile.clear();
+     
+        for ( k=0; k<nzs; k++ ) {
+            
+            idx = ( i*nzs + k)*4;
+     
+            // all four values surrounding this location must be good
+            if ( xvalsprf[idx+0] != xbad && xvalsprf[idx+1] != xbad && xvalsprf[idx+2] != xbad && xvalsprf[idx+3] != xbad 
+              && yvalsprf[idx+0] != ybad && yvalsprf[idx+1] != ybad && yvalsprf[idx+2] != ybad && yvalsprf[idx+3] != ybad ) {
+
+                 x_val = this->minicalc( fx, fy
+                         , xvalsprf[idx+0], xvalsprf[idx+1], xvalsprf[idx+2], xvalsprf[idx+3] );
+
+                 y_val = this->minicalc( fx, fy
+                         , yvalsprf[idx+0], yvalsprf[idx+1], yvalsprf[idx+2], yvalsprf[idx+3] );
+
+            } else {
+                 x_val = xbad;
+                 y_val = ybad;
+            }
+
+            xprofile.push_back(x_val);
+            yprofile.push_back(y_val);
+     
+        }
+
+        // interpolate the horizontally-interplated profile vertically
+        xvals[i] = vin.profile( xgrid.levels(), xprofile, zs[i], xbad, flags );
+        yvals[i] = vin.profile( ygrid.levels(), yprofile, zs[i], ybad, flags );
+
+     }
+     
+     delete[] xvalsprf;
+     delete[] yvalsprf;
+
+}
+
 void BilinearHinterp::vinterpVector( int n, const real* lons, const real* lats, const real* zs, real* xvals, real* yvals, const GridField3D& xgrid, const GridField3D& ygrid, const Vinterp& vin, int flags ) const 
 {
      vinterpVector( n, lons, lats, zs, xvals, yvals, dynamic_cast<const GridLatLonField3D&>(xgrid), dynamic_cast<const GridLatLonField3D&>(ygrid), vin, flags );
@@ -2236,6 +2358,168 @@ void BilinearHinterp::vinterp( const int n, const real* lons, const real* lats,
      
 }
 
+void BilinearHinterp::vinterp( const int n, const real* lons, const real* lats, const real* zs, real* results, const GridLatLonField3D& grid, const Vinterp& vin, HLatLonStencil& stencil, int flags ) const
+{
+     // the bad-or-missing-data fill value
+     real bad;
+     // data values at the four grid points that surround each desired lat and lon
+     real *vals;
+     // loop index for the grid vertical level
+     int k;
+     // number of vertical levels
+     int nzs;
+     // a vector to hold horizontally-interpolated data,
+     // which will subsequently be vertically interpolated
+     std::vector<real> profile;
+     // index offset used in assembling indices from different grid levels
+     int idx;
+     // temporary variable to hold an interpolated result
+     real val;
+     // the weights of a point within its grid cell
+     real fx, fy;
+     
+     if ( n <= 0 ) {
+        return;
+     }
+     
+     // find the grid cells and weights, reusing whatever we can
+     stencil.update( n, lons, lats, grid );
+     nzs = stencil.levels();
+     
+     // the bad-or-missing-data fill value
+     bad = grid.fillval();
+     
+     // create an array to hold the grid point values
+     vals = new real[4*n*nzs];
+          
+     // Get the values at the corners of the grid cells.
+     // (gridpoints() does not modify the indices; it just does not say so.)
+     grid.ask_for_data();
+     grid.gridpoints( 4*n*nzs, const_cast<int*>(stencil.indices()), vals, do_local(flags) );
+
+     // for each input point
+     for ( int i=0; i<n; i++ ) {
+         
+         fx = stencil.xweight(i);
+         fy = stencil.yweight(i);
+         
+         // empty out the vertical profile
+         profile.clear();
+         
+         // for each vertical level in the profile
+         for ( k=0; k<nzs; k++ ) {
+             
+             idx = ( k + i*nzs )*4;
+
+             // all four values surrounding this location must be good
+             if ( vals[idx+0] != bad && vals[idx+1] != bad 
+               && vals[idx+2] != bad && vals[idx+3] != bad ) {
+
+                  val = this->minicalc( fx, fy
+                          , vals[idx+0], vals[idx+1], vals[idx+2], vals[idx+3] );
+
+             } else {
+                  val = bad;
+             }
+
+             profile.push_back(val);
+        
+         }
+
+         // interpolate the horizontally-interplated profile vertically,
+         results[i] = vin.profile( grid.levels(), profile, zs[i], bad, flags );
+
+     }
+     
+     delete[] vals;
+     
+}
+
+bool BilinearHinterp::vinterpPair( const int n, const real* lons, const real* lats, const real* zs, real* results1, real* results2, const GridLatLonField3D& grid, const real* pairs, const Vinterp& vin, HLatLonStencil& stencil, int flags ) const
+{
+     // the bad-or-missing-data fill value
+     real bad;
+     // the direct indices of the corners of the grid cells
+     const int* idxs;
+     // loop index for the grid vertical level
+     int k;
+     // number of vertical levels
+     int nzs;
+     // vectors to hold horizontally-interpolated data at the two times,
+     // which will subsequently be vertically interpolated
+     std::vector<real> profile1;
+     std::vector<real> profile2;
+     // index offset used in assembling indices from different grid levels
+     int idx;
+     // the locations of the corner values in the interleaved array
+     int c0, c1, c2, c3;
+     // the weights of a point within its grid cell
+     real fx, fy;
+     
+     if ( n <= 0 ) {
+        return true;
+     }
+     
+     // find the grid cells and weights, reusing whatever we can
+     stencil.update( n, lons, lats, grid );
+     nzs = stencil.levels();
+     idxs = stencil.indices();
+     
+     // the bad-or-missing-data fill value
+     bad = grid.fillval();
+     
+     profile1.reserve( nzs );
+     profile2.reserve( nzs );
+     
+     // for each input point
+     for ( int i=0; i<n; i++ ) {
+         
+         fx = stencil.xweight(i);
+         fy = stencil.yweight(i);
+         
+         // empty out the vertical profiles
+         profile1.clear();
+         profile2.clear();
+         
+         // for each vertical level in the profile
+         for ( k=0; k<nzs; k++ ) {
+             
+             idx = ( k + i*nzs )*4;
+             
+             // each corner holds both times, side by side
+             c0 = 2*idxs[idx+0];
+             c1 = 2*idxs[idx+1];
+             c2 = 2*idxs[idx+2];
+             c3 = 2*idxs[idx+3];
+
+             // all four values surrounding this location must be good
+             if ( pairs[c0] != bad && pairs[c1] != bad 
+               && pairs[c2] != bad && pairs[c3] != bad ) {
+                  profile1.push_back( this->minicalc( fx, fy
+                          , pairs[c0], pairs[c1], pairs[c2], pairs[c3] ) );
+             } else {
+                  profile1.push_back( bad );
+             }
+             if ( pairs[c0+1] != bad && pairs[c1+1] != bad 
+               && pairs[c2+1] != bad && pairs[c3+1] != bad ) {
+                  profile2.push_back( this->minicalc( fx, fy
+                          , pairs[c0+1], pairs[c1+1], pairs[c2+1], pairs[c3+1] ) );
+             } else {
+                  profile2.push_back( bad );
+             }
+        
+         }
+
+         // interpolate the horizontally-interplated profiles vertically,
+         results1[i] = vin.profile( grid.levels(), profile1, zs[i], bad, flags );
+         results2[i] = vin.profile( grid.levels(), profile2, zs[i], bad, flags );
+
+     }
+     
+     return true;
+     
+}
+
 void BilinearHinterp::vinterp( const int n, const real* lons, const real* lats, const real* zs, real* results, const GridField3D& grid, const Vinterp& vin, int flags ) const
 {
     // downcast and interpolate
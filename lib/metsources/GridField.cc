@@ -17,8 +17,11 @@
 
 #include "config.h"
 #include <time.h>
+#include <algorithm>
 
 #include "gigatraj/GridField.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/EventTrace.hh"
 
 using namespace gigatraj;
 
@@ -90,7 +93,7 @@ GridField::GridField(const GridField& src)
        }   
        nd = src.nd;
        if ( nd > 0 ) {
-          dater = new real[nd];
+          dater = new gridreal[nd];
           for ( int i=0; i < nd; i++ ) {
              dater[i] = src.dater[i];
           }
@@ -99,7 +102,7 @@ GridField::GridField(const GridField& src)
     } else { 
        data.clear();
        if ( src.data.size() > 0 ) {
-            data = src.dump();
+            data = src.data;
        }
        dater = NULLPTR;
     }
@@ -155,7 +158,7 @@ void GridField::assign( const GridField& src)
        }
        nd = src.nd;
        if ( nd > 0 ) {
-          dater = new real[nd];
+          dater = new gridreal[nd];
           for ( int i=0; i < nd; i++ ) {
              dater[i] = src.dater[i];
           }
@@ -164,7 +167,7 @@ void GridField::assign( const GridField& src)
     } else { 
        data.clear();
        if ( src.data.size() > 0 ) {
-            data = src.dump();
+            data = src.data;
        }
        dater = NULLPTR;
     }
@@ -443,14 +446,15 @@ std::vector<real> GridField::dump()  const
    
    if ( hasdata() ) { 
       if ( use_array ) {
-         stuff.resize(nd);
+         stuff.reserve(nd);
          for ( int i=0; i < nd; i++ ) {
              stuff.push_back( dater[i] );
          }
          
          return stuff;
       } else {
-         return data;
+         stuff.assign( data.begin(), data.end() );
+         return stuff;
       }
    } else {
        std::cerr << "GridField Has no data" << std::endl;
@@ -824,3 +828,55 @@ std::string GridField::attribute( const std::string key ) const
 
 }
 
+void GridField::remote_gridpoints( int n, const int* indices, real* vals ) const
+{
+     // the distinct indices, in ascending order
+     std::vector<int> uniq;
+     // the values at the distinct indices
+     std::vector<real> uvals;
+     // number of distinct indices
+     int nu;
+     
+     if ( n <= 0 ) {
+        // the met processor is already waiting for a count,
+        // so tell it that we need nothing
+        n = 0;
+        pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
+        return;
+     }
+     
+     GT_TIMER( rtttimer, "GridField::remote_gridpoints round trip" );
+     GT_EVENT_BEGIN( rttevent );
+     
+     uniq.assign( indices, indices + n );
+     std::sort( uniq.begin(), uniq.end() );
+     uniq.erase( std::unique( uniq.begin(), uniq.end() ), uniq.end() );
+     nu = uniq.size();
+     GT_COUNT( "GridField::remote_gridpoints points", nu );
+     
+     if ( nu == n ) {
+     
+        // no duplicates, so ask for the points as given
+        pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
+        pgroup->send_ints( metproc, n, indices, PGR_TAG_GCOORDS );
+        pgroup->receive_reals( metproc, n, vals, PGR_TAG_GVALS );
+        
+     } else {
+     
+        //- std::cerr << "remote_gridpoints: " << n << " points -> " << nu << " unique" << std::endl;
+        uvals.resize( nu );
+        pgroup->send_ints( metproc, 1, &nu, PGR_TAG_GNUM );
+        pgroup->send_ints( metproc, nu, &(uniq[0]), PGR_TAG_GCOORDS );
+        pgroup->receive_reals( metproc, nu, &(uvals[0]), PGR_TAG_GVALS );
+        
+        // scatter the values back
+        for ( int i=0; i < n; i++ ) {
+            vals[i] = uvals[ std::lower_bound( uniq.begin(), uniq.end(), indices[i] ) - uniq.begin() ];
+        }
+     
+     }
+     
+     GT_EVENT_BYTES( sizeof(int) + nu*( sizeof(int) + sizeof(real) ) );
+     GT_EVENT_END( rttevent, "gridpoints", metproc, quant, ctime, -1 );
+
+}
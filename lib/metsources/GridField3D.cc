@@ -21,6 +21,8 @@
 #include <stdlib.h>
 
 #include "gigatraj/GridField3D.hh"
+#include "gigatraj/EventTrace.hh"
+#include "gigatraj/Instrument.hh"
 
 using namespace gigatraj;
 
@@ -40,6 +42,8 @@ GridField3D::GridField3D(): GridField()
    use_array = 1;
    nd = 0;
    dater = NULLPTR;
+   
+   clearHalo();
 
 }
 
@@ -59,6 +63,8 @@ GridField3D::GridField3D(const GridField3D& src): GridField(src)
         zs = src.zs;
 
         zs.setPgroup( pgroup, metproc );
+        
+        clearHalo();
 }
 
 void GridField3D::assign( const GridField3D& src )
@@ -73,6 +79,8 @@ void GridField3D::assign( const GridField3D& src )
             zs = src.zs; 
 
     zs.setPgroup( pgroup, metproc );
+    
+    clearHalo();
 }
 
 
@@ -83,6 +91,7 @@ void GridField3D::clear() {
    mksVScale = 1.0;
    mksVOffset = 0.0;
    zs.clear();
+   clearHalo();
    
    GridField::clear();   
 
@@ -111,7 +120,7 @@ real GridField3D::operator()( int i, int j, int k ) const
    return value(i,j,k);
 }        
 
-real& GridField3D::operator()( int i, int j, int k )  
+gridreal& GridField3D::operator()( int i, int j, int k )  
 {
    return valueref(i,j,k);
 }
@@ -180,7 +189,7 @@ real GridField3D::level( const int k ) const
    return zs(k);
 }; 
 
-void GridField3D::absorbLevels( int n, real* zvals )
+void GridField3D::absorbLevels( int n, gridreal* zvals )
 {
       if ( zvals != NULLPTR ) {
          zs.absorb( n, zvals );
@@ -321,6 +330,10 @@ void GridField3D::svr_send_vals( int id ) const
      real* vals;
      int cmd;
      int n;
+     int box[6];
+     int nx, ny, nz;
+     int nb;
+     int m;
      
      if ( metproc < 0 ) {
          // serial processing.  Send nothing, but
@@ -332,33 +345,157 @@ void GridField3D::svr_send_vals( int id ) const
      } else {
 
         //- std::cerr << "--- metproc starts sending values" << std::endl;    
+        GT_EVENT_BEGIN( sendevent );
         // get the number of points desired
         pgroup->receive_ints( id, 1, &n, PGR_TAG_GNUM );
         //- std::cerr << "      (*(*(* client " << id << " wants values for " << n << " points" << std::endl;
 
-        //- std::cerr << "--- metproc n=" << n << std::endl;    
-        // get the integer coordinates of the points
-        try {
-            coords = new int[n];
-        } catch(...) {
-           throw (badmemreq());
+        // A negative number is a request for a sub-block (see setHalo()).
+        // The client follows that with the individual points it still needs.
+        while ( n < 0 ) {
+        
+            pgroup->receive_ints( id, 6, box, PGR_TAG_GCOORDS );
+            dims( &nx, &ny, &nz );
+            nb = box[1]*box[3]*box[5];
+            try {
+               vals = new real[nb];
+            } catch(...) {
+               throw (badmemreq());
+            }
+            m = 0;
+            for ( int k=box[4]; k < box[4] + box[5]; k++ ) {
+               for ( int j=box[2]; j < box[2] + box[3]; j++ ) {
+                  for ( int i=box[0]; i < box[0] + box[1]; i++ ) {
+                     // (the first dimension may wrap around)
+                     vals[m++] = this->value( i % nx, j, k );
+                  }
+               }
+            }
+            pgroup->send_reals( id, nb, vals, PGR_TAG_GVALS );
+            GT_EVENT_BYTES( nb*sizeof(real) );
+            delete[] vals;
+            
+            pgroup->receive_ints( id, 1, &n, PGR_TAG_GNUM );
         }
-        //- std::cerr << "      (*(*(* about to receive " << n << " indices from " << id << std::endl;
-        pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
-        //- std::cerr << "      (*(*(* client " << id << " gave us indices" << std::endl;
-
-        // send the data values requested
-        vals = new real[n];
-        //- std::cerr << "      (*(*(* about to load vals from coords; coords[0]= " << coords[0] << std::endl;
-        for ( int i=0; i<n; i++ ) {
-            vals[i] = this->value( coords[i] );
+        
+        // (a zero count means the client needs nothing more)
+        if ( n > 0 ) {
+        
+           //- std::cerr << "--- metproc n=" << n << std::endl;    
+           // get the integer coordinates of the points
+           try {
+               coords = new int[n];
+           } catch(...) {
+              throw (badmemreq());
+           }
+           //- std::cerr << "      (*(*(* about to receive " << n << " indices from " << id << std::endl;
+           pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
+           //- std::cerr << "      (*(*(* client " << id << " gave us indices" << std::endl;
+
+           // send the data values requested
+           vals = new real[n];
+           //- std::cerr << "      (*(*(* about to load vals from coords; coords[0]= " << coords[0] << std::endl;
+           for ( int i=0; i<n; i++ ) {
+               vals[i] = this->value( coords[i] );
+           }
+           pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
+           GT_EVENT_BYTES( sizeof(int) + n*( sizeof(int) + sizeof(real) ) );
+           //- std::cerr << "      (*(*(* send client " << id << " gave us indices " << std::endl;
+           
+           delete[] vals;
+           delete[] coords;
         }
-        pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
-        //- std::cerr << "      (*(*(* send client " << id << " gave us indices " << std::endl;
+        GT_EVENT_END( sendevent, "send_vals", id, quant, ctime, -1 );
         //- std::cerr << "--- metproc stops sending values" << std::endl;    
         
-        delete vals;
-        delete coords;
+     }
+
+}
+
+void GridField3D::setHalo( real lon0, real lon1, real lat0, real lat1, real z0, real z1 )
+{
+     for ( int i=0; i < 6; i++ ) {
+         halo_want[i] = 0;
+     }
+}
+
+void GridField3D::clearHalo()
+{
+     for ( int i=0; i < 6; i++ ) {
+         halo_want[i] = 0;
+         halo_have[i] = 0;
+     }
+     halo_vals.clear();
+}
+
+void GridField3D::halo_gridpoints( int n, const int* is, const int* js, const int* ks, const int* indices, real* vals ) const
+{
+     int cmd;
+     int nx, ny, nz;
+     int nb;
+     int ii, jj, kk;
+     // indices and positions of the points not in the sub-block
+     std::vector<int> rest;
+     std::vector<int> restpos;
+     std::vector<real> restvals;
+     
+     if ( halo_want[1] <= 0 ) {
+        // no region set; ask for everything
+        remote_gridpoints( n, indices, vals );
+        return;
+     }
+     
+     dims( &nx, &ny, &nz );
+     
+     // do we need to fetch a new sub-block?
+     // (we do not if the one we have already covers the one we want)
+     if ( halo_have[1] <= 0
+       || ! ( ( halo_have[1] >= nx || ( ( halo_want[0] - halo_have[0] + nx ) % nx ) + halo_want[1] <= halo_have[1] )
+           && halo_want[2] >= halo_have[2] && halo_want[2] + halo_want[3] <= halo_have[2] + halo_have[3]
+           && halo_want[4] >= halo_have[4] && halo_want[4] + halo_want[5] <= halo_have[4] + halo_have[5] ) ) {
+     
+        GT_TIMER( halotimer, "GridField3D::halo_gridpoints sub-block fetch" );
+        GT_EVENT_BEGIN( haloevent );
+        nb = halo_want[1]*halo_want[3]*halo_want[5];
+        halo_vals.resize( nb );
+        cmd = -1;
+        pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GNUM );
+        pgroup->send_ints( metproc, 6, halo_want, PGR_TAG_GCOORDS );
+        pgroup->receive_reals( metproc, nb, &(halo_vals[0]), PGR_TAG_GVALS );
+        for ( int i=0; i < 6; i++ ) {
+            halo_have[i] = halo_want[i];
+        }
+        GT_COUNT( "GridField3D::halo_gridpoints sub-block points", nb );
+        GT_EVENT_BYTES( 7*sizeof(int) + nb*sizeof(real) );
+        GT_EVENT_END( haloevent, "halo", metproc, quant, ctime, -1 );
+        //- std::cerr << "halo_gridpoints: fetched " << nb << " points from " << metproc << std::endl;
+     }
+     
+     for ( int m=0; m < n; m++ ) {
+         ii = ( ( is[m] - halo_have[0] ) % nx + nx ) % nx;
+         jj = js[m] - halo_have[2];
+         kk = ks[m] - halo_have[4];
+         if ( ii < halo_have[1] 
+           && jj >= 0 && jj < halo_have[3]
+           && kk >= 0 && kk < halo_have[5] ) {
+            vals[m] = halo_vals[ ii + halo_have[1]*( jj + halo_have[3]*kk ) ];
+         } else {
+            rest.push_back( indices[m] );
+            restpos.push_back( m );
+         }
+     }
+     GT_COUNT( "GridField3D::halo_gridpoints points outside the sub-block", rest.size() );
+     
+     if ( rest.size() > 0 ) {
+        restvals.resize( rest.size() );
+        remote_gridpoints( rest.size(), &(rest[0]), &(restvals[0]) );
+        for ( int m=0; m < rest.size(); m++ ) {
+            vals[ restpos[m] ] = restvals[m];
+        }
+     } else {
+        // tell the met processor that we need no individual points
+        cmd = 0;
+        pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GNUM );
      }
 
 }
@@ -502,7 +639,7 @@ GridField3D::iterator& GridField3D::iterator::operator=(const GridField3D::itera
 
 
 /// override operator *, returns a pointer to the current data element
-real& GridField3D::iterator::operator*() const 
+gridreal& GridField3D::iterator::operator*() const 
 {
    
    if ( my_grid->use_array ) {     
@@ -239,7 +239,7 @@ void GridFieldDim::set_value( int i, real val )
 
 }    
 
-void GridFieldDim::absorb( int n, real* vals )
+void GridFieldDim::absorb( int n, gridreal* vals )
 {
      
      if ( checkdim( n, vals ) ) {
@@ -259,11 +259,11 @@ void GridFieldDim::absorb( int n, real* vals )
 }
 
 
-real* GridFieldDim::extract( int *n ) const 
+gridreal* GridFieldDim::extract( int *n ) const 
 {
-    real* result;
+    gridreal* result;
     
-    result = new real[nd];
+    result = new gridreal[nd];
     
     for ( int i=0; i < nd; i++ ) {
         result[i] = dater[i];
@@ -280,7 +280,6 @@ real* GridFieldDim::values( int n, real* vals, int *indices ) const
 {
      int indx;
      int ref;
-     int i,j;
 
      if ( ! hasdata() ) {
          std::cerr << "GridFieldDim: has no data in values() call" << std::endl;
@@ -384,11 +383,11 @@ bool GridFieldDim::checkdim( const realvec& inx ) const
 
 }
 
-bool GridFieldDim::checkdim( int n, const real* inx ) const
+bool GridFieldDim::checkdim( int n, const gridreal* inx ) const
 {
     bool result;
     int i;
-    real val;
+    gridreal val;
     
     result = false;
     
@@ -438,14 +437,13 @@ void GridFieldDim::setDir( const int loadFlags )
 void GridFieldDim::load( const realvec& inx, const int loadFlags  )
 {
    int indx = 0;
-   int i;
    
    checkdim(inx);
    
    nzs = inx.size();  
    flushData();
    nd = inx.size();
-   dater = new real[nd];
+   dater = new gridreal[nd];
    for ( int i=0; i < nd; i++ ) {
       dater[i] = inx[i];
    }
@@ -585,11 +583,17 @@ void GridFieldDim::receive_meta()
          flushData();
          nd = nzs;
          try {
-            dater = new real[nd];
+            dater = new gridreal[nd];
+            dimvals = new real[nd];
          } catch(...) {
             throw (badmemreq());
          }
-         pgroup->receive_reals( metproc, nzs, dater, PGR_TAG_GDIMS ); 
+         // the coordinates go over the wire as reals
+         pgroup->receive_reals( metproc, nzs, dimvals, PGR_TAG_GDIMS ); 
+         for ( i=0; i < nd; i++ ) {
+             dater[i] = dimvals[i];
+         }
+         delete[] dimvals;
          //- std::cerr << "   GridFieldDim::receive_meta: r-210 " << nzs << " from " << metproc  << std::endl;
          //- std::cerr << "   GridFieldDim::receive_meta: r-210 ; dater[1] = " << dater[1]  << std::endl;
          
@@ -638,7 +642,12 @@ void GridFieldDim::svr_send_meta(int id) const
          //- std::cerr << "   GridFieldDim::svr_send_meta: s-200 to " << id << std::endl;
 
          // send the coordinates
-         pgroup->send_reals( id, nd, dater, PGR_TAG_GDIMS ); 
+         dimvals = new real[nd];
+         for ( i=0; i < nd; i++ ) {
+             dimvals[i] = dater[i];
+         }
+         pgroup->send_reals( id, nd, dimvals, PGR_TAG_GDIMS ); 
+         delete[] dimvals;
    
      }
 
@@ -711,7 +720,7 @@ void GridFieldDim::deserialize(std::istream& is)
        flushData();
        nd = nxzs;
        if ( nd > 0 ) {
-          dater = new real[nd];
+          dater = new gridreal[nd];
           for ( i=0; i<nxzs; i++ ) {
               is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real) ));
               dater[i] = val;
@@ -731,7 +740,7 @@ void GridFieldDim::deserialize(std::istream& is)
 
 void GridFieldDim::svr_send_vals( int id ) const
 {
-     int* coords;
+     int* dimvals;
      real* vals;
      int cmd;
      int n;
@@ -751,23 +760,23 @@ std::cerr << "--- Hey 08" << std::endl;
 
         // get the integer coordinates of the points
         try {
-           coords = new int[n];
+           dimvals = new int[n];
         } catch (...) {
            throw (badmemreq());
         }
-        pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
+        pgroup->receive_ints( id, n, dimvals, PGR_TAG_GCOORDS );
 
         // send the data values requested
         vals = new real[n];
         for ( int i=0; i<n; i++ ) {
-            vals[i] = this->value( coords[i] );
+            vals[i] = this->value( dimvals[i] );
         }
         // todo: send error instead of numbers
         
         pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
         
-        delete vals;
-        delete coords;
+        delete[] vals;
+        delete[] dimvals;
      }
 
 }
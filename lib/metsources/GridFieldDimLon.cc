@@ -351,11 +351,17 @@ void GridFieldDimLon::receive_meta()
          flushData();
          nd = nzs;
          try {
-            dater = new real[nd];
+            dater = new gridreal[nd];
+            dimvals = new real[nd];
          } catch(...) {
             throw (badmemreq());
          }
-         pgroup->receive_reals( metproc, nzs, dater, PGR_TAG_GDIMS ); 
+         // the coordinates go over the wire as reals
+         pgroup->receive_reals( metproc, nzs, dimvals, PGR_TAG_GDIMS ); 
+         for ( i=0; i < nd; i++ ) {
+             dater[i] = dimvals[i];
+         }
+         delete[] dimvals;
 
          setDir();
          clear_nodata();
@@ -401,7 +407,12 @@ void GridFieldDimLon::svr_send_meta(int id) const
          //- std::cerr << "   GridFieldDimLon::svr_send_meta: s-200 to " << id << std::endl;
 
          // send the coordinates
-         pgroup->send_reals( id, nd, dater, PGR_TAG_GDIMS ); 
+         dimvals = new real[nd];
+         for ( i=0; i < nd; i++ ) {
+             dimvals[i] = dater[i];
+         }
+         pgroup->send_reals( id, nd, dimvals, PGR_TAG_GDIMS ); 
+         delete[] dimvals;
    
      }
 
@@ -413,7 +424,6 @@ void GridFieldDimLon::serialize(std::ostream& os) const
   int prec;
   string str;
   int len;
-  int i, j;
   double t;
   real val;
   int ival;
@@ -446,7 +456,6 @@ void GridFieldDimLon::deserialize(std::istream& is)
    string str;
    int len;
    char cc;
-   int i;
    double t;
    real val;
    int ival;
@@ -476,7 +485,7 @@ void GridFieldDimLon::deserialize(std::istream& is)
 
 void GridFieldDimLon::svr_send_vals( int id ) const
 {
-     int* coords;
+     int* dimvals;
      real* vals;
      int cmd;
      int n;
@@ -495,23 +504,23 @@ void GridFieldDimLon::svr_send_vals( int id ) const
 
         // get the integer coordinates of the points
         try {
-           coords = new int[n];
+           dimvals = new int[n];
         } catch (...) {
            throw (badmemreq());
         }
-        pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
+        pgroup->receive_ints( id, n, dimvals, PGR_TAG_GCOORDS );
 
         // send the data values requested
         vals = new real[n];
         for ( int i=0; i<n; i++ ) {
-            vals[i] = this->value( coords[i] );
+            vals[i] = this->value( dimvals[i] );
         }
         // todo: send error instead of numbers
         
         pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
         
-        delete vals;
-        delete coords;
+        delete[] vals;
+        delete[] dimvals;
      }
 
 }
@@ -185,9 +185,9 @@ real GridFieldProfile::value( int i )  const
 };
 
 
-real& GridFieldProfile::valueref( int i ) 
+gridreal& GridFieldProfile::valueref( int i ) 
 {
-   real* result;
+   gridreal* result;
 
    if ( ! hasdata() ) {
        throw (baddatareq());
@@ -206,7 +206,6 @@ real* GridFieldProfile::values( int n, real* vals, int *indices ) const
 {
      int indx;
      int ref;
-     int i,j;
 
      if ( ! hasdata() ) {
          std::cerr << "GridFieldProfile: has no data in values() call" << std::endl;
@@ -237,7 +236,7 @@ real GridFieldProfile::operator()( int i ) const
    return value(i);
 }        
 
-real& GridFieldProfile::operator()( int i )
+gridreal& GridFieldProfile::operator()( int i )
 {
    return valueref(i);
 }        
@@ -284,14 +283,13 @@ void GridFieldProfile::transform( const std::string unyts, real scale, real offs
 void GridFieldProfile::load( const realvec& inx, const realvec& indata, const int loadFlags  )
 {
    int indx = 0;
-   int i;
    
    zs.load( inx );   
    
    clearData();
    
    nd = zs.size();
-   dater = new real[nd];
+   dater = new gridreal[nd];
 
    // copy the data   
    for (int indx=0; indx < zs.size(); indx++ ) {
@@ -305,7 +303,6 @@ void GridFieldProfile::load( const realvec& inx, const realvec& indata, const in
 void GridFieldProfile::load( const realvec& indata, const int loadFlags  )
 {
    int indx = 0;
-   int i;
    
    if ( zs.size() != indata.size() ) {
       throw(badincompatcoords());
@@ -314,7 +311,7 @@ void GridFieldProfile::load( const realvec& indata, const int loadFlags  )
    clearData();
    
    nd = zs.size();
-   dater = new real[nd];
+   dater = new gridreal[nd];
 
    // copy the data   
    for (int indx=0; indx < zs.size(); indx++ ) {
@@ -460,6 +457,7 @@ void GridFieldProfile::gridpoints( int n, int* is, real* vals, int flags ) const
 void GridFieldProfile::receive_meta()
 {
      real* dimvals;
+     gridreal* zvals;
      int cmd;
      int i;
      int nzs;
@@ -502,12 +500,17 @@ void GridFieldProfile::receive_meta()
          
          try {
             dimvals = new real[nzs];
+            zvals = new gridreal[nzs];
          } catch(...) {
             throw (badmemreq());
          }
          pgroup->receive_reals( metproc, nzs, dimvals, PGR_TAG_GDIMS ); 
-         zs.absorb(nzs, dimvals);
-         // note; no NOT delete dimvels here; zs now owns that array
+         for ( i=0; i < nzs; i++ ) {
+             zvals[i] = dimvals[i];
+         }
+         delete[] dimvals;
+         zs.absorb(nzs, zvals);
+         // note; no NOT delete zvals here; zs now owns that array
 
          metaID = 0;
    
@@ -660,7 +663,7 @@ void GridFieldProfile::deserialize(std::istream& is)
           // read the data
 
           nd = nxzs;
-          dater = new real[nd];
+          dater = new gridreal[nd];
           for ( i=0; i < nd; i++ ) {
               is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real) ));
               dater[i] = val;
@@ -745,7 +748,7 @@ GridFieldProfile::iterator& GridFieldProfile::iterator::operator=(const GridFiel
 
 
 /// override operator *, returns a reference to the current data element
-real& GridFieldProfile::iterator::operator*() const 
+gridreal& GridFieldProfile::iterator::operator*() const 
 {
 
    if ( my_index >= 0 && my_index < my_grid->nd ) {
@@ -883,7 +886,7 @@ void GridFieldProfile::setPgroup( ProcessGrp* pg, int met)
 
 }
 
-void GridFieldProfile::absorb( int n, real* vals, real* dvals )
+void GridFieldProfile::absorb( int n, gridreal* vals, gridreal* dvals )
 {
      if ( dvals != NULLPTR ) {
         zs.absorb( n, dvals );
@@ -897,7 +900,7 @@ void GridFieldProfile::absorb( int n, real* vals, real* dvals )
      clear_nodata();
 }
 
-void GridFieldProfile::absorbZs( int n, real* dvals )
+void GridFieldProfile::absorbZs( int n, gridreal* dvals )
 {
      zs.absorb( n, dvals );     
 }
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 
 #include "gigatraj/GridFieldSfc.hh"
+#include "gigatraj/EventTrace.hh"
 
 using namespace gigatraj;
 
@@ -84,7 +85,7 @@ real GridFieldSfc::operator()( int i, const int j ) const
    return value(i,j);
 }        
 
-real& GridFieldSfc::operator()( int i, const int j )
+gridreal& GridFieldSfc::operator()( int i, const int j )
 {
    return valueref(i,j);
 }        
@@ -172,28 +173,34 @@ void GridFieldSfc::svr_send_vals( int id ) const
          
      } else {
      
+        GT_EVENT_BEGIN( sendevent );
         // get the number of points desired
         pgroup->receive_ints( id, 1, &n, PGR_TAG_GNUM );
 
-        // get the integer coordinates of the points
-        try {
-           coords = new int[n];
-        } catch (...) {
-           throw (badmemreq());
-        }
-        pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
-
-        // send the data values requested
-        vals = new real[n];
-        for ( int i=0; i<n; i++ ) {
-            vals[i] = this->value( coords[i] );
-        }
-        // todo: send error instead of numbers
+        // (a zero count means the client needs nothing more)
+        if ( n > 0 ) {
+
+           // get the integer coordinates of the points
+           try {
+              coords = new int[n];
+           } catch (...) {
+              throw (badmemreq());
+           }
+           pgroup->receive_ints( id, n, coords, PGR_TAG_GCOORDS );
+
+           // send the data values requested
+           vals = new real[n];
+           for ( int i=0; i<n; i++ ) {
+               vals[i] = this->value( coords[i] );
+           }
+           // todo: send error instead of numbers
         
-        pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
-        
-        delete vals;
-        delete coords;
+           pgroup->send_reals( id, n, vals, PGR_TAG_GVALS );
+           GT_EVENT_BYTES( sizeof(int) + n*( sizeof(int) + sizeof(real) ) );
+           delete[] vals;
+           delete[] coords;
+        }
+        GT_EVENT_END( sendevent, "send_vals", id, quant, ctime, -1 );
      }
 
 }
@@ -296,7 +303,7 @@ GridFieldSfc::iterator& GridFieldSfc::iterator::operator=(const GridFieldSfc::it
 
 
 /// override operator *, returns a reference to the current data element
-real& GridFieldSfc::iterator::operator*() const 
+gridreal& GridFieldSfc::iterator::operator*() const 
 {
 
    if ( my_grid->use_array ) {
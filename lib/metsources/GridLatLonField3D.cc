@@ -109,6 +109,138 @@ void GridLatLonField3D::setPgroup( ProcessGrp* pg, int met)
 
 }
 
+// finds the span of indices into an ordered dimension that covers a range of values,
+// plus one index on either side
+static void haloSpan( const std::vector<real>& v, real a, real b, int* i0, int* ni )
+{
+     int imin;
+     int imax;
+     int n;
+     real tmp;
+     
+     if ( a > b ) {
+        tmp = a;
+        a = b;
+        b = tmp;
+     }
+     
+     n = v.size();
+     imin = n;
+     imax = -1;
+     for ( int i=0; i < n; i++ ) {
+         if ( v[i] >= a && v[i] <= b ) {
+            if ( i < imin ) {
+               imin = i;
+            }
+            if ( i > imax ) {
+               imax = i;
+            }
+         }
+     }
+     if ( imax < 0 ) {
+        // the range lies between two gridpoints; start from the nearer one
+        imin = 0;
+        for ( int i=1; i < n; i++ ) {
+            if ( ABS( v[i] - (a+b)/2.0 ) < ABS( v[imin] - (a+b)/2.0 ) ) {
+               imin = i;
+            }
+        }
+        imax = imin;
+     }
+     imin = imin - 1;
+     if ( imin < 0 ) {
+        imin = 0;
+     }
+     imax = imax + 1;
+     if ( imax >= n ) {
+        imax = n - 1;
+     }
+     
+     *i0 = imin;
+     *ni = imax - imin + 1;
+
+}
+
+void GridLatLonField3D::setHalo( real lon0, real lon1, real lat0, real lat1, real z0, real z1 )
+{
+     std::vector<real> vals;
+     std::vector<bool> inside;
+     real span;
+     real d;
+     int nx;
+     int count;
+     int start;
+     
+     // (any sub-block already held is kept until it is found
+     // not to cover the new region)
+     for ( int i=0; i < 6; i++ ) {
+         halo_want[i] = 0;
+     }
+     
+     nx = lons.size();
+     if ( nx <= 0 || lats.size() <= 0 || zs.size() <= 0 ) {
+        return;
+     }
+     
+     // longitudes
+     span = lon1 - lon0;
+     if ( span >= 360.0 || span < 0.0 ) {
+        halo_want[0] = 0;
+        halo_want[1] = nx;
+     } else {
+        vals = lons.dimension();
+        inside.resize( nx );
+        count = 0;
+        for ( int i=0; i < nx; i++ ) {
+            d = fmod( vals[i] - lon0, 360.0 );
+            if ( d < 0.0 ) {
+               d = d + 360.0;
+            }
+            inside[i] = ( d <= span );
+            if ( inside[i] ) {
+               count++;
+            }
+        }
+        if ( count == 0 ) {
+           // the range lies between two gridpoints; start from the nearer one
+           start = 0;
+           for ( int i=1; i < nx; i++ ) {
+               if ( ABS( fmod( vals[i] - lon0 - span/2.0 + 540.0, 360.0 ) - 180.0 )
+                  < ABS( fmod( vals[start] - lon0 - span/2.0 + 540.0, 360.0 ) - 180.0 ) ) {
+                  start = i;
+               }
+           }
+           count = 1;
+        } else {
+           // the longitudes are in order, so the ones inside
+           // the range form one run, possibly wrapping around
+           start = 0;
+           if ( count < nx ) {
+              for ( int i=0; i < nx; i++ ) {
+                  if ( inside[i] && ! inside[ (i - 1 + nx) % nx ] ) {
+                     start = i;
+                     break;
+                  }
+              }
+           }
+        }
+        // one more gridpoint on either side
+        halo_want[0] = ( start - 1 + nx ) % nx;
+        halo_want[1] = count + 2;
+        if ( halo_want[1] >= nx ) {
+           halo_want[0] = 0;
+           halo_want[1] = nx;
+        }
+     }
+     
+     // latitudes
+     haloSpan( lats.dimension(), lat0, lat1, &(halo_want[2]), &(halo_want[3]) );
+     
+     // vertical levels
+     haloSpan( zs.dimension(), z0, z1, &(halo_want[4]), &(halo_want[5]) );
+     
+}
+
 void GridLatLonField3D::dims( int* nlon, int* nlat, int* nv)  const
 {
    *nlon = lons.size();
@@ -183,9 +315,9 @@ real* GridLatLonField3D::values( int n, real* vals, int *indices ) const
      return vals;
 };
 
-real& GridLatLonField3D::valueref( int i, int j, int k )  
+gridreal& GridLatLonField3D::valueref( int i, int j, int k )  
 {
-     real *result;
+     gridreal *result;
      int indx;
 
      if ( ! hasdata() ) {
@@ -278,7 +410,7 @@ void GridLatLonField3D::load( const realvec& inlons, const realvec& inlats
    
    clearData();
    nd = nlons*nlats*nzs;
-   dater = new real[nd];   
+   dater = new gridreal[nd];   
 
    // copy the data   
    for (int indx=0; indx < nd; indx++ ) {
@@ -310,7 +442,7 @@ void GridLatLonField3D::load( const realvec& inlons, const realvec& inlats
 
    if ( loadFlags & GFL_PREFILL ) {
       nd = nlons*nlats*nzs;
-      dater = new real[nd];   
+      dater = new gridreal[nd];   
       for ( int i=0; i<nd; i++ ) {
          dater[i] = fill_value;
       }
@@ -327,7 +459,7 @@ void GridLatLonField3D::load( const realvec& indata, const int loadFlags )
       throw(badincompatcoords());
    }      
    nd = lons.size()*lats.size()*zs.size();
-   dater = new real[nd];   
+   dater = new gridreal[nd];   
    for ( int i=0; i<nd; i++ ) {
       dater[i] = indata[i];
    }
@@ -440,11 +572,11 @@ int GridLatLonField3D::doeswrap() const
 GridLatLonFieldSfc* GridLatLonField3D::extractSfc( int k ) const
 {
     GridLatLonFieldSfc* result;
-    real* newdata;
+    gridreal* newdata;
     std::string name;
     int indx;
     int ndx;
-    real* dimvals;
+    gridreal* dimvals;
     int nx;
     
     
@@ -471,7 +603,7 @@ GridLatLonFieldSfc* GridLatLonField3D::extractSfc( int k ) const
     result->set_surface( name );
     
     ndx = lons.size()*lats.size();
-    newdata = new real[ndx];
+    newdata = new gridreal[ndx];
     for ( int indx=0; indx < ndx; indx++ ) {
         newdata[indx] = dater[indx + k*ndx];
     }    
@@ -606,7 +738,7 @@ GridFieldSfc* GridLatLonField3D::areas() const
 
 }
 
-void GridLatLonField3D::absorb( int nlons, int nlats, int nzs, real* vals , real* lonvals, real* latvals, real *zvals)
+void GridLatLonField3D::absorb( int nlons, int nlats, int nzs, gridreal* vals , gridreal* lonvals, gridreal* latvals, gridreal *zvals)
 {
       if ( lonvals != NULLPTR ) {
          lons.absorb( nlons, lonvals );
@@ -625,7 +757,7 @@ void GridLatLonField3D::absorb( int nlons, int nlats, int nzs, real* vals , real
       
 }
 
-void GridLatLonField3D::absorbLons( int n, real* lonvals )
+void GridLatLonField3D::absorbLons( int n, gridreal* lonvals )
 {
       if ( lonvals != NULLPTR ) {
          lons.absorb( n, lonvals );
@@ -633,7 +765,7 @@ void GridLatLonField3D::absorbLons( int n, real* lonvals )
 
 }
 
-void GridLatLonField3D::absorbLats( int n, real* latvals )
+void GridLatLonField3D::absorbLats( int n, gridreal* latvals )
 {
       if ( latvals != NULLPTR ) {
          lats.absorb( n, latvals );
@@ -702,15 +834,8 @@ void GridLatLonField3D::gridpoints( int n, int* is, int* js, int* ks, real* vals
          //cmd = PGR_CMD_GDATA;
          // pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GREQ );
          //- std::cerr << "  about to send N to " << metproc << std::endl;
-         // send request for n points 
-         pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
-         //- std::cerr << "--- tracproc n=" << n << std::endl;    
-         //- std::cerr << "  sent N=" << n << " to " << metproc << std::endl;
-         // send the coordinates
-         pgroup->send_ints( metproc, n, coords, PGR_TAG_GCOORDS );
-         //- std::cerr << "  sent pnt indices to " << metproc << std::endl;
-         // receive the values
-         pgroup->receive_reals( metproc, n, vals, PGR_TAG_GVALS );
+         // send request for the n points, and receive the values
+         halo_gridpoints( n, is, js, ks, coords, vals );
          //- std::cerr << " yyyyyyyyyyyy: got " << n << " values " << std::endl;
      
          if ( done ) {
@@ -750,14 +875,16 @@ void GridLatLonField3D::gridpoints( int n, int* indices, real* vals, int flags)
          //cmd = PGR_CMD_GDATA;
          // pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GREQ );
          //- std::cerr << "  about to send N to " << metproc << std::endl;
-         // send request for n points 
-         pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
-         //- std::cerr << "  sent N=" << n << " to " << metproc << std::endl;
-         // send the coordinates
-         pgroup->send_ints( metproc, n, indices, PGR_TAG_GCOORDS );
-         //- std::cerr << "  sent pnt indices to " << metproc << std::endl;
-         // receive the values
-         pgroup->receive_reals( metproc, n, vals, PGR_TAG_GVALS );
+         // send request for the n points, and receive the values
+         if ( halo_want[1] > 0 ) {
+            std::vector<int> is(n);
+            std::vector<int> js(n);
+            std::vector<int> ks(n);
+            splitIndex( n, indices, &(is[0]), &(js[0]), &(ks[0]) );
+            halo_gridpoints( n, &(is[0]), &(js[0]), &(ks[0]), indices, vals );
+         } else {
+            remote_gridpoints( n, indices, vals );
+         }
          //- std::cerr << " yyyyyyyyyyyy: got " << n << " values " << std::endl;
      
          if ( done ) {
@@ -771,7 +898,7 @@ void GridLatLonField3D::gridpoints( int n, int* indices, real* vals, int flags)
 
 void GridLatLonField3D::receive_meta()
 {
-     real* dimvals;
+     gridreal* dimvals;
      int cmd;
      int i;
 
@@ -825,7 +952,7 @@ void GridLatLonField3D::receive_meta()
 
 void GridLatLonField3D::svr_send_meta(int id) const
 {
-     real* dimvals;
+     gridreal* dimvals;
      int cmd;
      int i;
 
@@ -959,11 +1086,11 @@ void GridLatLonField3D::deserialize(std::istream& is)
    real val;
    int ival;
    int nxlons, nxlats, nxzs;
-   real* xdata;
+   gridreal* xdata;
    int version;
-   real* xlons;
-   real* xlats;
-   real *xzs;
+   gridreal* xlons;
+   gridreal* xlats;
+   gridreal *xzs;
 
    clear();   
 
@@ -984,14 +1111,14 @@ void GridLatLonField3D::deserialize(std::istream& is)
             is.read( reinterpret_cast<char *>(&nxzs), static_cast<std::streamsize>( sizeof(int) ));
             
             // read the longitudes
-            xlons = new real[nxlons];
+            xlons = new gridreal[nxlons];
             for ( i=0; i<nxlons; i++ ) {
                 is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
                 xlons[i] = val;
             }    
             lons.absorb( nxlons, xlons );
             // read the latitudes
-            xlats = new real[nxlats];
+            xlats = new gridreal[nxlats];
             for ( i=0; i<nxlats; i++ ) {
                 is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
                 xlats[i] = val;
@@ -999,7 +1126,7 @@ void GridLatLonField3D::deserialize(std::istream& is)
             lats.absorb( nxlats, xlats );
             
             // read the levels
-            xzs = new real[nxzs];
+            xzs = new gridreal[nxzs];
             for ( i=0; i<nxzs; i++ ) {
                 is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
                 xzs[i] = val;
@@ -1020,7 +1147,7 @@ void GridLatLonField3D::deserialize(std::istream& is)
       } 
       
        // read the data
-       xdata = new real[nxlats*nxlons*nxzs];
+       xdata = new gridreal[nxlats*nxlons*nxzs];
        for ( i=0; i<nxlats*nxlons*nxzs; i++ ) {
            is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
            xdata[i] = val;
@@ -140,9 +140,9 @@ real GridLatLonFieldSfc::value( int i, int j )  const
 };
 
 
-real& GridLatLonFieldSfc::valueref( int i, int j ) 
+gridreal& GridLatLonFieldSfc::valueref( int i, int j ) 
 {
-   real* result;
+   gridreal* result;
    int indx;
 
    if ( ! hasdata() ) {
@@ -283,7 +283,7 @@ void GridLatLonFieldSfc::load( const realvec& inlons, const realvec& inlats, con
    
    clearData();
    nd = nlons*nlats;
-   dater = new real[nd];   
+   dater = new gridreal[nd];   
 
    // copy the data   
    for (int indx=0; indx < nd; indx++ ) {
@@ -304,7 +304,7 @@ void GridLatLonFieldSfc::load( const realvec& inlons, const realvec& inlats, con
 
    if ( loadFlags & GFL_PREFILL ) {
       nd = lons.size()*lats.size();
-      dater = new real[nd];
+      dater = new gridreal[nd];
       for ( int i=0; i<nd; i++ ) {
          dater[i] = fill_value;
       }
@@ -328,7 +328,7 @@ void GridLatLonFieldSfc::load( const realvec& indata, const int loadFlags )
    
    clearData();
    nd = nlons*nlats;
-   dater = new real[nd];
+   dater = new gridreal[nd];
    for ( int i=0; i<nd; i++ ) {
       dater[i] = indata[i];
    }
@@ -475,14 +475,14 @@ real GridLatLonFieldSfc::area(int i) const
 GridFieldSfc* GridLatLonFieldSfc::areas() const
 {
     GridLatLonFieldSfc* result;
-    real* newdata;
+    gridreal* newdata;
     real ar;
     real dlon, dlat;
     real lat1, lat2, lon1, lon2;
     int maxlon;
     int nlons, nlats;
-    real* newlats;
-    real* newlons;
+    gridreal* newlats;
+    gridreal* newlons;
     
     nlons = lons.size();
     nlats = lats.size();
@@ -494,9 +494,9 @@ GridFieldSfc* GridLatLonFieldSfc::areas() const
     result->set_fillval( -999.0 );
     result->set_surface( "" );
     
-    newdata = new real[nlons*nlats];
-    newlons = new real[nlons];
-    newlats = new real[nlats]; 
+    newdata = new gridreal[nlons*nlats];
+    newlons = new gridreal[nlons];
+    newlats = new gridreal[nlats]; 
     for ( int j=0; j<nlats; j++ ) {
         newlats[j] = lats(j);
         if ( j > 0 ) {
@@ -561,7 +561,7 @@ GridFieldSfc* GridLatLonFieldSfc::areas() const
 
 }
 
-void GridLatLonFieldSfc::absorb( int nlons, int nlats, real* vals , real* lonvals, real* latvals)
+void GridLatLonFieldSfc::absorb( int nlons, int nlats, gridreal* vals , gridreal* lonvals, gridreal* latvals)
 {
       if ( lonvals != NULLPTR ) {
          lons.absorb( nlons, lonvals );
@@ -577,7 +577,7 @@ void GridLatLonFieldSfc::absorb( int nlons, int nlats, real* vals , real* lonval
       
 }
 
-void GridLatLonFieldSfc::absorbLons( int n, real* lonvals )
+void GridLatLonFieldSfc::absorbLons( int n, gridreal* lonvals )
 {
       if ( lonvals != NULLPTR ) {
          lons.absorb( n, lonvals );
@@ -585,7 +585,7 @@ void GridLatLonFieldSfc::absorbLons( int n, real* lonvals )
 
 }
 
-void GridLatLonFieldSfc::absorbLats( int n, real* latvals )
+void GridLatLonFieldSfc::absorbLats( int n, gridreal* latvals )
 {
       if ( latvals != NULLPTR ) {
          lats.absorb( n, latvals );
@@ -662,12 +662,8 @@ void GridLatLonFieldSfc::gridpoints( int n, int* is, int* js, real* vals, int fl
          // send data request to central met reader process
          //cmd = PGR_CMD_GDATA;
          //pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GREQ );
-         // send request for n points 
-         pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
-         // send the coordinates
-         pgroup->send_ints( metproc, n, coords, PGR_TAG_GCOORDS );
-         // receive the values
-         pgroup->receive_reals( metproc, n, vals, PGR_TAG_GVALS );
+         // send request for the n points, and receive the values
+         remote_gridpoints( n, coords, vals );
 
          if ( done ) {
             svr_done();
@@ -705,12 +701,8 @@ void GridLatLonFieldSfc::gridpoints( int n, int* indices, real* vals, int flags)
          // send data request to central met reader process
          //cmd = PGR_CMD_GDATA;
          //pgroup->send_ints( metproc, 1, &cmd, PGR_TAG_GREQ );
-         // send request for n points 
-         pgroup->send_ints( metproc, 1, &n, PGR_TAG_GNUM );
-         // send the coordinates
-         pgroup->send_ints( metproc, n, indices, PGR_TAG_GCOORDS );
-         // receive the values
-         pgroup->receive_reals( metproc, n, vals, PGR_TAG_GVALS );
+         // send request for the n points, and receive the values
+         remote_gridpoints( n, indices, vals );
 
          if ( done ) {
             svr_done();
@@ -954,9 +946,9 @@ void GridLatLonFieldSfc::deserialize(std::istream& is)
    real val;
    int ival;
    int nxlons, nxlats;
-   real* xlons;
-   real *xlats;
-   real *xdata;
+   gridreal* xlons;
+   gridreal *xlats;
+   gridreal *xdata;
    int version;
    
    clear();
@@ -977,13 +969,13 @@ void GridLatLonFieldSfc::deserialize(std::istream& is)
            is.read( reinterpret_cast<char *>(&nxlats), static_cast<std::streamsize>( sizeof(int)) );
        
            // read the longitudes
-           xlons = new real[nxlons];
+           xlons = new gridreal[nxlons];
            for ( i=0; i<nxlons; i++ ) {
                is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
                xlons[i] = val;
            }    
            // read the latitudes
-           xlats = new real[nxlats];
+           xlats = new gridreal[nxlats];
            for ( i=0; i<nxlats; i++ ) {
                is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real)) );
                xlats[i] = val;
@@ -1003,7 +995,7 @@ void GridLatLonFieldSfc::deserialize(std::istream& is)
       } 
       
       // read the data
-      xdata = new real[nxlats*nxlons];
+      xdata = new gridreal[nxlats*nxlons];
       for ( i=0; i<nxlats*nxlons; i++ ) {
           is.read( reinterpret_cast<char *>(&val), static_cast<std::streamsize>( sizeof(real) ));
           xdata[i] = val;
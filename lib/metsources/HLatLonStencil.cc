@@ -0,0 +1,212 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+#include "config.h"
+
+#include "gigatraj/HLatLonStencil.hh"
+
+using namespace gigatraj;
+
+
+HLatLonStencil::HLatLonStencil()
+{
+    np = 0;
+    nlons = 0;
+    nlats = 0;
+    nzs = 0;
+    glon0 = 0.0;
+    glon1 = 0.0;
+    glat0 = 0.0;
+    glat1 = 0.0;
+    nhits = 0;
+    nmisses = 0;
+}
+
+HLatLonStencil::~HLatLonStencil()
+{
+}
+
+void HLatLonStencil::clear()
+{
+    for ( int i=0; i<np; i++ ) {
+        ok[i] = 0;
+    }
+}
+
+void HLatLonStencil::resetStats()
+{
+    nhits = 0;
+    nmisses = 0;
+}
+
+void HLatLonStencil::weights( int i, real lon, real lat, real& fx, real& fy ) const
+{
+     real fx1;
+     
+     // (this mirrors BilinearHinterp::minicalc(), 
+     //  including its handling of cells that straddle the longitude wrap point)
+     fx = lon2s[i] - lon1s[i];
+     if ( fx > 180.0 && lon2s[i] > lon1s[i] ) {
+        fx = fx - 360.0;
+     }   
+     if ( fx < -180.0 && lon2s[i] < lon1s[i] ) {
+        fx = fx + 360.0;
+     }   
+     fx1 = lon - lon1s[i];
+     if ( fx1 > 180.0 && lon2s[i] > lon1s[i] ) {
+        fx1 = fx1 - 360.0;
+     }   
+     if ( fx1 < -180.0 && lon2s[i] < lon1s[i] ) {
+        fx1 = fx1 + 360.0;
+     } 
+     fx = fx1 / fx;
+          
+     fy = ( lat - lat1s[i] ) / ( lat2s[i] - lat1s[i] );  
+
+}
+
+void HLatLonStencil::corners( int i, const GridLatLonField3D& grid )
+{
+     int idx;
+     
+     for ( int k=0; k<nzs; k++ ) {
+     
+         idx = (i*nzs + k)*4;
+         
+         iis[idx+0] = i1s[i];
+         jjs[idx+0] = j1s[i];
+         kks[idx+0] = k;
+         iis[idx+1] = i1s[i];
+         jjs[idx+1] = j2s[i];
+         kks[idx+1] = k;
+         iis[idx+2] = i2s[i];
+         jjs[idx+2] = j1s[i];
+         kks[idx+2] = k;
+         iis[idx+3] = i2s[i];
+         jjs[idx+3] = j2s[i];
+         kks[idx+3] = k;
+         
+         idxs[idx+0] = grid.joinIndex( i1s[i], j1s[i], k );
+         idxs[idx+1] = grid.joinIndex( i1s[i], j2s[i], k );
+         idxs[idx+2] = grid.joinIndex( i2s[i], j1s[i], k );
+         idxs[idx+3] = grid.joinIndex( i2s[i], j2s[i], k );
+         
+     }
+
+}
+
+void HLatLonStencil::update( int n, const real* lons, const real* lats, const GridLatLonField3D& grid )
+{
+     int gnlons, gnlats, gnzs;
+     real lon, lat;
+     real fx, fy;
+     int i1, i2, j1, j2;
+     
+     grid.dims( &gnlons, &gnlats, &gnzs );
+     
+     // if the grid geometry has changed, nothing we have is any good
+     if ( gnlons != nlons || gnlats != nlats || gnzs != nzs
+       || grid.longitude(0) != glon0 || grid.longitude(gnlons-1) != glon1
+       || grid.latitude(0) != glat0 || grid.latitude(gnlats-1) != glat1 ) {
+       
+        nlons = gnlons;
+        nlats = gnlats;
+        nzs = gnzs;
+        glon0 = grid.longitude(0);
+        glon1 = grid.longitude(gnlons-1);
+        glat0 = grid.latitude(0);
+        glat1 = grid.latitude(gnlats-1);
+        
+        // (the sizes of the corner arrays depend on nzs)
+        np = 0;
+        ok.clear();
+     
+     }
+     
+     if ( n != np ) {
+        // stencils for points that are still in the set remain usable
+        ok.resize( n, 0 );
+        plons.resize( n );
+        plats.resize( n );
+        i1s.resize( n );
+        i2s.resize( n );
+        j1s.resize( n );
+        j2s.resize( n );
+        lon1s.resize( n );
+        lon2s.resize( n );
+        lat1s.resize( n );
+        lat2s.resize( n );
+        fxs.resize( n );
+        fys.resize( n );
+        idxs.resize( 4*nzs*n );
+        iis.resize( 4*nzs*n );
+        jjs.resize( 4*nzs*n );
+        kks.resize( 4*nzs*n );
+        np = n;
+     }
+     
+     for ( int i=0; i<n; i++ ) {
+     
+         lon = grid.wrap( lons[i] );
+         lat = lats[i];
+         
+         if ( ok[i] ) {
+         
+            if ( lon == plons[i] && lat == plats[i] ) {
+               // same place as last time
+               nhits++;
+               continue;
+            }
+            
+            weights( i, lon, lat, fx, fy );
+            if ( fx >= 0.0 && fx <= 1.0 && fy >= 0.0 && fy <= 1.0 ) {
+               // still in the same cell
+               plons[i] = lon;
+               plats[i] = lat;
+               fxs[i] = fx;
+               fys[i] = fy;
+               nhits++;
+               continue;
+            }
+            
+         }
+         
+         // look the point up on the grid
+         // (this may throw an exception if the point is off the grid,
+         // in which case the point's stencil remains unusable)
+         ok[i] = 0;
+         grid.lonindex( lon, &i1, &i2 );
+         grid.latindex( lat, &j1, &j2 );
+         nmisses++;
+
+         i1s[i] = i1;
+         i2s[i] = i2;
+         j1s[i] = j1;
+         j2s[i] = j2;
+         lon1s[i] = grid.longitude(i1);
+         lon2s[i] = grid.longitude(i2);
+         lat1s[i] = grid.latitude(j1);
+         lat2s[i] = grid.latitude(j2);
+         
+         weights( i, lon, lat, fx, fy );
+         plons[i] = lon;
+         plats[i] = lat;
+         fxs[i] = fx;
+         fys[i] = fy;
+         
+         corners( i, grid );
+         
+         ok[i] = 1;
+         
+     }
+
+}
+
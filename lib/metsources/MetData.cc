@@ -18,14 +18,40 @@
 #include "config.h"
 
 #include "gigatraj/MetData.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/EventTrace.hh"
 
 #include <iostream>
 #include <fstream>
 #include <iosfwd>
 #include <sstream>
+#include <math.h>
+#include <stdint.h>
 
 using namespace gigatraj;
 
+#ifdef USE_THREADS
+// holds the number of each thread of a pool (plus 1, so that unnumbered threads are 0)
+static pthread_key_t thread_key;
+static pthread_once_t thread_once = PTHREAD_ONCE_INIT;
+
+static void init_threadkey()
+{
+    pthread_key_create( &thread_key, NULLPTR );
+}
+
+// sets up a lock that a thread may take more than once
+static void init_metlock( pthread_mutex_t* lock )
+{
+    pthread_mutexattr_t attr;
+    
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( lock, &attr );
+    pthread_mutexattr_destroy( &attr );
+}
+#endif
+
 // constructor
 MetData::MetData()
 { 
@@ -36,19 +62,62 @@ MetData::MetData()
      flags = 0;
      dbug = 0;
      cfgFile = "";
+     my_stepsync = 1;
+     my_steps = 0;
+     my_donecarry = 0;
+     my_stepserve = false;
+     my_skew = 0;
+     my_maxskew = 0;
+     my_halo = false;
+     my_halospeed = 150.0;
+     my_halodz = -1.0;
+     my_haloset = false;
+     my_levwin = false;
+     my_levwinpad = 2;
+     my_threads = 1;
+     my_lockdepth = 0;
+#ifdef USE_THREADS
+     init_metlock( &my_lock );
+#endif
 };
 
+// destructor
+MetData::~MetData()
+{
+#ifdef USE_THREADS
+     pthread_mutex_destroy( &my_lock );
+#endif
+}
+
 // copy constructor
 MetData::MetData( const MetData& src )
 {
 
    my_pgroup  = src.my_pgroup;
    my_metproc = src.my_metproc;
+   my_metshards = src.my_metshards;
    now = time(NULL);
    wfctr = src.wfctr;
    flags = 0;
    dbug = src.dbug;
    cfgFile = src.cfgFile;
+   my_stepsync = src.my_stepsync;
+   my_steps = 0;
+   my_donecarry = 0;
+   my_stepserve = false;
+   my_skew = 0;
+   my_maxskew = 0;
+   my_halo = src.my_halo;
+   my_halospeed = src.my_halospeed;
+   my_halodz = src.my_halodz;
+   my_haloset = false;
+   my_levwin = src.my_levwin;
+   my_levwinpad = src.my_levwinpad;
+   my_threads = 1;
+   my_lockdepth = 0;
+#ifdef USE_THREADS
+   init_metlock( &my_lock );
+#endif
 
 }
 
@@ -58,11 +127,19 @@ void MetData::assign( const MetData& src )
 
    my_pgroup  = src.my_pgroup;
    my_metproc = src.my_metproc;
+   my_metshards = src.my_metshards;
    now = src.now;
    wfctr = src.wfctr;
    flags = src.flags;
    dbug = src.dbug;
    cfgFile = src.cfgFile;
+   my_stepsync = src.my_stepsync;
+   my_halo = src.my_halo;
+   my_halospeed = src.my_halospeed;
+   my_halodz = src.my_halodz;
+   my_haloset = false;
+   my_levwin = src.my_levwin;
+   my_levwinpad = src.my_levwinpad;
 
 }
 
@@ -147,7 +224,102 @@ void MetData::setPgroup( ProcessGrp *pg, int met )
 
    my_pgroup = pg;
    my_metproc = met;
+   // a new process group invalidates any sharding
+   my_metshards.clear();
+   my_svrpend.clear();
+   // and starts the time step bookkeeping afresh
+   my_steps = 0;
+   my_clientsteps.clear();
+   my_donecarry = 0;
+   my_skew = 0;
+   my_maxskew = 0;
+
+}
+
+void MetData::setMetShards( const std::vector<int>& shards )
+{
+   int myid;
+   
+   my_metshards.clear();
+   my_svrpend.clear();
+   
+   if ( my_pgroup == NULLPTR || shards.size() == 0 ) {
+      return;
+   }
+   
+   my_metshards = shards;
+   
+   // by default, talk to the first shard
+   my_metproc = my_metshards[0];
+   
+   // but if we are one of the shards, then we are a met server
+   myid = my_pgroup->id();
+   for ( int i=0; i < my_metshards.size(); i++ ) {
+       if ( my_metshards[i] == myid ) {
+          my_metproc = myid;
+       }
+   }
+
+}
+
+int MetData::metShards() const
+{
+   int result;
+   
+   result = 0;
+   if ( my_pgroup != NULLPTR && my_metproc >= 0 ) {
+      result = my_metshards.size();
+      if ( result < 1 ) {
+         result = 1;
+      }
+   }
+   
+   return result;
+}
+
+int MetData::metShard( const std::string& quantity, double time )
+{
+   unsigned long hash;
+   long long tkey;
+   
+   if ( ! isMetSharded() ) {
+      return my_metproc;
+   }
+   
+   // FNV-1a hash of the quantity name...
+   hash = 2166136261UL;
+   for ( int i=0; i < quantity.size(); i++ ) {
+       hash = ( hash ^ (unsigned char)(quantity[i]) ) * 16777619UL;
+       hash = hash & 0xFFFFFFFFUL;
+   }
+   // ...mixed with the snapshot time (to the nearest microday or so),
+   // so that every processor maps a snapshot to the same shard
+   // no matter how the time was spelled
+   tkey = llround( time*1.0e6 );
+   for ( int i=0; i < 8; i++ ) {
+       hash = ( hash ^ (unsigned long)( tkey & 0xFF ) ) * 16777619UL;
+       hash = hash & 0xFFFFFFFFUL;
+       tkey = tkey >> 8;
+   }
 
+   return my_metshards[ hash % my_metshards.size() ];
+}
+
+int MetData::metClients() const
+{
+   int result;
+   
+   result = 0;
+   if ( my_pgroup != NULLPTR ) {
+      result = my_pgroup->size() - metShards();
+   }
+   
+   return result;
+}
+
+void MetData::expect_svr_status( int proc )
+{
+   my_svrpend.push_back( proc );
 }
 
 void MetData::sync( int mode )
@@ -169,10 +341,26 @@ int MetData::receive_svr_status()
 {
    int result;
    
+   int status;
+   
    result = PGR_STATUS_OK;
    
    if ( isMetClient() ) {
-       my_pgroup->receive_ints( my_metproc, 1, &result, PGR_TAG_STATUS );
+       GT_EVENT_BEGIN( waitevent );
+       if ( my_svrpend.size() == 0 ) {
+          my_pgroup->receive_ints( my_metproc, 1, &result, PGR_TAG_STATUS );
+          GT_EVENT_END( waitevent, "status wait", my_metproc, "", "", 0 );
+       } else {
+          // collect the status from each server to which we sent the request
+          for ( int i=0; i < my_svrpend.size(); i++ ) {
+              my_pgroup->receive_ints( my_svrpend[i], 1, &status, PGR_TAG_STATUS );
+              if ( status != PGR_STATUS_OK ) {
+                 result = status;
+              }
+          }
+          GT_EVENT_END( waitevent, "status wait", ( my_svrpend.size() == 1 ) ? my_svrpend[0] : -1, "", "", 0 );
+          my_svrpend.clear();
+       }
    }
 
    return result;
@@ -198,7 +386,14 @@ void MetData::signalMetDone()
          std::cerr << "MetData::signalMetDone: " << my_pgroup->id() << "/" << my_pgroup->group_id()
                    << " signaling DONE to met proc " << my_metproc << std::endl;
       }
-      my_pgroup->send_ints( my_metproc, 1, &client_req, PGR_TAG_REQ );
+      if ( isMetSharded() ) {
+         // every one of the met server shards has to hear from us
+         for ( int i=0; i < my_metshards.size(); i++ ) {
+             my_pgroup->send_ints( my_metshards[i], 1, &client_req, PGR_TAG_REQ );
+         }
+      } else {
+         my_pgroup->send_ints( my_metproc, 1, &client_req, PGR_TAG_REQ );
+      }
    }
    
    // everybody sync at this point
@@ -209,6 +404,397 @@ void MetData::signalMetDone()
 
 }
 
+void MetData::setStepSync( int every )
+{
+   if ( every < 0 ) {
+      every = 0;
+   }
+   my_stepsync = every;
+}
+
+int MetData::stepSync() const
+{
+   return my_stepsync;
+}
+
+void MetData::serveMetStep()
+{
+   int lo;
+   int hi;
+   
+   if ( my_stepsync == 1 ) {
+      // the usual lock-step
+      serveMet();
+      return;
+   }
+   
+   if ( isMetServer() ) {
+   
+      // is this a time step at which everyone synchronizes?
+      my_stepserve = ! ( my_stepsync > 1 && ( (my_steps + 1) % my_stepsync ) == 0 );
+      
+      serveMet();
+      
+      my_stepserve = false;
+      my_steps++;
+      
+      // how far apart are the clients now?
+      lo = -1;
+      hi = -1;
+      for ( int i=0; i < my_clientsteps.size(); i++ ) {
+          if ( my_clientsteps[i] >= 0 ) {
+             if ( lo < 0 || my_clientsteps[i] < lo ) {
+                lo = my_clientsteps[i];
+             }
+             if ( my_clientsteps[i] > hi ) {
+                hi = my_clientsteps[i];
+             }
+          }
+      }
+      my_skew = 0;
+      if ( lo >= 0 ) {
+         my_skew = hi - lo;
+      }
+      if ( my_skew > my_maxskew ) {
+         my_maxskew = my_skew;
+      }
+      GT_COUNT( "MetData::serveMetStep client skew", my_skew );
+      if ( dbug >= 2 ) {
+         std::cerr << "MetData::serveMetStep: " << my_pgroup->id() << "/" << my_pgroup->group_id()
+                   << " step " << my_steps << " client skew " << my_skew << " steps" << std::endl;
+      }
+   }
+
+}
+
+void MetData::signalMetStep()
+{
+   int client_req = PGR_CMD_STEP;
+   
+   if ( my_stepsync == 1 ) {
+      // the usual lock-step
+      signalMetDone();
+      return;
+   }
+   
+   my_steps++;
+   
+   if ( isMetClient() ) {
+      // tell the met server(s) that we have finished this step
+      if ( isMetSharded() ) {
+         for ( int i=0; i < my_metshards.size(); i++ ) {
+             my_pgroup->send_ints( my_metshards[i], 1, &client_req, PGR_TAG_REQ );
+         }
+      } else {
+         my_pgroup->send_ints( my_metproc, 1, &client_req, PGR_TAG_REQ );
+      }
+   }
+   
+   // is this a time step at which everyone synchronizes?
+   if ( my_stepsync > 1 && ( my_steps % my_stepsync ) == 0 ) {
+      signalMetDone();
+   }
+
+}
+
+int MetData::stepSkew() const
+{
+   return my_skew;
+}
+
+int MetData::maxStepSkew() const
+{
+   return my_maxskew;
+}
+
+void MetData::setHalo( bool mode, real speed, real dz )
+{
+   my_halo = mode;
+   my_halospeed = ABS( speed );
+   my_halodz = dz;
+   my_haloset = false;
+}
+
+bool MetData::halo() const
+{
+   return my_halo;
+}
+
+void MetData::setLevelWindow( bool mode, int pad )
+{
+   my_levwin = mode;
+   my_levwinpad = 0;
+   if ( pad > 0 ) {
+      my_levwinpad = pad;
+   }
+}
+
+bool MetData::levelWindow() const
+{
+   return my_levwin;
+}
+
+void MetData::haloRegion( int n, const real* lons, const real* lats, const real* zs, double dt, PlanetNav* nav )
+{
+   // longitude ranges, over [0,360) and over [-180,180)
+   real lo1 = 0.0;
+   real hi1 = 0.0;
+   real lo2 = 0.0;
+   real hi2 = 0.0;
+   real lon;
+   real dlat;
+   real dlon;
+   real coslat;
+   int m;
+   
+   my_haloset = false;
+   
+   // (sub-blocks are for met clients, level windows for met sources that read their own data)
+   if ( ! ( ( my_halo && isMetClient() ) || ( my_levwin && ! isMetClient() ) ) ) {
+      return;
+   }
+   
+   m = 0;
+   for ( int i=0; i < n; i++ ) {
+       // skip parcels with bad positions
+       if ( ! FINITE( lons[i] ) || ! FINITE( lats[i] ) || ! FINITE( zs[i] ) ) {
+          continue;
+       }
+       lon = fmod( lons[i], 360.0 );
+       if ( lon < 0.0 ) {
+          lon = lon + 360.0;
+       }
+       if ( m == 0 ) {
+          lo1 = hi1 = lon;
+          my_halobox[2] = my_halobox[3] = lats[i];
+          my_halobox[4] = my_halobox[5] = zs[i];
+       } else {
+          if ( lon < lo1 ) { lo1 = lon; }
+          if ( lon > hi1 ) { hi1 = lon; }
+          if ( lats[i] < my_halobox[2] ) { my_halobox[2] = lats[i]; }
+          if ( lats[i] > my_halobox[3] ) { my_halobox[3] = lats[i]; }
+          if ( zs[i] < my_halobox[4] ) { my_halobox[4] = zs[i]; }
+          if ( zs[i] > my_halobox[5] ) { my_halobox[5] = zs[i]; }
+       }
+       if ( lon >= 180.0 ) {
+          lon = lon - 360.0;
+       }
+       if ( m == 0 ) {
+          lo2 = hi2 = lon;
+       } else {
+          if ( lon < lo2 ) { lo2 = lon; }
+          if ( lon > hi2 ) { hi2 = lon; }
+       }
+       m++;
+   }
+   if ( m == 0 ) {
+      // no parcel has a usable position, so there is no region
+      return;
+   }
+   
+   // a met source that reads its own data may choose its vertical levels
+   if ( my_levwin && ! isMetClient() ) {
+      levelRange( my_halobox[4], my_halobox[5] );
+   }
+   if ( ! my_halo || ! isMetClient() ) {
+      return;
+   }
+   
+   // parcels that straddle the prime meridian span less of
+   // the [-180,180) range than of the [0,360) range 
+   if ( (hi2 - lo2) < (hi1 - lo1) ) {
+      my_halobox[0] = lo2;
+      my_halobox[1] = hi2;
+   } else {
+      my_halobox[0] = lo1;
+      my_halobox[1] = hi1;
+   }
+   
+   // how far (in degrees) can a parcel move in one time step?
+   // (dt is in days, and the planet's distances are in km)
+   dlat = my_halospeed * ABS( dt ) * 86400.0 / ( 1000.0 * nav->distance( 0.0, 0.0, 0.0, 1.0 ) );
+   
+   my_halobox[2] = my_halobox[2] - dlat;
+   if ( my_halobox[2] < -90.0 ) {
+      my_halobox[2] = -90.0;
+   }
+   my_halobox[3] = my_halobox[3] + dlat;
+   if ( my_halobox[3] > 90.0 ) {
+      my_halobox[3] = 90.0;
+   }
+   
+   coslat = cos( my_halobox[2] * PI / 180.0 );
+   if ( cos( my_halobox[3] * PI / 180.0 ) < coslat ) {
+      coslat = cos( my_halobox[3] * PI / 180.0 );
+   }
+   if ( coslat < 0.01 ) {
+      // close to the pole, so take all longitudes
+      my_halobox[1] = my_halobox[0] + 360.0;
+   } else {
+      dlon = dlat / coslat;
+      my_halobox[0] = my_halobox[0] - dlon;
+      my_halobox[1] = my_halobox[1] + dlon;
+      if ( my_halobox[1] - my_halobox[0] > 360.0 ) {
+         my_halobox[1] = my_halobox[0] + 360.0;
+      }
+   }
+   
+   if ( my_halodz >= 0.0 ) {
+      my_halobox[4] = my_halobox[4] - my_halodz;
+      my_halobox[5] = my_halobox[5] + my_halodz;
+   } else {
+      // all levels
+      my_halobox[4] = -1.0e30;
+      my_halobox[5] = 1.0e30;
+   }
+   
+   my_haloset = true;
+   
+}
+
+MetData::Lock::Lock( MetData* met )
+{
+   src = met;
+   src->lockMet();
+   held = true;
+}
+
+MetData::Lock::~Lock()
+{
+   if ( held ) {
+      src->unlockMet();
+   }
+}
+
+void MetData::Lock::release()
+{
+   // an outer call may be relying on a nested lock
+   if ( held && src->my_lockdepth == 1 ) {
+      src->unlockMet();
+      held = false;
+   }
+}
+
+void MetData::Lock::reacquire()
+{
+   if ( ! held ) {
+      src->lockMet();
+      held = true;
+   }
+}
+
+void MetData::lockMet()
+{
+#ifdef USE_THREADS
+   pthread_mutex_lock( &my_lock );
+   // (only the thread holding the lock touches this)
+   my_lockdepth++;
+#endif
+}
+
+void MetData::unlockMet()
+{
+#ifdef USE_THREADS
+   my_lockdepth--;
+   pthread_mutex_unlock( &my_lock );
+#endif
+}
+
+bool MetData::threadSafe() const
+{
+   return false;
+}
+
+void MetData::setThreads( int n )
+{
+   my_threads = ( n > 1 ) ? n : 1;
+}
+
+int MetData::threads() const
+{
+   return my_threads;
+}
+
+void MetData::setThread( int i )
+{
+#ifdef USE_THREADS
+   pthread_once( &thread_once, init_threadkey );
+   pthread_setspecific( thread_key, reinterpret_cast<void*>( static_cast<intptr_t>( i + 1 ) ) );
+#endif
+}
+
+int MetData::thread()
+{
+   int result;
+   
+   result = 0;
+#ifdef USE_THREADS
+   pthread_once( &thread_once, init_threadkey );
+   result = static_cast<int>( reinterpret_cast<intptr_t>( pthread_getspecific( thread_key ) ) ) - 1;
+   if ( result < 0 ) {
+      result = 0;
+   }
+#endif
+   
+   return result;
+}
+
+int MetData::serveBegin()
+{
+   int result;
+   
+   // any "done" signals that arrived while we were serving
+   // an unsynchronized time step count toward this loop
+   result = my_donecarry;
+   my_donecarry = 0;
+   
+   return result;
+}
+
+bool MetData::serving( int done_count, int done_goal ) const
+{
+   if ( my_stepserve ) {
+      // keep going until every client has finished the current step
+      for ( int i=0; i < my_clientsteps.size(); i++ ) {
+          if ( my_clientsteps[i] >= 0 && my_clientsteps[i] <= my_steps ) {
+             return true;
+          }
+      }
+      return ( my_clientsteps.size() == 0 && done_goal > 0 );
+   }
+   
+   return ( done_count < done_goal );
+}
+
+void MetData::clientStep( int src )
+{
+   if ( my_clientsteps.size() == 0 ) {
+      // every processor in the group is a client, except the met servers
+      my_clientsteps.resize( my_pgroup->size(), 0 );
+      if ( isMetSharded() ) {
+         for ( int i=0; i < my_metshards.size(); i++ ) {
+             my_clientsteps[ my_metshards[i] ] = -1;
+         }
+      } else {
+         my_clientsteps[ my_metproc ] = -1;
+      }
+   }
+   
+   my_clientsteps[src]++;
+}
+
+void MetData::serveEnd( int done_count )
+{
+   if ( my_stepserve ) {
+      // save these for the next synchronized loop
+      my_donecarry = done_count;
+   } else {
+      if ( my_pgroup != NULLPTR ) {
+         my_pgroup->sync();
+      }
+   }
+}
+
 
 int MetData::useMet()
 {
@@ -17,10 +17,14 @@
 
 #include "config.h"
 
+#include <limits>
+
 #include "gigatraj/MetGridData.hh"
 #include "gigatraj/BilinearHinterp.hh"
 #include "gigatraj/LinearVinterp.hh"
 #include "gigatraj/LogLinearVinterp.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/EventTrace.hh"
 
 using namespace gigatraj;
 
@@ -38,6 +42,11 @@ MetGridData::MetGridData() : MetData()
       hin = new BilinearHinterp();
       myHin = true;
       maxsnaps = 3;
+      cache_budget = 0;
+      cache_tick = 0;
+      cache_hits = 0;
+      cache_misses = 0;
+      cache_evictions = 0;
       
       // use CF conventions by default
       //  zonal wind
@@ -59,6 +68,9 @@ MetGridData::MetGridData() : MetData()
       
       diskcachedir = NULLPTR;
       diskcaching = false;
+#ifdef USE_SHMCACHE
+      shmcache = NULLPTR;
+#endif
       
       override_tbase = -1;
       override_tspace = -1;
@@ -101,6 +113,11 @@ MetGridData::~MetGridData()
      if ( diskcachedir != NULLPTR ) {
         delete diskcachedir;
      }   
+#ifdef USE_SHMCACHE
+     if ( shmcache != NULLPTR ) {
+        delete shmcache;
+     }
+#endif
 }
 
 // copy constructor
@@ -110,6 +127,9 @@ MetGridData::MetGridData( const MetGridData& src ) : MetData(src)
     // The  MetGridData::assign method calls the MetData::assign() method
     // which is a redundant. Not very efficient, but should cause no harm.
     // the benefit is that we only have to maintain the assign() method below.
+#ifdef USE_SHMCACHE
+    shmcache = NULLPTR;
+#endif
     assign(src);
 }
 
@@ -152,6 +172,11 @@ void MetGridData::assign( const MetGridData& src )
       }
 
       maxsnaps = src.maxsnaps;
+      cache_budget = src.cache_budget;
+      cache_tick = 0;
+      cache_hits = 0;
+      cache_misses = 0;
+      cache_evictions = 0;
 
       wind_ew_name = src.wind_ew_name ;
       wind_ns_name = src.wind_ns_name ;
@@ -159,10 +184,6 @@ void MetGridData::assign( const MetGridData& src )
 
       flush_cache();
       
-      us = new MetCache3D(wind_ew_name, maxsnaps);
-      vs = new MetCache3D(wind_ns_name, maxsnaps);
-      ws = new MetCache3D(wind_vert_name, maxsnaps);
-      
       if ( src.diskcachedir != NULLPTR ) {
          if ( diskcachedir == NULLPTR ) {
             diskcachedir = new FilePath();
@@ -173,6 +194,7 @@ void MetGridData::assign( const MetGridData& src )
          diskcachedir = NULLPTR;
       }      
       diskcaching = src.diskcaching;      
+      setSharedCache( src.sharedCache() );
 
       override_tbase = src.override_tbase;
       override_tspace = src.override_tspace;
@@ -352,11 +374,200 @@ void MetGridData::flush_cache()
      
      field3Ds.clear();
      field2Ds.clear();
+     cache_used.clear();
+     cache_held.clear();
+
+     us = new MetCache3D(wind_ew_name, cacheSnaps());
+     vs = new MetCache3D(wind_ns_name, cacheSnaps());
+     ws = new MetCache3D(wind_vert_name, cacheSnaps());
+
+}
+
+int MetGridData::cacheSnaps() const
+{
+     // under a memory budget, the budget decides how many snapshots to keep
+     if ( cache_budget > 0 ) {
+        return std::numeric_limits<int>::max();
+     }
+     return maxsnaps;
+}
+
+void MetGridData::setCacheBudget( size_t bytes )
+{
+     std::map< std::string, MetCache3D* >::iterator i;
+     std::map< std::string, MetCacheSfc* >::iterator j;
+     int n;
+
+     cache_budget = bytes;
+     
+     n = cacheSnaps();
+     us->setSize( n );
+     vs->setSize( n );
+     ws->setSize( n );
+     for ( i = field3Ds.begin(); i != field3Ds.end(); i++ ) {
+        (*i).second->setSize( n );
+     }    
+     for ( j = field2Ds.begin(); j != field2Ds.end(); j++ ) {
+        (*j).second->setSize( n );
+     }    
+     
+     if ( cache_budget > 0 ) {
+        // (grids cached before now count as the least recently used)
+        trimCache( NULLPTR );
+     } else {
+        cache_used.clear();
+     }
+     
+     // note: going back to no budget leaves any excess snapshots in the
+     // per-quantity caches until new snapshots push them out
+}
+
+size_t MetGridData::cacheBudget() const
+{
+     return cache_budget;
+}
+
+size_t MetGridData::cacheBytes() const
+{
+     std::map< std::string, MetCache3D* >::const_iterator i;
+     std::map< std::string, MetCacheSfc* >::const_iterator j;
+     size_t total;
+     
+     total = us->bytes() + vs->bytes() + ws->bytes();
+     for ( i = field3Ds.begin(); i != field3Ds.end(); i++ ) {
+        total += (*i).second->bytes();
+     }    
+     for ( j = field2Ds.begin(); j != field2Ds.end(); j++ ) {
+        total += (*j).second->bytes();
+     }    
+     
+     return total;
+}
+
+void MetGridData::cacheStats( long& hits, long& misses, long& evictions ) const
+{
+     hits = cache_hits;
+     misses = cache_misses;
+     evictions = cache_evictions;
+}
+
+void MetGridData::holdCache( const void* field )
+{
+     if ( field != NULLPTR ) {
+        cache_held[field]++;
+     }
+}
+
+void MetGridData::releaseCache( const void* field )
+{
+     std::map<const void*, int>::iterator h;
+     
+     h = cache_held.find( field );
+     if ( h != cache_held.end() ) {
+        if ( --((*h).second) <= 0 ) {
+           cache_held.erase( h );
+        }
+     }
+}
+
+void MetGridData::touchCache( const void* field )
+{
+     if ( cache_budget > 0 ) {
+        cache_tick++;
+        cache_used[field] = cache_tick;
+     }
+}
 
-     us = new MetCache3D(wind_ew_name, maxsnaps);
-     vs = new MetCache3D(wind_ns_name, maxsnaps);
-     ws = new MetCache3D(wind_vert_name, maxsnaps);
+void MetGridData::trimCache( const void* keep )
+{
+     std::map< std::string, MetCache3D* >::iterator i;
+     std::map< std::string, MetCacheSfc* >::iterator j;
+     std::map<const void*, long>::const_iterator u;
+     std::vector<MetCache3D*> c3ds;
+     std::vector<MetCacheSfc*> csfcs;
+     size_t total;
+     GridField3D* g3d;
+     GridFieldSfc* gsfc;
+     GridField3D* v3d;
+     GridFieldSfc* vsfc;
+     MetCache3D* vc3d;
+     MetCacheSfc* vcsfc;
+     long vtick;
+     long tick;
+     
+     if ( cache_budget == 0 ) {
+        return;
+     }
+     
+     c3ds.push_back( us );
+     c3ds.push_back( vs );
+     c3ds.push_back( ws );
+     for ( i = field3Ds.begin(); i != field3Ds.end(); i++ ) {
+        c3ds.push_back( (*i).second );
+     }    
+     for ( j = field2Ds.begin(); j != field2Ds.end(); j++ ) {
+        csfcs.push_back( (*j).second );
+     }    
+
+     total = cacheBytes();
+     while ( total > cache_budget ) {
+     
+        // find the least-recently-used grid that is not being held,
+        // across all of the caches
+        v3d = NULLPTR;
+        vsfc = NULLPTR;
+        vc3d = NULLPTR;
+        vcsfc = NULLPTR;
+        vtick = 0;
+        for ( int k=0; k < c3ds.size(); k++ ) {
+           for ( int m=0; m < c3ds[k]->count(); m++ ) {
+              g3d = c3ds[k]->entry(m);
+              if ( g3d == keep || cache_held.count( g3d ) > 0 ) {
+                 continue;
+              }
+              u = cache_used.find( g3d );
+              tick = ( u != cache_used.end() ) ? (*u).second : 0;
+              if ( ( v3d == NULLPTR && vsfc == NULLPTR ) || tick < vtick ) {
+                 v3d = g3d;
+                 vc3d = c3ds[k];
+                 vsfc = NULLPTR;
+                 vtick = tick;
+              }
+           }
+        }
+        for ( int k=0; k < csfcs.size(); k++ ) {
+           for ( int m=0; m < csfcs[k]->count(); m++ ) {
+              gsfc = csfcs[k]->entry(m);
+              if ( gsfc == keep || cache_held.count( gsfc ) > 0 ) {
+                 continue;
+              }
+              u = cache_used.find( gsfc );
+              tick = ( u != cache_used.end() ) ? (*u).second : 0;
+              if ( ( v3d == NULLPTR && vsfc == NULLPTR ) || tick < vtick ) {
+                 vsfc = gsfc;
+                 vcsfc = csfcs[k];
+                 v3d = NULLPTR;
+                 vtick = tick;
+              }
+           }
+        }
 
+        if ( v3d != NULLPTR ) {
+           //- std::cerr << "  budget dropping " << v3d->quantity() << " @ " << v3d->met_time() << std::endl;
+           total = total - static_cast<size_t>(v3d->dataSize())*sizeof(gridreal);
+           cache_used.erase( v3d );
+           vc3d->drop( v3d );
+        } else if ( vsfc != NULLPTR ) {
+           //- std::cerr << "  budget dropping " << vsfc->quantity() << " @ " << vsfc->met_time() << std::endl;
+           total = total - static_cast<size_t>(vsfc->dataSize())*sizeof(gridreal);
+           cache_used.erase( vsfc );
+           vcsfc->drop( vsfc );
+        } else {
+           // everything left is in use
+           break;
+        }
+        cache_evictions++;
+     }
 }
 
 
@@ -447,6 +658,9 @@ void MetGridData::remove( GridField3D* field )
     std::map< std::string, MetCache3D* >::iterator i;
     bool keepit = false;
     
+    // the caller is done with it
+    releaseCache( field );
+    
     if ( field == NULLPTR ) {
        keepit = true;
     }
@@ -479,6 +693,9 @@ void MetGridData::remove( GridFieldSfc* field )
     std::map< std::string, MetCacheSfc* >::iterator j;
     bool keepit = false;
     
+    // the caller is done with it
+    releaseCache( field );
+    
     if ( field == NULLPTR ) {
        keepit = true;
     }
@@ -499,6 +716,29 @@ void MetGridData::remove( GridFieldSfc* field )
 
 }
 
+void MetGridData::setThreads( int n )
+{
+    std::map< std::string, MetCache3D* >::iterator i;
+    std::map< std::string, MetCacheSfc* >::iterator j;
+    bool mode;
+    
+    MetData::setThreads( n );
+    
+    // while threads are sharing the caches, a thread may still be
+    // using a field that another thread's request pushes out of its cache
+    mode = ( my_threads > 1 );
+    us->hold( mode );
+    vs->hold( mode );
+    ws->hold( mode );
+    for ( i = field3Ds.begin(); i != field3Ds.end(); i++ ) {
+        (*i).second->hold( mode );
+    }
+    for ( j = field2Ds.begin(); j != field2Ds.end(); j++ ) {
+        (*j).second->hold( mode );
+    }
+    
+}
+
 void MetGridData::impose_times( double otbase, double otspace )
 {
        if ( otbase < 24.0 ) {
@@ -609,7 +849,8 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
        } else {
           // No, not something we are caching already.
           // Create a new cache object and add it to the collection.
-          cache = new MetCache3D(quantity, maxsnaps);
+          cache = new MetCache3D(quantity, cacheSnaps());
+          cache->hold( my_threads > 1 );
           field3Ds[quantity] = cache;
        }    
 
@@ -622,6 +863,7 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
     // try to get the cached field valid for our desired time
     grid = cache->query(time);
     if ( grid == NULLPTR ) {
+       cache_misses++;
        // no cached data for the desired time
         
        // are we getting met data from a dedicated met processor?
@@ -629,8 +871,16 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
           // No?   Ok, we should be reading met data ourselves.
           // Do it.
           
-          // try the disk cache
-          grid = readCache3D(quantity, time);
+          // try the shared cache, and then the disk cache
+          GT_TIMER( disktimer, "MetGridData::new_mgmtGrid3D disk cache read" );
+          grid = readShared3D(quantity, time);
+          if ( grid == NULLPTR ) {
+             grid = readCache3D(quantity, time);
+             if ( grid != NULLPTR ) {
+                writeShared(grid);
+             }
+          }
+          GT_TIMER_STOP( disktimer );
           if ( grid == NULLPTR ) {
      
              // data not in cache.  we have to go get it.
@@ -640,6 +890,7 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
              }
 
              // read in the data from the actual source
+             GT_TIMER( readtimer, "MetGridData::new_mgmtGrid3D direct read" );
              grid = new_directGrid3D( quantity, time );
              if ( grid != NULLPTR ) {
              
@@ -773,11 +1024,15 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
                 // so do that now.
                 grid->setPgroup( my_pgroup, my_metproc ); 
              
+                GT_TIMER_STOP( readtimer );
+                
                 // add it to the disk cache
                 if ( dbug >= 2 ) {
                    std::cerr << "MetGridData::new_mgmtGrid3D:  writing " << grid->quantity() << " @ " << grid->met_time() << " to disk cache" << std::endl;
                 }    
+                GT_TIMER( writetimer, "MetGridData::new_mgmtGrid3D disk cache write" );
                 writeCache(grid);
+                writeShared(grid);
 
              } else {
                 if ( dbug > 0 ) {
@@ -789,6 +1044,7 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
              if ( dbug >= 1 ) {
                 std::cerr << "MetGridData::new_mgmtGrid3D:  request fulfilled from disk cache" << std::endl;
              }  
+             GT_COUNT( "MetGridData::new_mgmtGrid3D disk cache hits", 1 );
              
              // need to set the PGrp stuff before we use this grid.
              grid->setPgroup( my_pgroup, my_metproc );  
@@ -801,7 +1057,9 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
              if ( dbug >= 1 ) {
                std::cerr << "MetGridData::new_mgmtGrid3D:  adding data to memory cache" << std::endl;
              }
-             cache->add(grid);
+             cache_evictions += cache->add(grid);
+             touchCache( grid );
+             trimCache( grid );
           }   
     
           if ( dbug >= 2 ) {
@@ -822,7 +1080,9 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
              std::cerr << "MetGridData::new_mgmtGrid3D:  (met client) asking met processor " << my_metproc << " for metadata" << std::endl;
           } 
           
+          GT_TIMER( clienttimer, "MetGridData::new_mgmtGrid3D met server request" );
           grid = new_clientGrid3D( quantity, time );   
+          GT_TIMER_STOP( clienttimer );
        
           if ( dbug >= 1 ) {
             std::cerr << "MetGridData::new_mgmtGrid3D:  (met client) grid created and received metadata from met processor" << std::endl;
@@ -837,7 +1097,9 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
              if ( dbug >= 1 ) {
                std::cerr << "MetGridData::new_mgmtGrid3D:  adding client grid to memory cache" << std::endl;
              }
-             cache->add(grid);
+             cache_evictions += cache->add(grid);
+             touchCache( grid );
+             trimCache( grid );
           }   
          
          
@@ -848,10 +1110,27 @@ GridField3D* MetGridData::new_mgmtGrid3D( const std::string& quantity, const std
        if ( dbug >= 1 ) {
           std::cerr << "MetGridData::new_mgmtGrid3D:  request fullfilled from memory cache" << std::endl;
        } 
+       GT_COUNT( "MetGridData::new_mgmtGrid3D memory cache hits", 1 );
+       cache_hits++;
+       touchCache( grid );
        // note: since the grid was retrieved from cache, its
        // group stuff is already in place.
     }
 
+    // A met client tells the grid which region its parcels are in now,
+    // whether the grid is new or has come from the cache.
+    // (Without a current region, the grid must not go on using an old one.)
+    if ( grid != NULLPTR && isMetClient() ) {
+       if ( my_haloset ) {
+          grid->setHalo( my_halobox[0], my_halobox[1], my_halobox[2], my_halobox[3], my_halobox[4], my_halobox[5] );
+       } else {
+          grid->clearHalo();
+       }
+    }
+
+    // the caller holds the grid until it gives it back through remove()
+    holdCache( grid );
+
     if ( dbug > 0 ) {
        std::cerr << "MetGridData::new_mgmtGrid3D:  returning " << quantity << " on " << vquant << " @ " << time << std::endl;
     }
@@ -864,20 +1143,25 @@ void MetGridData::request_meta3D( const std::string& quantity, double time )
 {
      int cmd;
      std::string ctime;
+     int svr;
      
      if ( isMetClient() ) {
+        // which met server handles this quantity and time?
+        svr = metShard( quantity, time );
         // send this request to the met server processor's Met Source object    
         // send request for metadata
         cmd = PGR_CMD_M3M;
-        my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+        my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
         //- std::cerr << "   MetGridData::request_meta3D:  (met client) sent cmd " << std::endl;
         // send string for quantity
-        my_pgroup->send_string( my_metproc, quantity, PGR_TAG_QUANT ); // quantity
+        my_pgroup->send_string( svr, quantity, PGR_TAG_QUANT ); // quantity
         //- std::cerr << "   MetGridData::request_meta3D:  (met client) sent quantity " << std::endl;
         // send string for vertical coord
         ctime = time2Cal( time );
-        my_pgroup->send_string( my_metproc, ctime, PGR_TAG_TIME ); // time
+        my_pgroup->send_string( svr, ctime, PGR_TAG_TIME ); // time
         //- std::cerr << "   MetGridData::request_meta3D:  (met client) sent time " << std::endl;
+        expect_svr_status( svr );
+        GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, quantity, ctime, -1 );
      }
 
 }
@@ -886,17 +1170,22 @@ void MetGridData::request_meta3D( const std::string& quantity, double time )
 void MetGridData::request_data3D( std::string& quantity, std::string& time )
 {
      int cmd;
+     int svr;
      
      if ( isMetClient() ) {
+         // which met server handles this quantity and time?
+         svr = metShard( quantity, cal2Time( time ) );
          //- std::cerr << "MetGridData::request_data3D: (client) sending SCALAR request" << std::endl;
          // send "need data" status to central met reader process
          cmd = PGR_CMD_M3D;
          // send request for data
-         my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+         my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
          // send the desired quantity to the server
-         my_pgroup->send_string( my_metproc, quantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, quantity, PGR_TAG_QUANT );
          // send the desired timestamp to the server
-         my_pgroup->send_string( my_metproc, time, PGR_TAG_TIME );
+         my_pgroup->send_string( svr, time, PGR_TAG_TIME );
+         expect_svr_status( svr );
+         GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, quantity, time, -1 );
          //std::cerr << "MetGridData::request_data3D: (client) sent request" << std::endl;
      }
 }
@@ -904,18 +1193,35 @@ void MetGridData::request_data3D( std::string& quantity, std::string& time )
 void MetGridData::request_data3D( std::string& xquantity, std::string& yquantity, std::string& time )
 {
      int cmd;
+     int svr;
+     int svr2;
+     double ttime;
      
      if ( isMetClient() ) {
+         // which met servers handle these quantities at this time?
+         ttime = cal2Time( time );
+         svr = metShard( xquantity, ttime );
+         svr2 = metShard( yquantity, ttime );
+         if ( svr != svr2 ) {
+            // The two components live on different met server shards,
+            // so we make separate scalar requests of each.  The client
+            // grid objects already know which shard to talk to.
+            request_data3D( xquantity, time );
+            request_data3D( yquantity, time );
+            return;
+         }
          //- std::cerr << "MetGridData::request_data3D: (client) sending VECTOR request" << std::endl;
          // send "need data" status to central met reader process
          cmd = PGR_CMD_M3DV;
          // send request for data
-         my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+         my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
          // send the desired vector component quantities to the server
-         my_pgroup->send_string( my_metproc, xquantity, PGR_TAG_QUANT );
-         my_pgroup->send_string( my_metproc, yquantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, xquantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, yquantity, PGR_TAG_QUANT );
          // send the desired timestamp to the server
-         my_pgroup->send_string( my_metproc, time, PGR_TAG_TIME );
+         my_pgroup->send_string( svr, time, PGR_TAG_TIME );
+         expect_svr_status( svr );
+         GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, xquantity + "," + yquantity, time, -1 );
          //std::cerr << "MetGridData::request_data3D: (client) sent request" << std::endl;
      }
 }
@@ -976,7 +1282,8 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
     if ( (qm=field2Ds.find(fullqname)) != field2Ds.end() ) {
        cache = (*qm).second;
     } else {
-       cache = new MetCacheSfc(fullqname, maxsnaps);
+       cache = new MetCacheSfc(fullqname, cacheSnaps());
+       cache->hold( my_threads > 1 );
        field2Ds[fullqname] = cache;
     }    
 
@@ -988,14 +1295,21 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
     // try to get the cached field valid for our desired time
     grid = cache->query(time);
     if ( grid == NULLPTR ) {
+       cache_misses++;
      
        // are we getting met data from a dedicated met processor?
        if ( ! isMetClient() ) {
           // No? we should be reading met data ourselves.
           // Do it.
           
-          // try the disk cache
-          grid = readCacheSfc( fullqname, time );
+          // try the shared cache, and then the disk cache
+          grid = readSharedSfc( fullqname, time );
+          if ( grid == NULLPTR ) {
+             grid = readCacheSfc( fullqname, time );
+             if ( grid != NULLPTR ) {
+                writeShared(grid);
+             }
+          }
           if ( grid == NULLPTR ) {
 
              // data not in cache.  we have to go get it.
@@ -1021,6 +1335,7 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
                    std::cerr << "MetGridData::new_mgmtGridSfc:  writing " << grid->quantity() << " on Sfc " << grid->surface() << " @ " << grid->met_time() << " to disk cache" << std::endl;
                 }    
                 writeCache(grid);
+                writeShared(grid);
              } else {
                 if ( dbug > 0 ) {
                    std::cerr << "MetGridData::new_mgmtGridSfc:  failed to read met data from source" << std::endl;            
@@ -1037,12 +1352,14 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
           }
 
           // either through reading from the data source or from disk cache
-          if ( grid == NULLPTR ) {
+          if ( grid != NULLPTR ) {
              // add it to the in-memory cache
              if ( dbug > 1 ) {
                std::cerr << "MetGridData::new_mgmtGridSfc:  adding data to memory cache" << std::endl;
              }
-             cache->add(grid);
+             cache_evictions += cache->add(grid);
+             touchCache( grid );
+             trimCache( grid );
           }
           
        } else {
@@ -1068,7 +1385,9 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
              if ( dbug >= 1 ) {
                std::cerr << "MetGridData::new_mgmtGridSfc:  adding client grid to memory cache" << std::endl;
              }
-             cache->add(grid);
+             cache_evictions += cache->add(grid);
+             touchCache( grid );
+             trimCache( grid );
           }   
        
        }
@@ -1076,10 +1395,15 @@ GridFieldSfc* MetGridData::new_mgmtGridSfc( const std::string& quantity, const s
        if ( dbug >= 1 ) {
           std::cerr << "MetGridData::new_mgmtGridSfc:  request fullfilled from memory cache" << std::endl;
        }    
+       cache_hits++;
+       touchCache( grid );
        // note: since the grid was retrieved from cache, its
        // group stuff is already in place.
     }
 
+    // the caller holds the grid until it gives it back through remove()
+    holdCache( grid );
+
     if ( dbug > 0 ) {
        std::cerr << "MetGridData::new_mgmtGridSfc:  returning " << quantname << " on Sfc " << sfcname << " @ " << time  << std::endl;
     }
@@ -1091,20 +1415,25 @@ void MetGridData::request_metaSfc( const std::string& quantity, double time )
 {
      int cmd;
      std::string ctime;
+     int svr;
      
      if ( isMetClient() ) {
+        // which met server handles this quantity and time?
+        svr = metShard( quantity, time );
         // send this request to the met server processor's Met Source object    
         // send request for metadata
         cmd = PGR_CMD_M2M;
-        my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+        my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
         //- std::cerr << "   MetGridData::request_metaSfc:  (met client) sent cmd " << std::endl;
         // send string for quantity
-        my_pgroup->send_string( my_metproc, quantity, PGR_TAG_QUANT ); // quantity
+        my_pgroup->send_string( svr, quantity, PGR_TAG_QUANT ); // quantity
         //- std::cerr << "   MetGridData::request_metaSfc:  (met client) sent quantity " << std::endl;
         // send string for vertical coord
         ctime = time2Cal( time );
-        my_pgroup->send_string( my_metproc, ctime, PGR_TAG_TIME ); // time
+        my_pgroup->send_string( svr, ctime, PGR_TAG_TIME ); // time
         //- std::cerr << "   MetGridData::request_metaSfc:  (met client) sent time " << std::endl;
+        expect_svr_status( svr );
+        GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, quantity, ctime, -1 );
      }
 
 }
@@ -1113,17 +1442,22 @@ void MetGridData::request_metaSfc( const std::string& quantity, double time )
 void MetGridData::request_dataSfc( std::string& quantity, std::string& time )
 {
      int cmd;
+     int svr;
      
      if ( isMetClient() ) {
+         // which met server handles this quantity and time?
+         svr = metShard( quantity, cal2Time( time ) );
          //- std::cerr << "MetGridData::request_dataSfc: (client) sending request" << std::endl;
          // send "need data" status to central met reader process
          cmd = PGR_CMD_M2D;
          // send request for data
-         my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+         my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
          // send the desired quantity to the server
-         my_pgroup->send_string( my_metproc, quantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, quantity, PGR_TAG_QUANT );
          // send the desired timestamp to the server
-         my_pgroup->send_string( my_metproc, time, PGR_TAG_TIME );
+         my_pgroup->send_string( svr, time, PGR_TAG_TIME );
+         expect_svr_status( svr );
+         GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, quantity, time, -1 );
          //- std::cerr << "MetGridData::request_dataSfc: (client) sent request" << std::endl;
      }
 }
@@ -1131,18 +1465,35 @@ void MetGridData::request_dataSfc( std::string& quantity, std::string& time )
 void MetGridData::request_dataSfc( std::string& xquantity, std::string& yquantity, std::string& time )
 {
      int cmd;
+     int svr;
+     int svr2;
+     double ttime;
      
      if ( isMetClient() ) {
+         // which met servers handle these quantities at this time?
+         ttime = cal2Time( time );
+         svr = metShard( xquantity, ttime );
+         svr2 = metShard( yquantity, ttime );
+         if ( svr != svr2 ) {
+            // The two components live on different met server shards,
+            // so we make separate scalar requests of each.  The client
+            // grid objects already know which shard to talk to.
+            request_dataSfc( xquantity, time );
+            request_dataSfc( yquantity, time );
+            return;
+         }
          //- std::cerr << "MetGridData::request_dataSfc: (client) sending VECTOR request" << std::endl;
          // send "need data" status to central met reader process
          cmd = PGR_CMD_M2DV;
          // send request for data
-         my_pgroup->send_ints( my_metproc, 1, &cmd, PGR_TAG_REQ );
+         my_pgroup->send_ints( svr, 1, &cmd, PGR_TAG_REQ );
          // send the desired vector component quantities to the server
-         my_pgroup->send_string( my_metproc, xquantity, PGR_TAG_QUANT );
-         my_pgroup->send_string( my_metproc, yquantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, xquantity, PGR_TAG_QUANT );
+         my_pgroup->send_string( svr, yquantity, PGR_TAG_QUANT );
          // send the desired timestamp to the server
-         my_pgroup->send_string( my_metproc, time, PGR_TAG_TIME );
+         my_pgroup->send_string( svr, time, PGR_TAG_TIME );
+         expect_svr_status( svr );
+         GT_EVENT_MARK( EventTrace::cmdName( cmd ), svr, xquantity + "," + yquantity, time, -1 );
          //std::cerr << "MetGridData::request_dataSfc: (client) sent request" << std::endl;
      }
 
@@ -1180,12 +1531,42 @@ void MetGridData::setCacheDir( FilePath *path )
     }   
 }
 
+void MetGridData::setSharedCache( const std::string& sockname )
+{
+#ifdef USE_SHMCACHE
+    if ( shmcache != NULLPTR ) {
+       delete shmcache;
+       shmcache = NULLPTR;
+    }
+    if ( sockname != "" ) {
+       shmcache = new ShmCache( sockname );
+    }
+#endif
+}
+
+std::string MetGridData::sharedCache() const
+{
+#ifdef USE_SHMCACHE
+    if ( shmcache != NULLPTR ) {
+       return shmcache->socketName();
+    }
+#endif
+    return "";
+}
+
 void MetGridData::report() const
 {
     std::map< std::string, MetCache3D* >::const_iterator i;
     std::map< std::string, MetCacheSfc* >::const_iterator j;
   
     std::cerr << "++++++ MetGridData report::" << std::endl;
+    std::cerr << "*** Memory use: " << cacheBytes() << " bytes";
+    if ( cache_budget > 0 ) {
+       std::cerr << " of a " << cache_budget << "-byte budget";
+    }
+    std::cerr << std::endl;
+    std::cerr << "*** Cache statistics: " << cache_hits << " hits, " << cache_misses << " misses, " 
+              << cache_evictions << " evictions" << std::endl;
     std::cerr << "*** U-wind cache:" << std::endl;
     us->report();
     std::cerr << "*** V-wind cache:" << std::endl;
@@ -1222,6 +1603,8 @@ void MetGridData::serveMet()
     std::string quantity2;
     std::string time;
     
+    done_count = 0;
+    
     //std::cerr << "in serveMet" << std::endl;
     if ( isMetServer() ) {
 
@@ -1229,15 +1612,27 @@ void MetGridData::serveMet()
        // listen to and satisfy data requests from other processors
        
        // how many processors do we need to tell us we are done?
-       // (all except this one)
-       done_goal = my_pgroup->size() - 1;
-       done_count = 0;
+       // (all except the met server processors)
+       done_goal = metClients();
+       done_count = serveBegin();
 
        //- std::cerr << "MetGridData::serveMet: I am a met server. done_count is " << done_count << " of " << done_goal << std::endl;      
-       while ( done_count < done_goal ) {
+       while ( serving( done_count, done_goal ) ) {
              //- std::cerr << "MetGridData::serveMet: STARTING loop with done_count " << done_count << " of " << done_goal << std::endl;      
+          quantity = "";
+          quantity2 = "";
+          time = "";
+          
           // receive a signal from any processor in this group
+          GT_TIMER( waittimer, "MetGridData::serveMet idle wait" );
+          GT_EVENT_BEGIN( idleevent );
           my_pgroup->receive_ints( -1, 1, &client_cmd, PGR_TAG_REQ, &src );
+          GT_EVENT_END( idleevent, "idle", src, "", "", 0 );
+          GT_TIMER_STOP( waittimer );
+          // (how many other clients are queued up behind this one)
+          GT_COUNT( "MetGridData::serveMet queue depth", my_pgroup->pending( PGR_TAG_REQ ) );
+          GT_TIMER( svctimer, "MetGridData::serveMet service" );
+          GT_EVENT_BEGIN( svcevent );
           //- std::cerr << "serveMet: " << " got cmd " << client_cmd << " from proc " << src  << std::endl; 
           switch (client_cmd) {
           case PGR_CMD_DONE: // that client processor is finished making requests
@@ -1245,6 +1640,9 @@ void MetGridData::serveMet()
              done_count++;
              //- std::cerr << "svr_listen [" << my_pgroup->id() << "]" << " proc " << src << " is done" << std::endl; 
              break;
+          case PGR_CMD_STEP: // that client processor has finished a time step
+             clientStep( src );
+             break;
           case PGR_CMD_M3M: // that client processor is making a 3D metadata request
              //- std::cerr << "MetGridData::serveMet: got @@@@ PGR_CMD_M3M " << std::endl;      
              // get the desired quantity from the client
@@ -1435,6 +1833,11 @@ void MetGridData::serveMet()
 
              break;
           }
+          
+          // the request, and everything sent back to the client in response
+          GT_EVENT_BYTES( sizeof(int) + quantity.size() + quantity2.size() + time.size() );
+          GT_EVENT_END( svcevent, EventTrace::cmdName( client_cmd ), src
+                      , ( quantity2 != "" ) ? quantity + "," + quantity2 : quantity, time, -1 );
           //- std::cerr << "MetGridData::serveMet: ENDING loop with done_count " << done_count << " of " << done_goal << std::endl;      
 
        } 
@@ -1442,7 +1845,7 @@ void MetGridData::serveMet()
     
     //- std::cerr << "met server exit-syncing with the group" << std::endl;
     //my_pgroup->sync("Met server exit");
-    my_pgroup->sync();
+    serveEnd( done_count );
     //- std::cerr << "leaving serveMet" << std::endl;
     
     return; 
@@ -1459,6 +1862,7 @@ MetGridData::MetCache3D::MetCache3D( std::string quantity, int size )
 {
     quant = quantity;
     max = 3;
+    holding = false;
     if (size > 0 ) {
        max = size;
     }   
@@ -1474,6 +1878,9 @@ MetGridData::MetCache3D::~MetCache3D()
      for ( i=data.begin(); i != data.end(); i++ ) {
         delete *i;
      }   
+     for ( int k=0; k < held.size(); k++ ) {
+        delete held[k];
+     }
 
 }
 
@@ -1484,6 +1891,7 @@ MetGridData::MetCache3D::MetCache3D( const MetCache3D& src )
 
      quant = src.quant;
      max = src.max;
+     holding = false;
      
      // copy the held data 
      for ( i=src.data.begin(); i != src.data.end(); i++ ) {
@@ -1515,6 +1923,7 @@ GridField3D* MetGridData::MetCache3D::query( double time, int flag )
         result = *i;
         if ( result->time() == time ) {
            gotit = 1;
+           break;
         }
      }
      
@@ -1596,12 +2005,17 @@ bool MetGridData::MetCache3D::has( GridField3D* field )
          }   
      }   
     
+     // (fields set aside by hold() are still in use)
+     for ( int j=0; j < held.size() && ! result; j++ ) {
+         result = ( field == held[j] );
+     }
+    
      return result;
 }
 
-void MetGridData::MetCache3D::add( GridField3D* field )
+int MetGridData::MetCache3D::add( GridField3D* field )
 {
-   int i;
+   int ndropped = 0;
    
    // do we have too many snapshots to hold another?
    while ( data.size() >= max ) {
@@ -1609,8 +2023,13 @@ void MetGridData::MetCache3D::add( GridField3D* field )
 
       // std::cerr << "  cache dropping " << grid->quantity() << " @ " << grid->met_time() << std::endl;
       
-      delete data.back();
+      if ( holding ) {
+         held.push_back( data.back() );
+      } else {
+         delete data.back();
+      }
       data.pop_back(); 
+      ndropped++;
    }
    
    // add this snapshot
@@ -1620,6 +2039,58 @@ void MetGridData::MetCache3D::add( GridField3D* field )
    //- std::cerr << "report: " << std::endl;
    //- report();
 
+   return ndropped;
+}
+
+void MetGridData::MetCache3D::drop( GridField3D* field )
+{
+   std::deque<GridField3D*>::iterator i;
+   
+   for ( i=data.begin(); i != data.end(); i++ ) {
+      if ( *i == field ) {
+         data.erase(i);
+         if ( holding ) {
+            held.push_back( field );
+         } else {
+            delete field;
+         }
+         break;
+      }
+   }
+}
+
+int MetGridData::MetCache3D::count() const
+{
+   return data.size();
+}
+
+GridField3D* MetGridData::MetCache3D::entry( int i ) const
+{
+   return data[i];
+}
+
+size_t MetGridData::MetCache3D::bytes() const
+{
+   std::deque<GridField3D*>::const_iterator i;
+   size_t total = 0;
+   
+   for ( i=data.begin(); i != data.end(); i++ ) {
+      total += static_cast<size_t>( (*i)->dataSize() ) * sizeof(gridreal);
+   }
+   
+   return total;
+}
+
+
+void MetGridData::MetCache3D::hold( bool mode )
+{
+   holding = mode;
+   if ( ! holding ) {
+      for ( int i=0; i < held.size(); i++ ) {
+          delete held[i];
+      }
+      held.clear();
+   }
 }
 
 void MetGridData::MetCache3D::report() const
@@ -1648,6 +2119,7 @@ MetGridData::MetCacheSfc::MetCacheSfc( std::string quantity, int size )
 {
     quant = quantity;
     max = 3;
+    holding = false;
     if (size > 0 ) {
        max = size;
     }   
@@ -1663,6 +2135,9 @@ MetGridData::MetCacheSfc::~MetCacheSfc()
      for ( i=data.begin(); i != data.end(); i++ ) {
         delete *i;
      }   
+     for ( int k=0; k < held.size(); k++ ) {
+        delete held[k];
+     }
 
 }
 
@@ -1673,6 +2148,7 @@ MetGridData::MetCacheSfc::MetCacheSfc( const MetCacheSfc& src )
 
      quant = src.quant;
      max = src.max;
+     holding = false;
      
      // copy the held data 
      for ( i=src.data.begin(); i != src.data.end(); i++ ) {
@@ -1704,6 +2180,7 @@ GridFieldSfc* MetGridData::MetCacheSfc::query( double time, int flag )
         result = *i;
         if ( result->time() == time ) {
            gotit = 1;
+           break;
         }
      }
      
@@ -1788,12 +2265,17 @@ bool MetGridData::MetCacheSfc::has( GridFieldSfc* field )
          }   
      }   
     
+     // (fields set aside by hold() are still in use)
+     for ( int j=0; j < held.size() && ! result; j++ ) {
+         result = ( field == held[j] );
+     }
+    
      return result;
 }
 
-void MetGridData::MetCacheSfc::add( GridFieldSfc* field )
+int MetGridData::MetCacheSfc::add( GridFieldSfc* field )
 {
-   int i;
+   int ndropped = 0;
    
    // do we have too many snapshots to hold another?
    while ( data.size() >= max ) {
@@ -1801,8 +2283,13 @@ void MetGridData::MetCacheSfc::add( GridFieldSfc* field )
       
       // std::cerr << "  cache dropping " << grid->quantity() << " @ " << grid->met_time() << std::endl;
       
-      delete data.back();
+      if ( holding ) {
+         held.push_back( data.back() );
+      } else {
+         delete data.back();
+      }
       data.pop_back(); 
+      ndropped++;
    }
    
    // add this snapshot
@@ -1812,6 +2299,58 @@ void MetGridData::MetCacheSfc::add( GridFieldSfc* field )
    //- std::cerr << "report: " << std::endl;
    //- report();
 
+   return ndropped;
+}
+
+void MetGridData::MetCacheSfc::drop( GridFieldSfc* field )
+{
+   std::deque<GridFieldSfc*>::iterator i;
+   
+   for ( i=data.begin(); i != data.end(); i++ ) {
+      if ( *i == field ) {
+         data.erase(i);
+         if ( holding ) {
+            held.push_back( field );
+         } else {
+            delete field;
+         }
+         break;
+      }
+   }
+}
+
+int MetGridData::MetCacheSfc::count() const
+{
+   return data.size();
+}
+
+GridFieldSfc* MetGridData::MetCacheSfc::entry( int i ) const
+{
+   return data[i];
+}
+
+size_t MetGridData::MetCacheSfc::bytes() const
+{
+   std::deque<GridFieldSfc*>::const_iterator i;
+   size_t total = 0;
+   
+   for ( i=data.begin(); i != data.end(); i++ ) {
+      total += static_cast<size_t>( (*i)->dataSize() ) * sizeof(gridreal);
+   }
+   
+   return total;
+}
+
+
+void MetGridData::MetCacheSfc::hold( bool mode )
+{
+   holding = mode;
+   if ( ! holding ) {
+      for ( int i=0; i < held.size(); i++ ) {
+          delete held[i];
+      }
+      held.clear();
+   }
 }
 
 void MetGridData::MetCacheSfc::report() const
@@ -19,7 +19,10 @@
 
 #include "math.h"
 
+#include <sstream>
+
 #include "gigatraj/MetGridLatLonData.hh"
+#include "gigatraj/Instrument.hh"
 
 using namespace gigatraj;
 
@@ -38,6 +41,9 @@ MetGridLatLonData::MetGridLatLonData() : MetGridData()
 
       field3Ds.clear();
       field2Ds.clear();
+      
+      use_stencil = true;
+      use_timepairs = false;
           
      //x3D = new GridLatLonField3D();
      //xSfc = new GridLatLonFieldSfc();
@@ -74,6 +80,9 @@ MetGridLatLonData::MetGridLatLonData(
       field3Ds.clear();
       field2Ds.clear();
 
+      use_stencil = true;
+      use_timepairs = false;
+
      //x3D = new GridLatLonField3D();
      //x3D->setPgroup( my_pgroup, my_metproc );
 
@@ -84,6 +93,9 @@ MetGridLatLonData::MetGridLatLonData(
 // destructor
 MetGridLatLonData::~MetGridLatLonData() 
 {
+   for ( int i=0; i < tstencils.size(); i++ ) {
+       delete tstencils[i];
+   }
    //delete x3D;
    //delete xSfc;
 }
@@ -97,6 +109,10 @@ MetGridLatLonData::MetGridLatLonData( const MetGridLatLonData&  src) : MetGridDa
     lons  = src.lons;
     lats  = src.lats;
     zs    = src.zs;
+    
+    // (the stencils and snapshot pairs themselves are not copied; they are rebuilt as needed)
+    use_stencil = src.use_stencil;
+    use_timepairs = src.use_timepairs;
 
 }    
 
@@ -110,6 +126,10 @@ void MetGridLatLonData::assign(const MetGridLatLonData& src)
     lons  = src.lons;
     lats  = src.lats;
     zs    = src.zs;
+    
+    // (the stencils and snapshot pairs themselves are not copied; they are rebuilt as needed)
+    use_stencil = src.use_stencil;
+    use_timepairs = src.use_timepairs;
 
 }    
 
@@ -131,11 +151,39 @@ MetGridData& MetGridLatLonData::operator=(const MetGridData& src)
 
 void MetGridLatLonData::setOption( const std::string &name, const std::string &value )
 {    
-     MetGridData::setOption( name, value ); 
+     int ival;
+     
+     if ( name == "StencilCache" ) {
+        if ( str2int( value, &ival ) ) {
+           use_stencil = ( ival != 0 );
+           stencil.clear();
+           for ( int i=0; i < tstencils.size(); i++ ) {
+               tstencils[i]->clear();
+           }
+        }
+     } else if ( name == "TimePairCache" ) {
+        if ( str2int( value, &ival ) ) {
+           use_timepairs = ( ival != 0 );
+           timepairs.clear();
+        }
+     } else {
+        MetGridData::setOption( name, value ); 
+     }
 }
 void MetGridLatLonData::setOption( const std::string &name, int value )
 {
-     MetGridData::setOption( name, value ); 
+     if ( name == "StencilCache" ) {
+        use_stencil = ( value != 0 );
+        stencil.clear();
+        for ( int i=0; i < tstencils.size(); i++ ) {
+            tstencils[i]->clear();
+        }
+     } else if ( name == "TimePairCache" ) {
+        use_timepairs = ( value != 0 );
+        timepairs.clear();
+     } else {
+        MetGridData::setOption( name, value ); 
+     }
 }
 
 void MetGridLatLonData::setOption( const std::string &name, float value )
@@ -152,7 +200,13 @@ bool MetGridLatLonData::getOption( const std::string &name, std::string &value )
 {
     bool result;
     
-    result = MetGridData::getOption( name, value ); 
+    if ( name == "StencilCache" ) {
+       result = int2str( ( use_stencil ? 1 : 0 ), value );
+    } else if ( name == "TimePairCache" ) {
+       result = int2str( ( use_timepairs ? 1 : 0 ), value );
+    } else {
+       result = MetGridData::getOption( name, value ); 
+    }
     
     return result;
 }
@@ -161,7 +215,15 @@ bool MetGridLatLonData::getOption( const std::string &name, int &value )
 {
     bool result;
     
-    result = MetGridData::getOption( name, value ); 
+    if ( name == "StencilCache" ) {
+       value = ( use_stencil ? 1 : 0 );
+       result = true;
+    } else if ( name == "TimePairCache" ) {
+       value = ( use_timepairs ? 1 : 0 );
+       result = true;
+    } else {
+       result = MetGridData::getOption( name, value ); 
+    }
 
     return result;
 }
@@ -256,6 +318,33 @@ void  MetGridLatLonData::get_uvw( double time, int n, real* lons, real* lats, re
 
 }
 
+bool MetGridLatLonData::threadSafe() const
+{
+    return true;
+}
+
+void MetGridLatLonData::setThreads( int n )
+{
+    MetGridData::setThreads( n );
+    
+    // thread 0 uses our own stencils
+    while ( tstencils.size() < my_threads - 1 ) {
+        tstencils.push_back( new HLatLonStencil() );
+    }
+}
+
+HLatLonStencil* MetGridLatLonData::threadStencil()
+{
+    int i;
+    
+    i = thread();
+    if ( my_threads <= 1 || i <= 0 || i > tstencils.size() ) {
+       return &stencil;
+    }
+    
+    return tstencils[i-1];
+}
+
 int MetGridLatLonData::setup(  const std::string quantity, const double time )
 {
     int ndims = 3;
@@ -296,6 +385,11 @@ real MetGridLatLonData::getData( string quantity, double time, real lon, real la
      real badval;
      const char *nanstr = "";
 
+     GT_COUNT( "MetGridLatLonData::getData scalar calls", 1 );
+
+     // other threads must wait their turn (see MetData::lockMet())
+     MetData::Lock lock( this );
+
      //- std::cerr << "====MetGridLatLonData::getData Entry" << std::endl;  
 
      // handle the special case of the quantity being a simple function of the vertical coordinate
@@ -540,6 +634,11 @@ void MetGridLatLonData::getVectorData( string lonquantity, string latquantity, r
      real xbadval, ybadval;
      const char *nanstr = "";
 
+     GT_COUNT( "MetGridLatLonData::getVectorData scalar calls", 1 );
+
+     // other threads must wait their turn (see MetData::lockMet())
+     MetData::Lock lock( this );
+
      // Note: this call to setup **should** suffice for both component quantities,
      // but there are no guarantees. (sigh)
      ndims = this->setup(lonquantity, time);
@@ -823,6 +922,10 @@ void MetGridLatLonData::getData( string quantity, double time, int n, real* lons
      const char *nanstr = "";
      real lat,lon,z;
 
+     GT_TIMER( interptimer, "MetGridLatLonData::getData array" );
+     GT_COUNT( "MetGridLatLonData::getData array points", n );
+
+     MetData::Lock lock( this );
 
      real* const vals1 = new real[n];
      real* const vals2 = new real[n];
@@ -877,7 +980,12 @@ void MetGridLatLonData::getData( string quantity, double time, int n, real* lons
      // start off assuming the data are valid
      is_valid = true;
      
-     if ( ndims == 3 ) {
+     if ( ndims == 3 
+       && pairVinterp( quantity, ct1, ct2, n, lons, lats, zs, vals1, vals2, t1, t2, badval, flags ) ) {
+     
+        // (both bracketing snapshots were interpolated at once)
+        
+     } else if ( ndims == 3 ) {
      
         //- std::cerr << ".... TIME(getData) = " << time << " (" << cxtime << ")" << std::endl;
         
@@ -908,11 +1016,24 @@ void MetGridLatLonData::getData( string quantity, double time, int n, real* lons
         badval = g1->fillval();
         try {
            if ( receive_svr_status() == PGR_STATUS_OK ) {
-              hin->vinterp( n, lons, lats, zs, vals1, *g1, *vin  );
+              if ( my_threads > 1 && ! isMetClient() ) {
+                 // let other threads use the met source while we interpolate
+                 // (the grids stay in memory until setThreads(1) is called)
+                 HLatLonStencil fresh;
+                 HLatLonStencil* st = ( use_stencil ) ? threadStencil() : &fresh;
+                 lock.release();
+                 hin->vinterp( n, lons, lats, zs, vals1, *g1, *vin, *st );
+                 lock.reacquire();
+              } else if ( use_stencil ) {
+                 hin->vinterp( n, lons, lats, zs, vals1, *g1, *vin, stencil );
+              } else {
+                 hin->vinterp( n, lons, lats, zs, vals1, *g1, *vin  );
+              }
            } else {
               throw (badmetfailure());
            }    
         } catch (...) {
+           lock.reacquire();
            for ( int i=0; i<n; i++ ) {
               vals1[i] = badval;
            }   
@@ -940,11 +1061,24 @@ void MetGridLatLonData::getData( string quantity, double time, int n, real* lons
            request_data3D(quantity,ct2);
            try {
               if ( receive_svr_status() == PGR_STATUS_OK ) {
-                 hin->vinterp( n, lons, lats, zs, vals2, *g2, *vin );
+                 if ( my_threads > 1 && ! isMetClient() ) {
+                    // let other threads use the met source while we interpolate
+                    // (the grids stay in memory until setThreads(1) is called)
+                    HLatLonStencil fresh;
+                    HLatLonStencil* st = ( use_stencil ) ? threadStencil() : &fresh;
+                    lock.release();
+                    hin->vinterp( n, lons, lats, zs, vals2, *g2, *vin, *st );
+                    lock.reacquire();
+                 } else if ( use_stencil ) {
+                    hin->vinterp( n, lons, lats, zs, vals2, *g2, *vin, stencil );
+                 } else {
+                    hin->vinterp( n, lons, lats, zs, vals2, *g2, *vin );
+                 }
               } else {
                  throw (badmetfailure());
               }
            } catch (...) {
+              lock.reacquire();
               for ( int i=0; i<n; i++ ) {
                   vals2[i] = g2->fillval();
               }
@@ -1121,6 +1255,10 @@ void MetGridLatLonData::getVectorData( int n, string lonquantity, string latquan
      real lat,lon,z;
      real lonval, latval;
 
+     GT_TIMER( interptimer, "MetGridLatLonData::getVectorData array" );
+     GT_COUNT( "MetGridLatLonData::getVectorData array points", n );
+
+     MetData::Lock lock( this );
 
      // Note: this call to setup **should** suffice for both component quantities,
      // but there are no guarantees. (sigh)
@@ -1160,7 +1298,25 @@ void MetGridLatLonData::getVectorData( int n, string lonquantity, string latquan
      real* const latvals1 = new real[n];
      real* const latvals2 = new real[n];
   
-     if ( ndims == 3 ) {
+     if ( ndims == 3 
+       && pairVinterp( lonquantity, ct1, ct2, n, lons, lats, zs, lonvals1, lonvals2, t1, t2, xbadval, flags )
+       && pairVinterp( latquantity, ct1, ct2, n, lons, lats, zs, latvals1, latvals2, t1, t2, ybadval, flags ) ) {
+     
+        // (both bracketing snapshots of each component were interpolated at once)
+        
+        // a vector is good only if both of its components are good
+        for ( int i=0; i<n; i++ ) {
+           if ( lonvals1[i] == xbadval || latvals1[i] == ybadval ) {
+              lonvals1[i] = xbadval;
+              latvals1[i] = ybadval;
+           }
+           if ( lonvals2[i] == xbadval || latvals2[i] == ybadval ) {
+              lonvals2[i] = xbadval;
+              latvals2[i] = ybadval;
+           }
+        }
+        
+     } else if ( ndims == 3 ) {
      
         /* The downcasting is necessary because the horizontal interpolation
            routines need the child class, not the abstract parent class.
@@ -1194,11 +1350,24 @@ void MetGridLatLonData::getVectorData( int n, string lonquantity, string latquan
         try {
            request_data3D(lonquantity,latquantity, ct1);
            if ( receive_svr_status() == PGR_STATUS_OK ) {
-              hin->vinterpVector( n, lons, lats, zs, lonvals1, latvals1, *gx1, *gy1, *vin );
+              if ( my_threads > 1 && ! isMetClient() ) {
+                 // let other threads use the met source while we interpolate
+                 // (the grids stay in memory until setThreads(1) is called)
+                 HLatLonStencil fresh;
+                 HLatLonStencil* st = ( use_stencil ) ? threadStencil() : &fresh;
+                 lock.release();
+                 hin->vinterpVector( n, lons, lats, zs, lonvals1, latvals1, *gx1, *gy1, *vin, *st );
+                 lock.reacquire();
+              } else if ( use_stencil ) {
+                 hin->vinterpVector( n, lons, lats, zs, lonvals1, latvals1, *gx1, *gy1, *vin, stencil );
+              } else {
+                 hin->vinterpVector( n, lons, lats, zs, lonvals1, latvals1, *gx1, *gy1, *vin );
+              }
            } else {
               throw (badmetfailure());
            }    
         } catch (...) {
+           lock.reacquire();
            for ( int i=0; i<n; i++ ) {
               lonvals1[i] = xbadval;
               latvals1[i] = ybadval;
@@ -1242,11 +1411,24 @@ void MetGridLatLonData::getVectorData( int n, string lonquantity, string latquan
            try {
               request_data3D(lonquantity,latquantity,ct2);
               if ( receive_svr_status() == PGR_STATUS_OK ) {
-                 hin->vinterpVector( n, lons, lats, zs, lonvals2, latvals2, *gx2, *gy2, *vin );
+                 if ( my_threads > 1 && ! isMetClient() ) {
+                    // let other threads use the met source while we interpolate
+                    // (the grids stay in memory until setThreads(1) is called)
+                    HLatLonStencil fresh;
+                    HLatLonStencil* st = ( use_stencil ) ? threadStencil() : &fresh;
+                    lock.release();
+                    hin->vinterpVector( n, lons, lats, zs, lonvals2, latvals2, *gx2, *gy2, *vin, *st );
+                    lock.reacquire();
+                 } else if ( use_stencil ) {
+                    hin->vinterpVector( n, lons, lats, zs, lonvals2, latvals2, *gx2, *gy2, *vin, stencil );
+                 } else {
+                    hin->vinterpVector( n, lons, lats, zs, lonvals2, latvals2, *gx2, *gy2, *vin );
+                 }
               } else {
                  throw (badmetfailure());
               }    
            } catch (...) {
+              lock.reacquire();
               for ( int i=0; i<n; i++ ) {
                  lonvals2[i] = gx2->fillval();
                  latvals2[i] = gy2->fillval();
@@ -1447,6 +1629,121 @@ void MetGridLatLonData::getVectorData( int n, string lonquantity, string latquan
 }
 
 
+bool MetGridLatLonData::pairVinterp( const std::string& quantity, const std::string& ct1, const std::string& ct2
+                                    , int n, real* lons, real* lats, real* zs, real* vals1, real* vals2
+                                    , double& t1, double& t2, real& badval, int flags )
+{
+     GridLatLonField3D *g1, *g2;
+     TimePair *pair;
+     // a stencil to use if the cached ones are turned off
+     HLatLonStencil fresh;
+     HLatLonStencil *st;
+     real val;
+     int ng;
+     
+     // met clients do not have the data to interleave,
+     // and there is nothing to interleave if the time falls on a snapshot
+     if ( ! use_timepairs || isMetClient() || ct1 == ct2 ) {
+        return false;
+     }
+     
+     st = ( use_stencil ) ? threadStencil() : &fresh;
+     
+     g1 = dynamic_cast<GridLatLonField3D*>(new_mgmtGrid3D( quantity, ct1 ));
+     
+     // not every interpolator can use interleaved snapshots
+     if ( ! hin->vinterpPair( 0, lons, lats, zs, vals1, vals2, *g1, NULLPTR, *vin, *st ) ) {
+        remove(g1);
+        return false;
+     }
+     
+     ng = g1->dataSize();
+     badval = g1->fillval();
+     
+     pair = &(timepairs[quantity]);
+     if ( pair->time1 != ct1 || pair->time2 != ct2 || static_cast<int>(pair->vals.size()) != 2*ng
+       || pair->vquant != g1->vertical() || pair->lons != g1->longitudes() 
+       || pair->lats != g1->latitudes() || pair->zs != g1->levels() ) {
+     
+        // we have moved into a new time interval (or the grids have changed), 
+        // so interleave its snapshots
+        GT_TIMER( pairtimer, "MetGridLatLonData::pairVinterp interleave" );
+        
+        g2 = dynamic_cast<GridLatLonField3D*>(new_mgmtGrid3D( quantity, ct2 ));
+        
+        // (reading g2 may have flushed the cache, and the pairs with it)
+        pair = &(timepairs[quantity]);
+        
+        // the two snapshots must lie on the same grid
+        if ( g2->dataSize() != ng || ! g1->compatible( *g2, METCOMPAT_HORIZ | METCOMPAT_VERT ) ) {
+           remove(g2);
+           remove(g1);
+           timepairs.erase( quantity );
+           return false;
+        }
+        
+        pair->vals.resize( 2*ng );
+        for ( int i=0; i<ng; i++ ) {
+            pair->vals[2*i] = g1->value(i);
+            // (the two snapshots must share a fill value)
+            val = g2->value(i);
+            pair->vals[2*i+1] = ( val != g2->fillval() ) ? val : badval;
+        }
+        pair->time1 = ct1;
+        pair->time2 = ct2;
+        pair->vquant = g1->vertical();
+        pair->lons = g1->longitudes();
+        pair->lats = g1->latitudes();
+        pair->zs = g1->levels();
+        pair->t2 = g2->time();
+        pair->mksScale2 = g2->mksScale;
+        pair->mksOffset2 = g2->mksOffset;
+        
+        remove(g2);
+     }
+     
+     try {
+        hin->vinterpPair( n, lons, lats, zs, vals1, vals2, *g1, &(pair->vals[0]), *vin, *st );
+     } catch (...) {
+        for ( int i=0; i<n; i++ ) {
+           vals1[i] = badval;
+           vals2[i] = badval;
+        }
+     }
+     
+     for ( int i=0; i<n; i++ ) {
+         if ( ( vals1[i] != badval ) && FINITE(vals1[i]) ) {
+            if ( flags & METDATA_MKS ) {
+               vals1[i] = vals1[i] * g1->mksScale + g1->mksOffset;
+            }
+         } else {
+            vals1[i] = badval;
+         }
+         if ( ( vals2[i] != badval ) && FINITE(vals2[i]) ) {
+            if ( flags & METDATA_MKS ) {
+               vals2[i] = vals2[i] * pair->mksScale2 + pair->mksOffset2;
+            }
+         } else {
+            vals2[i] = badval;
+         }
+     }
+     
+     t1 = g1->time();
+     t2 = pair->t2;
+     remove(g1);
+     
+     return true;
+}
+
+
+void MetGridLatLonData::flush_cache()
+{
+     timepairs.clear();
+     
+     MetGridData::flush_cache();
+}
+
+
 GridField3D* MetGridLatLonData::new_clientGrid3D( const std::string& quantity, const std::string& time )
 {
    int cmd;
@@ -1469,7 +1766,8 @@ GridField3D* MetGridLatLonData::new_clientGrid3D( const std::string& quantity, c
    result->clear();
    result->set_quantity( quantity );
    result->set_time( ttime, time ) ;
-   result->setPgroup( my_pgroup, my_metproc );    
+   // talk to whichever met processor is responsible for this quantity and time
+   result->setPgroup( my_pgroup, metShard( quantity, ttime ) );    
    //- std::cerr << "MetLatLonGridData::new_clientGrid3D:  (met client) set grid pgroup " << std::endl;
 
    // was the met processor able to come up with the data?
@@ -1522,7 +1820,8 @@ GridFieldSfc* MetGridLatLonData::new_clientGridSfc( const std::string& quantity,
    result->clear();
    result->set_quantity( quantity );
    result->set_time( ttime, time ) ;
-   result->setPgroup( my_pgroup, my_metproc );    
+   // talk to whichever met processor is responsible for this quantity and time
+   result->setPgroup( my_pgroup, metShard( quantity, ttime ) );    
    //- std::cerr << "MetGridData::new_clientGridSfc:  (met client) set grid pgroup " << std::endl;
 
    // was the met processor able to come up with the data?
@@ -1918,3 +2217,173 @@ GridFieldSfc* MetGridLatLonData::readCacheSfc( const std::string quantity, const
     return gridsfc;
 
 }
+
+void MetGridLatLonData::writeShared( const GridField3D* item ) const
+{
+#ifdef USE_SHMCACHE
+     FilePath* cachepath;
+     std::ostringstream buf;
+     const GridLatLonField3D* actualItem;
+    
+     if ( shmcache != NULLPTR && item->cacheable() ) {
+        actualItem = dynamic_cast<const GridLatLonField3D*>(item);
+        // the item is named the same way as its disk cache file
+        cachepath = cachefile( actualItem );
+        if ( cachepath != NULLPTR ) {
+           buf << *actualItem;
+           if ( shmcache->put( cachepath->basename(), buf.str() ) && dbug > 2 ) {
+              std::cerr << "MetGridLatLonData::writeShared: (3D) shared " << cachepath->basename() << std::endl;
+           }
+           delete cachepath;
+        }
+     }
+#endif
+}
+
+void MetGridLatLonData::writeShared( const GridFieldSfc* item ) const
+{
+#ifdef USE_SHMCACHE
+     FilePath* cachepath;
+     std::ostringstream buf;
+     const GridLatLonFieldSfc* actualItem;
+    
+     if ( shmcache != NULLPTR && item->cacheable() ) {
+        actualItem = dynamic_cast<const GridLatLonFieldSfc*>(item);
+        cachepath = cachefile( actualItem );
+        if ( cachepath != NULLPTR ) {
+           buf << *actualItem;
+           if ( shmcache->put( cachepath->basename(), buf.str() ) && dbug > 2 ) {
+              std::cerr << "MetGridLatLonData::writeShared: (Sfc) shared " << cachepath->basename() << std::endl;
+           }
+           delete cachepath;
+        }
+     }
+#endif
+}
+
+GridField3D* MetGridLatLonData::readShared3D( const std::string quantity, const std::string time )
+{
+    GridLatLonField3D* grid3d;
+#ifdef USE_SHMCACHE
+    FilePath* cachepath;
+    const char* data;
+    size_t size;
+    double xtime;
+    bool usingCache;
+#endif
+
+    grid3d = NULLPTR;
+
+#ifdef USE_SHMCACHE
+    if ( shmcache != NULLPTR ) {
+
+       // create a grid and set up quantities that
+       // are needed for naming the item
+       grid3d = new GridLatLonField3D;
+       grid3d->set_quantity(quantity);
+       grid3d->set_vertical(vquant);
+       xtime = cal2Time( time);
+       grid3d->set_time( xtime, time );
+       grid3d->setPgroup( my_pgroup, my_metproc );
+       
+       usingCache = false;
+       cachepath = cachefile( grid3d );
+       if ( cachepath != NULLPTR ) {
+          data = shmcache->attach( cachepath->basename(), size );
+          if ( data != NULLPTR ) {
+             try {
+                // deserialize straight out of the shared memory
+                ShmCache::Buffer sbuf( data, size );
+                std::istream inshm( &sbuf );
+                inshm >> *grid3d;
+                // (the item might not have the same base time as we do)
+                grid3d->set_time(xtime, time);
+                usingCache = true;
+                if ( dbug >= 2 ) {
+                   std::cerr << "MetGridLatLonData::readShared3D: read " << cachepath->basename() << " from the shared cache" << std::endl;
+                }
+             } catch (...) {
+                usingCache = false;
+             }
+             shmcache->detach( data, size );
+          }
+          delete cachepath;
+       }
+       
+       if ( ! usingCache ) {
+          remove(grid3d);
+          grid3d = NULLPTR;
+       }   
+    }
+#endif
+
+    return grid3d;
+}
+
+GridFieldSfc* MetGridLatLonData::readSharedSfc( const std::string quantity, const std::string time )
+{
+    GridLatLonFieldSfc* gridsfc;
+#ifdef USE_SHMCACHE
+    FilePath* cachepath;
+    const char* data;
+    size_t size;
+    double xtime;
+    bool usingCache;
+    std::string sfcname;
+    std::string quantname;
+    size_t pos;
+#endif
+
+    gridsfc = NULLPTR;
+
+#ifdef USE_SHMCACHE
+    if ( shmcache != NULLPTR ) {
+
+       // split the quantity name into quantity and surface
+       pos = quantity.find("@");
+       if ( pos != string::npos ) {
+          quantname = quantity.substr(0, pos);
+          sfcname = quantity.substr(pos+1);
+       } else {
+          quantname = quantity;
+          sfcname = "sfc";
+       }
+    
+       gridsfc = new GridLatLonFieldSfc;
+       gridsfc->set_quantity(quantname);
+       gridsfc->set_surface(sfcname);
+       xtime = cal2Time( time);
+       gridsfc->set_time( xtime, time );
+       gridsfc->setPgroup( my_pgroup, my_metproc );
+       
+       usingCache = false;
+       cachepath = cachefile( gridsfc );
+       if ( cachepath != NULLPTR ) {
+          data = shmcache->attach( cachepath->basename(), size );
+          if ( data != NULLPTR ) {
+             try {
+                ShmCache::Buffer sbuf( data, size );
+                std::istream inshm( &sbuf );
+                inshm >> *gridsfc;
+                gridsfc->set_time(xtime, time);
+                usingCache = true;
+                if ( dbug >= 2 ) {
+                   std::cerr << "MetGridLatLonData::readSharedSfc: read " << cachepath->basename() << " from the shared cache" << std::endl;
+                }
+             } catch (...) {
+                usingCache = false;
+             }
+             shmcache->detach( data, size );
+          }
+          delete cachepath;
+       }
+       
+       if ( ! usingCache ) {
+          remove( gridsfc );
+          gridsfc = NULLPTR;
+       }   
+    }
+#endif
+
+    return gridsfc;
+}
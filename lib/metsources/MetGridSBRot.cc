@@ -796,7 +796,10 @@ FilePath* MetGridSBRot::cachefile( const GridFieldSfc* item ) const
     if ( item->cacheable() ) {
 
        filepath = new FilePath;
-       *filepath = *diskcachedir;
+       // (the shared met cache uses these names, with or without a disk cache)
+       if ( diskcachedir != NULLPTR ) {
+          *filepath = *diskcachedir;
+       }
        
        fname = "MetGridSBRot_"
                + actualItem->quantity()
@@ -834,7 +837,10 @@ FilePath* MetGridSBRot::cachefile( const GridField3D* item ) const
     if ( item->cacheable() ) {
 
        filepath = new FilePath;
-       *filepath = *diskcachedir;
+       // (the shared met cache uses these names, with or without a disk cache)
+       if ( diskcachedir != NULLPTR ) {
+          *filepath = *diskcachedir;
+       }
        
        date = actualItem->met_time();
        
@@ -19,6 +19,8 @@
 
 #include "math.h"
 
+#include <algorithm>
+
 #include "gigatraj/MetMyGEOS.hh"
 
 using namespace gigatraj;
@@ -102,6 +104,16 @@ MetMyGEOS::MetMyGEOS( const MetMyGEOS&  src) : MetGridLatLonData(src)
      
      skip = src.skip;
      skoff = src.skoff;
+     for ( int i=0; i<6; i++ ) {
+         region_bnds[i] = src.region_bnds[i];
+     }
+     region_given = src.region_given;
+     region_vert = src.region_vert;
+     levwin_set = src.levwin_set;
+     for ( int i=0; i<2; i++ ) {
+         levwin_zs[i] = src.levwin_zs[i];
+         levwin_bnds[i] = src.levwin_bnds[i];
+     }
      waittry = src.waittry;
      openwait = src.openwait;
      ntries = src.ntries;
@@ -148,6 +160,16 @@ void MetMyGEOS::assign(const MetMyGEOS& src)
      
      skip = src.skip;
      skoff = src.skoff;
+     for ( int i=0; i<6; i++ ) {
+         region_bnds[i] = src.region_bnds[i];
+     }
+     region_given = src.region_given;
+     region_vert = src.region_vert;
+     levwin_set = src.levwin_set;
+     for ( int i=0; i<2; i++ ) {
+         levwin_zs[i] = src.levwin_zs[i];
+         levwin_bnds[i] = src.levwin_bnds[i];
+     }
      waittry = src.waittry;
      openwait = src.openwait;
      ntries = src.ntries;
@@ -273,19 +295,50 @@ void MetMyGEOS::setOption( const std::string &name, int value )
         setWaitOpen(value);
     } else {    
 */
-    MetGridLatLonData::setOption( name, value );
+    if ( name.substr(0,6) == "Region" ) {
+       setOption( name, static_cast<double>(value) );
+    } else {
+       MetGridLatLonData::setOption( name, value );
+    }
 //    }
     
 }
 
 void MetMyGEOS::setOption( const std::string &name, float value )
 {
-    MetGridLatLonData::setOption( name, value );
+    if ( name.substr(0,6) == "Region" ) {
+       setOption( name, static_cast<double>(value) );
+    } else {
+       MetGridLatLonData::setOption( name, value );
+    }
 }
 
 void MetMyGEOS::setOption( const std::string &name, double value )
 {
-    MetGridLatLonData::setOption( name, value );
+    int idx;
+    
+    idx = -1;
+    if ( name == "RegionLonMin" ) {
+       idx = 0;
+    } else if ( name == "RegionLonMax" ) {
+       idx = 1;
+    } else if ( name == "RegionLatMin" ) {
+       idx = 2;
+    } else if ( name == "RegionLatMax" ) {
+       idx = 3;
+    } else if ( name == "RegionZMin" ) {
+       idx = 4;
+    } else if ( name == "RegionZMax" ) {
+       idx = 5;
+    }
+    
+    if ( idx >= 0 ) {
+       region_bnds[idx] = value;
+       region_given = region_given | ( 1 << idx );
+       // (the new region takes effect when the next file is opened) 
+    } else {
+       MetGridLatLonData::setOption( name, value );
+    }
 }
 
 
@@ -365,13 +418,234 @@ bool MetMyGEOS::getOption( const std::string &name, int &value )
 
 bool MetMyGEOS::getOption( const std::string &name, float &value )
 {
-    return MetGridLatLonData::getOption( name, value );
+    bool result;
+    double dval;
+    
+    if ( name.substr(0,6) == "Region" ) {
+       result = getOption( name, dval );
+       value = dval;
+    } else {
+       result = MetGridLatLonData::getOption( name, value );
+    }
+    
+    return result;
 }
 
 
 bool MetMyGEOS::getOption( const std::string &name, double &value )
 {
-    return MetGridLatLonData::getOption( name, value );
+    int idx;
+    bool result;
+    
+    idx = -1;
+    if ( name == "RegionLonMin" ) {
+       idx = 0;
+    } else if ( name == "RegionLonMax" ) {
+       idx = 1;
+    } else if ( name == "RegionLatMin" ) {
+       idx = 2;
+    } else if ( name == "RegionLatMax" ) {
+       idx = 3;
+    } else if ( name == "RegionZMin" ) {
+       idx = 4;
+    } else if ( name == "RegionZMax" ) {
+       idx = 5;
+    }
+    
+    if ( idx >= 0 ) {
+       value = 0.0;
+       result = false;
+       if ( region_given & ( 1 << idx ) ) {
+          value = region_bnds[idx];
+          result = true;
+       }
+    } else {
+       result = MetGridLatLonData::getOption( name, value );
+    }
+    
+    return result;
+}
+
+
+bool MetMyGEOS::inDomain( real lon, real lat, real z ) const
+{
+    real span;
+    real x;
+    
+    if ( region_given == 0 ) {
+       return true;
+    }
+    
+    if ( (region_given & 0x03) == 0x03 ) {
+       span = region_bnds[1] - region_bnds[0];
+       while ( span <= 0.0 ) {
+          span = span + 360.0;
+       }
+       x = lon - region_bnds[0];
+       while ( x < 0.0 ) {
+          x = x + 360.0;
+       }
+       while ( x >= 360.0 ) {
+          x = x - 360.0;
+       }
+       if ( x > span ) {
+          return false;
+       }
+    }
+    
+    if ( ( (region_given & 0x04) && ( lat < region_bnds[2] ) )
+      || ( (region_given & 0x08) && ( lat > region_bnds[3] ) ) ) {
+       return false;
+    }
+    
+    if ( region_vert ) {
+       if ( ( (region_given & 0x10) && ( z < region_bnds[4] ) )
+         || ( (region_given & 0x20) && ( z > region_bnds[5] ) ) ) {
+          return false;
+       }
+    }
+    
+    return true;
+}
+
+
+void MetMyGEOS::update_vregion()
+{
+    int given;
+    real zmin, zmax;
+    std::vector<real> zz;
+    int n;
+    int i;
+    
+    given = ( region_given >> 4 ) & 0x03;
+    zmin = region_bnds[4];
+    zmax = region_bnds[5];
+    
+    if ( levwin_set ) {
+    
+       // widen the parcels' range by a margin of levels
+       levwin_bnds[0] = levwin_zs[0];
+       levwin_bnds[1] = levwin_zs[1];
+       zz = vgrid.levs;
+       n = zz.size();
+       if ( n > 1 ) {
+          std::sort( zz.begin(), zz.end() );
+          
+          i = 0;
+          while ( i < (n - 1) && zz[i+1] <= levwin_bnds[0] ) {
+             i++;
+          }
+          i = i - my_levwinpad;
+          if ( i < 0 ) {
+             i = 0;
+          }
+          if ( zz[i] < levwin_bnds[0] ) {
+             levwin_bnds[0] = zz[i];
+          }
+          
+          i = n - 1;
+          while ( i > 0 && zz[i-1] >= levwin_bnds[1] ) {
+             i--;
+          }
+          i = i + my_levwinpad;
+          if ( i > (n - 1) ) {
+             i = n - 1;
+          }
+          if ( zz[i] > levwin_bnds[1] ) {
+             levwin_bnds[1] = zz[i];
+          }
+       }
+       
+       // combine the window with the region
+       if ( ! (given & 0x01) || ( levwin_bnds[0] > zmin ) ) {
+          zmin = levwin_bnds[0];
+       }
+       if ( ! (given & 0x02) || ( levwin_bnds[1] < zmax ) ) {
+          zmax = levwin_bnds[1];
+       }
+       given = 0x03;
+    }
+    
+    // (Levels are cut out only in the native vertical coordinate;
+    // data to be converted to some other vertical coordinate
+    // are read in full.)
+    region_vert = ( given != 0 ) && ( vgrid.quant == vquant );
+    if ( region_vert ) {
+       vgrid.region( given, zmin, zmax );
+    } else {
+       vgrid.region( 0, 0.0, 0.0 );
+    }
+
+}
+
+
+void MetMyGEOS::levelRange( real zlo, real zhi )
+{
+    int oldFirst, oldCount;
+    
+    // (the window may be widened by another thread at any time)
+    MetData::Lock lock( this );
+    
+    // The parcels have not moved beyond the range we last saw.
+    // (Once any parcel enters the padding, we widen and re-pad.)
+    if ( levwin_set && ( zlo >= levwin_zs[0] ) && ( zhi <= levwin_zs[1] ) ) {
+       return;
+    }
+    
+    // the window only ever widens
+    if ( levwin_set ) {
+       if ( levwin_zs[0] < zlo ) {
+          zlo = levwin_zs[0];
+       }
+       if ( levwin_zs[1] > zhi ) {
+          zhi = levwin_zs[1];
+       }
+    }
+    levwin_zs[0] = zlo;
+    levwin_zs[1] = zhi;
+    levwin_set = true;
+    
+    oldFirst = vgrid.levFirst;
+    oldCount = vgrid.levCount;
+    
+    update_vregion();
+    
+    if ( dbug > 2 ) {
+       std::cerr << "MetMyGEOS::levelRange: level window " << levwin_bnds[0] << " to " << levwin_bnds[1] 
+                 << " (" << vgrid.levCount << " of " << vgrid.nLevs << " levels)" << std::endl;
+    }
+    
+    if ( ( vgrid.levFirst != oldFirst ) || ( vgrid.levCount != oldCount ) ) {
+       // the 3D fields held in memory were read with the old levels
+       flush_cache();
+    }
+
+}
+
+
+std::string MetMyGEOS::region_tag( bool vert ) const
+{
+    std::ostringstream ss;
+    int given;
+    
+    given = region_given;
+    if ( ! vert ) {
+       given = given & 0x0F;
+    }
+    
+    if ( given != 0 ) {
+       ss << "X" << given;
+       for ( int i=0; i<6; i++ ) {
+           if ( given & ( 1 << i ) ) {
+              ss << ":" << region_bnds[i];
+           }
+       }
+    }
+    if ( vert && levwin_set ) {
+       ss << "W:" << levwin_bnds[0] << ":" << levwin_bnds[1];
+    }
+    
+    return ss.str();
 }
 
 
@@ -1072,7 +1346,10 @@ FilePath* MetMyGEOS::cachefile( const GridFieldSfc* item ) const
     if ( item->cacheable() ) {
 
        filepath = new FilePath;
-       *filepath = *diskcachedir;
+       // (the shared met cache uses these names, with or without a disk cache)
+       if ( diskcachedir != NULLPTR ) {
+          *filepath = *diskcachedir;
+       }
        
        flags = "";
        try {
@@ -1091,6 +1368,7 @@ FilePath* MetMyGEOS::cachefile( const GridFieldSfc* item ) const
           }
           flags = flags + ss.str();
        }
+       flags = flags + region_tag( false );
        
        date = actualItem->met_time();
        
@@ -1139,7 +1417,10 @@ FilePath* MetMyGEOS::cachefile( const GridField3D* item ) const
     if ( item->cacheable() ) {
 
        filepath = new FilePath;
-       *filepath = *diskcachedir;
+       // (the shared met cache uses these names, with or without a disk cache)
+       if ( diskcachedir != NULLPTR ) {
+          *filepath = *diskcachedir;
+       }
        
        flags = "";
        try {
@@ -1159,6 +1440,7 @@ FilePath* MetMyGEOS::cachefile( const GridField3D* item ) const
           }
           flags = flags + ss.str();
        }
+       flags = flags + region_tag( true );
       
        date = actualItem->met_time();
        
@@ -1884,6 +2166,16 @@ void MetMyGEOS::reset()
      catTimeOffset = 0;
      skip = 0;
      skoff = 0;
+     for ( int i=0; i<6; i++ ) {
+         region_bnds[i] = 0.0;
+     }
+     region_given = 0;
+     region_vert = false;
+     levwin_set = false;
+     for ( int i=0; i<2; i++ ) {
+         levwin_zs[i] = 0.0;
+         levwin_bnds[i] = 0.0;
+     }
      waittry = 1;
      openwait = 0;
      ntries = 1;
@@ -1921,7 +2213,9 @@ MetMyGEOS* MetMyGEOS::myNew()
    dup->setPgroup(my_pgroup, my_metproc);
    dup->defineCal( time2Cal(0), 0.0 );
    dup->maxsnaps = this->maxsnaps;
+   dup->setCacheBudget( this->cache_budget );
    dup->setCacheDir( this->diskcachedir );
+   dup->setSharedCache( this->sharedCache() );
 
    dup->mettag = this->mettag;
    dup->modelrun = this->modelrun;
@@ -1958,6 +2252,16 @@ MetMyGEOS* MetMyGEOS::myNew()
 
    dup->skip = this->skip;
    dup->skoff = this->skoff;
+   for ( int i=0; i<6; i++ ) {
+       dup->region_bnds[i] = this->region_bnds[i];
+   }
+   dup->region_given = this->region_given;
+   dup->region_vert = this->region_vert;
+   dup->levwin_set = this->levwin_set;
+   for ( int i=0; i<2; i++ ) {
+       dup->levwin_zs[i] = this->levwin_zs[i];
+       dup->levwin_bnds[i] = this->levwin_bnds[i];
+   }
    dup->waittry = this->waittry;
    dup->openwait = this->openwait;
    dup->ntries = this->ntries;
@@ -4162,7 +4466,6 @@ void MetMyGEOS::update_hgrid()
 {
     bool ok;
     std::string hspec;
-    int newLen;
     real lonstrt, lonend, londelta;
     int nlon;
     real latstrt, latend, latdelta;
@@ -4318,28 +4621,21 @@ void MetMyGEOS::update_hgrid()
        hgrid.thin_offset = skoff;
     }
    
-    newLen = hgrid.nLons/hgrid.thin;
-    if ( newLen*hgrid.thin < hgrid.nLons ) {
-       newLen++;
-    }
-
+    // restrict the horiz grid to the region, if one has been set
+    hgrid.region( region_given, region_bnds );
+    
     // reset the lons and lats
     lons.clear();
-    lons.reserve( newLen );
-    for ( int i=0; i<newLen; i++ ) {
-        lons.push_back( hgrid.startLon + hgrid.deltaLon*(hgrid.thin_offset + hgrid.thin*i) );
+    lons.reserve( hgrid.lonCount );
+    for ( int i=0; i<hgrid.lonCount; i++ ) {
+        lons.push_back( hgrid.startLon + hgrid.deltaLon*(hgrid.lonFirst + hgrid.thin*i) );
     }
     nlons = lons.size();
         
-    newLen = hgrid.nLats/hgrid.thin;
-    if ( newLen*hgrid.thin < hgrid.nLats ) {
-       newLen++;
-    }
- 
     lats.clear();
-    lats.reserve( newLen );
-    for ( int i=0; i<newLen; i++ ) {
-        lats.push_back( hgrid.startLat + hgrid.deltaLat*hgrid.thin*i );
+    lats.reserve( hgrid.latCount );
+    for ( int i=0; i<hgrid.latCount; i++ ) {
+        lats.push_back( hgrid.startLat + hgrid.deltaLat*(hgrid.latFirst + hgrid.thin*i) );
     }
     nlats = lats.size();
 
@@ -4454,6 +4750,9 @@ void MetMyGEOS::update_vgrid()
        native_zs = vgrid.levs;
        native_nzs = vgrid.nLevs;
 
+       // restrict the vertical levels to the region, if one has been set
+       update_vregion();
+
     }
 }
 
@@ -5110,7 +5409,7 @@ void MetMyGEOS::Source_read_data_floats( std::vector<real>&vals, int var_id, int
 }
 
 
-void MetMyGEOS::Source_read_data_floats( real** vals, int var_id, int ndims, size_t *starts, size_t *counts, ptrdiff_t *strides )
+void MetMyGEOS::Source_read_data_floats( gridreal** vals, int var_id, int ndims, size_t *starts, size_t *counts, ptrdiff_t *strides )
 {
      float *buffr;
      int totsize;
@@ -5236,7 +5535,7 @@ void MetMyGEOS::Source_read_data_floats( real** vals, int var_id, int ndims, siz
         std::cerr << "MetMyGEOS::Source_read_data: (" << ndims << "D):  about to read data! " <<  std::endl;
      }
 
-     *vals = new real[totsize];
+     *vals = new gridreal[totsize];
      total_read = 0;
 
      err = NC_NOERR;
@@ -5378,10 +5677,10 @@ void MetMyGEOS::Source_read_data_floats( real** vals, int var_id, int ndims, siz
 void MetMyGEOS::Source_getvar(const std::string& quantity, const double time, GridLatLonField3D* grid3d )
 {
      int err;
-     real* xlons;
-     real* xlats;
-     real* xzs;
-     real* xdata;
+     gridreal* xlons;
+     gridreal* xlats;
+     gridreal* xzs;
+     gridreal* xdata;
      int xnlons, xnlats, xnzs;
      char attr_name[NC_MAX_NAME+1];
      char attr_cval[NC_MAX_NAME+1];
@@ -5508,23 +5807,38 @@ void MetMyGEOS::Source_getvar(const std::string& quantity, const double time, Gr
         vcounts[3] = nlons;
         vstride[3] = 1;
         
-        if ( skip > 0 ) {
-           // thin out xlons and xlats
+        if ( vgrid.levCount < nzs ) {
+           // read only the levels in the region
+           vstarts[1] = vgrid.levFirst;
+           vcounts[1] = vgrid.levCount;
+           
+           nzs = vgrid.levCount;
+           
+           for (int i=0; i<nzs; i++ ) {
+               xzs[i] = xzs[vgrid.levFirst + i];
+           }
+        }
+        
+        if ( skip > 0 || hgrid.lonCount < nlons || hgrid.latCount < nlats ) {
+           // thin out and/or cut out a region of xlons and xlats
            vcounts[2] = lats.size();
-           vstride[2] = skip;
+           vstride[2] = hgrid.thin;
+           vstarts[2] = hgrid.latFirst;
            
            vcounts[3] = lons.size();
-           vstride[3] = skip;
-           vstarts[3] = skoff;
+           vstride[3] = hgrid.thin;
+           vstarts[3] = hgrid.lonFirst;
            
            nlons = vcounts[3];
            nlats = vcounts[2];
            
-           xlons = new real[nlons];;
+           delete[] xlons;
+           delete[] xlats;
+           xlons = new gridreal[nlons];;
            for (int i=0; i<nlons; i++ ) {
                xlons[i] = hgrid.startLon + hgrid.deltaLon*(vstarts[3] + i*vstride[3]);
            }    
-           xlats = new real[nlats];
+           xlats = new gridreal[nlats];
            for (int i=0; i<nlats; i++ ) {
                xlats[i] = hgrid.startLat + hgrid.deltaLat*(vstarts[2] + i*vstride[2]);
            }    
@@ -5564,9 +5878,9 @@ void MetMyGEOS::Source_getvar(const std::string& quantity, const double time, Gr
 void MetMyGEOS::Source_getvar(const std::string& quantity, const double time, GridLatLonFieldSfc* grid2d )
 {
      int err;
-     real* xlons;
-     real* xlats;
-     real* xdata;
+     gridreal* xlons;
+     gridreal* xlats;
+     gridreal* xdata;
      int xnlons, xnlats, xnzs;
      char attr_name[NC_MAX_NAME+1];
      char attr_cval[NC_MAX_NAME+1];
@@ -5676,23 +5990,26 @@ void MetMyGEOS::Source_getvar(const std::string& quantity, const double time, Gr
         vcounts[2] = nlons;
         vstride[2] = 1;
         
-        if ( skip > 0 ) {
-           // thin out xlons and xlats
+        if ( skip > 0 || hgrid.lonCount < nlons || hgrid.latCount < nlats ) {
+           // thin out and/or cut out a region of xlons and xlats
            vcounts[1] = lats.size();
-           vstride[1] = skip;
+           vstride[1] = hgrid.thin;
+           vstarts[1] = hgrid.latFirst;
 
            vcounts[2] = lons.size();
-           vstride[2] = skip;
-           vstarts[2] = skoff;
+           vstride[2] = hgrid.thin;
+           vstarts[2] = hgrid.lonFirst;
            
            nlons = vcounts[2];
            nlats = vcounts[1];
            
-           xlons = new real[nlons];;
+           delete[] xlons;
+           delete[] xlats;
+           xlons = new gridreal[nlons];;
            for (int i=0; i<nlons; i++ ) {
                xlons[i] = hgrid.startLon + hgrid.deltaLon*(vstarts[2] + i*vstride[2]);
            }    
-           xlats = new real[nlats];
+           xlats = new gridreal[nlats];
            for (int i=0; i<nlats; i++ ) {
                xlats[i] = hgrid.startLat + hgrid.deltaLat*(vstarts[1] + i*vstride[1]);
            }    
@@ -6019,6 +6336,11 @@ void MetMyGEOS::HGridSpec::clear()
     thin = 1; 
     thin_offset = 0;
     
+    lonFirst = 0;
+    lonCount = 0;
+    latFirst = 0;
+    latCount = 0;
+    
     given = 0;
 }
 
@@ -6353,6 +6675,120 @@ bool MetMyGEOS::HGridSpec::test( const HGridSpec& cmp ) const
     return result;
 }
 
+void MetMyGEOS::HGridSpec::region( int given, const real* bnds )
+{
+    real span;
+    real x;
+    real lo, hi;
+    int i1, i2;
+    int last;
+    
+    // start with the whole (thinned) grid
+    lonFirst = thin_offset;
+    lonCount = 0;
+    if ( nLons > thin_offset ) {
+       lonCount = (nLons - 1 - thin_offset)/thin + 1;
+    }
+    latFirst = 0;
+    latCount = 0;
+    if ( nLats > 0 ) {
+       latCount = (nLats - 1)/thin + 1;
+    }
+    
+    if ( ( (given & 0x03) == 0x03 ) && ( lonCount > 0 ) ) {
+       
+       // the width of the region, going eastward from its western edge
+       span = bnds[1] - bnds[0];
+       while ( span <= 0.0 ) {
+          span = span + 360.0;
+       }
+       // the western edge, relative to the start of the grid
+       x = bnds[0] - startLon;
+       while ( x < 0.0 ) {
+          x = x + 360.0;
+       }
+       while ( x >= 360.0 ) {
+          x = x - 360.0;
+       }
+       
+       i1 = static_cast<int>( floor( x/deltaLon ) );
+       i2 = static_cast<int>( ceil( (x + span)/deltaLon ) );
+       
+       // If the region straddles the edge of the grid, it cannot
+       // be read as a single block, so we read all the longitudes.
+       if ( i2 < nLons ) {
+          
+          // pad by one gridpoint
+          i1 = i1 - 1;
+          if ( i1 < 0 ) {
+             i1 = 0;
+          }
+          i2 = i2 + 1;
+          if ( i2 > (nLons - 1) ) {
+             i2 = nLons - 1;
+          }
+          
+          // line up with the thinned gridpoints
+          if ( i1 > thin_offset ) {
+             lonFirst = thin_offset + ( (i1 - thin_offset)/thin )*thin;
+          }
+          last = lonFirst + ( (i2 - lonFirst + thin - 1)/thin )*thin;
+          if ( last > (nLons - 1) ) {
+             last = last - thin;
+          }
+          lonCount = (last - lonFirst)/thin + 1;
+          
+       }
+    }
+    
+    if ( (given & 0x0C) && ( latCount > 0 ) ) {
+    
+       lo = -90.0;
+       if ( given & 0x04 ) {
+          lo = bnds[2];
+       }
+       hi = 90.0;
+       if ( given & 0x08 ) {
+          hi = bnds[3];
+       }
+       
+       i1 = static_cast<int>( floor( (lo - startLat)/deltaLat ) );
+       i2 = static_cast<int>( ceil( (hi - startLat)/deltaLat ) );
+       if ( i1 > i2 ) {
+          // latitudes decrease
+          last = i1;
+          i1 = i2;
+          i2 = last;
+       }
+       
+       // pad by one gridpoint
+       i1 = i1 - 1;
+       if ( i1 < 0 ) {
+          i1 = 0;
+       }
+       if ( i1 > (nLats - 1) ) {
+          i1 = nLats - 1;
+       }
+       i2 = i2 + 1;
+       if ( i2 > (nLats - 1) ) {
+          i2 = nLats - 1;
+       }
+       if ( i2 < i1 ) {
+          i2 = i1;
+       }
+       
+       // line up with the thinned gridpoints
+       latFirst = ( i1/thin )*thin;
+       last = latFirst + ( (i2 - latFirst + thin - 1)/thin )*thin;
+       if ( last > (nLats - 1) ) {
+          last = last - thin;
+       }
+       latCount = (last - latFirst)/thin + 1;
+       
+    }
+
+}
+
 
 
 
@@ -6377,6 +6813,8 @@ void MetMyGEOS::VGridSpec::clear()
    mksOffset = 0.0;
    levs.clear();
    nLevs = 0;
+   levFirst = 0;
+   levCount = 0;
 
 }
 
@@ -6918,6 +7356,56 @@ bool MetMyGEOS::VGridSpec::test( const VGridSpec& cmp ) const
 
 }
 
+void MetMyGEOS::VGridSpec::region( int given, real zmin, real zmax )
+{
+    real a, b;
+    int k1, k2;
+    
+    // start with all the levels
+    levFirst = 0;
+    levCount = nLevs;
+    
+    if ( ( (given & 0x03) == 0 ) || ( nLevs < 2 ) ) {
+       return;
+    }
+    
+    // find the layers that overlap the range
+    k1 = nLevs;
+    k2 = -1;
+    for ( int k = 0; k < (nLevs - 1); k++ ) {
+        a = levs[k];
+        b = levs[k+1];
+        if ( a > b ) {
+           a = levs[k+1];
+           b = levs[k];
+        }
+        if ( ( ( ! (given & 0x01) ) || ( b >= zmin ) )
+          && ( ( ! (given & 0x02) ) || ( a <= zmax ) ) ) {
+           if ( k < k1 ) {
+              k1 = k;
+           }
+           k2 = k + 1;
+        }
+    }
+    
+    // (if none of them do, we read all the levels)
+    if ( k2 >= 0 ) {
+       // pad by one level
+       k1 = k1 - 1;
+       if ( k1 < 0 ) {
+          k1 = 0;
+       }
+       k2 = k2 + 1;
+       if ( k2 > (nLevs - 1) ) {
+          k2 = nLevs - 1;
+       }
+       
+       levFirst = k1;
+       levCount = k2 - k1 + 1;
+    }
+
+}
+
 // constructor
 MetMyGEOS::TGridSpec::TGridSpec()
 {
@@ -7424,17 +7912,17 @@ void MetMyGEOS::query_hgrid( const HGridSpec& qhgrid, std::vector<real>& lons, s
 
 }
 
-void MetMyGEOS::query_hgrid( const HGridSpec& qhgrid, int* nlons, real** lons, int* nlats, real** lats ) const
+void MetMyGEOS::query_hgrid( const HGridSpec& qhgrid, int* nlons, gridreal** lons, int* nlats, gridreal** lats ) const
 {
      *nlons = qhgrid.nLons;
-     *lons = new real[qhgrid.nLons];
+     *lons = new gridreal[qhgrid.nLons];
      for (int i=0; i < qhgrid.nLons; i++ ) {
          (*lons)[i] = qhgrid.startLon + i*qhgrid.deltaLon;
      }
      (*lons)[ qhgrid.nLons - 1 ] = qhgrid.endLon;
 
      *nlats = qhgrid.nLats;
-     *lats = new real[qhgrid.nLats];
+     *lats = new gridreal[qhgrid.nLats];
      for (int i=0; i < qhgrid.nLats; i++ ) {
          (*lats)[i] = qhgrid.startLat + i*qhgrid.deltaLat;
      }
@@ -7450,10 +7938,10 @@ void MetMyGEOS::query_vgrid( const VGridSpec& qvgrid, std::vector<real>& levels,
 
 }
 
-void MetMyGEOS::query_vgrid( const VGridSpec& qvgrid, int* nlevs, real** levels, std::string& q, std::string& u  ) const
+void MetMyGEOS::query_vgrid( const VGridSpec& qvgrid, int* nlevs, gridreal** levels, std::string& q, std::string& u  ) const
 {
      *nlevs = qvgrid.levs.size();
-     *levels = new real[*nlevs];
+     *levels = new gridreal[*nlevs];
      for ( int i=0; i < *nlevs; i++ ) {
          (*levels)[i] = qvgrid.levs[i];
      }
@@ -858,10 +858,11 @@ void MetSBRot::serveMet()
    
    if ( isMetServer() ) {
       // how many processors do we need to tell us we are done?
-      done_goal = my_pgroup->size() - 1;
+      done_goal = metClients();
+      done_count = serveBegin();
 //std::cerr << "serveMet: [" << my_pgroup->id() << "] entering, looking for " << done_goal << std::endl;
       
-      while ( done_count < done_goal ) {
+      while ( serving( done_count, done_goal ) ) {
 //std::cerr << "serveMet: [" << my_pgroup->id() << "] begin loop " << done_count << " of " << done_goal << std::endl;
       
           // receive a signal from any processor in this group
@@ -873,6 +874,10 @@ void MetSBRot::serveMet()
              done_count++;
 //std::cerr << "serveMet: [" << my_pgroup->id() << "] done_count = " << done_count << " of " << done_goal << std::endl;
              break;
+          case PGR_CMD_STEP:
+             // that processor has finished a time step
+             clientStep( src );
+             break;
           case PGR_CMD_DATA:
              // send data values to a client
 //std::cerr << "serveMet: [" << my_pgroup->id() << "] sending misc data " << std::endl;
@@ -918,7 +923,7 @@ void MetSBRot::serveMet()
       }
       
       // sync with the clients;
-      my_pgroup->sync();
+      serveEnd( done_count );
    }
 //std::cerr << "serveMet: [" << my_pgroup->id() << "] exit" << std::endl;
 
@@ -0,0 +1,955 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
+/*!
+
+\page  gt_bench gt_bench: Run standard performance benchmarks
+
+The gt_bench program runs a set of standard, reproducible benchmark
+scenarios against synthetic meteorological data, and reports the results
+in JSON format so that they can be compared from one build to another
+to track performance regressions. It needs no external met data
+and no network access: the met data come from the MetGridSBRot
+and MetSBRot sources, and the workloads are generated from a fixed random seed.
+
+For example:
+
+\code
+    gt_bench --parcels 100000 --steps 20 --output bench.json
+    mpirun -n 8 gt_bench --mpi --scenarios swarm_advance
+\endcode    
+
+The calling sequence is:
+\code 
+gt_bench [ --parcels n ] [ --steps n ] [ --batch n ] [ --seed n ] \
+         [ --scenarios list ] [ --output file ] [ --cachedir dir ] \
+         [ --mpi ] [ --met_server_ratio r ] [ --verbose ] [ -h|--help ]  
+\endcode
+
+The command-line options are:
+
+  \li \c help : prints out a description of options and then stops
+  \li \c verbose : prints out messages to let the user know what progress is being made
+  \li \c parcels : the number of parcels (or points) in each workload
+  \li \c steps : the number of repetitions (e.g., time steps) in each scenario
+  \li \c batch : the number of points in each call to the array versions of getData() and vinterp()
+  \li \c seed : the seed for the random number generator that creates the workloads
+  \li \c scenarios : a comma-separated list of the scenarios to run, or "all"
+  \li \c output : the file to which the JSON results are written ("-" for standard output)
+  \li \c cachedir : a scratch directory for the disk cache and netcdf output scenarios.
+                    It is deleted when the program finishes.
+  \li \c mpi : use MPI for the swarm_advance (and netcdf_out) scenarios
+  \li \c met_server_ratio : the ratio of tracing processors to met data server processors
+         for the swarm_advance scenario (0 = no met server processors)
+
+The scenarios are:
+
+  \li \c getdata_scalar : the scalar version of MetGridData::getData()
+  \li \c getdata_vector : the array version of MetGridData::getData()
+  \li \c vinterp : the array version of BilinearHinterp::vinterp(), on an in-memory grid
+  \li \c integ_rk4 : IntegRK4 time steps for an array of parcels, using MetSBRot winds
+  \li \c swarm_reorder : single-processor Swarm::advance() time steps of scattered parcels, 
+         without and with the space-filling-curve ordering of Swarm::setReorder(). 
+         The two must give identical parcel positions.
+  \li \c earth_nav : the multi-point Earth deltaxy(), vRelocate(), distance(), and bearing() methods,
+         in each of the modes of PlanetSphereNav::vectorized(). The batch modes' results
+         must agree with those of the scalar code.
+  \li \c swarm_advance : Swarm::advance() time steps, across all processors 
+  \li \c netcdf_out : NetcdfOut writes of the Swarm (if gigatraj was built with netcdf)
+  \li \c disk_cache : reloading met data snapshots from the disk cache, compared with generating them
+
+For each scenario, the JSON output gives the number of operations
+and the time they took, the throughput, the distribution
+of per-operation latencies (in microseconds), and the high-water mark
+of the process memory use (in kB) at the end of the scenario.
+In multiprocessing runs, the results are written by the root processor only.
+The exit status is non-zero if any scenario fails its consistency check.
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Configuration.hh"
+#include "gigatraj/RandomSrc.hh"
+#include "gigatraj/ProcessGrp.hh"
+#include "gigatraj/SerialGrp.hh"
+#ifdef USE_MPI
+#include "gigatraj/MPIGrp.hh"
+#endif
+#include "gigatraj/Parcel.hh"
+#include "gigatraj/Swarm.hh"
+#include "gigatraj/MetSBRot.hh"
+#include "gigatraj/MetGridSBRot.hh"
+#include "gigatraj/GridLatLonField3D.hh"
+#include "gigatraj/BilinearHinterp.hh"
+#include "gigatraj/LinearVinterp.hh"
+#include "gigatraj/IntegRK4.hh"
+#include "gigatraj/Earth.hh"
+#ifdef USE_NETCDF
+#include "gigatraj/NetcdfOut.hh"
+#endif
+  
+using namespace gigatraj;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+
+
+/*------------------------------------------------------------------------------------------*/
+/* the results of one benchmark scenario */
+class BenchResult {
+
+   public:
+   
+      // the scenario name
+      string name;
+      // what an operation is
+      string unit;
+      // the number of operations done
+      double ops;
+      // the elapsed (wall-clock) time, in seconds
+      double seconds;
+      // the time taken by each timed chunk of work, in seconds, and the number of operations in each
+      vector<double> chunks;
+      vector<double> chunkops;
+      // any extra numbers to be reported
+      vector<string> xnames;
+      vector<double> xvals;
+      
+      BenchResult( const string &nam, const string &un ) : name(nam), unit(un), ops(0.0), seconds(0.0) {};
+      
+      // records a chunk of work
+      void add( double secs, double n ) 
+      {
+          chunks.push_back( secs );
+          chunkops.push_back( n );
+          seconds += secs;
+          ops += n;
+      }
+      
+      // records an extra number
+      void extra( const string &xname, double xval )
+      {
+          xnames.push_back( xname );
+          xvals.push_back( xval );
+      }
+};
+  
+
+/*------------------------------------------------------------------------------------------*/
+/* returns the wall-clock time, in seconds */
+static double wallclock()
+{
+    struct timeval tv;
+    
+    gettimeofday( &tv, NULLPTR );
+    
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec)*1.0e-6;
+}
+
+/* returns the high-water mark of this process's memory use, in kB */
+static long maxrss()
+{
+    struct rusage usage;
+    
+    getrusage( RUSAGE_SELF, &usage );
+    
+    return usage.ru_maxrss;
+}
+
+/* returns the p-th percentile of a sorted vector */
+static double percentile( const vector<double> &sorted, double p )
+{
+    size_t i;
+    
+    if ( sorted.size() == 0 ) {
+       return 0.0;
+    }
+    i = static_cast<size_t>( p/100.0*( sorted.size() - 1 ) + 0.5 );
+    
+    return sorted[i];
+}
+
+/* writes one scenario's results as a JSON object */
+static void writeResult( std::ostream &os, const BenchResult &res, long rss )
+{
+    vector<double> lat;
+    size_t i;
+    
+    // per-operation latencies, in microseconds
+    for ( i=0; i<res.chunks.size(); i++ ) {
+        if ( res.chunkops[i] > 0 ) {
+           lat.push_back( res.chunks[i]/res.chunkops[i]*1.0e6 );
+        }
+    }
+    std::sort( lat.begin(), lat.end() );
+    
+    os << "    {" << endl;
+    os << "      \"name\": \"" << res.name << "\"," << endl;
+    os << "      \"unit\": \"" << res.unit << "\"," << endl;
+    os << "      \"operations\": " << res.ops << "," << endl;
+    os << "      \"seconds\": " << res.seconds << "," << endl;
+    os << "      \"throughput\": " << ( ( res.seconds > 0 ) ? res.ops/res.seconds : 0.0 ) << "," << endl;
+    os << "      \"latency_us\": { \"samples\": " << lat.size()
+       << ", \"min\": " << ( lat.size() > 0 ? lat[0] : 0.0 ) 
+       << ", \"p50\": " << percentile( lat, 50.0 ) 
+       << ", \"p90\": " << percentile( lat, 90.0 ) 
+       << ", \"p99\": " << percentile( lat, 99.0 ) 
+       << ", \"max\": " << ( lat.size() > 0 ? lat[lat.size()-1] : 0.0 ) << " }," << endl;
+    for ( i=0; i<res.xnames.size(); i++ ) {
+        os << "      \"" << res.xnames[i] << "\": " << res.xvals[i] << "," << endl;
+    }
+    os << "      \"maxrss_kb\": " << rss << endl;
+    os << "    }";
+}
+
+
+/*------------------------------------------------------------------------------------------*/
+/* scalar and array getData() from a gridded met source */
+static void bench_getdata( vector<BenchResult> &results, bool scalar, int n, int nsteps, int batch, unsigned int seed )
+{
+    MetGridSBRot metsrc( 1.0, 1.0, 40.0, 30.0 );
+    RandomSrc rnd( seed );
+    vector<real> lons(n), lats(n), zs(n), vals(n);
+    double start, tyme;
+    int i, j, k, m;
+    
+    for ( i=0; i<n; i++ ) {
+        lons[i] = rnd.uniform( 0.0, 360.0 );
+        lats[i] = rnd.uniform( -89.0, 89.0 );
+        zs[i] = rnd.uniform( 1.0, 40.0 );
+    }
+    
+    // one untimed pass, so that the met grids get loaded
+    tyme = 0.5;
+    metsrc.getData( "t", tyme, n, &(lons[0]), &(lats[0]), &(zs[0]), &(vals[0]) );
+
+    if ( scalar ) {
+       BenchResult res( "getdata_scalar", "points" );
+       for ( k=0; k<nsteps; k++ ) {
+           for ( i=0; i<n; i += batch ) {
+               m = std::min( batch, n - i );
+               start = wallclock();
+               for ( j=i; j<i+m; j++ ) {
+                   vals[j] = metsrc.getData( "t", tyme, lons[j], lats[j], zs[j] );
+               }
+               res.add( wallclock() - start, m );
+           }
+       }
+       results.push_back( res );
+    } else {
+       BenchResult res( "getdata_vector", "points" );
+       for ( k=0; k<nsteps; k++ ) {
+           for ( i=0; i<n; i += batch ) {
+               m = std::min( batch, n - i );
+               start = wallclock();
+               metsrc.getData( "t", tyme, m, &(lons[i]), &(lats[i]), &(zs[i]), &(vals[i]) );
+               res.add( wallclock() - start, m );
+           }
+       }
+       res.extra( "batch", batch );
+       results.push_back( res );
+    }
+
+}
+
+/* the array version of the bilinear horizontal interpolator, on a synthetic grid */
+static void bench_vinterp( vector<BenchResult> &results, int n, int nsteps, int batch, unsigned int seed )
+{
+    GridLatLonField3D grid;
+    BilinearHinterp hin;
+    LinearVinterp vin;
+    RandomSrc rnd( seed );
+    vector<real> glons, glats, gzs, gdata;
+    vector<real> lons(n), lats(n), zs(n), vals(n);
+    BenchResult res( "vinterp", "points" );
+    double start;
+    int i, j, k, m;
+    
+    for ( i=0; i<360; i++ ) {
+        glons.push_back( i*1.0 );
+    }
+    for ( j=0; j<181; j++ ) {
+        glats.push_back( j*1.0 - 90.0 );
+    }
+    for ( k=0; k<30; k++ ) {
+        gzs.push_back( k*2.0 );
+    }
+    gdata.reserve( glons.size()*glats.size()*gzs.size() );
+    for ( k=0; k<30; k++ ) {
+    for ( j=0; j<181; j++ ) {
+    for ( i=0; i<360; i++ ) {
+        gdata.push_back( 250.0 + 20.0*COS( glats[j]*RCONV )*SIN( 3.0*glons[i]*RCONV ) + gzs[k] );
+    }
+    }
+    }
+    grid.set_quantity( "t" );
+    grid.set_units( "K" );
+    grid.set_vertical( "alt" );
+    grid.set_vunits( "km" );
+    grid.set_time( 0.0, "0" );
+    grid.load( glons, glats, gzs, gdata );
+    
+    for ( i=0; i<n; i++ ) {
+        lons[i] = rnd.uniform( 0.0, 359.0 );
+        lats[i] = rnd.uniform( -89.0, 89.0 );
+        zs[i] = rnd.uniform( 1.0, 57.0 );
+    }
+    
+    for ( k=0; k<nsteps; k++ ) {
+        for ( i=0; i<n; i += batch ) {
+            m = std::min( batch, n - i );
+            start = wallclock();
+            hin.vinterp( m, &(lons[i]), &(lats[i]), &(zs[i]), &(vals[i]), grid, vin );
+            res.add( wallclock() - start, m );
+        }
+    }
+    res.extra( "batch", batch );
+    results.push_back( res );
+
+}
+
+/* RK4 time steps of an array of parcels */
+static void bench_integ( vector<BenchResult> &results, int n, int nsteps, unsigned int seed )
+{
+    MetSBRot metsrc( 40.0, 30.0 );
+    Earth nav;
+    IntegRK4 integ;
+    RandomSrc rnd( seed );
+    vector<real> lons(n), lats(n), zs(n);
+    vector<int> flags(n);
+    BenchResult res( "integ_rk4", "parcel-steps" );
+    double tyme;
+    double start;
+    int i, k;
+    
+    for ( i=0; i<n; i++ ) {
+        lons[i] = rnd.uniform( 0.0, 360.0 );
+        lats[i] = rnd.uniform( -89.0, 89.0 );
+        zs[i] = rnd.uniform( 1.0, 40.0 );
+        flags[i] = 0;
+    }
+    
+    tyme = 0.0;
+    for ( k=0; k<nsteps; k++ ) {
+        start = wallclock();
+        integ.go( n, &(lons[0]), &(lats[0]), &(zs[0]), &(flags[0]), tyme, &metsrc, &nav, 0.01 );
+        res.add( wallclock() - start, n );
+    }
+    results.push_back( res );
+
+}
+
+/* Swarm advance() steps of scattered parcels, with and without space-filling-curve ordering */
+static int bench_reorder( vector<BenchResult> &results, int n, int nsteps, unsigned int seed )
+{
+    MetGridSBRot metsrc( 1.0, 1.0, 40.0, 30.0 );
+    RandomSrc rnd( seed );
+    Parcel p, q;
+    Swarm *swm[2];
+    BenchResult plain( "swarm_reorder_off", "parcel-steps" );
+    BenchResult sorted( "swarm_reorder_on", "parcel-steps" );
+    BenchResult *res;
+    double start;
+    double dt;
+    real lon, lat, lon2, lat2;
+    real diff;
+    int status = 0;
+    int i, k;
+    
+    p.setMet( metsrc );
+    
+    swm[0] = new Swarm( p, n );
+    swm[1] = new Swarm( p, n );
+    
+    // the same randomly-scattered parcels in both Swarms
+    for ( k=0; k<n; k++ ) {
+        p.setPos( rnd.uniform( 0.0, 360.0 ), rnd.uniform( -80.0, 80.0 ) );
+        p.setZ( rnd.uniform( 1.0, 40.0 ) );
+        swm[0]->set( k, p );
+        swm[1]->set( k, p );
+    }
+    swm[1]->setReorder( 1 );
+    
+    dt = 0.01;
+    
+    for ( i=0; i<2; i++ ) {
+        res = ( i == 0 ) ? &plain : &sorted;
+        
+        // one untimed step, so that the met grids get loaded
+        swm[i]->advance( dt );
+        
+        for ( k=0; k<nsteps; k++ ) {
+            start = wallclock();
+            swm[i]->advance( dt );
+            res->add( wallclock() - start, n );
+        }
+    }
+    
+    // sorting must not change the answers, nor the order of the parcels
+    diff = 0.0;
+    for ( k=0; k<n; k++ ) {
+        p = swm[0]->get( k );
+        q = swm[1]->get( k );
+        p.getPos( &lon, &lat );
+        q.getPos( &lon2, &lat2 );
+        diff = std::max( diff, std::max( static_cast<real>(ABS( lon - lon2 )), static_cast<real>(ABS( lat - lat2 )) ) );
+    }
+    if ( diff > 0.0 ) {
+       cerr << "swarm_reorder: the sorted parcels differ by up to " << diff << " degrees" << endl;
+       status = 1;
+    }
+    
+    if ( sorted.seconds > 0 ) {
+       sorted.extra( "speedup_vs_unsorted", plain.seconds/sorted.seconds );
+    }
+    sorted.extra( "max_diff", diff );
+    results.push_back( plain );
+    results.push_back( sorted );
+    
+    delete swm[1];
+    delete swm[0];
+    
+    return status;
+}
+
+/* returns the largest difference between two arrays, 
+   ignoring places where both are NaN, and counting longitudes modulo 360
+*/
+static real maxdiff( const vector<real> &a, const vector<real> &b, bool islon=false )
+{
+    real d;
+    real result = 0.0;
+    size_t i;
+    
+    for ( i=0; i<a.size(); i++ ) {
+        if ( ! FINITE(a[i]) && ! FINITE(b[i]) ) {
+           continue;
+        }
+        d = ABS( a[i] - b[i] );
+        if ( islon && d > 180.0 ) {
+           d = ABS( d - 360.0 );
+        }
+        if ( ! ( d <= result ) ) {
+           result = d;
+        }
+    }
+    
+    return result;
+}
+
+/* the multi-point Earth navigation methods, in the scalar code and in each batch mode */
+static int bench_nav( vector<BenchResult> &results, int n, int nsteps, unsigned int seed )
+{
+    Earth e;
+    RandomSrc rnd( seed );
+    vector<real> lons0(n), lats0(n), lons2(n), lats2(n), dxs(n), dys(n), us0(n), vs0(n);
+    // the results from each mode; [0] holds the scalar results, for comparison
+    vector<real> lons[2], lats[2], u[2], v[2], d[2], b[2];
+    // the largest acceptable differences from the scalar code (in degrees of arc), for each batch mode.
+    // (In single precision, the scalar code itself is good
+    //  to only about 0.01 degrees near the poles, where ACOS is ill-conditioned.)
+    real tol[3];
+    const char *names[4] = { "deltaxy", "vRelocate", "distance", "bearing" };
+    real tols[4];
+    real diff;
+    double start;
+    int status = 0;
+    int i, k, mode, meth, w;
+    
+    tol[0] = 0.0;
+    tol[1] = ( sizeof(real) > 4 ) ? 1.0e-10 : 1.0e-3;
+    tol[2] = ( sizeof(real) > 4 ) ? 1.0e-9 : 1.0e-2;
+    
+    for ( i=0; i<n; i++ ) {
+        lons0[i] = rnd.uniform( -180.0, 180.0 );
+        lats0[i] = rnd.uniform( -90.0, 90.0 );
+        dxs[i] = rnd.uniform( -500.0, 500.0 );
+        dys[i] = rnd.uniform( -500.0, 500.0 );
+        us0[i] = rnd.uniform( -50.0, 50.0 );
+        vs0[i] = rnd.uniform( -50.0, 50.0 );
+    }
+    // some special cases: a bad value, no motion, a pole, near a pole, and a path into the pole
+    if ( n >= 5 ) {
+       dxs[0] = RNAN("");
+       dxs[1] = 0.0;
+       dys[1] = 0.0;
+       lats0[2] = -90.0;
+       lats0[3] = 89.999;
+       lats0[4] = 89.0;
+       lons0[4] = 10.0;
+       dxs[4] = 0.0;
+       dys[4] = 1.0*RCONV*e.radius();
+    }
+    // the displaced points serve as the second points for distance, bearing, and vRelocate
+    lons2 = lons0;
+    lats2 = lats0;
+    e.deltaxy( n, &(lons2[0]), &(lats2[0]), &(dxs[0]), &(dys[0]), 1.0, -1 );
+    
+    for ( w=0; w<2; w++ ) {
+        lons[w].resize( n );
+        lats[w].resize( n );
+        u[w].resize( n );
+        v[w].resize( n );
+        d[w].resize( n );
+        b[w].resize( n );
+    }
+    
+    for ( mode=0; mode<=2; mode++ ) {
+        e.vectorized( mode );
+        w = ( mode == 0 ) ? 0 : 1;
+        
+        for ( meth=0; meth<4; meth++ ) {
+            std::ostringstream name;
+            name << "nav_" << names[meth] << "_mode" << mode;
+            BenchResult res( name.str(), "points" );
+            
+            for ( k=0; k<nsteps; k++ ) {
+                switch ( meth ) {
+                case 0:
+                   lons[w] = lons0;
+                   lats[w] = lats0;
+                   start = wallclock();
+                   e.deltaxy( n, &(lons[w][0]), &(lats[w][0]), &(dxs[0]), &(dys[0]), 1.0, -1 );
+                   break;
+                case 1:
+                   u[w] = us0;
+                   v[w] = vs0;
+                   start = wallclock();
+                   e.vRelocate( n, &(lons2[0]), &(lats2[0]), &(lons0[0]), &(lats0[0]), &(u[w][0]), &(v[w][0]), -1 );
+                   break;
+                case 2:
+                   start = wallclock();
+                   e.distance( n, &(lons0[0]), &(lats0[0]), &(lons2[0]), &(lats2[0]), &(d[w][0]) );
+                   break;
+                default:
+                   start = wallclock();
+                   e.bearing( n, &(lons0[0]), &(lats0[0]), &(lons2[0]), &(lats2[0]), &(b[w][0]) );
+                   break;
+                }
+                res.add( wallclock() - start, n );
+            }
+            
+            if ( mode > 0 ) {
+               switch ( meth ) {
+               case 0:
+                  diff = std::max( maxdiff( lons[1], lons[0], true ), maxdiff( lats[1], lats[0] ) );
+                  tols[meth] = tol[mode];
+                  break;
+               case 1:
+                  diff = std::max( maxdiff( u[1], u[0] ), maxdiff( v[1], v[0] ) );
+                  tols[meth] = tol[mode]*100.0;
+                  break;
+               case 2:
+                  diff = maxdiff( d[1], d[0] );
+                  tols[meth] = tol[mode]*RCONV*e.radius();
+                  break;
+               default:
+                  // the bearing between nearly coincident points is ill-conditioned, 
+                  // so those are left out of the comparison
+                  for ( i=0; i<n; i++ ) {
+                      if ( d[0][i] < 10.0 ) {
+                         b[1][i] = b[0][i];
+                      }
+                  }
+                  diff = maxdiff( b[1], b[0], true );
+                  tols[meth] = tol[mode];
+                  break;
+               }
+               res.extra( "max_diff", diff );
+               if ( ! ( diff <= tols[meth] ) ) {
+                  cerr << names[meth] << " mode " << mode << " differs from the scalar code by " << diff << endl;
+                  status = 1;
+               }
+            }
+            
+            results.push_back( res );
+        }
+    }
+    
+    return status;
+}
+
+/* Swarm advance() steps on all processors, and optionally netcdf output */
+static void bench_swarm( vector<BenchResult> &results, ProcessGrp *pgrp, int mcsr, bool do_netcdf, const string &dir
+                       , int n, int nsteps, unsigned int seed )
+{
+    MetGridSBRot metsrc( 1.0, 1.0, 40.0, 30.0 );
+    RandomSrc rnd( seed );
+    Parcel p;
+    Swarm *swm;
+    BenchResult res( "swarm_advance", "parcel-steps" );
+    double start;
+    double dt;
+    int k;
+    
+    metsrc.setPgroup( pgrp );
+    p.setMet( metsrc );
+    
+    swm = new Swarm( p, pgrp, n, mcsr );
+    
+    // only the root processor's values are used by set()
+    for ( k=0; k<n; k++ ) {
+        p.setPos( rnd.uniform( 0.0, 360.0 ), rnd.uniform( -80.0, 80.0 ) );
+        p.setZ( rnd.uniform( 1.0, 40.0 ) );
+        swm->set( k, p );
+    }
+    
+    dt = 0.01;
+    
+    // one untimed step, so that the met grids get loaded
+    swm->advance( dt );
+    swm->sync();
+    
+    for ( k=0; k<nsteps; k++ ) {
+        start = wallclock();
+        swm->advance( dt );
+        swm->sync();
+        res.add( wallclock() - start, n );
+    }
+    res.extra( "processors", pgrp->size() );
+    results.push_back( res );
+    
+#ifdef USE_NETCDF
+    if ( do_netcdf ) {
+       NetcdfOut out;
+       BenchResult nres( "netcdf_out", "parcel-records" );
+       
+       out.filename( dir + "/gt_bench_out.nc4" );
+       out.init( &p, swm->size() );
+       out.open();
+       for ( k=0; k<nsteps; k++ ) {
+           swm->advance( dt );
+           start = wallclock();
+           out.apply( *swm );
+           swm->sync();
+           nres.add( wallclock() - start, n );
+       }
+       out.close();
+       results.push_back( nres );
+    }
+#endif
+
+    delete swm;
+
+}
+
+/* reloading met snapshots from the disk cache */
+static void bench_diskcache( vector<BenchResult> &results, const string &dir, int nsteps )
+{
+    MetGridSBRot *metsrc;
+    BenchResult res( "disk_cache", "snapshots" );
+    BenchResult gen( "disk_cache_generate", "snapshots" );
+    double start;
+    int k;
+    
+    // Generate and cache one snapshot per (integer) day. A fresh met source is used
+    // for each snapshot, so that its memory cache is never used.
+    for ( k=0; k<nsteps; k++ ) {
+        metsrc = new MetGridSBRot( 1.0, 1.0, 40.0, 30.0 );
+        metsrc->setCacheDir( dir );
+        start = wallclock();
+        metsrc->getData( "t", static_cast<double>(k), 10.0, 20.0, 10.0 );
+        gen.add( wallclock() - start, 1 );
+        delete metsrc;
+    }
+    
+    // now reload them from the disk cache
+    for ( k=0; k<nsteps; k++ ) {
+        metsrc = new MetGridSBRot( 1.0, 1.0, 40.0, 30.0 );
+        metsrc->setCacheDir( dir );
+        start = wallclock();
+        metsrc->getData( "t", static_cast<double>(k), 10.0, 20.0, 10.0 );
+        res.add( wallclock() - start, 1 );
+        delete metsrc;
+    }
+    
+    if ( res.seconds > 0 ) {
+       res.extra( "speedup_vs_generate", gen.seconds/res.seconds );
+    }
+    results.push_back( gen );
+    results.push_back( res );
+
+}
+
+
+/*------------------------------------------------------------------------------------------*/
+/* This function sets up configuration parameters and gathers settings
+   from configuration files and command line options
+*/
+int getconfig(int argc, char * const argv[], Configuration& conf ) 
+{
+    // flag that indicates whether anything went wrong
+    int status;
+    // print help text and quit?
+    bool doHelp;
+    // usage help string
+    std::string usage;
+    
+    
+    usage = "gt_bench ";
+    
+    status = 0;
+
+    usage +=  "[ --help|-h ]";
+    conf.add("help"      , cBoolean, "N"                , "h", 0, "print help" );
+
+    usage +=  " [--verbose] ";
+    conf.add("verbose"   , cBoolean, "N"                , "" , 0, "print detailed progress messages" );
+
+    usage +=  " [--parcels N] ";
+    conf.add("parcels"   , cInt,    "100000"            , "n", 0, "the number of parcels or points in each workload" );
+
+    usage +=  " [--steps N] ";
+    conf.add("steps"     , cInt,    "10"                , "", 0, "the number of repetitions of each scenario" );
+
+    usage +=  " [--batch N] ";
+    conf.add("batch"     , cInt,    "1000"              , "", 0, "the number of points in each array getData() or vinterp() call" );
+
+    usage +=  " [--seed N] ";
+    conf.add("seed"      , cInt,    "1234"              , "", 0, "the random number seed for the workloads" );
+
+    usage +=  " [--scenarios list] ";
+    conf.add("scenarios" , cString, "all"               , "", 0, "comma-separated list of scenarios to run, or \"all\"" );
+
+    usage +=  " [--output file] ";
+    conf.add("output"    , cString, "-"                 , "o", 0, "the JSON output file (\"-\" for stdout)" );
+
+    usage +=  " [--cachedir dir] ";
+    conf.add("cachedir"  , cString, "gt_bench_scratch"  , "", 0, "scratch directory for the disk cache and output scenarios" );
+
+    usage +=  " [--mpi] ";
+    conf.add("mpi"       , cBoolean, "N"                , "" , 0, "use OpenMPI multiprocessing" );
+
+    usage +=  " [--met_server_ratio r] ";
+    conf.add("met_server_ratio", cInt, "0"              , "", 0, "number of tracing processors per met data server processor" );
+
+    conf.load(argc,argv);
+    
+    conf.fetchParam("help", doHelp);
+    if ( doHelp ) {
+       conf.help(usage,"");
+       exit(0);
+    }
+    
+    if ( conf.get("parcels") == "" || atoi( conf.get("parcels").c_str() ) <= 0 
+      || atoi( conf.get("steps").c_str() ) <= 0 || atoi( conf.get("batch").c_str() ) <= 0 ) {
+       cerr << "The number of parcels, steps, and batch size must all be positive." << endl;
+       status = 1;
+    }
+        
+    if ( status != 0 ) {   
+       cerr << "Bad configuration." << endl;
+       conf.help(usage,"");
+    }
+    
+    return status;
+}
+
+/* returns true if the named scenario is to be run */
+static bool wanted( const string &list, const string &name )
+{
+    string item;
+    std::istringstream items( list );
+    
+    if ( list == "all" ) {
+       return true;
+    }
+    while ( std::getline( items, item, ',' ) ) {
+       if ( item == name ) {
+          return true;
+       }
+    }
+    
+    return false;
+}
+
+  
+int main( int argc, char * argv[] ) 
+{
+    Configuration config;
+    bool verbose;
+    bool use_mpi;
+    int mcsr;
+    int n;
+    int nsteps;
+    int batch;
+    int seed;
+    string scenarios;
+    string output;
+    string dir;
+    ProcessGrp *pgrp;
+    vector<BenchResult> results;
+    vector<long> rss;
+    size_t i, nr;
+    std::ostream *os;
+    std::ofstream *ofs;
+    // non-zero if any scenario's results failed their consistency checks
+    int status = 0;
+    
+    if ( getconfig( argc, argv, config ) != 0 ) {
+       exit(1);
+    }
+    config.fetchParam( "verbose", verbose );
+    config.fetchParam( "mpi", use_mpi );
+    config.fetchParam( "met_server_ratio", mcsr );
+    config.fetchParam( "parcels", n );
+    config.fetchParam( "steps", nsteps );
+    config.fetchParam( "batch", batch );
+    config.fetchParam( "seed", seed );
+    config.fetchParam( "scenarios", scenarios );
+    config.fetchParam( "output", output );
+    config.fetchParam( "cachedir", dir );
+    
+#ifdef USE_MPI
+    if ( use_mpi ) {
+       pgrp = new MPIGrp(argc, argv);
+    } else {
+#else
+    if ( 1 ) {
+#endif
+       pgrp = new SerialGrp();
+    }
+    
+    // the scratch directory
+    if ( pgrp->id() == 0 ) {
+       if ( system( ( "/bin/mkdir -p " + dir ).c_str() ) != 0 ) {
+          cerr << "Could not create scratch directory " << dir << endl;
+       }
+    }
+    pgrp->sync();
+    
+    // The single-process scenarios run on the root processor only
+    if ( pgrp->id() == 0 ) {
+       if ( wanted( scenarios, "getdata_scalar" ) ) {
+          if ( verbose ) {
+             cerr << "running getdata_scalar" << endl;
+          }
+          bench_getdata( results, true, n, nsteps, batch, seed );
+       }
+       if ( wanted( scenarios, "getdata_vector" ) ) {
+          if ( verbose ) {
+             cerr << "running getdata_vector" << endl;
+          }
+          bench_getdata( results, false, n, nsteps, batch, seed );
+       }
+       if ( wanted( scenarios, "vinterp" ) ) {
+          if ( verbose ) {
+             cerr << "running vinterp" << endl;
+          }
+          bench_vinterp( results, n, nsteps, batch, seed );
+       }
+       if ( wanted( scenarios, "integ_rk4" ) ) {
+          if ( verbose ) {
+             cerr << "running integ_rk4" << endl;
+          }
+          bench_integ( results, n, nsteps, seed );
+       }
+       if ( wanted( scenarios, "swarm_reorder" ) ) {
+          if ( verbose ) {
+             cerr << "running swarm_reorder" << endl;
+          }
+          status |= bench_reorder( results, n, nsteps, seed );
+       }
+       if ( wanted( scenarios, "earth_nav" ) ) {
+          if ( verbose ) {
+             cerr << "running earth_nav" << endl;
+          }
+          status |= bench_nav( results, n, nsteps, seed );
+       }
+       if ( wanted( scenarios, "disk_cache" ) ) {
+          if ( verbose ) {
+             cerr << "running disk_cache" << endl;
+          }
+          bench_diskcache( results, dir, nsteps );
+       }
+       // (the memory high-water mark only ever increases, so 
+       //  we record it for each scenario as we go)
+       for ( i=rss.size(); i<results.size(); i++ ) {
+           rss.push_back( maxrss() );
+       }
+    }
+    
+    if ( wanted( scenarios, "swarm_advance" ) || wanted( scenarios, "netcdf_out" ) ) {
+       if ( verbose && pgrp->id() == 0 ) {
+          cerr << "running swarm_advance on " << pgrp->size() << " processors" << endl;
+       }
+       pgrp->sync();
+       nr = results.size();
+       bench_swarm( results, pgrp, mcsr, wanted( scenarios, "netcdf_out" ), dir, n, nsteps, seed );
+       if ( ! wanted( scenarios, "swarm_advance" ) ) {
+          results.erase( results.begin() + nr );
+       }
+       for ( i=rss.size(); i<results.size(); i++ ) {
+           rss.push_back( maxrss() );
+       }
+    }
+    
+    pgrp->sync();
+    
+    if ( pgrp->id() == 0 ) {
+       
+       if ( output == "-" ) {
+          os = &std::cout;
+          ofs = NULLPTR;
+       } else {
+          ofs = new std::ofstream( output.c_str() );
+          os = ofs;
+       }
+       
+       *os << std::setprecision(8);
+       *os << "{" << endl;
+       *os << "  \"program\": \"gt_bench\"," << endl;
+       *os << "  \"real_bytes\": " << sizeof(real) << "," << endl;
+       *os << "  \"processors\": " << pgrp->size() << "," << endl;
+       *os << "  \"parcels\": " << n << "," << endl;
+       *os << "  \"steps\": " << nsteps << "," << endl;
+       *os << "  \"batch\": " << batch << "," << endl;
+       *os << "  \"seed\": " << seed << "," << endl;
+       *os << "  \"results\": [" << endl;
+       for ( i=0; i<results.size(); i++ ) {
+           writeResult( *os, results[i], rss[i] );
+           if ( i < results.size() - 1 ) {
+              *os << ",";
+           }
+           *os << endl;
+       }
+       *os << "  ]" << endl;
+       *os << "}" << endl;
+       
+       if ( ofs != NULLPTR ) {
+          ofs->close();
+          delete ofs;
+       }
+       
+       // clean up the scratch space
+       if ( system( ( "/bin/rm -rf " + dir ).c_str() ) != 0 ) {
+          cerr << "Could not remove scratch directory " << dir << endl;
+       }
+    }
+    
+    pgrp->shutdown();
+
+    exit(status);
+}
@@ -0,0 +1,224 @@
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
+/*!
+
+\page  gt_met_cached gt_met_cached: Share meteorological data among model runs on one host
+
+
+The gt_met_cached program is a small local server that lets independent
+trajectory model runs on the same machine share the meteorological data
+fields that they read and derive. Each field that one run obtains
+for itself is handed to the server, which keeps it in POSIX shared memory.
+Other runs that need the same field then map it read-only from shared memory 
+instead of reading it from the data source (or the disk cache) and 
+deriving it all over again. Derived quantities such as potential temperature
+are shared along with the fields that are read directly.
+
+The server and its clients talk through a Unix-domain socket; no network is used.
+A model run uses the server if it is given the same socket name (for example, with
+the \c metcache option of gtmodel_s01 or gtmodel_s02). The runs that share a server must use
+the same meteorological data source settings, just as they would if they shared a disk cache.
+A model run whose server is not running simply does without it.
+
+This program is built only if gigatraj was configured with the --enable-shmcache option.
+
+The calling sequence is:
+\code
+gt_met_cached [ --help|-h ] [ --verbose ] [--debug level]  [ --config|-c configFile ] [ --rc|-r resourcefile ] \\
+               [ --socket|-s socketname ] [ --budget|-m megabytes ] [ --background ] [ --stats ] [ --stop ]
+\endcode
+              
+The command-line options are:
+
+ \li \c help : prints out a description of options and then stops
+ \li \c verbose : prints out messages to let the user know what the server is doing
+ \li \c debug : prints out copious technical debugging messages
+ \li \c config : specifies the name of a configation file. The default is "gt_met_cached.config"
+ \li \c rc : specifies the name of a resource file. The default is "$HOME/.gigatrajrc"
+ \li \c socket : the name of the socket through which clients reach the server. The default is "/tmp/gigatraj_metcache".
+ \li \c budget : the maximum amount of data, in megabytes, that the server is to hold.
+                 When this is exceeded, the least-recently-used fields are dropped. The default is 0, meaning no limit.
+ \li \c background : run the server in the background, detached from the terminal
+ \li \c stats : instead of starting a server, print the statistics of the server that is already running
+ \li \c stop : instead of starting a server, tell the server that is already running to shut down
+
+The server runs until it is told to stop (with the \c stop option), or until
+it receives a SIGINT or SIGTERM signal. When it stops, it removes all of its 
+shared memory segments.
+
+*/
+
+
+#include <iostream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Configuration.hh"
+#include "gigatraj/ShmCache.hh"
+
+using namespace gigatraj;
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+
+/*------------------------------------------------------------------------------------------*/
+int getconfig(int argc, char * const argv[], Configuration& conf ) 
+{
+    int status;
+    // argv index
+    int aidx;
+    // print help text and quit?
+    bool doHelp;
+    // usage help string
+    std::string usage;
+    
+    usage = "gt_met_cached ";
+    
+    status = 0;
+
+    usage += " [--help|-h] ";
+    conf.add("help"      , cBoolean, "N"                , "h", 0, "print help and quit" );
+
+    usage += " [--rc|-r resourcefile] ";
+    conf.add("rc", cConfig, string(getenv("HOME")) + "/.gigatrajrc", "r" );
+    usage += " [--config|-c configfile] ";
+    conf.add("config", cConfig, "gt_met_cached.config", "c" );
+
+    // register these parameters with the configuration object
+    usage += " [--verbose] ";
+    conf.add("verbose"   , cBoolean, "N"                , "" , 0, "print progress messages" );
+    usage += " [--debug level] ";
+    conf.add("debug"     , cInt    , "0"                , "" , 0, "print debugging messages" );
+    usage += " [--socket|-s socketname] ";
+    conf.add("socket"    , cString , "/tmp/gigatraj_metcache", "s", 0, "the server's socket" );
+    usage += " [--budget|-m megabytes] ";
+    conf.add("budget"    , cInt    , "0"                , "m", 0, "maximum amount of data to hold, in MB (0=no limit)" );
+    usage += " [--background] ";
+    conf.add("background", cBoolean, "N"                , "" , 0, "run in the background" );
+    usage += " [--stats] ";
+    conf.add("stats"     , cBoolean, "N"                , "" , 0, "print the running server's statistics and quit" );
+    usage += " [--stop] ";
+    conf.add("stop"      , cBoolean, "N"                , "" , 0, "tell the running server to shut down and quit" );
+
+    // load the config values from any config files, as well as the command line
+    aidx = conf.load(argc,argv);
+    
+    conf.fetchParam("help", doHelp);
+    if ( doHelp ) {
+       conf.help(usage,"");
+       exit(0);
+    }
+    
+    if ( conf.get("socket") == "" || conf.str2int( conf.get("budget") ) < 0 ) {
+       status = 1;
+    }
+
+    // Any errors?  Print out a usage message.
+    if ( status != 0 ) {   
+       cerr << "Bad configuration." << endl;
+       conf.help(usage,"");
+    }
+
+    return status;
+}
+
+
+/*------------------------------------------------------------------------------------------*/
+
+int main( int argc, char * const argv[] ) 
+{
+    // return status. 0 = all went well.
+    int status;
+    // configuration object
+    Configuration config;
+    // flag for printing information about what the program is doing
+    bool verbose;
+    // debugging level
+    int debug;
+    // the socket name
+    string sockname;
+    // the data budget, in megabytes
+    int budget;
+    // run in the background?
+    bool background;
+    // only print statistics?
+    bool dostats;
+    // only stop the server?
+    bool dostop;
+    // the cache 
+    ShmCache* cache;
+    // server statistics
+    long items, hits, misses;
+    size_t bytes;
+    
+    status = getconfig( argc, argv, config );
+    if ( status != 0 ) {
+       exit(status);
+    }
+    config.fetchParam("verbose", verbose);
+    config.fetchParam("background", background);
+    config.fetchParam("stats", dostats);
+    config.fetchParam("stop", dostop);
+    debug = config.str2int( config.get("debug") );
+    budget = config.str2int( config.get("budget") );
+    sockname = config.get("socket");
+    
+    cache = new ShmCache( sockname );
+    cache->dbug = debug;
+    if ( verbose && cache->dbug == 0 ) {
+       cache->dbug = 1;
+    }
+    
+    if ( dostats || dostop ) {
+       if ( dostats ) {
+          if ( cache->stats( items, bytes, hits, misses ) ) {
+             cout << sockname << ": " << items << " fields, " << bytes << " bytes, " 
+                  << hits << " hits, " << misses << " misses" << endl;
+          } else {
+             cerr << "No server is running on " << sockname << endl;
+             status = 1;
+          }
+       }
+       if ( dostop ) {
+          if ( ! cache->shutdown() ) {
+             cerr << "No server is running on " << sockname << endl;
+             status = 1;
+          }
+       }
+       delete cache;
+       exit(status);
+    }
+    
+    if ( background ) {
+       // detach from the terminal
+       if ( fork() != 0 ) {
+          exit(0);
+       }
+       setsid();
+    }
+    
+    try {
+       cache->serve( static_cast<size_t>(budget)*1024*1024 );
+    } catch ( ShmCache::badSocket ) {
+       cerr << "Cannot serve on " << sockname << " (is another server already using it?)" << endl;
+       status = 1;
+    }
+    
+    delete cache;
+    
+    exit(status);
+    
+}
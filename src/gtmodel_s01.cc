@@ -28,7 +28,7 @@ multiprocessing, but it can use cached data, if a cache directory is defined.
 The calling sequence is:
 \code
 gtmodel_s01 [ --help|-h ] [ --list ] [ --verbose ] [--debug level] [ --config|-c configFile ] [ --rc|-r resourcefile ] \\
-               [--cachedir|-d directory ] [ --source|-s metsource ] \\
+               [--cachedir|-d directory ] [ --metcache socketname ] [ --source|-s metsource ] \\
                [ --begdate|-b yyyy-mm-ddThh:mm:ss ] [ --enddate|-e yyyy-mm-ddThh:mm:ss ] --zerodate|-z yymmddThh:mm:ss\\
                [ --tstep|-t timeDelta ] [ --frequency|-f outputfreq ] \\
                [ --vertical|-v verticalCoord ] [ --iso|-i ] [ --parcelvertical pVerticalCoord ] \\
@@ -66,6 +66,9 @@ begdate=2007-10-23T13
           source, while a configuration file would contain settings that are specific to a single tool
           or even a single run of a tool. 
  \li \c cachedir : specifies a directory into which the cached data files are to be placed. If omitted, then no disk caching is done.
+ \li \c metcache : if gigatraj was built with the --enable-shmcache option, the socket name of a 
+                   local met cache server (see gt_met_cached) through which meteorological
+                   fields are shared with other model runs on the same host. If omitted, then no such sharing is done.
  \li \c  source : specifies the meteorological data source. This may be one of:
                - SBROT = solid-body earth rotation, a test data set only
                - MERRA = the NASA Goddard GMAO MERRA reanalysis
@@ -140,7 +143,9 @@ begdate=2007-10-23T13
                      for the integrator. A positive value's effect depends on the integrator
                      being used.
 
-  \li \c integrator  specifies the name of the integrator to be used. (e.g., "RK4", "RK4a").
+  \li \c integrator  specifies the name of the integrator to be used. (e.g., "RK4", "RK4a", "RK4c", "RK32").
+                     ("RK4c" steps parcels as Earth-centred unit vectors, with no polar special cases.
+                     "RK32" does the same, but substeps each parcel adaptively within each time step.)
                      (The default value, RK4a, is usually the best.)
   
   \li \c metoptions ; specifies a string of ";"-separated options for the met data source.
@@ -177,6 +182,17 @@ begdate=2007-10-23T13
 
    \li \c keep_save  Ordinarily the save file (if used) is deleted after a successful run. Use this option to keep it.
    
+   \li \c instrument_steps  If gigatraj was configured with --enable-instrument, a summary of
+                    the time spent in various parts of the model is printed at the end of the run.
+                    If this is set to a positive number N, a summary is also printed
+                    every N time steps. (This option is only available if instrumentation is enabled.)
+   
+   \li \c trace_file  If gigatraj was configured with --enable-instrument, the requests and responses
+                    passed between the met processors and their clients are recorded and written to
+                    this file at the end of the run, as a Chrome-trace JSON timeline that can be
+                    loaded into chrome://tracing or the Perfetto UI. (This option is only available
+                    if instrumentation is enabled.)
+   
 Note that the begdate and enddate settings are mandatory: they must be defined somewhere, usually in the command line options.
 
 Settings are applied in this order: first, built-in default values are loaded. These defaults are:
@@ -222,12 +238,16 @@ Finally, settings from the command-line options are loaded, overwriting any prev
 
 #include "gigatraj/IntegRK4a.hh"
 #include "gigatraj/IntegRK4.hh"
+#include "gigatraj/IntegRK4Cart.hh"
+#include "gigatraj/IntegRK32.hh"
 
 #include "gigatraj/Parcel.hh"
 #include "gigatraj/Flock.hh"
 #include "gigatraj/trace.hh"
 #include "gigatraj/PGenFile.hh"
 #include "gigatraj/ChangeVertical.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/EventTrace.hh"
 
 #include "gigatraj/StreamPrint.hh"
 #include "gigatraj/StreamDump.hh"
@@ -326,6 +346,10 @@ int getconfig(int argc, char * const argv[], Configuration& conf, MetSelector &m
     conf.add("parcelvertical"  , cString , ""           , "",  0, "parcel input/output vertical coordinate" );
     usage +=  " [--cachedir|-d dir]";
     conf.add("cachedir"  , cString , ""                 , "d", 0, "met data cache directory" );
+#ifdef USE_SHMCACHE
+    usage +=  " [--metcache socketname]";
+    conf.add("metcache"  , cString , ""                 , "" , 0, "socket of a local met cache server to share met data through" );
+#endif
     usage +=  " [--frequency|-f outputFreq]";
     conf.add("frequency" , cFloat  , "1.0"              , "f", 0, "output frequency, in hours" );
     usage +=  " [--tstep|-t timedelta ]";
@@ -379,6 +403,12 @@ int getconfig(int argc, char * const argv[], Configuration& conf, MetSelector &m
     conf.add("save_steps", cInt, "500"          , "" , 0, "number of time steps bwtween which model state is to be saved" );
     usage +=  " [--keep_save] ";
     conf.add("keep_save"   , cBoolean, "N"                , "" , 0, "keep save_file after a successful run" );
+#ifdef USE_INSTRUMENT
+    usage +=  " [--instrument_steps nsteps ] ";
+    usage +=  " [--trace_file filename ] ";
+    conf.add("instrument_steps", cInt, "0"          , "" , 0, "number of time steps between instrumentation summaries (0=only at the end)" );
+    conf.add("trace_file", cString, ""             , "" , 0, "file to which a timeline of met server traffic is written" );
+#endif
 
     // Load the config setting values from any config files, as well as the command line
     // The defaults are loaded first
@@ -642,6 +672,8 @@ int main( int argc, char * argv[] )
     string zerodate;
     // the meteorological data cache directory 
     string cachedir;
+    // the socket of a shared met cache server
+    string metcache;
     // the output frequency, in seconds
     float outfreq;
     // flag to indicate whether we are to trace on isosurfaces of the vertical coordinate
@@ -678,6 +710,11 @@ int main( int argc, char * argv[] )
     int sinterval;
     // save-count
     int scount;
+    // instrumentation summary interval and count
+    int iinterval;
+    int icount;
+    // met server traffic timeline file
+    std::string trace_file;
     // we dump parcels states every accumul_time interval    
     double accumul_time;
 #ifdef USE_NETCDF
@@ -792,6 +829,10 @@ int main( int argc, char * argv[] )
        enddate = config.get("enddate");
        zerodate = config.get("zerodate");
        cachedir = config.get("cachedir");
+       metcache = "";
+#ifdef USE_SHMCACHE
+       metcache = config.get("metcache");
+#endif
        config.fetchParam("frequency", outfreq);
        config.fetchParam("iso", isosfc);
        config.fetchParam("metbasehr", tbase);
@@ -815,6 +856,11 @@ int main( int argc, char * argv[] )
        config.fetchParam("restore_from", restore_file );
        sinterval = config.str2int( config.get("save_steps") );
        config.fetchParam("keep_save", keep_save);
+       iinterval = 0;
+#ifdef USE_INSTRUMENT
+       config.fetchParam("instrument_steps", iinterval );
+       config.fetchParam("trace_file", trace_file );
+#endif
 #ifdef USE_NETCDF
        config.fetchParam("input_netcdf", inNetcdf );
        outNetcdfFile = config.get("netcdf_out");
@@ -998,6 +1044,10 @@ int main( int argc, char * argv[] )
        filepath.makedir();
        // Tell the data source to use disk caching
        metsource->setCacheDir( cachedir );
+       // share met data with other runs on this host?
+       if ( metcache != "" ) {
+          metsource->setSharedCache( metcache );
+       }
        
        // thin out the horizontal grid?
        // set any horizontal thinning (not all sources use this)
@@ -1073,6 +1123,12 @@ int main( int argc, char * argv[] )
        } else if ( integratorName == "RK4a" ) {
           integrator = new IntegRK4a;
           pcl.integrator( integrator );
+       } else if ( integratorName == "RK4c" ) {
+          integrator = new IntegRK4Cart;
+          pcl.integrator( integrator );
+       } else if ( integratorName == "RK32" ) {
+          integrator = new IntegRK32;
+          pcl.integrator( integrator );
        } else { 
           integrator = NULLPTR;
        }
@@ -1192,20 +1248,17 @@ int main( int argc, char * argv[] )
                       << " to  " << vertical << endl;
               }
               for ( iter = flock->begin(); iter != flock->end(); iter++ ) {
-                  fpcl = *iter;
                   // the value in the parcel is not really "Vertical" coodinate, 
                   // but in the "ParcelVertical" coordinate.
                   // For the conversion to work, this must be noted.
-                  fpcl.setNonVert();
-    
-                  // Do the conversion for this parcel           
-                  inVChange->apply( fpcl );
-
-                  // the parcel's nonVert status has been changes by the apply() above
-                  
-                  // put the new parcel's values in the Flock element
-                  *iter = fpcl;
-
+                  iter->setNonVert();
+              }
+              
+              // Do the conversion for all of this processor's parcels at once.
+              // (The parcels' nonVert status is changed by the apply().)
+              inVChange->apply( *flock );
+              if ( verbose && inVChange->badCount() > 0 ) {
+                 cerr << inVChange->badCount() << " parcels could not be converted, and will not be traced" << endl;
               }
               
               delete inVChange;
@@ -1274,12 +1327,18 @@ int main( int argc, char * argv[] )
           cerr << "STARTING : " << endl;
        }    
     
+       // start recording met server traffic, if desired
+       if ( trace_file != "" ) {
+          EventTrace::start( pgrp, trace_file );
+       }
+       
        // Trace the Parcel trajectories
        // forwards or backwards
        tracing = true;
        
        // initialize the save-state counter
        scount = 0;
+       icount = 0;
        
        flock->metDelay();
        
@@ -1316,6 +1375,7 @@ int main( int argc, char * argv[] )
            //cout << "      after  time: "  << ((*flock)[0]).getTime() << endl;
            
            scount++;
+           icount++;
            
            // by default, we will not produce output for this time step
            do_output = false;
@@ -1394,10 +1454,24 @@ int main( int argc, char * argv[] )
            if ( debug ) {         
               std::cerr << "@@@@@@@@@@@@@@@@@@@@ end of tracing loop" << std::endl;
            }
+           
+           // periodic summary of where the time is going
+           // (Every processor must take part in this.)
+           if ( iinterval > 0 && icount >= iinterval && tracing ) {
+              Instrument::report( pgrp, cerr, "model time " + metsource->time2Cal(time) );
+              icount = 0;
+           }
        }
        
        flock->sync();
        
+       // (this does nothing unless instrumentation is enabled)
+       Instrument::report( pgrp, cerr, "end of run" );
+       
+       // write out the met server traffic timeline
+       // (this does nothing unless a trace file was requested)
+       EventTrace::finish();
+       
        // All done.  Destroy the things we created
 #ifdef USE_NETCDF
        if ( outNetcdf ) {
@@ -1405,6 +1479,12 @@ int main( int argc, char * argv[] )
           delete out_netcdf;
        }
 #endif
+       if ( verbose && dynamic_cast<IntegRK32*>(integrator) != NULLPTR ) {
+          IntegRK32 *adaptive = dynamic_cast<IntegRK32*>(integrator);
+          cerr << "Integrator mean substeps per parcel per step = " << adaptive->meanSubsteps() 
+               << " (" << adaptive->meanRejects() << " rejected)" << endl;
+       }
+       
        delete flock;
        delete metsource;
        if ( integrator != NULLPTR ) {
@@ -28,7 +28,7 @@ multiprocessing, but it can use cached data, if a cache directory is defined.
 The calling sequence is:
 \code
 gtmodel_s02 [ --help|-h ] [ --list ] [ --verbose ] [--debug level] [ --config|-c configFile ] [ --rc|-r resourcefile ] \\
-               [--cachedir|-d directory ] [ --source|-s metsource ] \\
+               [--cachedir|-d directory ] [ --metcache socketname ] [ --source|-s metsource ] \\
                [ --begdate|-b yyyy-mm-ddThh:mm:ss ] [ --enddate|-e yyyy-mm-ddThh:mm:ss ] --zerodate|-z yymmddThh:mm:ss\\
                [ --tstep|-t timeDelta ] [ --frequency|-f outputfreq ]  \\
                [ --vertical|-v verticalCoord ] [ --iso|-i ] [ --parcelvertical pVerticalCoord ] \\
@@ -65,6 +65,9 @@ begdate=2007-10-23T13
           source, while a configuration file would contain settings that are specific to a single tool
           or even a single run of a tool. 
  \li \c cachedir : specifies a directory into which the cached data files are to be placed. If omitted, then no disk caching is done.
+ \li \c metcache : if gigatraj was built with the --enable-shmcache option, the socket name of a 
+                   local met cache server (see gt_met_cached) through which meteorological
+                   fields are shared with other model runs on the same host. If omitted, then no such sharing is done.
  \li \c  source : specifies the meteorological data source. This may be one of:
                - SBROT = solid-body earth rotation, a test data set only
                - MERRA = the NASA Goddard GMAO MERRA reanalysis
@@ -138,7 +141,9 @@ begdate=2007-10-23T13
                      for the integrator. A positive value's effect depends on the integrator
                      being used.
 
-  \li \c integrator  specifies the name of the integrator to be used. (e.g., "RK4", "RK4a").
+  \li \c integrator  specifies the name of the integrator to be used. (e.g., "RK4", "RK4a", "RK4c", "RK32").
+                     ("RK4c" steps parcels as Earth-centred unit vectors, with no polar special cases.
+                     "RK32" does the same, but substeps each parcel adaptively within each time step.)
                      (The default value, RK4a, is usually the best.)
      
   \li \c metoptions ; specifies a string of ";"-separated options for the met data source.
@@ -165,6 +170,29 @@ begdate=2007-10-23T13
    \li \c met_server_ratio: sets the ratio of parcel-tracing processors to meteorological data servers 
                             in a multiprocessing environment. 
    
+   \li \c met_sync_steps: in a multiprocessing environment, the number of time steps between
+                          full synchronizations of the parcel-tracing processors and the meteorological data servers.
+                          The default is 1, which synchronizes every time step. Larger values let the
+                          faster processors run ahead of the slower ones between synchronizations, and
+                          0 synchronizes only for output and state saves. With the verbose option, each met
+                          server reports the largest skew among its clients at the end of the run.
+   
+   \li \c met_halo: in a multiprocessing environment, if set to a positive number, each parcel-tracing processor
+                    fetches from the meteorological data servers the sub-block of each gridded field that covers
+                    its parcels, once per data snapshot, instead of asking for individual gridpoints.
+                    The value is the greatest expected horizontal wind speed, in m/s, which sets how much the 
+                    region is padded to allow for parcel motion during a time step. The default is 0 (off).
+   
+   \li \c met_levels: if set to a positive number, the meteorological data source reads only the vertical 
+                      levels that span the parcels, with this many levels of margin above and below. 
+                      The range of levels is widened as the parcels approach its edges.
+                      Data sources that cannot restrict their vertical levels ignore this. 
+                      The default is 0 (read all levels).
+   
+   \li \c threads: if gigatraj was built with the --enable-threads option, the number of threads 
+                   with which each parcel-tracing processor traces its parcels. The threads
+                   share a single copy of the meteorological data. The default is 1.
+   
    \li \c save_to  after every N time steps, save the model state to the specified file, for later
                    restoration if the model run is interrupted.
    
@@ -175,6 +203,17 @@ begdate=2007-10-23T13
 
    \li \c keep_save  Ordinarily the save file (if used) is deleted after a successful run. Use this option to keep it.
    
+   \li \c instrument_steps  If gigatraj was configured with --enable-instrument, a summary of
+                    the time spent in various parts of the model is printed at the end of the run.
+                    If this is set to a positive number N, a summary is also printed
+                    every N time steps. (This option is only available if instrumentation is enabled.)
+   
+   \li \c trace_file  If gigatraj was configured with --enable-instrument, the requests and responses
+                    passed between the met processors and their clients are recorded and written to
+                    this file at the end of the run, as a Chrome-trace JSON timeline that can be
+                    loaded into chrome://tracing or the Perfetto UI. (This option is only available
+                    if instrumentation is enabled.)
+   
 Note that the begdate and enddate settings are mandatory: they must be defined somewhere, usually in the command line options.
 
 Settings are applied in this order: first, built-in default values are loaded. These defaults are:
@@ -220,12 +259,16 @@ Finally, settings from the command-line options are loaded, overwriting any prev
 
 #include "gigatraj/IntegRK4a.hh"
 #include "gigatraj/IntegRK4.hh"
+#include "gigatraj/IntegRK4Cart.hh"
+#include "gigatraj/IntegRK32.hh"
 
 #include "gigatraj/Parcel.hh"
 #include "gigatraj/Swarm.hh"
 #include "gigatraj/trace.hh"
 #include "gigatraj/PGenFile.hh"
 #include "gigatraj/ChangeVertical.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/EventTrace.hh"
 
 #include "gigatraj/StreamPrint.hh"
 #include "gigatraj/StreamDump.hh"
@@ -324,6 +367,10 @@ int getconfig(int argc, char * const argv[], Configuration& conf, MetSelector &m
     conf.add("parcelvertical"  , cString , ""           , "",  0, "parcel input/output vertical coordinate" );
     usage +=  " [--cachedir|-d dir]";
     conf.add("cachedir"  , cString , ""                 , "d", 0, "met data cache directory" );
+#ifdef USE_SHMCACHE
+    usage +=  " [--metcache socketname]";
+    conf.add("metcache"  , cString , ""                 , "" , 0, "socket of a local met cache server to share met data through" );
+#endif
     usage +=  " [--frequency|-f outputFreq]";
     conf.add("frequency" , cFloat  , "1.0"              , "f", 0, "output frequency, in hours" );
     usage +=  " [--tstep|-t timedelta ]";
@@ -366,6 +413,16 @@ int getconfig(int argc, char * const argv[], Configuration& conf, MetSelector &m
     conf.add("mpi"   , cBoolean, "N"                , "" , 0, "use OpenMPI multiprocessing" );
     usage +=  " [--met_server_ratio m ] ";
     conf.add("met_server_ratio", cInt, "5"          , "" , 0, "met client:server ratio (e.g., 3 means a 3:1 ratio)" );
+    usage +=  " [--met_sync_steps n ] ";
+    conf.add("met_sync_steps", cInt, "1"            , "" , 0, "number of time steps between met client/server synchronizations (0=only at output)" );
+    usage +=  " [--met_halo speed ] ";
+    conf.add("met_halo", cFloat, "0.0"              , "" , 0, "fetch met sub-blocks around the parcels, padded for this max wind speed (m/s) (0=off)" );
+#endif
+    usage +=  " [--met_levels n ] ";
+    conf.add("met_levels", cInt, "0"                , "" , 0, "read only the vertical levels spanning the parcels, with this many levels of margin (0=off)" );
+#ifdef USE_THREADS
+    usage +=  " [--threads n ] ";
+    conf.add("threads", cInt, "1"                   , "" , 0, "number of threads with which to trace each processor's parcels" );
 #endif
     usage += " [ --save_to savefile ]";
     conf.add("save_to"     , cString,  ""                   , "" , 0, "file to save model state to" );
@@ -375,6 +432,12 @@ int getconfig(int argc, char * const argv[], Configuration& conf, MetSelector &m
     conf.add("save_steps", cInt, "500"          , "" , 0, "number of time steps bwtween which model state is to be saved" );
     usage +=  " [--keep_save] ";
     conf.add("keep_save"   , cBoolean, "N"                , "" , 0, "keep save_file after a successful run" );
+#ifdef USE_INSTRUMENT
+    usage +=  " [--instrument_steps nsteps ] ";
+    usage +=  " [--trace_file filename ] ";
+    conf.add("instrument_steps", cInt, "0"          , "" , 0, "number of time steps between instrumentation summaries (0=only at the end)" );
+    conf.add("trace_file", cString, ""             , "" , 0, "file to which a timeline of met server traffic is written" );
+#endif
 
     // Load the config setting values from any config files, as well as the command line
     // The defaults are loaded first
@@ -639,6 +702,8 @@ int main( int argc, char * argv[] )
     string zerodate;
     // the meteorological data cache directory 
     string cachedir;
+    // the socket of a shared met cache server
+    string metcache;
     // the output frequency, in seconds
     float outfreq;
     // flag to indicate whether we are to trace on isosurfaces of the vertical coordinate
@@ -661,6 +726,14 @@ int main( int argc, char * argv[] )
     bool use_mpi;
     // met client-to-server ratio
     int mcsr;
+    // time steps between met client/server synchronizations
+    int stepsync;
+    // max wind speed for met sub-block padding (0 = no sub-blocks)
+    double halospeed;
+    // margin of the vertical level window (0 = read all levels)
+    int levwin;
+    // number of threads per tracing processor
+    int nthreads;
     // bad-parcel output flag
     bool nobad;
     // save/restore
@@ -675,6 +748,11 @@ int main( int argc, char * argv[] )
     int sinterval;
     // save-count
     int scount;
+    // instrumentation summary interval and count
+    int iinterval;
+    int icount;
+    // met server traffic timeline file
+    std::string trace_file;
     // we dump parcels states every accumul_time interval    
     double accumul_time;
 #ifdef USE_NETCDF
@@ -788,6 +866,10 @@ int main( int argc, char * argv[] )
        enddate = config.get("enddate");
        zerodate = config.get("zerodate");
        cachedir = config.get("cachedir");
+       metcache = "";
+#ifdef USE_SHMCACHE
+       metcache = config.get("metcache");
+#endif
        config.fetchParam("frequency", outfreq);
        config.fetchParam("iso", isosfc);
        config.fetchParam("metbasehr", tbase);
@@ -803,14 +885,28 @@ int main( int argc, char * argv[] )
        ifmt = config.get("inputformat");
        tstep = config.str2dbl( config.get("tstep") );
        delay = config.str2dbl( config.get("delay") );
+       stepsync = 1;
+       halospeed = 0.0;
 #ifdef USE_MPI
        config.fetchParam("mpi", use_mpi);
        config.fetchParam("met_server_ratio", mcsr);
+       config.fetchParam("met_sync_steps", stepsync);
+       halospeed = config.str2dbl( config.get("met_halo") );
+#endif
+       config.fetchParam("met_levels", levwin);
+       nthreads = 1;
+#ifdef USE_THREADS
+       config.fetchParam("threads", nthreads);
 #endif
        config.fetchParam("save_to", save_file );
        config.fetchParam("restore_from", restore_file );
        sinterval = config.str2int( config.get("save_steps") );
        config.fetchParam("keep_save", keep_save);
+       iinterval = 0;
+#ifdef USE_INSTRUMENT
+       config.fetchParam("instrument_steps", iinterval );
+       config.fetchParam("trace_file", trace_file );
+#endif
 #ifdef USE_NETCDF
        config.fetchParam("input_netcdf", inNetcdf );
        outNetcdfFile = config.get("netcdf_out");
@@ -986,6 +1082,16 @@ int main( int argc, char * argv[] )
        }
        // set the prozessing group
        metsource->setPgroup( pgrp );
+       // and how often the met servers and their clients synchronize
+       metsource->setStepSync( stepsync );
+       // and whether the clients fetch met sub-blocks
+       if ( halospeed > 0.0 ) {
+          metsource->setHalo( true, halospeed );
+       }
+       // and whether it reads only the vertical levels that span the parcels
+       if ( levwin > 0 ) {
+          metsource->setLevelWindow( true, levwin );
+       }
 
         
        // Set up the output cache directory
@@ -993,6 +1099,10 @@ int main( int argc, char * argv[] )
        filepath.makedir();
        // Tell the data source to use disk caching
        metsource->setCacheDir( cachedir );
+       // share met data with other runs on this host?
+       if ( metcache != "" ) {
+          metsource->setSharedCache( metcache );
+       }
        
        // thin out the horizontal grid?
        // set any horizontal thinning (not all sources use this)
@@ -1068,6 +1178,12 @@ int main( int argc, char * argv[] )
        } else if ( integratorName == "RK4a" ) {
           integrator = new IntegRK4a;
           pcl.integrator( integrator );
+       } else if ( integratorName == "RK4c" ) {
+          integrator = new IntegRK4Cart;
+          pcl.integrator( integrator );
+       } else if ( integratorName == "RK32" ) {
+          integrator = new IntegRK32;
+          pcl.integrator( integrator );
        } else { 
           integrator = NULLPTR;
        }
@@ -1153,7 +1269,7 @@ int main( int argc, char * argv[] )
           time = begtime;
           
           // we dump parcels states every accumul_time interval 
-          double accumul_time = 0.0;
+          accumul_time = 0.0;
 
        } else {
        
@@ -1173,6 +1289,11 @@ int main( int argc, char * argv[] )
           iter->conformal( confml );
        }
        
+       // trace each processor's parcels with a pool of threads
+       if ( nthreads > 1 ) {
+          swarm->setThreads( nthreads );
+       }
+       
 
        if ( do_restore == 0 ) {  
           // but we may need to convert the parcels' vertical coordinates
@@ -1187,20 +1308,17 @@ int main( int argc, char * argv[] )
                       << " to  " << vertical << endl;
               }
               for ( iter = swarm->begin(); iter != swarm->end(); iter++ ) {
-                  fpcl = *iter;
                   // the value in the parcel is not really "Vertical" coodinate, 
                   // but in the "ParcelVertical" coordinate.
                   // For the conversion to work, this must be noted.
-                  fpcl.setNonVert();
-    
-                  // Do the conversion for this parcel           
-                  inVChange->apply( fpcl );
-
-                  // the parcel's nonVert status has been changes by the apply() above
-                  
-                  // put the new parcel's values in the Swarm element
-                  *iter = fpcl;
-
+                  iter->setNonVert();
+              }
+              
+              // Do the conversion for all of this processor's parcels at once.
+              // (The parcels' nonVert status is changed by the apply().)
+              inVChange->apply( *swarm );
+              if ( verbose && inVChange->badCount() > 0 ) {
+                 cerr << inVChange->badCount() << " parcels could not be converted, and will not be traced" << endl;
               }
               
               delete inVChange;
@@ -1269,12 +1387,18 @@ int main( int argc, char * argv[] )
           cerr << "STARTING : " << endl;
        }    
     
+       // start recording met server traffic, if desired
+       if ( trace_file != "" ) {
+          EventTrace::start( pgrp, trace_file );
+       }
+       
        // Trace the Parcel trajectories
        // forwards or backwards
        tracing = true;
        
        // initialize the save-state counter
        scount = 0;
+       icount = 0;
        
        swarm->metDelay();
        
@@ -1311,6 +1435,7 @@ int main( int argc, char * argv[] )
            //cout << "      after  time: "  << ((*swarm)[0]).getTime() << endl;
            
            scount++;
+           icount++;
            
            // by default, we will not produce output for this time step
            do_output = false;
@@ -1389,10 +1514,30 @@ int main( int argc, char * argv[] )
            if ( debug ) {         
               std::cerr << "@@@@@@@@@@@@@@@@@@@@ end of tracing loop" << std::endl;
            }
+           
+           // periodic summary of where the time is going
+           // (Every processor must take part in this.)
+           if ( iinterval > 0 && icount >= iinterval && tracing ) {
+              Instrument::report( pgrp, cerr, "model time " + metsource->time2Cal(time) );
+              icount = 0;
+           }
        }
        
        swarm->sync();
        
+       // how far apart did the met clients drift?
+       if ( verbose && stepsync != 1 && metsource->isMetServer() ) {
+          cerr << "Met server " << pgrp->id() << ": largest client skew was " 
+               << metsource->maxStepSkew() << " time steps" << endl;
+       }
+       
+       // (this does nothing unless instrumentation is enabled)
+       Instrument::report( pgrp, cerr, "end of run" );
+       
+       // write out the met server traffic timeline
+       // (this does nothing unless a trace file was requested)
+       EventTrace::finish();
+       
        // All done.  Destroy the things we created
 #ifdef USE_NETCDF
        if ( outNetcdf ) {
@@ -1400,6 +1545,15 @@ int main( int argc, char * argv[] )
           delete out_netcdf;
        }
 #endif
+       if ( verbose && dynamic_cast<IntegRK32*>(integrator) != NULLPTR ) {
+          // each process reports on the parcels that it traced
+          IntegRK32 *adaptive = dynamic_cast<IntegRK32*>(integrator);
+          if ( adaptive->meanSubsteps() > 0 ) {
+             cerr << "Integrator mean substeps per parcel per step = " << adaptive->meanSubsteps() 
+                  << " (" << adaptive->meanRejects() << " rejected)" << endl;
+          }
+       }
+       
        delete swarm;
        delete metsource;
        if ( integrator != NULLPTR ) {
@@ -54,6 +54,9 @@ int main()
     real tstlon, tstlat;
     real tstlons[3], tstlats[3], tstzs[3];
     real *tstvals, tstvals2[3], tstvals3[3];
+    real tstvals4[3], tstvals5[3];
+    std::vector<real> pairs;
+    HLatLonStencil stencil;
     HLatLonInterp *interp;
     Vinterp *vin;
 
@@ -456,6 +459,94 @@ int main()
     }
 
 
+    //=========================== interpolating with cached stencils
+    tstlons[0] = -76.3;
+    tstlats[0] = 39.7;
+    tstzs[0] = 225.0;
+    tstlons[1] = 0.5;
+    tstlats[1] = -35.0;
+    tstzs[1] = 100.0;
+    tstlons[2] = 359.5;
+    tstlats[2] = 90.0;
+    tstzs[2] = 80.0;
+    interp->vinterp(3, tstlons, tstlats, tstzs, tstvals2, grid3d, *vin, stencil );
+    if ( mismatch( tstvals2[0], -1.47045 ) 
+    || mismatch( tstvals2[1], -0.0682093 ) 
+    || mismatch( tstvals2[2], -0.246592 ) ) {
+       cerr << " Mismatched stencil GridLatLonField3D interpolated value: " 
+           << -1.47045 << " vs. " << tstvals2[0] 
+           << ", " << -0.0682093 << " vs. " << tstvals2[1] 
+           << ", " << -0.246592 << " vs. " << tstvals2[2] << endl;
+       exit(1);
+    }
+    if ( stencil.misses() != 3 || stencil.hits() != 0 ) {
+       cerr << " Stencils were not looked up: " << stencil.misses() << ", " << stencil.hits() << endl;
+       exit(1);
+    }
+    // the same points on a grid of the same shape reuse the stencils
+    interp->vinterpVector( 3, tstlons, tstlats, tstzs, tstvals2, tstvals3, grid3d, grid3d2, *vin, stencil );
+    if ( mismatch( tstvals2[0], -1.47045 ) 
+      || mismatch( tstvals2[1], -0.0682093 ) 
+      || mismatch( tstvals2[2], -0.246592 ) 
+      || mismatch( tstvals3[0], (-1.47045 - 0.5)/2 ) 
+      || mismatch( tstvals3[1], (-0.0682093 - 0.5)/2 ) 
+      || mismatch( tstvals3[2], (-0.246592 - 0.5)/2 ) ) {
+       cerr << " Mismatched stencil vector GridLatLonField3D interpolated value: " 
+           << -1.47045 << " vs. " << tstvals2[0] 
+           << ", " << -0.0682093 << " vs. " << tstvals2[1] 
+           << ", " << -0.246592 << " vs. " << tstvals2[2] << "; "
+           << (-1.47045 - 0.5)/2 << " vs. " << tstvals3[0] 
+           << ", " << (-0.0682093 - 0.5)/2 << " vs. " << tstvals3[1] 
+           << ", " << (-0.246592 - 0.5)/2 << " vs. " << tstvals3[2] << endl;
+       exit(1);
+    }
+    if ( stencil.misses() != 3 || stencil.hits() != 3 ) {
+       cerr << " Stencils were not reused: " << stencil.misses() << ", " << stencil.hits() << endl;
+       exit(1);
+    }
+    // points that move a little stay in their cells; points that move far do not
+    tstlons[0] = -76.31;
+    tstlats[0] = 39.71;
+    tstlons[1] = 30.5;
+    interp->vinterp(3, tstlons, tstlats, tstzs, tstvals2, grid3d, *vin, stencil );
+    interp->vinterp(3, tstlons, tstlats, tstzs, tstvals3, grid3d, *vin );
+    if ( mismatch( tstvals2[0], tstvals3[0] ) 
+    || mismatch( tstvals2[1], tstvals3[1] ) 
+    || mismatch( tstvals2[2], tstvals3[2] ) ) {
+       cerr << " Mismatched moved stencil GridLatLonField3D interpolated value: " 
+           << tstvals3[0] << " vs. " << tstvals2[0] 
+           << ", " << tstvals3[1] << " vs. " << tstvals2[1] 
+           << ", " << tstvals3[2] << " vs. " << tstvals2[2] << endl;
+       exit(1);
+    }
+    if ( stencil.misses() != 4 || stencil.hits() != 5 ) {
+       cerr << " Stencils were mishandled after moving: " << stencil.misses() << ", " << stencil.hits() << endl;
+       exit(1);
+    }
+
+    //=========================== interpolating interleaved snapshot pairs
+    // treat grid3d and grid3d2 as two snapshots, side by side
+    pairs.resize( 2*grid3d.dataSize() );
+    for ( i=0; i<grid3d.dataSize(); i++ ) {
+        pairs[2*i] = grid3d.value(i);
+        pairs[2*i+1] = grid3d2.value(i);
+    }
+    if ( ! interp->vinterpPair( 3, tstlons, tstlats, tstzs, tstvals4, tstvals5, grid3d, &(pairs[0]), *vin, stencil ) ) {
+       cerr << " vinterpPair is not implemented " << endl;
+       exit(1);
+    }
+    interp->vinterp(3, tstlons, tstlats, tstzs, tstvals2, grid3d, *vin, stencil );
+    interp->vinterp(3, tstlons, tstlats, tstzs, tstvals3, grid3d2, *vin, stencil );
+    for ( i=0; i<3; i++ ) {
+        if ( tstvals4[i] != tstvals2[i] || tstvals5[i] != tstvals3[i] ) {
+           cerr << " Mismatched interleaved pair value " << i << ": " 
+                << tstvals2[i] << " vs. " << tstvals4[i] 
+                << ", " << tstvals3[i] << " vs. " << tstvals5[i] << endl;
+           exit(1);
+        }
+    }
+
+
     delete vin;
     delete interp;
 
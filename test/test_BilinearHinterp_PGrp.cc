@@ -173,6 +173,30 @@ int main(int argc, char* argv[])
           exit(1);
        }
        delete vdata;
+       
+       // a tight cluster of points, many of which share the same gridpoints
+       vlons.clear();
+       vlats.clear();
+       vzs.clear();
+       for ( i=0; i<50; i++ ) {
+          vlons.push_back( -76.3 + i*0.001 );
+          vlats.push_back( 39.7 );
+          vzs.push_back( 225.0 );
+          vlons.push_back(  0.5 );
+          vlats.push_back( -35.0 );
+          vzs.push_back( 100.0 );
+       }
+       vdata = interp->vinterp(vlons,vlats, vzs, grid, *vin );
+       for ( i=0; i<50; i++ ) {
+          if ( mismatch( (*vdata)[2*i], -1.47045, 0.01 ) 
+            || mismatch( (*vdata)[2*i+1], -0.0682093 ) ) {
+             cerr << " Mismatched clustered GridLatLonField3D interpolated value at " << i << ": "
+                 << -1.47045 << " vs. " << (*vdata)[2*i] 
+                 << ", " << -0.0682093 << " vs. " << (*vdata)[2*i+1] << endl;
+             exit(1);
+          }
+       }
+       delete vdata;
 
        // send the "I am done" signal
        // =========================  method svr_done
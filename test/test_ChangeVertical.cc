@@ -101,6 +101,46 @@ int main()
        exit(1);  
     } 
     
+    //------------------------------------------------------------------
+    
+    // batched conversion of a vector of parcels
+    std::vector<Parcel> pv;
+    real zvals[5] = { 5.0, 10.0, 15.0, 20.0, 25.0 };
+    int errs[5];
+    ChangeVertical vc3;
+    ChangeVertical vc4;
+    for ( i=0; i<5; i++ ) {
+        p2 = p;
+        p2.setPos( lon + 30.0*i, lat - 10.0*i );
+        p2.setZ( zvals[i] );
+        pv.push_back( p2 );
+    }
+    vc3.to( "theta" );
+    vc3.apply( pv );
+    if ( vc3.badCount() != 0 ) {
+       cerr << "bad batched count: " << vc3.badCount() << endl;
+       exit(1);  
+    } 
+    for ( i=0; i<5; i++ ) {
+        val0 = metsrc->getData( "theta", time0, lon + 30.0*i, lat - 10.0*i, zvals[i] );
+        val = pv[i].getZ();
+        if ( mismatch(val, val0) || ! pv[i].queryNonVert() ) {
+           cerr << "bad batched theta value " << i << ": " << val << " vs. " << val0 << endl;
+           exit(1);  
+        } 
+    }
+    
+    // and back again, as an array, with error flags
+    vc4.from( "theta" );
+    vc4.apply( &(pv[0]), 5, errs );
+    for ( i=0; i<5; i++ ) {
+        val = pv[i].getZ();
+        if ( errs[i] != 0 || mismatch(val, zvals[i], 0.01) || pv[i].queryNonVert() ) {
+           cerr << "bad batched alt value " << i << ": " << val << " vs. " << zvals[i] << endl;
+           exit(1);  
+        } 
+    }
+    
     delete metsrc;
 
     //------------------------------------------------------------------
@@ -1129,6 +1129,55 @@ int main()
         }
     }
     
+    // =============================   batch (vectorized) versions of the multi-point methods
+    for ( int mode=1; mode <= 2; mode++ ) {
+        e.vectorized( mode );
+        if ( e.vectorized() != mode ) {
+           cerr << "vectorized mode " << mode << " was not set" << endl;
+           exit(1);
+        }
+        for ( int i=0; i<n; i++ ) {
+           lons2[i] = lons[i];
+           lats2[i] = lats[i];
+        }
+        e.deltaxy( n, lons2, lats2, dxs, dys, 1.0, -1 );
+        for ( int i=0; i<n; i++ ) {
+            if ( mismatch(lons2[i], targetlons_exact[i]) || mismatch(lats2[i],targetlats_exact[i]) ) {
+               cerr << "array: Bad xy <batch " << mode << "> array increment check at i=" << i << " ("
+               << "expecting ( " << targetlons_exact[i] << ", " << targetlats_exact[i] << "), got ("
+               << lons2[i] << ", " << lats2[i] << ")" << endl;
+               exit(1);  
+            }
+        }
+        // a path straight over the pole
+        lon = 10.0;
+        lat = 89.0;
+        vx = 0.0;
+        vy = 2.0*RCONV*e.radius();
+        e.deltaxy( 1, &lon, &lat, &vx, &vy, 1.0, -1 );
+        if ( mismatch( lon, e.wrap(190.0) ) || mismatch( lat, 89.0 ) ) {
+           cerr << "Bad xy <batch " << mode << "> over-the-pole increment: got (" 
+                << lon << ", " << lat << ")" << endl;
+           exit(1);
+        }
+        // distances and bearings agree with the scalar versions
+        dists = new real[n];
+        bearings = new real[n];
+        e.distance( n, lons, lats, lons2, lats2, dists );
+        e.bearing( n, lons, lats, lons2, lats2, bearings );
+        for ( int i=0; i<n; i++ ) {
+            if ( mismatch( dists[i], e.distance( lons[i], lats[i], lons2[i], lats2[i] ) ) 
+              || mismatch( bearings[i], e.bearing( lons[i], lats[i], lons2[i], lats2[i] ) ) ) {
+               cerr << "Bad <batch " << mode << "> distance/bearing at i=" << i << ": " 
+                    << dists[i] << "/" << bearings[i] << endl;
+               exit(1);
+            }
+        }
+        delete[] bearings;
+        delete[] dists;
+    }
+    e.vectorized( 0 );
+    
     delete[] dys;
     delete[] dxs;
     delete[] lats2;
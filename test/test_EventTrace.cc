@@ -0,0 +1,144 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
+/*!
+     Test program for the EventTrace class
+*/
+
+#include <stdlib.h>     
+#include <stdio.h>     
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/EventTrace.hh"
+#include "gigatraj/MetGridData.hh"
+#include "gigatraj/SerialGrp.hh"
+
+#include "test_utils.hh"
+
+using namespace gigatraj;
+using std::cerr;
+using std::endl;
+
+
+// a function with event recording in it
+static void work( int peer )
+{
+    GT_EVENT_BEGIN( workevent );
+    
+    usleep( 2000 );
+    GT_EVENT_BYTES( 400 );
+    
+    GT_EVENT_END( workevent, "test macro work", peer, "T", "2018-03-20T06:00", -1 );
+    GT_EVENT_MARK( "test macro mark", peer, "", "", -1 );
+}
+
+// reads the contents of a file
+static std::string slurp( const std::string& fname )
+{
+    std::ifstream in;
+    std::ostringstream txt;
+    
+    in.open( fname.c_str() );
+    if ( ! in.good() ) {
+       return "";
+    }
+    txt << in.rdbuf();
+    in.close();
+    
+    return txt.str();
+}
+
+int main() 
+{
+   SerialGrp grp;
+   std::string fname;
+   std::string txt;
+   
+   fname = "test_EventTrace_out.json";
+   remove( fname.c_str() );
+   
+   // =========================== command names
+   if ( std::string( EventTrace::cmdName( PGR_CMD_M3D ) ) != "PGR_CMD_M3D" 
+     || std::string( EventTrace::cmdName( -9999 ) ) != "PGR_CMD_unknown" ) {
+      cerr << "cmdName() returned bad names" << endl;
+      exit(1);
+   }
+   
+   // =========================== nothing is recorded before start()
+   if ( EventTrace::active() ) {
+      cerr << "EventTrace is active before start()" << endl;
+      exit(1);
+   }
+   EventTrace::instant( "test early", 3 );
+   // finish() does nothing without start()
+   EventTrace::finish();
+   if ( slurp( fname ) != "" ) {
+      cerr << "finish() wrote a file without start()" << endl;
+      exit(1);
+   }
+   
+   // =========================== record and write
+   EventTrace::start( &grp, fname );
+   if ( ! EventTrace::active() ) {
+      cerr << "EventTrace is not active after start()" << endl;
+      exit(1);
+   }
+   
+   {
+      EventTrace::Span span;
+      usleep( 5000 );
+      EventTrace::event( "test span", span, 2, "U\"V", "2018-03-20T12:00", 1234 );
+   }
+   EventTrace::instant( "test instant", 1 );
+   work( 5 );
+   
+   EventTrace::finish();
+   if ( EventTrace::active() ) {
+      cerr << "EventTrace is still active after finish()" << endl;
+      exit(1);
+   }
+   
+   txt = slurp( fname );
+   if ( txt.find( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" ) != 0 
+     || txt.find( "\"process_name\"" ) == std::string::npos
+     || txt.find( "\"name\":\"test span\",\"cat\":\"met\",\"ph\":\"X\"" ) == std::string::npos
+     || txt.find( "\"peer\":2,\"quantity\":\"U\\\"V\",\"time\":\"2018-03-20T12:00\",\"bytes\":1234}" ) == std::string::npos
+     || txt.find( "\"name\":\"test instant\",\"cat\":\"met\",\"ph\":\"i\"" ) == std::string::npos
+     || txt.find( "test early" ) != std::string::npos ) {
+      cerr << "finish() did not write the expected timeline:" << endl << txt << endl;
+      exit(1);
+   }
+   
+   if ( gigatraj::Instrument::enabled() ) {
+      // the macros recorded their events, with the bytes counted in between
+      if ( txt.find( "\"name\":\"test macro work\"" ) == std::string::npos
+        || txt.find( "\"peer\":5,\"quantity\":\"T\",\"time\":\"2018-03-20T06:00\",\"bytes\":400}" ) == std::string::npos
+        || txt.find( "\"name\":\"test macro mark\"" ) == std::string::npos ) {
+         cerr << "macros did not record events:" << endl << txt << endl;
+         exit(1);
+      }
+   } else {
+      // the macros do nothing at all
+      if ( txt.find( "test macro" ) != std::string::npos ) {
+         cerr << "macros recorded events when instrumentation is disabled" << endl;
+         exit(1);
+      }
+   }
+   
+   remove( fname.c_str() );
+   
+   exit(0);
+}
@@ -376,6 +376,73 @@ int main(int argc, char* argv[])
 
     delete flk;
 
+    pgrp->sync();
+
+    // now test re-balancing the parcel load among the processors
+    flk = new Flock( p, pgrp, n, 0);
+    
+    // the first half of the parcels will not be traced, 
+    // so the lower-ranked processors have nothing to do
+    for ( k=0; k<n; k++ ) {
+        p.setPos( k*3.0, 60.0 - k*1.0 );
+        p.setZ( 500.0 );
+        p.setTime( 0.0 );
+        p.tag( k );
+        p.clearNoTrace();
+        if ( k < n/2 ) {
+           p.setNoTrace();
+        }
+        flk->set(k, p, 1);
+    }
+    pgrp->sync();
+    
+    flk->setRebalance(1);
+    flk->advance( 0.1 );
+    flk->advance( 0.1 );
+    pgrp->sync();
+
+    if ( nprocs > 1 ) {
+       if ( my_id == 0 ) {
+          if ( flk->migrations() <= 0 ) {
+             cerr << "No parcels were migrated" << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+          // (n/2 active parcels spread over nprocs processors)
+          if ( flk->loadImbalance() > ( (n/2)/nprocs + 1.5 )/( (n/2.0)/nprocs ) ) {
+             cerr << "Load imbalance too large after re-balancing: " << flk->loadImbalance() << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+       }
+    }
+    pgrp->sync();
+    
+    // the parcels should still have the same indices
+    for ( iter=flk->begin(); iter!=flk->end(); iter++ ) {
+       k = iter.index();
+       if ( mismatch( iter->tag(), k ) ) {
+          cerr << "parcel index " << k << " has tag " << iter->tag() << endl;
+          pgrp->shutdown();
+          exit(1);
+       }
+    }
+    pgrp->sync();
+    
+    for ( k=0; k<n; k++ ) {
+       p = flk->get(k);
+       p.getPos(&lon,&lat);
+       if ( ( k <  n/2 && ( mismatch( lon, k*3.0 ) || mismatch( lat, 60.0 - k*1.0 ) ) )
+          || ( k >= n/2 && mismatch( p.getTime(), 0.2 ) ) ) {
+          cerr << "Bad parcel " << k << " after re-balancing: (" << lon << ", " << lat << ") at " << p.getTime() << endl;
+          pgrp->shutdown();
+          exit(1);
+       }
+    }
+    pgrp->sync();
+
+    delete flk;
+
 
     /* Shut down MPI */
     //MPI_Finalize();
@@ -23,6 +23,8 @@
 #include "gigatraj/Parcel.hh"
 #include "gigatraj/SerialGrp.hh"
 #include "gigatraj/Flock.hh"
+#include "gigatraj/Swarm.hh"
+#include "gigatraj/MetSBRot.hh"
 
 #include "test_utils.hh"
 
@@ -37,7 +39,7 @@ using std::operator>>;
 int main() 
 {
 
-    Parcel p;
+    Parcel p, q;
     Parcel *pc;
     real lon;
     real lat;
@@ -47,6 +49,12 @@ int main()
     Flock::iterator iter;
     SerialGrp *pgrp;
     int k;
+    MetSBRot metsrc;
+    Flock *flk2;
+    Swarm *swm;
+    std::vector<Parcel> pcls;
+    real lon2, lat2, z2;
+    int i;
 
     // create a process group (serial, of course)
     pgrp = new SerialGrp();
@@ -148,5 +156,54 @@ int main()
 
     delete flk;
 
+    // advance a Flock, and compare its parcels with the
+    // same parcels traced in a Swarm and traced one at a time
+    metsrc.set( 40.0, 30.0 );
+    p.setMet( metsrc );
+    flk2 = new Flock( p, pgrp, 50, 0 );
+    swm = new Swarm( p, 50 );
+    for ( k=0; k<50; k++ ) {
+        p.setPos( k*7.0, 70.0 - k*2.8 );
+        p.setZ( 10.0 + k*0.1 );
+        flk2->set( k, p );
+        swm->set( k, p );
+        pcls.push_back( p );
+    }
+    for ( i=0; i<20; i++ ) {
+        flk2->advance( 0.05 );
+        swm->advance( 0.05 );
+        for ( k=0; k<50; k++ ) {
+            pcls[k].advance( 0.05 );
+        }
+    }
+    for ( k=0; k<50; k++ ) {
+        p = flk2->get( k );
+        p.getPos( &lon, &lat );
+        z = p.getZ();
+        
+        q = swm->get( k );
+        q.getPos( &lon2, &lat2 );
+        z2 = q.getZ();
+        if ( mismatch( lon, lon2 ) || mismatch( lat, lat2 ) || mismatch( z, z2 ) 
+          || mismatch( p.getTime(), q.getTime() ) ) {
+           cerr << "Flock and Swarm parcel " << k << " differ after advance(): "
+                << "(" << lon << ", " << lat << ", " << z << ") vs. "
+                << "(" << lon2 << ", " << lat2 << ", " << z2 << ")" << endl;
+           exit(1);
+        }
+        
+        pcls[k].getPos( &lon2, &lat2 );
+        z2 = pcls[k].getZ();
+        if ( mismatch( lon, lon2, 0.001 ) || mismatch( lat, lat2, 0.001 ) || mismatch( z, z2 ) 
+          || mismatch( p.getTime(), pcls[k].getTime() ) ) {
+           cerr << "Flock parcel " << k << " differs from a single Parcel after advance(): "
+                << "(" << lon << ", " << lat << ", " << z << ") vs. "
+                << "(" << lon2 << ", " << lat2 << ", " << z2 << ")" << endl;
+           exit(1);
+        }
+    }
+    delete swm;
+    delete flk2;
+
     exit(0);
 }
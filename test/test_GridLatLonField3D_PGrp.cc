@@ -189,6 +189,24 @@ int main(int argc, char* argv[])
           exit(1);        
        }
        
+       // an empty request must still leave the met processor
+       // ready for the next one
+       grid.ask_for_data();
+       grid.gridpoints( 0, ia, ja, ka, da);
+       da[0] = -1.0;
+       da[1] = -1.0;
+       da[2] = -1.0;
+       grid.ask_for_data();
+       grid.gridpoints( 3, ia, ja, ka, da);
+       if ( da[0] != grid2( ia[0],ja[0], ka[0] ) 
+        ||  da[1] != grid2( ia[1],ja[1], ka[1] ) 
+        ||  da[2] != grid2( ia[2],ja[2], ka[2] ) ) {
+          cerr << " gridpoints results do not match after an empty request" << endl;
+          grid.svr_done();
+          grp->shutdown();
+          exit(1);        
+       }
+       
        // send the "I am done" signal
        // =========================  method svr_done
        grid.svr_done();
@@ -0,0 +1,194 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
+/*!
+     Test program for the Instrument class
+*/
+
+#include <stdlib.h>     
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Instrument.hh"
+#include "gigatraj/SerialGrp.hh"
+
+#include "test_utils.hh"
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+using namespace gigatraj;
+using std::cerr;
+using std::endl;
+
+
+// a function with instrumentation in it
+static void work( int n )
+{
+    GT_TIMER( worktimer, "test work" );
+    GT_COUNT( "test work items", n );
+    
+    usleep( 1000*n );
+}
+
+#ifdef USE_THREADS
+// records the values 1 through 100 for a counter, from a thread of its own
+static void* threadCount( void* arg )
+{
+    int which;
+    
+    which = *( static_cast<int*>(arg) );
+    for ( int k=1; k<=100; k++ ) {
+        Instrument::record( which, k );
+    }
+    
+    return NULLPTR;
+}
+#endif
+
+int main() 
+{
+   SerialGrp grp;
+   std::ostringstream out;
+   std::string txt;
+   int s1, s2, s3;
+   double t1, t2;
+   int i;
+
+   // =========================== slots
+   s1 = Instrument::slot( "test timer" );
+   s2 = Instrument::slot( "test counter", Instrument::Count );
+   s3 = Instrument::slot( "test timer" );
+   if ( s1 == s2 || s1 != s3 ) {
+      cerr << "slot() returned " << s1 << ", " << s2 << ", " << s3 << endl;
+      exit(1);
+   }
+   
+   // =========================== clock
+   t1 = Instrument::clock();
+   usleep( 20000 );
+   t2 = Instrument::clock();
+   if ( (t2 - t1) < 0.015 || (t2 - t1) > 5.0 ) {
+      cerr << "clock() measured a 20 ms sleep as " << (t2 - t1) << " s" << endl;
+      exit(1);
+   }
+   
+   // =========================== record and report
+   Instrument::record( s2, 3.0 );
+   Instrument::record( s2, 5.0 );
+   {
+      Instrument::Timer tmr( s1 );
+      usleep( 5000 );
+   }
+   
+   Instrument::report( &grp, out, "test", true );
+   txt = out.str();
+   
+   if ( Instrument::enabled() ) {
+      if ( txt.find( "Instrumentation summary: test" ) == std::string::npos 
+        || txt.find( "test counter" ) == std::string::npos
+        || txt.find( "test timer" ) == std::string::npos ) {
+         cerr << "report() did not print the expected summary:" << endl << txt << endl;
+         exit(1);
+      }
+      
+      // the counter summary: 2 events, total 8, mean 4, min 3, max 5
+      i = txt.find( "test counter" );
+      std::istringstream line( txt.substr( i + 12 ) );
+      std::string kind;
+      int procs;
+      double n, sum, mean, mn, mx;
+      line >> kind >> procs >> n >> sum >> mean >> mn >> mx;
+      if ( kind != "count" || procs != 1 || n != 2 || sum != 8.0 || mean != 4.0 || mn != 3.0 || mx != 5.0 ) {
+         cerr << "Bad counter summary: " << kind << " " << procs << " " << n << " " << sum 
+              << " " << mean << " " << mn << " " << mx << endl;
+         exit(1);
+      }
+      
+      // the statistics were cleared by the report, so nothing should be reported now
+      out.str("");
+      Instrument::report( &grp, out );
+      if ( out.str().find( "test counter" ) != std::string::npos ) {
+         cerr << "report() with clear did not reset the statistics" << endl;
+         exit(1);
+      }
+      
+      // =========================== macros
+      work( 2 );
+      work( 4 );
+      out.str("");
+      Instrument::report( NULLPTR, out );
+      txt = out.str();
+      if ( txt.find( "test work items" ) == std::string::npos 
+        || txt.find( "test work " ) == std::string::npos ) {
+         cerr << "macros did not record statistics:" << endl << txt << endl;
+         exit(1);
+      }
+      
+#ifdef USE_THREADS
+      // =========================== threads
+      // (each thread keeps its own table, which must be folded into the report)
+      pthread_t thr[4];
+      int s4;
+      size_t pos;
+      s4 = Instrument::slot( "test thread counter", Instrument::Count );
+      for ( i=0; i<4; i++ ) {
+          pthread_create( &(thr[i]), NULLPTR, threadCount, &s4 );
+      }
+      Instrument::record( s4, 1000.0 );
+      for ( i=0; i<4; i++ ) {
+          pthread_join( thr[i], NULLPTR );
+      }
+      out.str("");
+      Instrument::report( &grp, out );
+      txt = out.str();
+      pos = txt.find( "test thread counter" );
+      if ( pos == std::string::npos ) {
+         cerr << "threads did not record statistics:" << endl << txt << endl;
+         exit(1);
+      }
+      {
+         std::istringstream tline( txt.substr( pos + 19 ) );
+         std::string kind;
+         int procs;
+         double n, sum, mean, mn, mx;
+         tline >> kind >> procs >> n >> sum >> mean >> mn >> mx;
+         // 4 threads x (1 + ... + 100), plus the main thread's 1000
+         if ( n != 401 || sum != 21200.0 || mn != 1.0 || mx != 1000.0 ) {
+            cerr << "Bad thread counter summary: " << n << " " << sum 
+                 << " " << mn << " " << mx << endl;
+            exit(1);
+         }
+      }
+#endif
+      
+   } else {
+      if ( txt != "" ) {
+         cerr << "report() printed a summary when instrumentation is disabled:" << endl << txt << endl;
+         exit(1);
+      }
+      
+      // the macros do nothing at all
+      work( 1 );
+      out.str("");
+      Instrument::report( NULLPTR, out );
+      if ( out.str() != "" ) {
+         cerr << "macros recorded statistics when instrumentation is disabled" << endl;
+         exit(1);
+      }
+   }
+   
+   exit(0);
+}
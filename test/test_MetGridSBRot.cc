@@ -66,6 +66,9 @@ int main()
     std::string testString0;
     std::string datdir;
     std::string cfgfile;
+    real plons[4], plats[4], pzs[4];
+    real pu0[4], pv0[4], pw0[4], pq0[4];
+    real pu[4], pv[4], pw[4], pq[4];
    
     datdir = datadir("srcdir"); 
     
@@ -299,6 +302,58 @@ int main()
 
     }
 
+    //=============  time interpolation from interleaved snapshot pairs
+    plons[0] = 23.4;  plats[0] = 45.1;  pzs[0] = 30.0;
+    plons[1] = 0.5;   plats[1] = -35.0; pzs[1] = 12.0;
+    plons[2] = 359.5; plats[2] = 89.5;  pzs[2] = 3.0;
+    plons[3] = 181.0; plats[3] = 0.2;   pzs[3] = 44.0;
+    metsrc->getOption( "TimePairCache", testInt );
+    if ( testInt != 0 ) {
+       cerr << "TimePairCache is on by default" << endl;
+       exit(1);
+    }
+    for ( tt=1.05; tt<=2.0; tt+=0.3 ) {
+        metsrc->setOption( "TimePairCache", 0 );
+        metsrc->get_uvw( tt, 4, plons, plats, pzs, pu0, pv0, pw0 );
+        metsrc->getData( "somestuff", tt, 4, plons, plats, pzs, pq0, METDATA_MKS );
+        metsrc->setOption( "TimePairCache", 1 );
+        metsrc->get_uvw( tt, 4, plons, plats, pzs, pu, pv, pw );
+        metsrc->getData( "somestuff", tt, 4, plons, plats, pzs, pq, METDATA_MKS );
+        for ( i=0; i<4; i++ ) {
+            if ( pu[i] != pu0[i] || pv[i] != pv0[i] || pw[i] != pw0[i] || pq[i] != pq0[i] ) {
+               cerr << "bad paired time interp @ " << tt << " pt " << i << ": " 
+                    << pu0[i] << ", " << pv0[i] << ", " << pw0[i] << ", " << pq0[i] << " vs. "
+                    << pu[i] << ", " << pv[i] << ", " << pw[i] << ", " << pq[i] << endl;
+               exit(1);  
+            }
+        }
+    }
+    
+    // the pairs must not outlive a change of vertical coordinate, 
+    // even to one with as many levels as the native altitudes
+    std::vector<real> thetas19;
+    for ( i=0; i<19; i++ ) {
+        thetas19.push_back( static_cast<real>(i) * 50.0 + 300.0 );
+    }
+    tt = 1.65;
+    metsrc->getData( "p", tt, 4, plons, plats, pzs, pq, METDATA_MKS );
+    metsrc->set_vertical( "theta", "K", &thetas19 );
+    pzs[0] = 350.0;
+    pzs[1] = 500.0;
+    pzs[2] = 700.0;
+    pzs[3] = 900.0;
+    metsrc->getData( "p", tt, 4, plons, plats, pzs, pq, METDATA_MKS );
+    metsrc->setOption( "TimePairCache", 0 );
+    metsrc->getData( "p", tt, 4, plons, plats, pzs, pq0, METDATA_MKS );
+    for ( i=0; i<4; i++ ) {
+        if ( pq[i] != pq0[i] ) {
+           cerr << "bad paired time interp after vertical change, pt " << i << ": " 
+                << pq0[i] << " vs. " << pq[i] << endl;
+           exit(1);  
+        }
+    }
+    metsrc->set_vertical( "alt", "km" );
+
     //=============  time interpolation (testing caching)
 
 
@@ -328,6 +383,71 @@ int main()
     } 
 
 
+    //---- now test the memory budget
+    long hits, misses, drops;
+    long hits0, misses0, drops0;
+    size_t used;
+    // (a generous budget, so that nothing is dropped yet)
+    metsrc->setCacheBudget( 1000000000 );
+    v0 = metsrc->get_u( 4.5*24.0*3600.0, 23.4, 45.1, thet );
+    for ( i=5; i<9; i++ ) {
+       u = metsrc->get_u( (i + 0.5)*24.0*3600.0, 23.4, 45.1, thet );
+    }
+    used = metsrc->cacheBytes();
+    metsrc->cacheStats( hits0, misses0, drops0 );
+    // now squeeze it
+    metsrc->setCacheBudget( used/2 );
+    metsrc->cacheStats( hits, misses, drops );
+    if ( metsrc->cacheBytes() > used/2 || drops <= drops0 ) {
+       cerr << " memory budget not enforced: " << metsrc->cacheBytes() << " bytes, " << drops << " evictions" << endl;
+       exit(1);
+    }
+    // the latest bracket was used most recently, so it should still be in memory
+    v = metsrc->get_u( 8.5*24.0*3600.0, 23.4, 45.1, thet );
+    metsrc->cacheStats( hits, misses, drops );
+    if ( v != u || misses != misses0 || hits <= hits0 ) {
+       cerr << " memory budget dropped recent grids: " << misses0 << " vs. " << misses << " misses" << endl;
+       exit(1);
+    }
+    // the earliest grids were dropped, and must be fetched again
+    v = metsrc->get_u( 4.5*24.0*3600.0, 23.4, 45.1, thet );
+    metsrc->cacheStats( hits, misses, drops );
+    if ( v != v0 || misses == misses0 ) {
+       cerr << " memory budget refetch failure: " << v0 << " vs. " << v << endl;
+       exit(1);
+    }
+    if ( metsrc->cacheBytes() > used/2 ) {
+       cerr << " memory budget exceeded: " << metsrc->cacheBytes() << " vs. " << used/2 << endl;
+       exit(1);
+    }
+    // grids that have been handed out stay in memory until they are given back,
+    // even when another quantity at other times needs the room
+    GridField3D *gq1, *gq1b, *gq2, *gq3;
+    std::string tq1, tq2;
+    tq1 = metsrc->time2Cal( 10.0*24.0*3600.0 );
+    tq2 = metsrc->time2Cal( 10.75*24.0*3600.0 );
+    metsrc->setCacheBudget( 1 );
+    gq1 = metsrc->new_mgmtGrid3D( "u", tq1 );
+    gq2 = metsrc->new_mgmtGrid3D( "t", tq2 );
+    metsrc->cacheStats( hits0, misses0, drops0 );
+    gq1b = metsrc->new_mgmtGrid3D( "u", tq1 );
+    metsrc->cacheStats( hits, misses, drops );
+    if ( gq1b != gq1 || hits != hits0 + 1 || misses != misses0 ) {
+       cerr << " memory budget dropped a grid in use: " << hits0 << " vs. " << hits << " hits" << endl;
+       exit(1);
+    }
+    metsrc->remove( gq1b );
+    metsrc->remove( gq2 );
+    metsrc->remove( gq1 );
+    // once given back, they may be dropped
+    gq3 = metsrc->new_mgmtGrid3D( "u", tq2 );
+    if ( metsrc->cacheBytes() != static_cast<size_t>(gq3->dataSize())*sizeof(gridreal) ) {
+       cerr << " memory budget kept grids no longer in use: " << metsrc->cacheBytes() << " bytes" << endl;
+       exit(1);
+    }
+    metsrc->remove( gq3 );
+    metsrc->setCacheBudget( 0 );
+
     //---- now test disk caching
     //cerr << "====================================================" << endl;
     //metsrc->dbug = 1;
@@ -22,6 +22,7 @@
 
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/MetGridSBRot.hh"
+#include "gigatraj/Earth.hh"
 #ifdef USING_MPI
 #include "gigatraj/MPIGrp.hh"
 #else
@@ -52,6 +53,8 @@ int main(int argc, char* argv[])
     double time0;
     int i;
     ProcessGrp *grp;
+    Earth nav;
+    real plons[3], plats[3], pzs[3];
     
     /* start up MPI */
 #ifdef USING_MPI
@@ -100,6 +103,126 @@ int main(int argc, char* argv[])
     
         metsrc->signalMetDone();
     }
+
+
+    /* now try it again, with met requests sharded across two met processors */
+    delete metsrc;
+    metsrc = new MetGridSBRot;
+    
+    if ( grp->size() > 3 ) {
+       std::vector<int> shards;
+       shards.push_back(1);
+       shards.push_back(2);
+       metsrc->setPgroup(grp, 1);
+       metsrc->setMetShards( shards );
+    } else {
+       metsrc->setPgroup(grp);    
+    }
+
+    if ( metsrc->useMet() ) {
+    
+       metsrc->get_uvw( 0.0, 0.0, -45.0, 0.0, &u, &v, &w);  
+       if ( mismatch(u, u0) || mismatch(v,v0) || mismatch(w, w0) ) {
+          cerr << "Bad sharded equ. wind val 0-3 : (" << u0 << ", " << v0  << ", " << w0 << ")"
+          << " vs.  (" << u << ", " << v  << ", " << w << ")" << endl;
+          metsrc->signalMetDone();
+          grp->shutdown();
+          exit(1);  
+       } 
+
+       val = metsrc->getData( "t", 3.0, 0.0, 45.0, 0.0 );
+       if ( mismatch(val0, val) ) {
+          cerr << "Bad! sharded 45-deg temp value: " << val0 << " vs. " << val << endl;
+          metsrc->signalMetDone();
+          grp->shutdown();
+          exit(1);  
+       } 
+    
+       metsrc->signalMetDone();
+    }
+
+    /* now have the client fetch the met data in sub-blocks around its parcels */
+    delete metsrc;
+    metsrc = new MetGridSBRot;
+    
+    if ( grp->size() > 2 ) {
+       metsrc->setPgroup(grp, 1);
+    } else {
+       metsrc->setPgroup(grp);    
+    }
+    metsrc->setHalo( true );
+
+    if ( metsrc->useMet() ) {
+    
+       // parcels that straddle the prime meridian
+       plons[0] = 355.0;
+       plats[0] = 40.0;
+       pzs[0] = 0.0;
+       plons[1] = 5.0;
+       plats[1] = 50.0;
+       pzs[1] = 0.0;
+       plons[2] = 0.0;
+       plats[2] = 45.0;
+       pzs[2] = 0.0;
+       metsrc->haloRegion( 3, plons, plats, pzs, 0.01, &nav );
+
+       // inside the sub-block
+       for ( i=0; i<3; i++ ) {
+           val0 = metsrc0->getData( "t", 3.0, plons[i], plats[i], pzs[i] );
+           val = metsrc->getData( "t", 3.0, plons[i], plats[i], pzs[i] );
+           if ( mismatch(val0, val) ) {
+              cerr << "Bad! sub-block temp value at (" << plons[i] << ", " << plats[i] << "): " 
+                   << val0 << " vs. " << val << endl;
+              metsrc->signalMetDone();
+              grp->shutdown();
+              exit(1);  
+           } 
+       }
+       
+       // outside the sub-block, so served point by point
+       val0 = metsrc0->getData( "t", 3.0, 180.0, -45.0, 0.0 );
+       val = metsrc->getData( "t", 3.0, 180.0, -45.0, 0.0 );
+       if ( mismatch(val0, val) ) {
+          cerr << "Bad! out-of-block temp value: " << val0 << " vs. " << val << endl;
+          metsrc->signalMetDone();
+          grp->shutdown();
+          exit(1);  
+       } 
+       
+       // the parcels move away, so a new sub-block is fetched
+       for ( i=0; i<3; i++ ) {
+           plons[i] = plons[i] + 170.0;
+           plats[i] = - plats[i];
+       }
+       metsrc->haloRegion( 3, plons, plats, pzs, 0.01, &nav );
+       for ( i=0; i<3; i++ ) {
+           val0 = metsrc0->getData( "t", 3.0, plons[i], plats[i], pzs[i] );
+           val = metsrc->getData( "t", 3.0, plons[i], plats[i], pzs[i] );
+           if ( mismatch(val0, val) ) {
+              cerr << "Bad! moved sub-block temp value at (" << plons[i] << ", " << plats[i] << "): " 
+                   << val0 << " vs. " << val << endl;
+              metsrc->signalMetDone();
+              grp->shutdown();
+              exit(1);  
+           } 
+       }
+       
+       // parcels with no usable positions leave no region at all
+       for ( i=0; i<3; i++ ) {
+           plons[i] = RNAN("");
+       }
+       metsrc->haloRegion( 3, plons, plats, pzs, 0.01, &nav );
+       val0 = metsrc0->getData( "t", 3.0, 0.0, 45.0, 0.0 );
+       val = metsrc->getData( "t", 3.0, 0.0, 45.0, 0.0 );
+       if ( mismatch(val0, val) ) {
+          cerr << "Bad! no-region temp value: " << val0 << " vs. " << val << endl;
+          metsrc->signalMetDone();
+          grp->shutdown();
+          exit(1);  
+       } 
+    
+       metsrc->signalMetDone();
+    }
 //cerr << "End" << endl;
     
 
@@ -22,6 +22,7 @@
 #include "gigatraj/gigatraj.hh"
 #include "gigatraj/MetMyGEOS.hh"
 #include "gigatraj/LogLinearVinterp.hh"
+#include "gigatraj/Earth.hh"
 
 #include "test_utils.hh"
 
@@ -625,6 +626,88 @@ int main()
     }
     
     
+    delete metsrc0;
+
+    //*************  Regional subset tests *******************************
+
+    metsrc0 = new MetMyGEOS(basedate);
+    metsrc0->metTag( metCatalog );
+    metsrc0->setOption( "RegionLonMin", eLon2 - 6.0 );
+    metsrc0->setOption( "RegionLonMax", eLon2 + 6.0 );
+    metsrc0->setOption( "RegionLatMin", eLat2 - 6.0 );
+    metsrc0->setOption( "RegionLatMax", eLat2 + 6.0 );
+
+    if ( ! metsrc0->getOption( "RegionLatMax", dd3 ) || mismatch( dd3, eLat2 + 6.0 ) ) {
+       cerr << "Bad RegionLatMax option: " << dd3 << " vs. " << eLat2 + 6.0 << endl;
+       exit(1);
+    }
+
+    // only part of the grid should be read
+    grid3d = metsrc0->Get3D( quant3d, date0 );
+    grid3d->dims( &nx, &ny, &nz );
+    if ( nx >= eNlons || ny >= eNlats || nz != eNvert ) {
+       cerr << "Bad regional grid3d dimensions: " << nx << ", " << ny << ", " << nz
+            << " vs. " << eNlons << ", " << eNlats << ", " << eNvert << endl;
+       exit(1);
+    }
+    delete grid3d;
+
+    // but the values inside the region should be the same
+    tyme = metsrc0->cal2Time( date0 );
+    dd = metsrc0->getData( quant3d, tyme, eLon2, eLat2, eVrt2  );
+    if ( mismatch(dd, eDat3d2) ) {
+       cerr << "Bad regional getdata(" << eLon2 << ", " << eLat2 << ", " << eVrt2 << ") T value: "
+       << dd << " vs. " << eDat3d2 << endl;
+       exit(1);
+    }
+
+    if ( ! metsrc0->inDomain( eLon2, eLat2, eVrt2 )
+      || metsrc0->inDomain( eLon2 + 72.0, eLat2, eVrt2 )
+      || metsrc0->inDomain( eLon2, eLat2 - 36.0, eVrt2 ) ) {
+       cerr << "Bad regional domain test" << endl;
+       exit(1);
+    }
+
+    delete metsrc0;
+
+    //*************  Vertical level window tests *******************************
+
+    // a value from all the levels
+    metsrc0 = new MetMyGEOS(basedate);
+    metsrc0->metTag( metCatalog );
+    tyme = metsrc0->cal2Time( date0 );
+    dd = metsrc0->getData( quant3d, tyme, eLon2, eLat2, 100.0 );
+    delete metsrc0;
+
+    metsrc0 = new MetMyGEOS(basedate);
+    metsrc0->metTag( metCatalog );
+    metsrc0->setLevelWindow( true, 1 );
+    {
+       real plon = eLon2;
+       real plat = eLat2;
+       real pz = 100.0;
+       Earth nav;
+       metsrc0->haloRegion( 1, &plon, &plat, &pz, 0.01, &nav );
+    }
+
+    // only the levels around the parcel should be read
+    grid3d = metsrc0->Get3D( quant3d, date0 );
+    grid3d->dims( &nx, &ny, &nz );
+    if ( nx != eNlons || ny != eNlats || nz >= eNvert ) {
+       cerr << "Bad level window grid3d dimensions: " << nx << ", " << ny << ", " << nz
+            << " vs. " << eNlons << ", " << eNlats << ", " << eNvert << endl;
+       exit(1);
+    }
+    delete grid3d;
+
+    // but give the same value
+    dd2 = metsrc0->getData( quant3d, tyme, eLon2, eLat2, 100.0 );
+    if ( mismatch(dd2, dd) ) {
+       cerr << "Bad level window getdata(" << eLon2 << ", " << eLat2 << ", " << 100.0 << ") T value: "
+       << dd2 << " vs. " << dd << endl;
+       exit(1);
+    }
+
     delete metsrc0;
     
 
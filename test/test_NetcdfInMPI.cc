@@ -50,6 +50,7 @@ int main(int argc, char* argv[])
     Parcel* ps;
     std::vector<Parcel> vps;
     Flock *fps;
+    Swarm *sps;
     real lat,lon,z;
     int nxt;
     int i;
@@ -122,6 +123,28 @@ int main(int argc, char* argv[])
     }   
     delete fps;
     
+    // and a Swarm, checking a parcel that is not on the root processor
+    input.reset();
+    
+    sps = new Swarm(p, pgrp, np, 0);
+    input.apply( *sps );
+    i = 9;
+    p = sps->get(i);
+    p.getPos( &lon, &lat );
+    z = p.getZ();
+    if ( mismatch( lon, 117.0 ) 
+      || mismatch( lat, 40.0 )
+      || mismatch( z, 70.0 ) ) {
+      
+       cerr << " misread Swarm parcel[" << i << "]: "
+       << "( " << lon << ", " << lat << ", " << z << " ) "
+       << " instead of ( 117, 40, 70 )" << endl;
+    
+       exit(1);
+      
+    }   
+    delete sps;
+    
     
     input.close();
 
@@ -155,6 +155,48 @@ int main()
     } 
     delete swarm;
     
+    
+    // with a fixed seed, each parcel's position depends only on its index,
+    // no matter which kind of container holds it
+    unsigned int saw = 12345;
+    gen.seed( &saw );
+    aflock = gen.create_array(p, np);
+    vflock = gen.create_vector(p, np);
+    swarm = gen.create_Swarm(p, np, NULLPTR ); 
+    vit = vflock->begin();
+    for ( sit = swarm->begin(); sit != swarm->end(); sit++ ) {
+        i = sit.index();
+        aflock[i].getPos( &lon, &lat );
+        sit->getPos( &xlon, &xlat );
+        if ( mismatch( xlat, lat ) || mismatch( xlon, lon ) ) {
+           cerr << "Seeded Swarm parcel " << i << " differs from array: (" << lon << "," << lat << ") != (" 
+                << xlon << ", " << xlat << ")" << endl;
+           exit(1);
+        }
+        vit->getPos( &xlon, &xlat );
+        if ( mismatch( xlat, lat ) || mismatch( xlon, lon ) ) {
+           cerr << "Seeded vector parcel " << i << " differs from array: (" << lon << "," << lat << ") != (" 
+                << xlon << ", " << xlat << ")" << endl;
+           exit(1);
+        }
+        vit++;
+    }
+    delete swarm;
+    delete vflock;
+    
+    // and a different seed gives different positions
+    saw = 54321;
+    gen.seed( &saw );
+    vflock = gen.create_vector(p, np);
+    aflock[0].getPos( &lon, &lat );
+    (*vflock)[0].getPos( &xlon, &xlat );
+    if ( ! mismatch( xlat, lat ) && ! mismatch( xlon, lon ) ) {
+       cerr << "Different seeds gave the same parcel: (" << lon << "," << lat << ")" << endl;
+       exit(1);
+    }
+    delete vflock;
+    delete []aflock;
+    
     exit(0);
     
 }
@@ -86,6 +86,48 @@ int main()
       }
    }
    
+   // the counter-based numbers for an item depend only on the seed and the item index,
+   // and with a zero seed and zero index they are the Philox-4x32-10 known-answer values
+   {
+      RandomSrc rnd0(0);
+      RandomSrc rnd1(0);
+      real vals0[4], vals1[4];
+      const real kat[4] = { 1713891541.0, 3781805453.0, 3159862348.0, 2600524760.0 };
+      
+      rnd0.uniform4( 0, vals0 );
+      for ( i=0; i<4; i++ ) {
+          if ( ABS( vals0[i]*4294967295.0 - kat[i] ) > 1000.0 ) {
+             cerr << "Philox known-answer mismatch in word " << i << ": " 
+                  << vals0[i]*4294967295.0 << " vs. " << kat[i] << endl;
+             exit(1);
+          }
+      }
+      
+      // sequential draws do not disturb the per-item numbers
+      val = rnd1.uniform();
+      val = rnd1.uniform();
+      rnd1.uniform4( 1000, vals1 );
+      rnd0.uniform4( 1000, vals0 );
+      for ( i=0; i<4; i++ ) {
+          if ( vals0[i] != vals1[i] ) {
+             cerr << "uniform4() is not reproducible: " << vals0[i] << " vs. " << vals1[i] << endl;
+             exit(1);
+          }
+      }
+      
+      // two generators with the same seed produce the same sequence
+      rnd0.seed( NULL );
+      n = 77;
+      rnd0.seed( (const unsigned int*)&n );
+      rnd1.seed( (const unsigned int*)&n );
+      for ( i=0; i<10; i++ ) {
+          if ( rnd0.uniform() != rnd1.uniform() ) {
+             cerr << "Identically-seeded generators differ" << endl;
+             exit(1);
+          }
+      }
+   }
+   
    exit(0);
 
 }
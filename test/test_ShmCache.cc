@@ -0,0 +1,194 @@
+
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+/*!
+     Test program for the ShmCache (shared met cache) class
+*/
+     
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/ShmCache.hh"
+#include "gigatraj/MetGridSBRot.hh"
+
+#include "test_utils.hh"
+
+using namespace gigatraj;
+using std::cerr;
+using std::endl;
+
+
+int main() 
+{
+    ShmCache* cache;
+    ShmCache* server;
+    MetGridSBRot* metsrc1;
+    MetGridSBRot* metsrc2;
+    std::ostringstream sockname;
+    std::string item;
+    std::string got;
+    const char* data;
+    size_t size;
+    long items, hits, misses;
+    long hits0, misses0;
+    size_t bytes;
+    pid_t pid;
+    int status;
+    int i;
+    real u1, u2;
+    real thet1, thet2;
+    
+    sockname << "test_ShmCache." << getpid() << ".sock";
+
+    // start up a server
+    pid = fork();
+    if ( pid == 0 ) {
+       server = new ShmCache( sockname.str() );
+       try {
+          server->serve();
+       } catch (...) {
+          _exit(1);
+       }
+       delete server;
+       _exit(0);
+    }
+    if ( pid < 0 ) {
+       cerr << "Could not start a server" << endl;
+       exit(1);
+    }
+    
+    cache = new ShmCache( sockname.str() );
+
+    // wait for the server to come up
+    for ( i=0; i < 100 && ! cache->stats( items, bytes, hits, misses ); i++ ) {
+       usleep( 100000 );
+    }
+    if ( i >= 100 ) {
+       cerr << "The server did not come up" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    //------------------ the basics
+    
+    if ( cache->attach( "nothing", size ) != NULLPTR ) {
+       cerr << "Attached to an item that does not exist" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    item = "a test item, with enough bytes in it to be worth sharing";
+    if ( ! cache->put( "test key", item ) ) {
+       cerr << "Server would not take an item" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    // the server already has this
+    if ( cache->put( "test key", "something else" ) ) {
+       cerr << "Server took a second copy of an item" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    data = cache->attach( "test key", size );
+    if ( data == NULLPTR || size != item.size() ) {
+       cerr << "Could not attach to an item" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    got = std::string( data, size );
+    cache->detach( data, size );
+    if ( got != item ) {
+       cerr << "Item mismatch: [" << got << "] vs [" << item << "]" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    if ( ! cache->stats( items, bytes, hits, misses ) 
+         || items != 1 || bytes != item.size() || hits != 1 || misses != 1 ) {
+       cerr << "Bad server statistics: " << items << " items, " << bytes << " bytes, " 
+            << hits << " hits, " << misses << " misses" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    //------------------ sharing met data
+    
+    // two independent met sources
+    metsrc1 = new MetGridSBRot();
+    metsrc1->setSharedCache( sockname.str() );
+    metsrc2 = new MetGridSBRot();
+    metsrc2->setSharedCache( sockname.str() );
+    
+    // the first source derives the fields itself and shares them...
+    u1 = metsrc1->get_u( 3.2*24.0*3600.0, 23.4, 45.1, 30.0 );
+    thet1 = metsrc1->getData( "theta", 3.2*24.0*3600.0, 23.4, 45.1, 30.0 );
+    cache->stats( items, bytes, hits0, misses0 );
+    if ( items <= 1 ) {
+       cerr << "Met source did not share its data" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    // ... and the second one gets them from the server
+    u2 = metsrc2->get_u( 3.2*24.0*3600.0, 23.4, 45.1, 30.0 );
+    thet2 = metsrc2->getData( "theta", 3.2*24.0*3600.0, 23.4, 45.1, 30.0 );
+    cache->stats( items, bytes, hits, misses );
+    if ( hits <= hits0 || misses != misses0 ) {
+       cerr << "Met source did not use the shared data: " << hits << " vs " << hits0 << " hits, " 
+            << misses << " vs " << misses0 << " misses" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    if ( u1 != u2 || thet1 != thet2 ) {
+       cerr << "Shared met data mismatch: " << u1 << " vs " << u2 << ", " << thet1 << " vs " << thet2 << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    
+    delete metsrc2;
+    delete metsrc1;
+    
+    //------------------ shutting down
+    
+    if ( ! cache->shutdown() ) {
+       cerr << "Server would not shut down" << endl;
+       kill( pid, SIGTERM );
+       exit(1);
+    }
+    waitpid( pid, &status, 0 );
+    if ( ! WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+       cerr << "Server did not exit cleanly" << endl;
+       exit(1);
+    }
+    // the server is gone
+    if ( cache->stats( items, bytes, hits, misses ) ) {
+       cerr << "Server is still running" << endl;
+       exit(1);
+    }
+    
+    delete cache;
+
+    //------------------------------------------------------------------
+
+    // if we got this far, everything is OK
+    exit(0);
+    
+}
@@ -378,6 +378,152 @@ int main(int argc, char* argv[])
 
     delete swm;
 
+    pgrp->sync();
+
+    // now test re-balancing the parcel load among the processors
+    swm = new Swarm( p, pgrp, n, 0);
+    
+    // the first half of the parcels will not be traced, 
+    // so the lower-ranked processors have nothing to do
+    for ( k=0; k<n; k++ ) {
+        p.setPos( k*3.0, 60.0 - k*1.0 );
+        p.setZ( 500.0 );
+        p.setTime( 0.0 );
+        p.tag( k );
+        p.clearNoTrace();
+        if ( k < n/2 ) {
+           p.setNoTrace();
+        }
+        swm->set(k, p, 1);
+    }
+    pgrp->sync();
+    
+    swm->setRebalance(1);
+    swm->advance( 0.1 );
+    swm->advance( 0.1 );
+    pgrp->sync();
+
+    if ( nprocs > 1 ) {
+       if ( my_id == 0 ) {
+          if ( swm->migrations() <= 0 ) {
+             cerr << "J: No parcels were migrated" << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+          // (n/2 active parcels spread over nprocs processors)
+          if ( swm->loadImbalance() > ( (n/2)/nprocs + 1.5 )/( (n/2.0)/nprocs ) ) {
+             cerr << "J: Load imbalance too large after re-balancing: " << swm->loadImbalance() << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+       }
+    }
+    pgrp->sync();
+    
+    // the parcels should still have the same indices
+    for ( iter=swm->begin(); iter!=swm->end(); iter++ ) {
+       k = iter.index();
+       if ( mismatch( iter->tag(), k ) ) {
+          cerr << "K: parcel index " << k << " has tag " << iter->tag() << endl;
+          pgrp->shutdown();
+          exit(1);
+       }
+    }
+    pgrp->sync();
+    
+    for ( k=0; k<n; k++ ) {
+       p = swm->get(k);
+       p.getPos(&lon,&lat);
+       if ( ( k <  n/2 && ( mismatch( lon, k*3.0 ) || mismatch( lat, 60.0 - k*1.0 ) ) )
+          || ( k >= n/2 && mismatch( p.getTime(), 0.2 ) ) ) {
+          cerr << "L: Bad parcel " << k << " after re-balancing: (" << lon << ", " << lat << ") at " << p.getTime() << endl;
+          pgrp->shutdown();
+          exit(1);
+       }
+    }
+    pgrp->sync();
+
+    delete swm;
+
+    pgrp->sync();
+
+    // now test migrating the parcels to spatial domains.
+    // The parcels are spread evenly over the globe's area, 
+    // in an order that has nothing to do with their indices.
+    swm = new Swarm( p, pgrp, n, 0);
+    for ( k=0; k<n; k++ ) {
+        p.setPos( k*3.0, asin( ( ((k*37) % n) + 0.5 )/n*2.0 - 1.0 )*180.0/PI );
+        p.setZ( 500.0 );
+        p.setTime( 0.0 );
+        p.tag( k );
+        p.clearNoTrace();
+        swm->set(k, p, 1);
+    }
+    pgrp->sync();
+    
+    for ( int mode=SWARM_DOMAIN_BANDS; mode <= SWARM_DOMAIN_TILES; mode++ ) {
+    
+       swm->setDomains( mode );
+       swm->setRebalance( -1 );
+       // (the first step migrates the parcels; the second gathers the loads)
+       swm->advance( 0.1 );
+       swm->advance( 0.1 );
+       pgrp->sync();
+       
+       if ( swm->getDomains() != mode ) {
+          cerr << "M: domain mode " << mode << " not set" << endl;
+          pgrp->shutdown();
+          exit(1);
+       }
+       
+       // every processor should be handling exactly the parcels in its domain
+       std::vector<int> expected( nprocs, 0 );
+       for ( k=0; k<n; k++ ) {
+           p = swm->get(k);
+           p.getPos(&lon,&lat);
+           expected[ swm->domain( lon, lat ) ]++;
+       }
+       if ( my_id == 0 ) {
+          if ( nprocs > 1 && swm->migrations() <= 0 ) {
+             cerr << "M: No parcels were migrated to their domains" << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+          for ( int ip=0; ip < nprocs; ip++ ) {
+              if ( swm->loads()[ip] != expected[ip] ) {
+                 cerr << "M: processor " << ip << " has " << swm->loads()[ip] 
+                      << " parcels, but its domain " << mode << " has " << expected[ip] << endl;
+                 pgrp->shutdown();
+                 exit(1);
+              }
+          }
+       }
+       pgrp->sync();
+       
+       // the parcels should still have the same indices and contents
+       for ( iter=swm->begin(); iter!=swm->end(); iter++ ) {
+          k = iter.index();
+          if ( mismatch( iter->tag(), k ) ) {
+             cerr << "N: parcel index " << k << " has tag " << iter->tag() << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+       }
+       pgrp->sync();
+       for ( k=0; k<n; k++ ) {
+          p = swm->get(k);
+          if ( mismatch( p.getTime(), 0.2*mode ) ) {
+             cerr << "N: Bad parcel " << k << " time after domain migration: " << p.getTime() << endl;
+             pgrp->shutdown();
+             exit(1);
+          }
+       }
+       pgrp->sync();
+    
+    }
+    
+    delete swm;
+
 
     /* Shut down MPI */
     //MPI_Finalize();
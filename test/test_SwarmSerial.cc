@@ -23,6 +23,8 @@
 #include "gigatraj/Parcel.hh"
 #include "gigatraj/SerialGrp.hh"
 #include "gigatraj/Swarm.hh"
+#include "gigatraj/MetGridSBRot.hh"
+#include "gigatraj/IntegRK32.hh"
 
 #include "test_utils.hh"
 
@@ -47,6 +49,13 @@ int main()
     Swarm::iterator iter;
     SerialGrp *pgrp;
     int k;
+    MetGridSBRot *metsrc;
+    Swarm *tswm;
+    real lon2;
+    real lat2;
+    real z2;
+    Integrator *integ0;
+    IntegRK32 adaptive;
 
     // create a process group (serial, of course)
     pgrp = new SerialGrp();
@@ -145,8 +154,59 @@ int main()
        exit(1);
     }
     
-
     delete swm;
 
+    // tracing with a pool of threads must give the same answers as without
+    metsrc = new MetGridSBRot( 5.0, 5.0, 40.0, 30.0 );
+    p.setMet( *metsrc );
+    // (the second time around, with an integrator that keeps scratch space between calls)
+    integ0 = p.integrator();
+    for ( int pass=0; pass < 2; pass++ ) {
+       if ( pass == 1 ) {
+          p.integrator( &adaptive );
+       }
+       swm = new Swarm( p, pgrp, 500, 0 );
+       tswm = new Swarm( p, pgrp, 500, 0 );
+       for ( k=0; k < 500; k++ ) {
+           p.setPos( (k*37) % 360, -80.0 + (k*13) % 160 );
+           p.setZ( 1.0 + (k % 39) );
+           swm->set( k, p );
+           tswm->set( k, p );
+       }
+       tswm->setThreads( 4, 16 );
+#ifdef USE_THREADS
+       if ( tswm->getThreads() != 4 ) {
+#else
+       if ( tswm->getThreads() != 1 ) {
+#endif
+          cerr << "Bad thread count: " << tswm->getThreads() << endl;
+          exit(1);
+       }
+       for ( k=0; k < 10; k++ ) {
+           swm->advance( 0.05 );
+           tswm->advance( 0.05 );
+       }
+       for ( k=0; k < 500; k++ ) {
+           p = swm->get( k );
+           p.getPos( &lon, &lat );
+           z = p.getZ();
+           p = tswm->get( k );
+           p.getPos( &lon2, &lat2 );
+           z2 = p.getZ();
+           if ( mismatch( lon, lon2 ) || mismatch( lat, lat2 ) || mismatch( z, z2 ) 
+             || mismatch( swm->get( k ).getTime(), tswm->get( k ).getTime() ) ) {
+              cerr << "Threaded tracing differs on parcel " << k << ": "
+                   << "(" << lon << ", " << lat << ", " << z << ") != "
+                   << "(" << lon2 << ", " << lat2 << ", " << z2 << ")" << endl;
+              exit(1);
+           }
+       }
+    
+       delete tswm;
+       delete swm;
+    }
+    p.integrator( integ0 );
+    delete metsrc;
+
     exit(0);
 }
@@ -0,0 +1,164 @@
+/******************************************************************************* 
+***  Copyright (c) 2023 United States Government as represented by the Administrator of the National Aeronautics and Space Administration.  All Rights Reserved. 
+*** 
+*** Disclaimer:
+*** No Warranty: THE SUBJECT SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER EXPRESSED, IMPLIED, OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL CONFORM TO SPECIFICATIONS, ANY IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, OR FREEDOM FROM INFRINGEMENT, ANY WARRANTY THAT THE SUBJECT SOFTWARE WILL BE ERROR FREE, OR ANY WARRANTY THAT DOCUMENTATION, IF PROVIDED, WILL CONFORM TO THE SUBJECT SOFTWARE. THIS AGREEMENT DOES NOT, IN ANY MANNER, CONSTITUTE AN ENDORSEMENT BY GOVERNMENT AGENCY OR ANY PRIOR RECIPIENT OF ANY RESULTS, RESULTING DESIGNS, HARDWARE, SOFTWARE PRODUCTS OR ANY OTHER APPLICATIONS RESULTING FROM USE OF THE SUBJECT SOFTWARE.  FURTHER, GOVERNMENT AGENCY DISCLAIMS ALL WARRANTIES AND LIABILITIES REGARDING THIRD-PARTY SOFTWARE, IF PRESENT IN THE ORIGINAL SOFTWARE, AND DISTRIBUTES IT "AS IS." 
+*** Waiver and Indemnity:  RECIPIENT AGREES TO WAIVE ANY AND ALL CLAIMS AGAINST THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT.  IF RECIPIENT'S USE OF THE SUBJECT SOFTWARE RESULTS IN ANY LIABILITIES, DEMANDS, DAMAGES, EXPENSES OR LOSSES ARISING FROM SUCH USE, INCLUDING ANY DAMAGES FROM PRODUCTS BASED ON, OR RESULTING FROM, RECIPIENT'S USE OF THE SUBJECT SOFTWARE, RECIPIENT SHALL INDEMNIFY AND HOLD HARMLESS THE UNITED STATES GOVERNMENT, ITS CONTRACTORS AND SUBCONTRACTORS, AS WELL AS ANY PRIOR RECIPIENT, TO THE EXTENT PERMITTED BY LAW.  RECIPIENT'S SOLE REMEDY FOR ANY SUCH MATTER SHALL BE THE IMMEDIATE, UNILATERAL TERMINATION OF THIS AGREEMENT. 
+***  (Please see the NOSA_19110.pdf file for more information.) 
+*** 
+********************************************************************************/
+
+
+// Tests the IntegRK4Cart and IntegRK32 integrators on trajectories that pass over the poles
+
+#include <iostream>
+#include "gigatraj/gigatraj.hh"
+#include "gigatraj/Parcel.hh"
+#include "gigatraj/MetSBRot.hh"
+#include "gigatraj/Earth.hh"
+#include "gigatraj/IntegRK4Cart.hh"
+#include "gigatraj/IntegRK32.hh"
+
+#include "test_utils.hh"
+
+using namespace gigatraj;
+using std::cerr;
+using std::endl;
+
+int main() 
+{
+
+    Parcel p;
+    Earth e;
+    MetSBRot metsrc;
+    IntegRK4Cart integ;
+    IntegRK32 adaptive( 1.0 );
+    real lon;
+    real lat;
+    real maxlat;
+    real olats[2] = { 0.0, 30.0 };
+    double dt;
+    double val;
+    double period;
+    int nsteps;
+    int i;
+    int trial;
+    
+    if ( integ.id != "IntegRK4Cart" ) {
+       cerr << "Bad integrator id: " << integ.id << endl;
+       exit(1);
+    }
+
+    p.setMet( metsrc );
+    p.integrator( &integ );
+    
+    // solid-body rotation about an axis in the equatorial plane,
+    // so that the flow passes directly over both poles
+    metsrc.set( 40.0, 90.0 );
+    
+    // the time (in days) to go once around the planet,
+    // in time steps of about an hour
+    period = 2.0*PI*e.radius()*1000.0/40.0/86400.0;
+    nsteps = static_cast<int>( period*24.0 + 0.5 );
+    dt = period/nsteps;
+
+    for ( trial=0; trial<2; trial++ ) {
+    
+        p.setTime( 0.0 );
+        p.setPos( 0.0, olats[trial] );
+        
+        // one full rotation should return the parcel to its starting point
+        maxlat = -90.0;
+        for ( i=0; i<nsteps; i++ ) {
+            p.advance( dt );
+            lat = p.getLat();
+            if ( lat > maxlat ) {
+               maxlat = lat;
+            }
+        }
+        lon = p.getLon();
+        lat = p.getLat();
+        if ( mismatch( lon, 0.0, 0.01 ) || mismatch( lat, olats[trial], 0.01 ) ) {
+           cerr << "Bad polar ending lon,lat: ( " << 0.0 << ", " << olats[trial] << " )" <<  
+               " ) --> ( " << lon << ", " << lat << " )" << endl;
+           exit(1);
+        }
+        // and the parcel should have gone nearly over the pole on the way
+        if ( maxlat < 89.0 ) {
+           cerr << "Polar trajectory from ( 0.0, " << olats[trial] << " ) reached only " << maxlat << endl;
+           exit(1);
+        }
+        
+        // now go backwards
+        for ( i=0; i<nsteps; i++ ) {
+            p.advance( -dt );
+        }
+        lon = p.getLon();
+        lat = p.getLat();
+        if ( mismatch( lon, 0.0, 0.01 ) || mismatch( lat, olats[trial], 0.01 ) ) {
+           cerr << "Bad polar restarting lon,lat: ( " << 0.0 << ", " << olats[trial] << " )" <<  
+               " ) --> ( " << lon << ", " << lat << " )" << endl;
+           exit(1);
+        }
+    }
+    
+    ////////////  the adaptive integrator, with one-day time steps
+    
+    if ( adaptive.id != "IntegRK32" ) {
+       cerr << "Bad integrator id: " << adaptive.id << endl;
+       exit(1);
+    }
+    
+    p.integrator( &adaptive );
+    
+    nsteps = static_cast<int>( period + 0.5 );
+    dt = period/nsteps;
+
+    for ( trial=0; trial<2; trial++ ) {
+    
+        p.setTime( 0.0 );
+        p.setPos( 0.0, olats[trial] );
+        
+        maxlat = -90.0;
+        for ( i=0; i<nsteps; i++ ) {
+            p.advance( dt );
+            lat = p.getLat();
+            if ( lat > maxlat ) {
+               maxlat = lat;
+            }
+        }
+        lon = p.getLon();
+        lat = p.getLat();
+        if ( mismatch( lon, 0.0, 0.01 ) || mismatch( lat, olats[trial], 0.01 ) ) {
+           cerr << "Bad adaptive polar ending lon,lat: ( " << 0.0 << ", " << olats[trial] << " )" <<  
+               " ) --> ( " << lon << ", " << lat << " )" << endl;
+           exit(1);
+        }
+        if ( maxlat < 89.0 ) {
+           cerr << "Adaptive polar trajectory from ( 0.0, " << olats[trial] << " ) reached only " << maxlat << endl;
+           exit(1);
+        }
+    }
+    
+    // a one-day step is much too long to take whole at this tolerance
+    if ( adaptive.meanSubsteps() <= 1.0 ) {
+       cerr << "Adaptive integrator did not substep: " << adaptive.meanSubsteps() << endl;
+       exit(1);
+    }
+    
+    // with a loose tolerance, the number of substeps goes down
+    val = adaptive.meanSubsteps();
+    adaptive.resetStats();
+    adaptive.tolerance( 100.0 );
+    p.setTime( 0.0 );
+    p.setPos( 0.0, 0.0 );
+    for ( i=0; i<nsteps; i++ ) {
+        p.advance( dt );
+    }
+    if ( adaptive.meanSubsteps() < 1.0 || adaptive.meanSubsteps() >= val ) {
+       cerr << "Bad adaptive mean substeps: " << adaptive.meanSubsteps() << " vs. " << val << endl;
+       exit(1);
+    }
+    
+    exit(0);
+}